@@ -36,6 +36,8 @@ public:
   int64_t acquire_ref()
   {
     int64_t idx = icpu_id();
+    // sched_getcpu() may fail or exceed OB_MAX_CPU_NUM on big boxes
+    idx = (idx < 0) ? 0 : (idx % MAX_REF_CNT);
     ref(idx, 1);
     return idx;
   }
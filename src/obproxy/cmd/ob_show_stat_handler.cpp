@@ -15,11 +15,14 @@
 #include "cmd/ob_show_stat_handler.h"
 #include "iocore/eventsystem/ob_event_processor.h"
 #include "iocore/eventsystem/ob_task.h"
+#include "obutils/ob_proxy_config.h"
+#include "proxy/mysql/ob_mysql_sm_time_histogram.h"
 
 using namespace oceanbase::common;
 using namespace oceanbase::obmysql;
 using namespace oceanbase::obproxy::net;
 using namespace oceanbase::obproxy::event;
+using namespace oceanbase::obproxy::proxy;
 
 namespace oceanbase
 {
@@ -74,6 +77,11 @@ int ObShowStatHandler::handle_show_stat(int event, void *data)
     }
   }
 
+  if (OB_SUCC(ret) && get_global_proxy_config().enable_cmd_time_histogram
+      && OB_FAIL(dump_cmd_time_histograms())) {
+    WARN_ICMD("fail to dump cmd time histograms", K(ret));
+  }
+
   if (OB_SUCC(ret)) {
     if (OB_FAIL(encode_eof_packet())) {
       WARN_ICMD("fail to encode eof packet", K(ret));
@@ -108,6 +116,70 @@ int ObShowStatHandler::dump_stat_item(const obproxy::ObRecRecord *record)
   return ret;
 }
 
+// every phase of cmd time histograms is shown as several stats, such as
+// cmd_time_histogram_server_process_request_p99, all in us except count
+int ObShowStatHandler::dump_cmd_time_histograms()
+{
+  int ret = OB_SUCCESS;
+  static const char *HISTOGRAM_PREFIX = "cmd_time_histogram_";
+  static const char *SUFFIXES[] = {"count", "avg", "p50", "p90", "p99", "p999", "max"};
+  static const double PERCENTILES[] = {50.0, 90.0, 99.0, 99.9};
+  ObCmdTimeHistograms *histograms = NULL;
+  char name[OB_MAX_COLUMN_NAME_LENGTH];
+
+  if (OB_ISNULL(histograms = new (std::nothrow) ObCmdTimeHistograms())) {
+    ret = OB_ALLOCATE_MEMORY_FAILED;
+    WARN_ICMD("fail to new ObCmdTimeHistograms", K(ret));
+  } else {
+    get_merged_cmd_time_histograms(*histograms);
+    for (int64_t type = 0; OB_SUCC(ret) && type < CMD_TIME_HISTOGRAM_MAX_TYPE; ++type) {
+      const ObCmdTimeHistogramType histogram_type = static_cast<ObCmdTimeHistogramType>(type);
+      const ObLatencyHistogram &histogram = histograms->get_histogram(histogram_type);
+      const int64_t count = histogram.get_count();
+      for (int64_t i = 0; OB_SUCC(ret) && count > 0 && i < ARRAYSIZEOF(SUFFIXES); ++i) {
+        int64_t value = 0;
+        if (0 == i) {
+          value = count;
+        } else if (1 == i) {
+          value = histogram.get_sum() / count;
+        } else if (i < ARRAYSIZEOF(SUFFIXES) - 1) {
+          value = histogram.get_value_at_percentile(PERCENTILES[i - 2]);
+        } else {
+          value = histogram.get_max();
+        }
+        const int64_t len = snprintf(name, sizeof(name), "%s%s_%s", HISTOGRAM_PREFIX,
+                                     get_cmd_time_histogram_name(histogram_type), SUFFIXES[i]);
+        if (OB_UNLIKELY(len <= 0) || OB_UNLIKELY(len >= static_cast<int64_t>(sizeof(name)))) {
+          ret = OB_BUF_NOT_ENOUGH;
+          WARN_ICMD("fail to fill histogram stat name", K(len), K(ret));
+        } else if (match_like(name, like_name_) && OB_FAIL(dump_stat_item(name, value))) {
+          WARN_ICMD("fail to dump histogram stat item", K(name), K(ret));
+        }
+      }
+    }
+    delete histograms;
+    histograms = NULL;
+  }
+  return ret;
+}
+
+int ObShowStatHandler::dump_stat_item(const char *name, const int64_t value)
+{
+  int ret = OB_SUCCESS;
+  ObNewRow row;
+  ObObj cells[OB_SC_MAX_STAT_COLUMN_ID];
+  cells[OB_SC_STAT_NAME].set_varchar(name);
+  cells[OB_SC_VALUE].set_int(value);
+  cells[OB_SC_PERSIST_TYPE].set_varchar(get_persist_type_str(RECP_NULL));
+
+  row.cells_ = cells;
+  row.count_ = OB_SC_MAX_STAT_COLUMN_ID;
+  if (OB_FAIL(encode_row_packet(row))) {
+    WARN_ICMD("fail to encode row packet", K(row), K(ret));
+  }
+  return ret;
+}
+
 int ObShowStatHandler::dump_stat_header()
 {
   int ret = OB_SUCCESS;
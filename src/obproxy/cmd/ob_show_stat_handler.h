@@ -33,6 +33,8 @@ private:
   int handle_show_stat(int event, void *data);
   int dump_stat_header();
   int dump_stat_item(const obproxy::ObRecRecord *record);
+  int dump_cmd_time_histograms();
+  int dump_stat_item(const char *name, const int64_t value);
   const common::ObString get_persist_type_str(const obproxy::ObRecPersistType type) const;
 
 private:
@@ -19,6 +19,7 @@
 #include "utils/ob_proxy_blowfish.h"
 #include "utils/ob_proxy_utils.h"
 #include "obutils/ob_proxy_config_utils.h"
+#include "stat/ob_processor_stats.h"
 #include "dbconfig/protobuf/dds-api/database.pb.h"
 #include "dbconfig/protobuf/dds-api/databaseAuthorities.pb.h"
 #include "dbconfig/protobuf/dds-api/databaseVariables.pb.h"
@@ -50,6 +51,25 @@ namespace obproxy
 namespace dbconfig
 {
 
+// whether rule_info of the current router is built from the same marked router,
+// then it is copied instead of parsed again
+static bool is_same_shard_rule(const Map<std::string, std::string> &rule_map,
+                               const bool is_sequence, const ObShardRule &rule_info)
+{
+  // rules kept in rule_info must not be removed
+  bool bret = rule_info.is_sequence_ == is_sequence
+              && (rule_info.tb_name_pattern_.empty() || rule_map.count("tbNamePattern") > 0)
+              && (rule_info.db_name_pattern_.empty() || rule_map.count("dbNamePattern") > 0)
+              && (rule_info.tb_suffix_.empty() || rule_map.count("tbSuffixPadding") > 0)
+              && (rule_info.tb_rules_.empty() || rule_map.count("tbRules") > 0)
+              && (rule_info.db_rules_.empty() || rule_map.count("dbRules") > 0)
+              && (rule_info.es_rules_.empty() || rule_map.count("elasticRules") > 0);
+  for (auto it = rule_map.cbegin(); bret && it != rule_map.cend(); ++it) {
+    bret = ObProxyPbUtils::is_same_shard_rule(it->first, it->second, rule_info);
+  }
+  return bret;
+}
+
 //-------ObDbConfigChildCont------
 ObDbConfigChildCont::ObDbConfigChildCont(ObProxyMutex *m, ObContinuation *cb_cont, ObEThread *cb_thread, const ObDDSCrdType type)
   : ObDbConfigFetchCont(m, cb_cont, cb_thread, type),
@@ -451,7 +471,10 @@ int ObDbConfigChildCont::parse_shard_tpo(const Any &res)
 int ObDbConfigChildCont::parse_shard_router(const Any &res)
 {
   int ret = OB_SUCCESS;
+  const int64_t begin_time_us = ObTimeUtility::current_time();
   ObShardRouter *child_info = NULL;
+  ObShardRouter *cur_child_info = NULL;
+  int64_t reused_count = 0;
   if (OB_UNLIKELY(!res.Is<ShardsRouter>())) {
     ret = OB_ERR_UNEXPECTED;
     LOG_WARN("resource type is not ShardsRouter", K(ret));
@@ -471,36 +494,57 @@ int ObDbConfigChildCont::parse_shard_router(const Any &res)
       for (auto it = kv_map.cbegin(); it != kv_map.cend(); ++it) {
         child_info->kv_map_.insert(std::pair<std::string, std::string>(it->first, it->second));
       }
+      // only the tables changed since the current version are parsed
+      cur_child_info = reinterpret_cast<ObShardRouter *>(get_global_dbconfig_cache().get_child_info(
+                         db_info_key_, child_info->name_.config_string_, TYPE_SHARDS_ROUTER));
       ObShardRule *rule_info = NULL;
+      ObShardRule *cur_rule_info = NULL;
       for (int i = 0; OB_SUCC(ret) && i < message.routers_size(); ++i) {
         rule_info = NULL;
+        cur_rule_info = NULL;
         const MarkedRouter &marked_router = message.routers(i);
         const std::string &table_name = marked_router.mark();
         string_to_upper_case(const_cast<char *>(table_name.c_str()), static_cast<int32_t>(table_name.length()));
         const Router &router = marked_router.router();
+        const Map<std::string, std::string >& rule_map = router.rules();
+        if (NULL != cur_child_info) {
+          const ObString table_name_str(static_cast<ObString::obstr_size_t>(table_name.length()), table_name.c_str());
+          if (OB_SUCCESS != cur_child_info->get_shard_rule(table_name_str, cur_rule_info)
+              || !is_same_shard_rule(rule_map, marked_router.sequence(), *cur_rule_info)) {
+            cur_rule_info = NULL;
+          }
+        }
         if (OB_ISNULL(rule_info = op_alloc(ObShardRule))) {
           ret = OB_ALLOCATE_MEMORY_FAILED;
           LOG_WARN("fail to alloc memory for ObShardRule", K(ret), K_(db_info_key));
         } else if (OB_FAIL(rule_info->init(table_name))) {
           LOG_WARN("fail to init rule info", "table_name", table_name.c_str(), K(ret));
+        } else if (NULL != cur_rule_info) {
+          if (OB_FAIL(rule_info->assign(*cur_rule_info))) {
+            LOG_WARN("fail to copy rule info", "table_name", table_name.c_str(), K(ret));
+          } else {
+            ++reused_count;
+            if (rule_info->is_sequence_) {
+              child_info->set_sequence_table(table_name);
+            }
+          }
         } else {
           if (marked_router.sequence()) {
             child_info->set_sequence_table(table_name);
             rule_info->set_is_sequence();
             LOG_INFO("succ to set sequence table name", "sequence table", table_name.c_str());
           }
-          const Map<std::string, std::string >& rule_map = router.rules();
           for (auto it = rule_map.cbegin(); OB_SUCC(ret) && it != rule_map.cend(); ++it) {
             if (OB_FAIL(ObProxyPbUtils::parse_shard_rule(it->first, it->second, *rule_info))) {
               LOG_WARN("fail to parse rule info", "rule_name", it->first.c_str(),
                        "rule_value", it->second.c_str());
             }
           } // end for rule map
-          if (OB_SUCC(ret)) {
-            LOG_DEBUG("succ to set db_rule_info", "table_name", table_name.c_str(),
-                      KPC(rule_info));
-            child_info->mr_map_.unique_set(rule_info);
-          }
+        }
+        if (OB_SUCC(ret)) {
+          LOG_DEBUG("succ to set db_rule_info", "table_name", table_name.c_str(),
+                    KPC(rule_info), "is_reused", NULL != cur_rule_info);
+          child_info->mr_map_.unique_set(rule_info);
         }
         if (OB_FAIL(ret) && NULL != rule_info) {
           op_free(rule_info);
@@ -527,8 +571,20 @@ int ObDbConfigChildCont::parse_shard_router(const Any &res)
           LOG_DEBUG("succ to put ObShardRouter", KPC(child_info));
         }
       }
+      if (OB_SUCC(ret)) {
+        const int64_t parsed_count = message.routers_size() - reused_count;
+        const int64_t cost_us = ObTimeUtility::current_time() - begin_time_us;
+        PROCESSOR_SUM_GLOBAL_DYN_STAT(DBCONFIG_SHARD_RULE_PARSED, parsed_count);
+        PROCESSOR_SUM_GLOBAL_DYN_STAT(DBCONFIG_SHARD_RULE_REUSED, reused_count);
+        LOG_INFO("succ to parse shards router", K_(db_info_key), "name", name.c_str(),
+                 "version", child_info->version_, K(parsed_count), K(reused_count), K(cost_us));
+      }
     }
   }
+  if (NULL != cur_child_info) {
+    cur_child_info->dec_ref();
+    cur_child_info = NULL;
+  }
   if (NULL != child_info) {
     child_info->dec_ref();
     child_info = NULL;
@@ -18,6 +18,7 @@
 #include "dbconfig/ob_proxy_db_config_info.h"
 #include "dbconfig/ob_proxy_pb_utils.h"
 #include "dbconfig/ob_proxy_db_config_processor.h"
+#include "stat/ob_processor_stats.h"
 #include "utils/ob_proxy_utils.h"
 #include "utils/ob_proxy_blowfish.h"
 #include "lib/number/ob_number_v2.h"
@@ -1339,6 +1340,32 @@ int64_t ObShardRule::to_string(char *buf, const int64_t buf_len) const
   return pos;
 }
 
+ObShardRule::~ObShardRule()
+{
+  if (NULL != arena_) {
+    arena_->dec_ref();
+    arena_ = NULL;
+  }
+}
+
+int ObShardRule::get_allocator(ObIAllocator *&allocator)
+{
+  int ret = OB_SUCCESS;
+  allocator = NULL;
+  if (NULL == arena_) {
+    if (OB_ISNULL(arena_ = op_alloc(ObShardRuleArena))) {
+      ret = OB_ALLOCATE_MEMORY_FAILED;
+      LOG_WARN("fail to alloc memory for ObShardRuleArena", K(ret));
+    } else {
+      arena_->inc_ref();
+    }
+  }
+  if (OB_SUCC(ret)) {
+    allocator = &arena_->allocator_;
+  }
+  return ret;
+}
+
 int ObShardRule::assign(const ObShardRule &other)
 {
   int ret = OB_SUCCESS;
@@ -1356,33 +1383,21 @@ int ObShardRule::assign(const ObShardRule &other)
     tb_suffix_.assign(other.tb_suffix_);
     tb_tail_.assign(other.tb_tail_);
     db_tail_.assign(other.db_tail_);
-    if (OB_FAIL(assign_rule_list(other.tb_rules_, tb_rules_))) {
+    if (OB_FAIL(tb_rules_.assign(other.tb_rules_))) {
       LOG_WARN("fail to copy tb rules", K(ret));
-    } else if (OB_FAIL(assign_rule_list(other.db_rules_, db_rules_))) {
+    } else if (OB_FAIL(db_rules_.assign(other.db_rules_))) {
       LOG_WARN("fail to copy db rules", K(ret));
-    } else if (OB_FAIL(assign_rule_list(other.es_rules_, es_rules_))) {
+    } else if (OB_FAIL(es_rules_.assign(other.es_rules_))) {
       LOG_WARN("fail to copy es rules", K(ret));
-    }
-  }
-  return ret;
-}
-
-int ObShardRule::assign_rule_list(const ObProxyShardRuleList &src_rule_list,
-                                  ObProxyShardRuleList &target_rule_list)
-{
-  int ret = OB_SUCCESS;
-  ObProxyShardRuleInfo new_rule_info;
-  for (int64_t i = 0; OB_SUCC(ret) && i < src_rule_list.count(); ++i) {
-    new_rule_info.reset();
-    const ObProxyShardRuleInfo &rule_info = src_rule_list.at(i);
-    if (OB_FAIL(ObProxyPbUtils::force_parse_groovy(rule_info.shard_rule_str_.config_string_,
-                new_rule_info, allocator_))) {
-      LOG_WARN("fail to parse shard rule str", K(rule_info), K(ret));
-    } else if (!new_rule_info.is_valid()) {
-      // do nothing
-      LOG_WARN("rule str is not support", K(rule_info.shard_rule_str_));
-    } else if (OB_FAIL(target_rule_list.push_back(new_rule_info))) {
-      LOG_WARN("fail to push back rule info", K(new_rule_info), K(ret));
+    } else if (arena_ != other.arena_) {
+      if (NULL != arena_) {
+        arena_->dec_ref();
+        arena_ = NULL;
+      }
+      if (NULL != other.arena_) {
+        other.arena_->inc_ref();
+        arena_ = other.arena_;
+      }
     }
   }
   return ret;
@@ -1497,13 +1512,19 @@ int ObShardRule::parse_from_json(const json::Value &json_value)
     }
   }
 
+  ObIAllocator *allocator = NULL;
+  if (OB_SUCC(ret) && OB_FAIL(get_allocator(allocator))) {
+    LOG_WARN("fail to get allocator", K(ret));
+  }
   if (OB_SUCC(ret)) {
-    if (NULL != tb_rules_config && OB_FAIL(ObProxyPbUtils::do_parse_json_rules(tb_rules_config, tb_rules_, allocator_))) {
+    if (NULL != tb_rules_config && OB_FAIL(ObProxyPbUtils::do_parse_json_rules(tb_rules_config, tb_rules_, *allocator))) {
       LOG_WARN("fail to parse tb rule list", K(ret));
-    } else if (NULL != db_rules_config && OB_FAIL(ObProxyPbUtils::do_parse_json_rules(db_rules_config, db_rules_, allocator_))) {
+    } else if (NULL != db_rules_config && OB_FAIL(ObProxyPbUtils::do_parse_json_rules(db_rules_config, db_rules_, *allocator))) {
       LOG_WARN("fail to parse db rule list", K(ret));
-    } else if (NULL != es_rules_config && OB_FAIL(ObProxyPbUtils::do_parse_json_rules(es_rules_config, es_rules_, allocator_))) {
+    } else if (NULL != es_rules_config && OB_FAIL(ObProxyPbUtils::do_parse_json_rules(es_rules_config, es_rules_, *allocator))) {
       LOG_WARN("fail to parse elastic rule list", K(ret));
+    } else {
+      PROCESSOR_SUM_GLOBAL_DYN_STAT(DBCONFIG_SHARD_RULE_PARSED, 1);
     }
   }
 
@@ -1573,6 +1594,23 @@ int ObShardRule::get_physic_index_random(const int64_t physic_size,int64_t &inde
   return ret;
 }
 
+// rules of common shapes are compiled when loaded, others are calculated by ObProxyExpr
+static int calc_shard_rule(const ObProxyShardRuleInfo &rule, const ObProxyExprCtx &expr_ctx,
+                           const SqlFieldResult &sql_result, ObIArray<ObObj> &result_array)
+{
+  int ret = OB_SUCCESS;
+  if (OB_ISNULL(rule.expr_)) {
+    ret = OB_ERR_UNEXPECTED;
+    LOG_WARN("proxy expr is null unexpected", K(ret));
+  } else if (rule.compiled_expr_.is_valid()) {
+    ret = rule.compiled_expr_.calc(expr_ctx, sql_result, result_array);
+  } else {
+    ObProxyExprCalcItem calc_item(const_cast<SqlFieldResult*>(&sql_result));
+    ret = rule.expr_->calc(expr_ctx, calc_item, result_array);
+  }
+  return ret;
+}
+
 int ObShardRule::get_physic_index(const SqlFieldResult &sql_result,
                                   ObProxyShardRuleList &rules,
                                   const int64_t physic_size,
@@ -1599,18 +1637,13 @@ int ObShardRule::get_physic_index(const SqlFieldResult &sql_result,
     for (i = 0; OB_SUCC(ret) && i < rules.count(); i++) {
       const ObProxyShardRuleInfo &rule = rules.at(i);
       ObProxyExprCtx expr_ctx(physic_size, type, is_elastic_index, &allocator);
-      ObProxyExpr *proxy_expr = rule.expr_;
       ObObj result_obj;
       ObSEArray<ObObj, 4> result_array;
       int64_t tmp_index = OBPROXY_MAX_DBMESH_ID;
 
       LOG_DEBUG("begin to calc rule", K(rule));
 
-      ObProxyExprCalcItem calc_item(const_cast<SqlFieldResult*>(&sql_result));
-      if (OB_ISNULL(proxy_expr)) {
-        ret = OB_ERR_UNEXPECTED;
-        LOG_WARN("proxy expr is null unexpected", K(ret));
-      } else if (OB_FAIL(proxy_expr->calc(expr_ctx, calc_item, result_array)) || result_array.empty()) {
+      if (OB_FAIL(calc_shard_rule(rule, expr_ctx, sql_result, result_array)) || result_array.empty()) {
         if (OB_EXPR_COLUMN_NOT_EXIST == ret) {
           ret = OB_SUCCESS;
           continue;
@@ -1680,16 +1713,11 @@ int ObShardRule::get_physic_index_array(const SqlFieldResult &sql_result,
   for (int64_t i = 0; OB_SUCC(ret) && i < rules.count(); i++) {
     const ObProxyShardRuleInfo &rule = rules.at(i);
     ObProxyExprCtx expr_ctx(physic_size, type, is_elastic_index, &allocator);
-    ObProxyExpr *proxy_expr = rule.expr_;
     ObSEArray<ObObj, 4> result_obj_array;
 
     LOG_DEBUG("begin to calc rule", K(rule));
 
-    ObProxyExprCalcItem calc_item(const_cast<SqlFieldResult*>(&sql_result));
-    if (OB_ISNULL(proxy_expr)) {
-      ret = OB_ERR_UNEXPECTED;
-      LOG_WARN("proxy expr is null unexpected", K(ret));
-    } else if (OB_FAIL(proxy_expr->calc(expr_ctx, calc_item, result_obj_array))) {
+    if (OB_FAIL(calc_shard_rule(rule, expr_ctx, sql_result, result_obj_array))) {
       if (OB_EXPR_COLUMN_NOT_EXIST == ret) {
         ret = OB_SUCCESS;
         continue;
@@ -1824,6 +1852,9 @@ int ObShardRouter::assign(const ObDbConfigChild &child_info)
         rule_info = NULL;
       }
     }
+    if (OB_SUCC(ret)) {
+      PROCESSOR_SUM_GLOBAL_DYN_STAT(DBCONFIG_SHARD_RULE_REUSED, mr_map_.count());
+    }
   }
   return ret;
 }
@@ -4187,21 +4218,37 @@ int ObDbConfigCache::handle_new_db_info(ObDbConfigLogicDb &db_info, bool is_from
     LOG_WARN("logic tenant does not exist", K(tenant_name), K(ret));
   } else {
     // directly add into ld map
+    const int64_t swap_begin_time_us = ObTimeUtility::current_time();
+    ObDbConfigLogicDb *cur_db_info = NULL;
     db_info.set_avail_state();
-    CWLockGuard guard(rwlock_);
-    ObDbConfigLogicDb *cur_db_info = tenant_info->ld_map_.remove(db_name);
+    {
+      CWLockGuard guard(rwlock_);
+      if (NULL != (cur_db_info = tenant_info->ld_map_.remove(db_name))) {
+        cur_db_info->set_deleting_state();
+      }
+      if (OB_FAIL(tenant_info->ld_map_.unique_set(&db_info))) {
+        LOG_WARN("fail to add new db info", K(db_name), K(tenant_name), K(ret));
+      } else {
+        db_info.inc_ref();
+        if (!is_from_local) {
+          db_info.set_need_dump_config(true);
+        }
+      }
+    }
+    // the old version may be the last reference of a large config tree,
+    // free it out of the lock so that routing is not blocked meanwhile
     if (NULL != cur_db_info) {
-      cur_db_info->set_deleting_state();
       cur_db_info->dec_ref();
       cur_db_info = NULL;
     }
-    if (OB_FAIL(tenant_info->ld_map_.unique_set(&db_info))) {
-      LOG_WARN("fail to add new db info", K(db_name), K(tenant_name), K(ret));
-    } else {
-      db_info.inc_ref();
-      if (!is_from_local) {
-        db_info.set_need_dump_config(true);
-      }
+    if (OB_SUCC(ret)) {
+      const int64_t now_us = ObTimeUtility::current_time();
+      const int64_t reload_cost_us = now_us - db_info.create_time_us_;
+      const int64_t swap_cost_us = now_us - swap_begin_time_us;
+      PROCESSOR_SUM_GLOBAL_DYN_STAT(DBCONFIG_RELOAD_LOGIC_DB_COUNT, 1);
+      PROCESSOR_SUM_GLOBAL_DYN_STAT(DBCONFIG_RELOAD_LOGIC_DB_TIME, reload_cost_us);
+      LOG_INFO("succ to reload logic db", K(tenant_name), K(db_name), "version", db_info.version_,
+               K(is_from_local), K(reload_cost_us), K(swap_cost_us));
     }
   }
 
@@ -15,6 +15,7 @@
 
 #include "lib/hash/ob_build_in_hashmap.h"
 #include "lib/json/ob_json.h"
+#include "lib/time/ob_time_utility.h"
 #include "share/schema/ob_priv_type.h"
 #include "dbconfig/ob_proxy_json_shard_config_info.h"
 #include "dbconfig/grpc/ob_proxy_grpc_utils.h"
@@ -461,6 +462,22 @@ private:
   DISALLOW_COPY_AND_ASSIGN(ObShardTpo);
 };
 
+// Memory of the parsed rule exprs of one ObShardRule. The exprs are never
+// changed after parsing, so copies of the rule made for a new config version
+// share them instead of parsing the rule strings again.
+class ObShardRuleArena : public common::ObSharedRefCount
+{
+public:
+  ObShardRuleArena() : allocator_() {}
+  virtual ~ObShardRuleArena() {}
+  virtual void free() { op_free(this); }
+
+  common::ObArenaAllocator allocator_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(ObShardRuleArena);
+};
+
 class ObShardRule
 {
 public:
@@ -469,13 +486,16 @@ public:
                   table_name_(), tb_name_pattern_(), db_name_pattern_(),
                   tb_prefix_(), db_prefix_(), tb_suffix_(), tb_tail_(), db_tail_(),
                   tb_rules_(), db_rules_(), es_rules_(),
-                  allocator_() {}
-  ~ObShardRule() {}
+                  arena_(NULL) {}
+  ~ObShardRule();
 
   int init(const std::string &table_name);
   void set_is_sequence() { is_sequence_ = true; }
 
+  // rule lists are copied without parsing, the exprs are shared with other
+  // through the refcounted arena_
   int assign(const ObShardRule &other);
+  int get_allocator(common::ObIAllocator *&allocator);
   void destroy() { op_free(this); }
   int64_t to_string(char *buf, const int64_t buf_len) const;
   int to_json_str(common::ObSqlString &buf) const;
@@ -504,8 +524,6 @@ public:
 
 private:
   static int64_t get_index_from_route_info();
-  int assign_rule_list(const ObProxyShardRuleList &src_rule_list,
-                       ObProxyShardRuleList &target_rule_list);
 public:
   bool is_sequence_;
   int64_t tb_size_;
@@ -523,7 +541,7 @@ public:
   ObProxyShardRuleList tb_rules_;
   ObProxyShardRuleList db_rules_;
   ObProxyShardRuleList es_rules_;
-  common::ObArenaAllocator allocator_;
+  ObShardRuleArena *arena_; // exprs of tb_rules_, db_rules_ and es_rules_
 
   LINK(ObShardRule, shard_rule_link_);
 
@@ -849,7 +867,8 @@ class ObDbConfigLogicDb : public ObDbConfigChild
 public:
   ObDbConfigLogicDb() : ObDbConfigChild(TYPE_DATABASE),
                         dc_state_(DC_BORN),
-                        is_strict_spec_mode_(false), need_update_bt_(false), db_name_(),
+                        is_strict_spec_mode_(false), need_update_bt_(false),
+                        create_time_us_(common::ObTimeUtility::current_time()), db_name_(),
                         db_cluster_(), db_mode_(), db_type_(),
                         testload_prefix_(), da_array_(),
                         dp_array_(), dv_array_(),
@@ -977,6 +996,7 @@ public:
   ObDbConfigState dc_state_;
   bool is_strict_spec_mode_;
   bool need_update_bt_;
+  int64_t create_time_us_; // start of the reload which builds this version
   obutils::ObProxyConfigString db_name_;
   obutils::ObProxyConfigString db_cluster_;
   obutils::ObProxyConfigString db_mode_;
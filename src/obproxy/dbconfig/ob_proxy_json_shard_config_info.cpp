@@ -35,13 +35,13 @@ DEF_TO_STRING(ObProxyShardRuleInfo)
 {
   int64_t pos = 0;
   J_OBJ_START();
-  J_KV(K_(shard_rule_str));
+  J_KV(K_(shard_rule_str), K_(compiled_expr));
   J_OBJ_END();
   return pos;
 }
 
 ObProxyShardRuleInfo::ObProxyShardRuleInfo()
-  : shard_rule_str_(), expr_(NULL)
+  : shard_rule_str_(), expr_(NULL), compiled_expr_()
 {
   reset();
 }
@@ -17,6 +17,7 @@
 #include "obutils/ob_proxy_sql_parser.h"
 #include "lib/ob_define.h"
 #include "lib/hash_func/murmur_hash.h"
+#include "opsql/func_expr_resolver/proxy_expr/ob_proxy_compiled_expr.h"
 
 namespace oceanbase
 {
@@ -44,6 +45,7 @@ public:
   {
     shard_rule_str_.reset();
     expr_ = NULL;
+    compiled_expr_.reset();
   }
 
   int assign(const ObProxyShardRuleInfo &other)
@@ -51,6 +53,7 @@ public:
     reset();
     shard_rule_str_.set_value(other.shard_rule_str_);
     expr_ = other.expr_;
+    compiled_expr_.assign(other.compiled_expr_);
     return common::OB_SUCCESS;
   }
 
@@ -61,6 +64,7 @@ public:
 
   obutils::ObProxyConfigString shard_rule_str_; //save sharding expr
   opsql::ObProxyExpr *expr_;
+  opsql::ObProxyCompiledExpr compiled_expr_; // valid if expr_ has a common shape, see ObProxyCompiledExpr
 
 private:
   DISALLOW_COPY_AND_ASSIGN(ObProxyShardRuleInfo);
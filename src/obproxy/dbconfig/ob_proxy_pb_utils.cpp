@@ -180,15 +180,24 @@ int ObProxyPbUtils::parse_shard_rule(const std::string &rule_name,
       LOG_WARN("fail to parse dbNamePattern", K(ret), "pattern_str", rule_value.c_str());
     }
   } else if (rule_name.compare("tbRules") == 0) {
-    if (OB_FAIL(parse_json_rules(rule_value, rule_info.tb_rules_, rule_info.allocator_))) {
+    ObIAllocator *allocator = NULL;
+    if (OB_FAIL(rule_info.get_allocator(allocator))) {
+      LOG_WARN("fail to get allocator", K(ret));
+    } else if (OB_FAIL(parse_json_rules(rule_value, rule_info.tb_rules_, *allocator))) {
       LOG_WARN("fail to parse tb rules", K(ret), "rules_str", rule_value.c_str());
     }
   } else if (rule_name.compare("dbRules") == 0) {
-    if (OB_FAIL(parse_json_rules(rule_value, rule_info.db_rules_, rule_info.allocator_))) {
+    ObIAllocator *allocator = NULL;
+    if (OB_FAIL(rule_info.get_allocator(allocator))) {
+      LOG_WARN("fail to get allocator", K(ret));
+    } else if (OB_FAIL(parse_json_rules(rule_value, rule_info.db_rules_, *allocator))) {
       LOG_WARN("fail to parse db rules", K(ret), "rules_str", rule_value.c_str());
     }
   } else if (rule_name.compare("elasticRules") == 0) {
-    if (OB_FAIL(parse_json_rules(rule_value, rule_info.es_rules_, rule_info.allocator_))) {
+    ObIAllocator *allocator = NULL;
+    if (OB_FAIL(rule_info.get_allocator(allocator))) {
+      LOG_WARN("fail to get allocator", K(ret));
+    } else if (OB_FAIL(parse_json_rules(rule_value, rule_info.es_rules_, *allocator))) {
       LOG_WARN("fail to parse elastic rules", K(ret), "rules_str", rule_value.c_str());
     }
   } else if (rule_name.compare("tbSuffixPadding") == 0) {
@@ -199,6 +208,67 @@ int ObProxyPbUtils::parse_shard_rule(const std::string &rule_name,
   return ret;
 }
 
+bool ObProxyPbUtils::is_same_shard_rule(const std::string &rule_name,
+                                        const std::string &rule_value,
+                                        const ObShardRule &rule_info)
+{
+  bool bret = false;
+  const ObString value(static_cast<ObString::obstr_size_t>(rule_value.length()), rule_value.c_str());
+  if (rule_name.compare("tbNamePattern") == 0) {
+    bret = rule_info.tb_name_pattern_.config_string_ == value;
+  } else if (rule_name.compare("dbNamePattern") == 0) {
+    bret = rule_info.db_name_pattern_.config_string_ == value;
+  } else if (rule_name.compare("tbRules") == 0) {
+    bret = is_same_json_rules(rule_value, rule_info.tb_rules_);
+  } else if (rule_name.compare("dbRules") == 0) {
+    bret = is_same_json_rules(rule_value, rule_info.db_rules_);
+  } else if (rule_name.compare("elasticRules") == 0) {
+    bret = is_same_json_rules(rule_value, rule_info.es_rules_);
+  } else if (rule_name.compare("tbSuffixPadding") == 0) {
+    bret = rule_info.tb_suffix_.config_string_ == value;
+  } else {
+    // ignored by parse_shard_rule too
+    bret = true;
+  }
+  return bret;
+}
+
+bool ObProxyPbUtils::is_same_json_rules(const std::string &json_str, const ObProxyShardRuleList &rule_list)
+{
+  bool bret = false;
+  if (json_str.length() == 0 || json_str.compare("null") == 0) {
+    bret = rule_list.empty();
+  } else {
+    int ret = OB_SUCCESS;
+    Value *json_root = NULL;
+    ObArenaAllocator json_allocator(ObModIds::OB_JSON_PARSER);
+    Parser parser;
+    if (OB_FAIL(parser.init(&json_allocator))) {
+      LOG_WARN("json parser init failed", K(ret));
+    } else if (OB_FAIL(parser.parse(json_str.c_str(), json_str.length(), json_root))) {
+      LOG_DEBUG("parse json failed", "json_str", json_str.c_str(), K(ret));
+    } else if (OB_ISNULL(json_root)) {
+      // not same
+    } else if (JT_STRING == json_root->get_type()) {
+      bret = rule_list.empty();
+    } else if (JT_ARRAY == json_root->get_type()) {
+      // rules which are not valid are not kept in rule_list, such lists are never the same
+      int64_t i = 0;
+      bret = true;
+      DLIST_FOREACH_X(it, json_root->get_array(), bret) {
+        if (JT_STRING != it->get_type() || i >= rule_list.count()
+            || rule_list.at(i).shard_rule_str_.config_string_ != it->get_string()) {
+          bret = false;
+        } else {
+          ++i;
+        }
+      }
+      bret = bret && i == rule_list.count();
+    }
+  }
+  return bret;
+}
+
 int ObProxyPbUtils::parse_json_rules(const std::string &json_str, ObProxyShardRuleList &rule_list,
                                      ObIAllocator &allocator)
 {
@@ -362,6 +432,9 @@ int ObProxyPbUtils::force_parse_groovy(const ObString &expr,
       LOG_WARN("parse failed", K(ret), K(parse_sql));
     } else if (OB_FAIL(resolver.resolve(result.param_node_, info.expr_))) {
       LOG_WARN("proxy expr resolve failed", K(ret));
+    } else if (OB_FAIL(info.compiled_expr_.compile(info.expr_))) {
+      LOG_DEBUG("sharding expr is not compiled, will be calculated by proxy expr", K(expr), K(ret));
+      ret = OB_SUCCESS;
     }
   }
 
@@ -86,6 +86,11 @@ public:
   static int parse_database_prop_rule(const std::string &prop_rule, ObDataBaseProp &child_info);
   static int parse_es_info(const std::string &sub_str, ObGroupCluster &gc_info, int64_t &last_eid);
   static int parse_shard_rule(const std::string &rule_name, const std::string &rule_value, ObShardRule &rule_info);
+  // whether parse_shard_rule on rule_info with the same rule results in the same rule_info,
+  // false is returned if it is not sure
+  static bool is_same_shard_rule(const std::string &rule_name, const std::string &rule_value,
+                                 const ObShardRule &rule_info);
+  static bool is_same_json_rules(const std::string &json_str, const ObProxyShardRuleList &rule_list);
   static int parse_json_rules(const std::string &json_str, ObProxyShardRuleList &rule_list, common::ObIAllocator &allocator);
   static int force_parse_groovy(const common::ObString &expr, ObProxyShardRuleInfo &info, common::ObIAllocator &allocator);
   static int do_parse_from_local_file(const char *dir, const char *file_name,
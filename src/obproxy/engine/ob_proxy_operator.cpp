@@ -16,6 +16,7 @@
 #include "iocore/eventsystem/ob_vconnection.h"
 #include "iocore/eventsystem/ob_ethread.h"
 
+#include "obutils/ob_proxy_config.h"
 #include "ob_proxy_operator.h"
 #include "ob_proxy_operator_table_scan.h"
 #include "ob_proxy_operator_async_task.h"
@@ -36,7 +37,7 @@ ObProxyOperator::ObProxyOperator(ObProxyOpInput *input, common::ObIAllocator &al
             is_phy_operator_(false), column_count_(0),
             row_count_(0), projector_(NULL), type_(PHY_INVALID), cur_result_rows_(NULL),
             result_fields_(NULL), operator_async_task_(NULL), timeout_ms_(0),
-            expr_has_calced_(false), result_(NULL)
+            expr_has_calced_(false), result_(NULL), row_batch_(NULL), row_batch_pos_(0)
 {}
 
 ObProxyOperator::~ObProxyOperator()
@@ -287,7 +288,11 @@ int ObProxyOperator::calc_result(ResultRow &row, ResultRow &result,
     }
 
     LOG_DEBUG("row display before calc:", K(row));
-    if (OB_ISNULL(tmp_buf = allocator_.alloc(sizeof(common::ObObj) * exprs_count))) {
+    if (OB_FAIL(ret)) {
+      // do nothing
+    } else if (OB_FAIL(result.reserve(expect_row_count))) {
+      LOG_WARN("fail to reserve result row", K(ret), K(expect_row_count));
+    } else if (OB_ISNULL(tmp_buf = allocator_.alloc(sizeof(common::ObObj) * exprs_count))) {
       ret = common::OB_ALLOCATE_MEMORY_FAILED;
       LOG_WARN("alloc memory failed", K(ret), K(sizeof(common::ObObj) * exprs_count));
     } else if (OB_ISNULL(obj_array = new (tmp_buf) common::ObObj[exprs_count])) {
@@ -298,9 +303,6 @@ int ObProxyOperator::calc_result(ResultRow &row, ResultRow &result,
     int64_t k = 0;
     for (int64_t i = 0, j = 0; OB_SUCC(ret) && i < exprs_count && j < expect_row_count; j++) {
       OB_ASSERT(OB_NOT_NULL(expr_ptr = exprs.at(i)));
-      ObSqlString str;
-      ObProxyExpr::print_proxy_expr(expr_ptr); //DEBUG print
-      expr_ptr->to_sql_string(str); //info for pint
       if (expr_ptr->is_star_expr()) {
         result.push_back(row.at(j));
         k++;
@@ -311,13 +313,13 @@ int ObProxyOperator::calc_result(ResultRow &row, ResultRow &result,
         ctx.set_scale(field_info->at(j).accuracy_.get_accuracy());
         result.push_back(obj_array + i); // result will be put into *(obj_array + i)
         if (OB_FAIL(expr_ptr->calc(ctx, calc_item, result))) {
-          LOG_WARN("internal error when calc the value for the expr", K(ret), K(i), K(str));
+          LOG_WARN("internal error when calc the value for the expr", K(ret), K(i), KPC(expr_ptr));
         } else {
           i++;//to next expr
         }
         ctx.set_scale(-1); //set default for next
       }
-      LOG_DEBUG("row display in calc:", K(i), K(j), K(result), K(str));
+      LOG_DEBUG("row display in calc:", K(i), K(j), K(result));
     }
     LOG_DEBUG("row display after calc:", K(result));
     LOG_DEBUG("success cal value of ObProxyOperator::cal_result", K(ret),
@@ -343,6 +345,44 @@ int ObProxyOperator::put_result_row(ResultRow *row)
   return ret;
 }
 
+bool ObProxyOperator::is_exceed_memory_limit() const
+{
+  bool bret = false;
+  const int64_t limit = obutils::get_global_proxy_config().sharding_plan_memory_limit;
+  const int64_t total = allocator_.total();
+  if (limit > 0 && total > limit) {
+    bret = true;
+    LOG_WARN("sharding plan memory exceeds limit", "op_name", get_op_name(type_), K(total), K(limit));
+  }
+  return bret;
+}
+
+int ObProxyOperator::check_memory_limit(ObProxyResultResp *&result)
+{
+  int ret = OB_SUCCESS;
+  if (is_exceed_memory_limit()) {
+    // every shard row is held by the plan allocator, stop here instead of letting one
+    // query take all proxy memory. The error packet goes up to the top operator,
+    // and pending shard tasks are cancelled when the async task terminates.
+    // Rows are not spilled to disk, sort and aggregation of proxy work on the rows
+    // in memory, so the user is told how to make the query fit.
+    char err_msg[OB_MAX_ERROR_MSG_LEN];
+    const int64_t len = snprintf(err_msg, sizeof(err_msg),
+        "cross shard query holds %ld bytes of shard rows in proxy, more than "
+        "sharding_plan_memory_limit(%ld), add filters or a limit to the query, "
+        "or raise sharding_plan_memory_limit",
+        allocator_.total(), obutils::get_global_proxy_config().sharding_plan_memory_limit.get());
+    if (OB_UNLIKELY(len <= 0) || OB_UNLIKELY(len >= static_cast<int64_t>(sizeof(err_msg)))) {
+      ret = OB_SIZE_OVERFLOW;
+      LOG_WARN("fail to format memory limit error message", K(len), K(ret));
+    } else if (OB_FAIL(packet_error_info(result, err_msg, len,
+                                         static_cast<uint16_t>(-OB_EXCEED_MEM_LIMIT)))) {
+      LOG_WARN("fail to packet error info", K(ret));
+    }
+  }
+  return ret;
+}
+
 int ObProxyOperator::process_ready_data(void *data, int &event)
 {
   int ret = OB_SUCCESS;
@@ -449,11 +489,21 @@ int ObProxyOperator::init_row(ResultRow *&row)
   int ret = common::OB_SUCCESS;
   void *buf = NULL;
   row = NULL;
-  if (OB_ISNULL(buf = allocator_.alloc(sizeof(ResultRow)))) {
-    ret = common::OB_ALLOCATE_MEMORY_FAILED;
-    LOG_WARN("no have enough memory to init", K(ret), K(op_name()), K(sizeof(ResultRow)));
-  } else {
-    row = new (buf) ResultRow(array_new_alloc_size, allocator_);
+  // every row of a shard response needs a ResultRow, take them from a batch
+  // instead of one allocation per row
+  if (NULL == row_batch_ || row_batch_pos_ >= ROW_BATCH_SIZE) {
+    if (OB_ISNULL(buf = allocator_.alloc(sizeof(ResultRow) * ROW_BATCH_SIZE))) {
+      ret = common::OB_ALLOCATE_MEMORY_FAILED;
+      LOG_WARN("no have enough memory to init", K(ret), K(op_name()),
+               "size", sizeof(ResultRow) * ROW_BATCH_SIZE);
+    } else {
+      row_batch_ = static_cast<ResultRow *>(buf);
+      row_batch_pos_ = 0;
+    }
+  }
+  if (OB_SUCC(ret)) {
+    row = new (row_batch_ + row_batch_pos_) ResultRow(array_new_alloc_size, allocator_);
+    row_batch_pos_++;
   }
   return ret;
 }
@@ -164,6 +164,11 @@ public:
   ObPhyOperatorType get_op_type() { return type_; }
 
   int put_result_row(ResultRow *row);
+  // memory of the whole plan is allocated from allocator_
+  bool is_exceed_memory_limit() const;
+  // if the plan exceeds sharding_plan_memory_limit, replace result with an error packet.
+  // it is a guard that fails the query, rows are never spilled to disk
+  int check_memory_limit(ObProxyResultResp *&result);
 
   int64_t get_cont_index() { return cont_index_; }
   void set_cont_index(int64_t cont_index) { cont_index_ = cont_index; }
@@ -199,6 +204,10 @@ protected:
   int64_t timeout_ms_;
   bool expr_has_calced_;
   void *result_;
+  // ResultRow objects handed out by init_row()
+  static const int64_t ROW_BATCH_SIZE = 64;
+  ResultRow *row_batch_;
+  int64_t row_batch_pos_;
   DISALLOW_COPY_AND_ASSIGN(ObProxyOperator);
 };
 
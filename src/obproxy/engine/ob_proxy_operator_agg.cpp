@@ -176,6 +176,9 @@ int ObProxyAggOp::process_exprs_in_agg(ResultRows *src_rows, ResultRows *obj_row
   common::ObSEArray<ObProxyExpr*, 4>& select_exprs =
         get_input()->get_select_exprs();
 
+  if (OB_FAIL(obj_rows->reserve(obj_rows->count() + row_count))) {
+    LOG_WARN("fail to reserve result rows", K(ret), K(row_count));
+  }
   for (int64_t i = 0; OB_SUCC(ret) && i < row_count; i++) {
     ResultRow *new_row = NULL;
     row = src_rows->at(i);
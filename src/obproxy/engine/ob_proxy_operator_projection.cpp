@@ -67,6 +67,9 @@ int ObProxyProOp::handle_response_result(void *data, bool is_final,  ObProxyResu
     if (limit_topv != -1 && cur_result_rows_->count() >= limit_topv) {
       //reach up limit in SELECT
       LOG_DEBUG("not need to projection result any more, for reached the limit", K(ret), K(limit_topv));
+    } else if (OB_FAIL(cur_result_rows_->reserve(cur_result_rows_->count()
+                                                 + opres->get_result_rows().count()))) {
+      LOG_WARN("fail to reserve result rows", K(ret));
     } else {
       while (OB_SUCC(ret) && (OB_SUCC(opres->next(row)))) {
         ResultRow *new_row = NULL;
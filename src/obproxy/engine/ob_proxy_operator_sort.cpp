@@ -185,11 +185,11 @@ int ObProxyMemSortOp::get_next_row()
     } else if (OB_ISNULL(rows = new (tmp_buf) ResultRows(array_new_alloc_size, allocator_))) {
       ret = common::OB_ERR_UNEXPECTED;
       LOG_WARN("init ResultRows failed", K(ret), K(op_name()), K(rows));
-    } else if (OB_ISNULL(tmp_buf = allocator_.alloc(sizeof(ObMemorySort)))) {
+    } else if (OB_ISNULL(tmp_buf = allocator_.alloc(sizeof(ObMergeSort)))) {
       ret = common::OB_ALLOCATE_MEMORY_FAILED;
-      LOG_WARN("no have enough memory to init", K(ret), K(op_name()), K(sizeof(ObMemorySort)));
+      LOG_WARN("no have enough memory to init", K(ret), K(op_name()), K(sizeof(ObMergeSort)));
     } else {
-      sort_imp_ = new (tmp_buf) ObMemorySort(*sort_columns_, allocator_, *rows);
+      sort_imp_ = new (tmp_buf) ObMergeSort(*sort_columns_, allocator_, *rows);
       sort_imp_->set_topn_cnt(get_input()->get_op_top_value());
     }
   }
@@ -246,7 +246,10 @@ int ObProxyMemSortOp::handle_response_result(void *data, bool is_final, ObProxyR
       ret = common::OB_SUCCESS;
     }
     LOG_DEBUG("ObProxyMemSortOp::process_ready_data: handle all row", K(i));
-    if (is_final) {
+    // rows of one response are one sorted run
+    if (OB_SUCC(ret) && OB_FAIL(static_cast<ObMergeSort*>(sort_imp_)->finish_run())) {
+      LOG_WARN("merge sort finish run error in ObProxySortOp", K(ret));
+    } else if (OB_SUCC(ret) && is_final) {
       ObProxyResultResp *res = NULL;
       if (OB_FAIL(sort_imp_->sort_rows())) {
         LOG_WARN("memory sort error in ObProxySortOp", K(ret));
@@ -269,99 +272,6 @@ int ObProxyMemSortOp::handle_response_result(void *data, bool is_final, ObProxyR
   return ret;
 }
 
-int ObProxyTopKOp::get_next_row()
-{
-  int ret = common::OB_SUCCESS;
-  if (OB_FAIL(init_sort_columns())) {
-    LOG_WARN("ObProxyTopKOp::get_next_row failed", K(ret));
-  } else {
-    void *tmp_buf = NULL;
-    ResultRows *rows = NULL;
-    if (OB_ISNULL(tmp_buf = allocator_.alloc(sizeof(ResultRows)))) {
-      ret = common::OB_ALLOCATE_MEMORY_FAILED;
-      LOG_WARN("no have enough memory to init", K(ret), K(op_name()), K(sizeof(ResultRows)));
-    } else if (OB_ISNULL(rows = new (tmp_buf) ResultRows(array_new_alloc_size, allocator_))) {
-      ret = common::OB_ERR_UNEXPECTED;
-      LOG_WARN("init ResultRows failed", K(ret), K(op_name()), K(rows));
-    } else if (OB_ISNULL(tmp_buf = allocator_.alloc(sizeof(ObTopKSort)))) {
-      ret = common::OB_ALLOCATE_MEMORY_FAILED;
-      LOG_WARN("no have enough memory to init", K(ret), K(op_name()),
-            K(sizeof(ObTopKSort)));
-    } else {
-      sort_imp_ = new (tmp_buf) ObTopKSort(*sort_columns_, allocator_, *rows,  *cur_result_rows_);
-      sort_imp_->set_topn_cnt(get_input()->get_op_top_value());
-    }
-  }
-  return ObProxySortOp::get_next_row();
-}
-
-//int ObProxyTopKOp::handle_response_result(executor::ObProxyParallelResp *pres, bool is_final, ObProxyResultResp *&result)
-int ObProxyTopKOp::handle_response_result(void *data, bool is_final, ObProxyResultResp *&result)
-{
-  int ret = OB_SUCCESS;
-  LOG_DEBUG("Enter ObProxyMemSortOp::handle_response_result", K(op_name()), K(data));
-
-  ObProxyResultResp *opres = NULL;
-
-  if (OB_ISNULL(data)) {
-    ret = common::OB_INVALID_ARGUMENT;
-    LOG_WARN("invalid input", K(ret), K(data));
-  } else if (OB_ISNULL(sort_imp_)) {
-    ret = common::OB_ERROR;
-    LOG_WARN("inner error sort_imp_ not init before to used.", K(ret));
-  } else if (OB_ISNULL(opres = reinterpret_cast<ObProxyResultResp*>(data))) {
-    ret = OB_ERR_UNEXPECTED;
-    LOG_WARN("ObProxyMemSortOp::handle_response_result not response result", K(opres), KP(opres));
-  } else if (!opres->is_resultset_resp()) {
-    ret = OB_ERR_UNEXPECTED;
-    LOG_WARN("ObProxyMemSortOp::handle_response_result not response result", K(opres), KP(opres), K(opres->is_resultset_resp()));
-  } else {
-    LOG_DEBUG("ObProxyMemSortOp::process_ready_data:resultset_resp", K(opres), KP(opres));
-    expr_has_calced_ = opres->get_has_calc_exprs();
-
-    if (OB_ISNULL(get_result_fields())) {
-      result_fields_ = opres->get_fields();
-    }
-    ResultRow *row = NULL;
-    int64_t i = 0;
-    while (OB_SUCC(opres->next(row))) {
-      if (OB_ISNULL(row)) {
-        LOG_DEBUG("ObProxyMemSortOp::process_ready_data: handle all row", K(i));
-        break;
-      } else if (OB_FAIL(add_order_by_obj(row))) { // add obj for order by at backend
-        LOG_WARN("ObProxyMemSortOp::process_ready_data add order by row error", K(ret), K(i));
-        break;
-      } else if (OB_FAIL((dynamic_cast<ObTopKSort*>(get_sort_impl()))->sort_rows(*row))) {
-        LOG_WARN("inner error to put rows", K(ret), K(op_name()));
-        break;
-      }
-      i++;
-    }
-    if (ret == common::OB_ITER_END) {
-      ret = common::OB_SUCCESS;
-    }
-    LOG_DEBUG("ObProxyMemSortOp::process_ready_data: handle all row", K(i));
-    if (is_final) {
-      ObProxyResultResp *res = NULL;
-      if (OB_FAIL(sort_imp_->sort_rows())) {
-        LOG_WARN("topK sort error in ObProxySortOp", K(ret));
-      } else if (OB_FAIL(dynamic_cast<ObTopKSort*>(sort_imp_)->fetch_final_results())) {
-        LOG_WARN("topK sort error in ObProxySortOp", K(ret));
-      } else if (OB_FAIL(remove_all_order_by_objs(*cur_result_rows_))) {
-        LOG_WARN("memory sort error in ObProxySortOp", K(ret));
-      } else if (OB_FAIL(packet_result_set(res, cur_result_rows_, get_result_fields()))) {
-        LOG_WARN("packet resultset packet error", K(ret));
-      }
-
-      if (OB_FAIL(ret) && OB_NOT_NULL(res)) {
-        res->set_packet_flag(PCK_ERR_RESPONSE);
-      }
-      result = res;
-    }
-  }
-  return ret;
-}
-
 ObBaseSort::ObBaseSort(SortColumnArray &sort_columns, common::ObIAllocator &allocator, ResultRows &sort_rows)
                : allocator_(allocator), sort_columns_(sort_columns),
                  sort_rows_(sort_rows), topn_cnt_(0), row_count_(0),
@@ -545,184 +455,143 @@ int ObMemorySort::quick_sort(int64_t low, int64_t height)
   return ret;
 }
 
-
-int ObTopKSort::sort_rows()
+int ObMergeSort::check_run_sorted(const int64_t start, const int64_t end, bool &is_sorted)
 {
   int ret = common::OB_SUCCESS;
-  if (OB_SUCC(heap_sort())) {
-    sorted_ = true;
+  is_sorted = true;
+  for (int64_t i = start + 1; OB_SUCC(ret) && is_sorted && i < end; i++) {
+    is_sorted = compare_row(*sort_rows_.at(i - 1), *sort_rows_.at(i), ret);
   }
   return ret;
 }
 
-int ObTopKSort::sort_rows(ResultRow &new_row)
+int ObMergeSort::finish_run()
 {
   int ret = common::OB_SUCCESS;
-  if (OB_ISNULL(&new_row)) {
-    ret = common::OB_INVALID_ARGUMENT;
-    LOG_WARN("invalid parament", K(ret));
-  } else if (row_count_ < get_topn_cnt()) {
-    sort_rows_heap_.push_back(&new_row);
-  }
-  if (OB_SUCC(ret)) {
-    row_count_++;
-  }
-
-  if (OB_SUCC(ret) && row_count_ > get_topn_cnt()) {
-    if (compare_row(new_row, *sort_rows_heap_.at(0), ret)) {
-      if (OB_FAIL(ret)) {
-        LOG_WARN("ObTopKSort::sort_rows compare_row fail", K(ret), K(new_row), K(*sort_rows_heap_.at(0)));
-        return ret;
-      }
-      sort_rows_heap_.at(0) = &new_row;
+  const int64_t run_end = sort_rows_.count();
+  bool is_sorted = true;
+  if (run_end > run_start_) {
+    if (OB_FAIL(check_run_sorted(run_start_, run_end, is_sorted))) {
+      LOG_WARN("ObMergeSort::finish_run check run sorted failed", K(ret), K_(run_start), K(run_end));
+    } else if (!is_sorted && OB_FAIL(quick_sort(run_start_, run_end - 1))) {
+      LOG_WARN("ObMergeSort::finish_run sort run failed", K(ret), K_(run_start), K(run_end));
+    } else if (OB_FAIL(run_ends_.push_back(run_end))) {
+      LOG_WARN("ObMergeSort::finish_run push back run end failed", K(ret), K(run_end));
     } else {
-      LOG_DEBUG("ObTopKSort::sort_rows invalid rows to return", K(new_row));
-      return ret;
-    }
-
-    if (OB_SUCC(ret) && OB_FAIL(build_heap())) {
-      LOG_WARN("ObTopKSort::sort_rows build heap failed", K(ret));
-    }
-
-  } else if (OB_SUCC(ret) && row_count_ == get_topn_cnt()) {
-    if (OB_FAIL(build_heap())) {
-      LOG_WARN("ObTopKSort::sort_rows build heap failed", K(ret));
-    }
-  }
-
-  return ret;
-}
-
-int ObTopKSort::build_heap() //build max heap
-{
-  int ret = common::OB_SUCCESS;
-  int64_t topn_value = sort_rows_heap_.count();//get_topn_cnt();
-
-  for (int64_t i = topn_value / 2 - 1; i >= 0; i--) {
-    if (OB_FAIL(heap_adjust(i, topn_value))) {
-      LOG_WARN(" ObTopKSort::build_heap heap_adjust fail", K(ret), K(i), K(topn_value));
-      break;
+      run_start_ = run_end;
+      LOG_DEBUG("ObMergeSort::finish_run", K(is_sorted), K(run_end), K(run_ends_.count()));
+      // only the first topn_cnt_ rows can be returned, drop others as early as possible
+      if (topn_cnt_ > 0 && run_ends_.count() > 1 && run_end > topn_cnt_
+          && OB_FAIL(merge_runs(topn_cnt_))) {
+        LOG_WARN("ObMergeSort::finish_run merge runs failed", K(ret), K_(topn_cnt));
+      }
     }
   }
-
   return ret;
 }
 
-int ObTopKSort::heap_adjust(int64_t p, int64_t len)
+int ObMergeSort::heap_adjust(ResultRowsIndex &heap, const ResultRowsIndex &cursors, int64_t p)
 {
   int ret = common::OB_SUCCESS;
-  if (p >= len) {
-    ret = common::OB_INVALID_ARGUMENT;
-  }
-
-  ResultRow *row = sort_rows_heap_.at(p);
+  const int64_t len = heap.count();
   int64_t child = (p * 2) + 1;
-  ResultRows &rows = sort_rows_heap_;
-  while (child < len && OB_SUCC(ret)) {
-    if (OB_SUCC(ret)
-      && child + 1 < len
-      && (compare_row(*rows.at(child), *rows.at(child+1), ret))) {
+  while (OB_SUCC(ret) && child < len) {
+    if (child + 1 < len
+        && !compare_row(get_run_head(cursors, heap.at(child)),
+                        get_run_head(cursors, heap.at(child + 1)), ret)) {
       child = child + 1;
     }
-    if (OB_SUCC(ret)
-        && compare_row(*row, *rows.at(child), ret)) {
-      swap_row(sort_rows_heap_.at(child), sort_rows_heap_.at(p));
+    if (OB_FAIL(ret)) {
+      LOG_WARN("ObMergeSort::heap_adjust compare row failed", K(ret), K(p), K(child));
+    } else if (compare_row(get_run_head(cursors, heap.at(p)),
+                           get_run_head(cursors, heap.at(child)), ret)) {
+      break;
+    } else if (OB_SUCC(ret)) {
+      swap_index(&heap.at(p), &heap.at(child));
       p = child;
       child = (p * 2) + 1;
-    } else {
-      break;
     }
   }
   return ret;
 }
 
-int ObTopKSort::heap_sort()
+int ObMergeSort::merge_runs(const int64_t limit)
 {
   int ret = common::OB_SUCCESS;
-  int64_t len = sort_rows_heap_.count();
-  OB_ASSERT(len <= get_topn_cnt());
-  if (OB_FAIL(build_heap())) {
-    ret = common::OB_ERR_UNEXPECTED;
-    LOG_WARN("ObTopKSort::heap_sort error");
-  }
-  for (int64_t i = len -1; OB_SUCC(ret) && i > 0; i--) {
-    swap_row(sort_rows_heap_.at(0), sort_rows_heap_.at(i));
-    if (OB_FAIL(heap_adjust(0, i))) {
-      LOG_WARN(" ObTopKSort::build_heap heap_adjust fail", K(ret), K(i), K(i));
+  const int64_t run_count = run_ends_.count();
+  const int64_t total_count = sort_rows_.count();
+  const int64_t merge_count = limit > 0 ? std::min(limit, total_count) : total_count;
+
+  if (run_count > 1) {
+    ResultRowsIndex &cursors = cursors_;
+    ResultRowsIndex &heap = heap_;
+    ResultRows &merged_rows = merged_rows_;
+    cursors.reuse();
+    heap.reuse();
+    merged_rows.reuse();
+    for (int64_t i = 0; OB_SUCC(ret) && i < run_count; i++) {
+      if (OB_FAIL(cursors.push_back(0 == i ? 0 : run_ends_.at(i - 1)))) {
+        LOG_WARN("ObMergeSort::merge_runs push back cursor failed", K(ret), K(i));
+      } else if (OB_FAIL(heap.push_back(i))) {
+        LOG_WARN("ObMergeSort::merge_runs push back heap failed", K(ret), K(i));
+      }
     }
-  }
-  return ret;
-}
-
-int ObTopKSort::fetch_final_results()
-{
-  int ret = common::OB_SUCCESS;
-  LOG_DEBUG("ObBaseSort::fetch_final_results", K(sort_rows_heap_.count()));
-  if (sorted_) {
-    //not need do anything
-    for (int64_t i = 0, j = sort_rows_heap_.count() - 1; i < j; i++, j--) {
-      LOG_DEBUG("topk sort row-f", K(*sort_rows_heap_.at(i)));
-      //swap_row(sort_rows_heap_.at(i), sort_rows_heap_.at(j));
+    if (OB_SUCC(ret) && OB_FAIL(merged_rows.reserve(merge_count))) {
+      LOG_WARN("ObMergeSort::merge_runs reserve failed", K(ret), K(merge_count));
+    }
+    for (int64_t i = run_count / 2 - 1; OB_SUCC(ret) && i >= 0; i--) {
+      ret = heap_adjust(heap, cursors, i);
     }
-  } else {
-    ret = common::OB_ERR_UNEXPECTED;
-    LOG_WARN("ObBaseSort::fetch_final_results for not sorted rows");
-  }
-  return ret;
-}
-
-/*
-int ObMergeSort::sort_rows()
-{
-  int ret = common::OB_SUCCESS;
-  if (OB_ISNULL(&merge_sort_rows_array_)) {
-    ret = common::OB_ERROR;
-    LOG_WARN("invalid input for merge sort", K(ret));
-  }
 
-  get_sort_rows().reset();
-
-  bool left_records = false;
-  ResultRow *key_row = NULL;
-  int64_t cur_loc = -1;
-  while (true) {
-    for (int64_t i = 0; i < sort_regions_; i++) {
-      ObRowTrunk &sort_rows =
-               *merge_sort_rows_array_.at(i);//->get_chrunk_rows();
-      if (merge_rows_index_.at(i) >= sort_rows.get_row_count()) {
-        continue;
-      }
-      left_records = true;
-      if (OB_ISNULL(key_row)) {
-        key_row = sort_rows.get_chrunk_rows().at(merge_rows_index_.at(i));
-        cur_loc = i;
-      } else if (compare_row(*sort_rows.get_chrunk_rows().at(merge_rows_index_.at(i)), *key_row)) {
-        key_row = sort_rows.get_chrunk_rows().at(merge_rows_index_.at(i));
-        cur_loc = i;
+    while (OB_SUCC(ret) && heap.count() > 0 && merged_rows.count() < merge_count) {
+      const int64_t run = heap.at(0);
+      if (OB_FAIL(merged_rows.push_back(&get_run_head(cursors, run)))) {
+        LOG_WARN("ObMergeSort::merge_runs push back row failed", K(ret), K(run));
+      } else {
+        if (++cursors.at(run) >= run_ends_.at(run)) {
+          // this run is drained, move the last one to top
+          heap.at(0) = heap.at(heap.count() - 1);
+          heap.pop_back();
+        }
+        if (heap.count() > 1) {
+          ret = heap_adjust(heap, cursors, 0);
+        }
       }
     }
 
-    if (!left_records) {
-      break;
+    if (OB_SUCC(ret) && OB_FAIL(sort_rows_.assign(merged_rows))) {
+      LOG_WARN("ObMergeSort::merge_runs assign merged rows failed", K(ret));
+    }
+  } else {
+    while (sort_rows_.count() > merge_count) {
+      sort_rows_.pop_back();
     }
-    get_sort_rows().push_back(key_row);
-    merge_rows_index_.at(cur_loc)++;
   }
+
+  if (OB_SUCC(ret)) {
+    row_count_ = sort_rows_.count();
+    run_start_ = row_count_;
+    run_ends_.reuse();
+    if (row_count_ > 0 && OB_FAIL(run_ends_.push_back(row_count_))) {
+      LOG_WARN("ObMergeSort::merge_runs push back run end failed", K(ret));
+    }
+  }
+  LOG_DEBUG("ObMergeSort::merge_runs", K(ret), K(run_count), K(total_count), K(limit), K_(row_count));
   return ret;
 }
 
-int ObRowTrunk::put_row(ResultRow& row)
+int ObMergeSort::sort_rows()
 {
-  int ret = OB_SUCCESS;
-  if (OB_ISNULL(&row)) {
-    ret = common::OB_INVALID_ARGUMENT;
-    LOG_WARN("invalid parament", K(ret));
+  int ret = common::OB_SUCCESS;
+  if (OB_FAIL(finish_run())) {
+    LOG_WARN("ObMergeSort::sort_rows finish run failed", K(ret));
+  } else if (OB_FAIL(merge_runs(topn_cnt_))) {
+    LOG_WARN("ObMergeSort::sort_rows merge runs failed", K(ret));
   } else {
-    chrunk_rows_.push_back(&row);
+    sorted_ = true;
   }
   return ret;
 }
-*/
 
 }
 }
@@ -101,17 +101,16 @@ public:
 
 };
 
-class ObProxyTopKOp : public ObProxySortOp
+/* Merge sort keeps only LIMIT + OFFSET rows while merging. */
+class ObProxyTopKOp : public ObProxyMemSortOp
 {
 public:
   ObProxyTopKOp(ObProxyOpInput *input, common::ObIAllocator &allocator)
-    : ObProxySortOp(input, allocator) {
+    : ObProxyMemSortOp(input, allocator) {
     set_op_type(PHY_TOPK);
   }
 
   ~ObProxyTopKOp() {};
-  virtual int get_next_row();
-  virtual int handle_response_result(void *src, bool is_final, ObProxyResultResp *&result);
 };
 
 class ObSortColumn : public common::ObColumnInfo
@@ -199,64 +198,47 @@ public:
   int quick_sort(int64_t low, int64_t height);
 };
 
-class ObTopKSort : public ObBaseSort
+/* K-way merge of sorted runs.
+ * Each shard returns its rows ordered by the pushed down ORDER BY, so the rows of one
+ * response form a sorted run. Runs are merged with a heap instead of sorting all rows
+ * again, a run which is not sorted (such as the output of hash agg) is sorted alone first.
+ * If topn_cnt_ is set, runs are merged as soon as more than topn_cnt_ rows are buffered
+ * and only the first topn_cnt_ rows are kept, so the rows to sort and merge are bounded.
+ * The dropped rows are not freed, they are allocated by the operator arena together with
+ * the shard responses and released when the query finishes. */
+class ObMergeSort : public ObMemorySort
 {
 public:
-  ObTopKSort(SortColumnArray &sort_column, common::ObIAllocator &allocator,
-    ResultRows &sort_rows, ResultRows &rows)
-    : ObBaseSort(sort_column, allocator, sort_rows),
-                row_count_(0), sort_rows_heap_(rows) {}
-
-  ~ObTopKSort() {}
+  ObMergeSort(SortColumnArray &sort_column, common::ObIAllocator &allocator, ResultRows &sort_rows)
+    : ObMemorySort(sort_column, allocator, sort_rows),
+      run_ends_(array_new_alloc_size, allocator), run_start_(0),
+      cursors_(array_new_alloc_size, allocator), heap_(array_new_alloc_size, allocator),
+      merged_rows_(array_new_alloc_size, allocator) {}
+  ~ObMergeSort() {}
 
+  // rows added by add_row() since last finish_run() form one run
+  int finish_run();
   virtual int sort_rows();
-  virtual int fetch_final_results();
-  virtual int sort_rows(ResultRow &row);
-  virtual int build_heap();
-  virtual int heap_adjust(int64_t p, int64_t len);
-  virtual int heap_sort();
-
-protected:
-  int64_t row_count_;
-  ResultRows &sort_rows_heap_;
-};
-
-/*
-class ObMergeSort : public ObBaseSort
-{
-public:
-  ObMergeSort() {
-    sort_regions_ = 0;
-  }
+  int64_t get_run_count() const { return run_ends_.count(); }
 
-  ObMergeSort(common::ObSEArray<ObRowTrunk*, 4> &merge_sort_rows_array, int64_t regions)
-    : merge_sort_rows_array_(merge_sort_rows_array), sort_regions_(regions)
+private:
+  int check_run_sorted(const int64_t start, const int64_t end, bool &is_sorted);
+  int merge_runs(const int64_t limit);
+  int heap_adjust(ResultRowsIndex &heap, const ResultRowsIndex &cursors, int64_t p);
+  ResultRow &get_run_head(const ResultRowsIndex &cursors, const int64_t run)
   {
-    merge_rows_index_.push_back(static_cast<int64_t>(0));
+    return *sort_rows_.at(cursors.at(run));
   }
 
-//  ObMergeSort(common::ObIArray<ObRowTrunk> &merge_sort_rows_array, int64_t regions)
-//    :merge_sort_rows_array_(merge_sort_rows_array), sort_regions_(regions) {
-//    for (int64_t i = 0; i < sort_regions_; i++) {
-//      merge_rows_index_.push_back(0);
-//    }
-//  }
-//
-  ~ObMergeSort() {}
-  virtual int sort_rows();
-  int merge_sort();
 protected:
-  //common::ObIArray<ObRowTrunk> merge_sort_rows_array_;
-  //common:ObIArray<int64_t> merge_rows_index_;
-  common::ObSEArray<ObRowTrunk*, 4> merge_sort_rows_array_;
-
-  common::ObSEArray<int64_t, 4> merge_rows_index_;
-
-  int64_t sort_regions_;
+  ResultRowsIndex run_ends_; // end offset of each run in sort_rows_
+  int64_t run_start_;        // start offset of the run being added
+  // reused by every merge_runs(), the arena does not grow with the number of merges
+  ResultRowsIndex cursors_;
+  ResultRowsIndex heap_;
+  ResultRows merged_rows_;
 };
 
-*/
-
 }
 }
 }
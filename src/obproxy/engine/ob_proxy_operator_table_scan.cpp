@@ -361,6 +361,8 @@ int ObProxyTableScanOp::handle_result(void *data, bool is_final, ObProxyResultRe
     } else if (pres->is_resultset_resp()) {
       if (OB_FAIL(handle_response_result(pres, is_final, result))) {
         LOG_WARN("failed to handle resultset_resp", K(ret));
+      } else if (OB_FAIL(check_memory_limit(result))) {
+        LOG_WARN("fail to check memory limit", K(ret));
       }
     } else if (pres->is_error_resp()) {
       if (OB_FAIL(packet_error_info(result, pres->get_err_msg().ptr(),
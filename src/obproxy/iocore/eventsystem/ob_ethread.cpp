@@ -57,6 +57,8 @@ ObEThread::ObEThread()
       net_poll_(NULL),
       inactivity_cop_(NULL),
       cs_map_(NULL),
+      shared_ss_manager_(NULL),
+      shared_ss_counter_(NULL),
       table_map_(NULL),
       partition_map_(NULL),
       routine_map_(NULL),
@@ -64,6 +66,9 @@ ObEThread::ObEThread()
       cache_cleaner_(NULL),
       sql_table_map_(NULL),
       random_seed_(NULL),
+      cmd_time_histograms_(NULL),
+      sqlaudit_ring_(NULL),
+      thread_allocator_(NULL),
       warn_log_buf_(NULL),
       warn_log_buf_start_(NULL),
       tt_(REGULAR),
@@ -90,6 +95,8 @@ ObEThread::ObEThread(const ObThreadType att, const int64_t anid)
       net_poll_(NULL),
       inactivity_cop_(NULL),
       cs_map_(NULL),
+      shared_ss_manager_(NULL),
+      shared_ss_counter_(NULL),
       table_map_(NULL),
       partition_map_(NULL),
       routine_map_(NULL),
@@ -97,6 +104,9 @@ ObEThread::ObEThread(const ObThreadType att, const int64_t anid)
       cache_cleaner_(NULL),
       sql_table_map_(NULL),
       random_seed_(NULL),
+      cmd_time_histograms_(NULL),
+      sqlaudit_ring_(NULL),
+      thread_allocator_(NULL),
       warn_log_buf_(NULL),
       warn_log_buf_start_(NULL),
       tt_(att),
@@ -123,6 +133,8 @@ ObEThread::ObEThread(const ObThreadType att, ObEvent *e)
       net_poll_(NULL),
       inactivity_cop_(NULL),
       cs_map_(NULL),
+      shared_ss_manager_(NULL),
+      shared_ss_counter_(NULL),
       table_map_(NULL),
       partition_map_(NULL),
       routine_map_(NULL),
@@ -130,6 +142,9 @@ ObEThread::ObEThread(const ObThreadType att, ObEvent *e)
       cache_cleaner_(NULL),
       sql_table_map_(NULL),
       random_seed_(NULL),
+      cmd_time_histograms_(NULL),
+      sqlaudit_ring_(NULL),
+      thread_allocator_(NULL),
       warn_log_buf_(NULL),
       warn_log_buf_start_(NULL),
       tt_(att),
@@ -343,6 +358,7 @@ inline void ObEThread::dequeue_local_event(Que(ObEvent, link_) &negative_queue)
 // If successful, call the continuation, otherwise put the event back into the queue.
 void ObEThread::execute()
 {
+  thread_allocator_ = &get_thread_allocator();
   switch (tt_) {
     case REGULAR: {
       Que(ObEvent, link_) negative_queue;
@@ -51,11 +51,15 @@ class ObCongestionRefHashMap;
 namespace proxy
 {
 class ObMysqlClientSessionMap;
+class ObMysqlSessionManagerNew;
+class ObSharedServerSessionCounter;
 class ObTableRefHashMap;
 class ObPartitionRefHashMap;
 class ObRoutineRefHashMap;
 class ObSqlTableRefHashMap;
 class ObCacheCleaner;
+class ObCmdTimeHistograms;
+class ObSqlauditRing;
 }
 namespace net
 {
@@ -69,6 +73,7 @@ namespace event
 {
 class ObEvent;
 class ObContinuation;
+struct ObThreadAllocator;
 
 typedef int (ObEThread::*schedule_handler_func) (ObEvent &event, const bool fast_signal);
 
@@ -306,6 +311,7 @@ public:
   net::ObNetPoll &get_net_poll() { return *net_poll_; }
   net::ObInactivityCop &get_inactivity_cop() { return *inactivity_cop_; }
   proxy::ObMysqlClientSessionMap &get_client_session_map() { return *cs_map_; }
+  proxy::ObMysqlSessionManagerNew &get_shared_session_manager() { return *shared_ss_manager_; }
   proxy::ObTableRefHashMap &get_table_map() { return *table_map_; }
   proxy::ObSqlTableRefHashMap &get_sql_table_map() { return *sql_table_map_; }
   proxy::ObPartitionRefHashMap &get_partition_map() { return *partition_map_; }
@@ -355,6 +361,8 @@ public:
   net::ObNetPoll *net_poll_;
   net::ObInactivityCop *inactivity_cop_;
   proxy::ObMysqlClientSessionMap *cs_map_;
+  proxy::ObMysqlSessionManagerNew *shared_ss_manager_;
+  proxy::ObSharedServerSessionCounter *shared_ss_counter_;
   proxy::ObTableRefHashMap *table_map_;
   proxy::ObPartitionRefHashMap *partition_map_;
   proxy::ObRoutineRefHashMap *routine_map_;
@@ -362,6 +370,9 @@ public:
   proxy::ObCacheCleaner *cache_cleaner_;
   proxy::ObSqlTableRefHashMap *sql_table_map_;
   common::ObMysqlRandom *random_seed_;
+  proxy::ObCmdTimeHistograms *cmd_time_histograms_;
+  proxy::ObSqlauditRing *sqlaudit_ring_;
+  ObThreadAllocator *thread_allocator_; // set when thread starts, for stats of other threads
 
   char *warn_log_buf_;
   char *warn_log_buf_start_;
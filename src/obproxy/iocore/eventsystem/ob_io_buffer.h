@@ -949,6 +949,14 @@ public:
 
   bool empty() const { return NULL == writer_; }
 
+  /**
+   * Drops all blocks if no reader has data on them, so an idle buffer holds
+   * no memory. New blocks of size_ are appended by the next write_avail().
+   *
+   * @return true if the blocks are dropped
+   */
+  bool release_empty_blocks();
+
   int64_t max_read_avail() const;
   int64_t max_block_count() const;
   int check_add_block();
@@ -1311,6 +1319,8 @@ inline int ObIOBufferData::alloc(const int64_t size)
       PROXY_EVENT_LOG(ERROR, "fail to allocate memory for ObIOBufferData", K(ret));
       size_ = 0;
       mem_type_ = NO_ALLOC;
+    } else {
+      get_thread_allocator().iobuffer_mem_bytes_ += size_;
     }
   }
   return ret;
@@ -1323,6 +1333,7 @@ inline void ObIOBufferData::dealloc()
     iobuffer_mem_dec(location_, size_);
 #endif
     op_fixed_mem_free(data_, size_);
+    get_thread_allocator().iobuffer_mem_bytes_ -= size_;
   }
 
   data_ = NULL;
@@ -2267,6 +2278,28 @@ inline int ObMIOBuffer::alloc(const int64_t size)
   return ret;
 }
 
+inline bool ObMIOBuffer::release_empty_blocks()
+{
+  bool bret = (NULL != writer_);
+  for (int64_t i = 0; i < MAX_MIOBUFFER_READERS && bret; ++i) {
+    if (readers_[i].is_allocated()
+        && (0 != readers_[i].reserved_size_ || readers_[i].is_read_avail_more_than(0))) {
+      bret = false;
+    }
+  }
+
+  if (bret) {
+    for (int64_t i = 0; i < MAX_MIOBUFFER_READERS; ++i) {
+      if (readers_[i].is_allocated()) {
+        readers_[i].block_ = NULL;
+        readers_[i].start_offset_ = 0;
+      }
+    }
+    writer_ = NULL;
+  }
+  return bret;
+}
+
 inline void ObMIOBuffer::dealloc_reader(ObIOBufferReader *e)
 {
   if (NULL != e->accessor_) {
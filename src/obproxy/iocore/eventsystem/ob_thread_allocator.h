@@ -172,11 +172,19 @@ inline void thread_freeup_void(common::ObFixedMemAllocator &a, ObProxyThreadAllo
 
 struct ObThreadAllocator
 {
+  ObThreadAllocator() : iobuffer_mem_bytes_(0) { }
+
+  // free pool of 8KB iobuffer blocks
+  int64_t get_free_8k_block_bytes() const { return block_8k_allocator_.allocated_ * size_8k; }
+
   ObProxyThreadAllocator mio_allocator_;
   ObProxyThreadAllocator io_block_allocator_;
   ObProxyThreadAllocator io_data_allocator_;
   ObProxyThreadAllocator block_8k_allocator_;
   ObProxyThreadAllocator sm_allocator_;
+  // bytes of iobuffer data allocated minus freed by this thread, it is negative
+  // if this thread frees more buffers allocated by others
+  int64_t iobuffer_mem_bytes_;
 };
 
 inline ObThreadAllocator &get_thread_allocator()
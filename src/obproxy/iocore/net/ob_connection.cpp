@@ -425,6 +425,14 @@ int ObServerConnection::setup_fd_for_listen(
     PROXY_SOCK_LOG(WARN, "fail to set sockopt SO_REUSEADDR", K(fd_), K(ret));
   }
 
+#ifdef SO_REUSEPORT
+  if (OB_SUCC(ret) && reuse_port_
+      && OB_FAIL(ObSocketManager::setsockopt(fd_, SOL_SOCKET, SO_REUSEPORT,
+      reinterpret_cast<const void *>(&SOCKOPT_ON), sizeof(SOCKOPT_ON)))) {
+    PROXY_SOCK_LOG(WARN, "fail to set sockopt SO_REUSEPORT", K(fd_), K(ret));
+  }
+#endif
+
 #ifdef SET_TCP_NO_DELAY
   if (OB_SUCC(ret) && OB_FAIL(ObSocketManager::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY,
       reinterpret_cast<const void *>(&SOCKOPT_ON), sizeof(SOCKOPT_ON)))) {
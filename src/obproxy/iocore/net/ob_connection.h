@@ -127,7 +127,7 @@ class ObServerConnection : public ObConnection
 {
 public:
   ObServerConnection()
-      : ObConnection()
+      : ObConnection(), reuse_port_(false)
   {
     ob_zero(accept_addr_);
   }
@@ -158,6 +158,8 @@ public:
 public:
   // Client side (inbound) local IP address.
   ObIpEndpoint accept_addr_;
+  // set SO_REUSEPORT on listen socket, each net thread owns one listen socket
+  bool reuse_port_;
 
 private:
   static const int32_t LISTEN_BACKLOG;
@@ -0,0 +1,277 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY_NET
+
+#include "iocore/net/ob_io_uring.h"
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include "lib/oblog/ob_log.h"
+#include "utils/ob_proxy_lib.h"
+
+#if OB_HAVE_IO_URING
+#include <linux/io_uring.h>
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#endif
+
+using namespace oceanbase::common;
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace net
+{
+
+#if OB_HAVE_IO_URING
+static inline int sys_io_uring_setup(const uint32_t entries, struct io_uring_params &params)
+{
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+}
+
+static inline int sys_io_uring_enter(const int fd, const uint32_t to_submit,
+                                     const uint32_t min_complete, const uint32_t flags)
+{
+  return static_cast<int>(syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0));
+}
+#endif
+
+ObIOUring::ObIOUring()
+    : is_inited_(false), ring_fd_(-1), sq_entries_(0), cq_entries_(0),
+      to_submit_(0), sqe_tail_(0), sq_ring_ptr_(MAP_FAILED), sq_ring_size_(0),
+      sq_head_(NULL), sq_tail_(NULL), sq_ring_mask_(NULL), sq_array_(NULL),
+      sqes_(MAP_FAILED), sqes_size_(0), cq_ring_ptr_(MAP_FAILED), cq_ring_size_(0),
+      cq_head_(NULL), cq_tail_(NULL), cq_ring_mask_(NULL), cqes_(NULL)
+{
+}
+
+int ObIOUring::init(const uint32_t entries)
+{
+  int ret = OB_SUCCESS;
+  if (OB_UNLIKELY(is_inited_)) {
+    ret = OB_INIT_TWICE;
+    LOG_WARN("io uring init twice", K(ret));
+  } else if (OB_UNLIKELY(0 == entries)) {
+    ret = OB_INVALID_ARGUMENT;
+    LOG_WARN("invalid argument", K(entries), K(ret));
+  } else {
+#if OB_HAVE_IO_URING
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    if (OB_UNLIKELY((ring_fd_ = sys_io_uring_setup(entries, params)) < 0)) {
+      ret = OB_NOT_SUPPORTED;
+      LOG_WARN("fail to io_uring_setup, kernel may not support io_uring", K(entries), KERRMSGS, K(ret));
+    } else {
+      sq_entries_ = params.sq_entries;
+      cq_entries_ = params.cq_entries;
+      sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+      cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+      sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+
+      if (MAP_FAILED == (sq_ring_ptr_ = mmap(NULL, sq_ring_size_, PROT_READ | PROT_WRITE,
+                                             MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING))) {
+        ret = OB_ERR_SYS;
+        LOG_WARN("fail to mmap io uring sq ring", K_(sq_ring_size), KERRMSGS, K(ret));
+      } else if (MAP_FAILED == (cq_ring_ptr_ = mmap(NULL, cq_ring_size_, PROT_READ | PROT_WRITE,
+                                                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING))) {
+        ret = OB_ERR_SYS;
+        LOG_WARN("fail to mmap io uring cq ring", K_(cq_ring_size), KERRMSGS, K(ret));
+      } else if (MAP_FAILED == (sqes_ = mmap(NULL, sqes_size_, PROT_READ | PROT_WRITE,
+                                             MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES))) {
+        ret = OB_ERR_SYS;
+        LOG_WARN("fail to mmap io uring sqes", K_(sqes_size), KERRMSGS, K(ret));
+      } else {
+        char *sq_ptr = static_cast<char *>(sq_ring_ptr_);
+        char *cq_ptr = static_cast<char *>(cq_ring_ptr_);
+        sq_head_ = reinterpret_cast<uint32_t *>(sq_ptr + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<uint32_t *>(sq_ptr + params.sq_off.tail);
+        sq_ring_mask_ = reinterpret_cast<uint32_t *>(sq_ptr + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<uint32_t *>(sq_ptr + params.sq_off.array);
+        cq_head_ = reinterpret_cast<uint32_t *>(cq_ptr + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<uint32_t *>(cq_ptr + params.cq_off.tail);
+        cq_ring_mask_ = reinterpret_cast<uint32_t *>(cq_ptr + params.cq_off.ring_mask);
+        cqes_ = cq_ptr + params.cq_off.cqes;
+        sqe_tail_ = *sq_tail_;
+        to_submit_ = 0;
+        is_inited_ = true;
+        LOG_INFO("succ to init io uring", KPC(this));
+      }
+    }
+#else
+    ret = OB_NOT_SUPPORTED;
+    LOG_WARN("proxy is built without io_uring support", K(entries), K(ret));
+#endif
+  }
+
+  if (OB_FAIL(ret)) {
+    destroy();
+  }
+  return ret;
+}
+
+void ObIOUring::destroy()
+{
+  if (MAP_FAILED != sqes_) {
+    munmap(sqes_, sqes_size_);
+    sqes_ = MAP_FAILED;
+  }
+  if (MAP_FAILED != cq_ring_ptr_) {
+    munmap(cq_ring_ptr_, cq_ring_size_);
+    cq_ring_ptr_ = MAP_FAILED;
+  }
+  if (MAP_FAILED != sq_ring_ptr_) {
+    munmap(sq_ring_ptr_, sq_ring_size_);
+    sq_ring_ptr_ = MAP_FAILED;
+  }
+  if (ring_fd_ >= 0) {
+    ::close(ring_fd_);
+    ring_fd_ = -1;
+  }
+  sq_head_ = NULL;
+  sq_tail_ = NULL;
+  sq_ring_mask_ = NULL;
+  sq_array_ = NULL;
+  cq_head_ = NULL;
+  cq_tail_ = NULL;
+  cq_ring_mask_ = NULL;
+  cqes_ = NULL;
+  to_submit_ = 0;
+  is_inited_ = false;
+}
+
+int ObIOUring::prep_readv(const int fd, const struct iovec *iov, const int32_t niov, const uint64_t user_data)
+{
+#if OB_HAVE_IO_URING
+  return prep_rw(IORING_OP_READV, fd, iov, niov, user_data);
+#else
+  UNUSED(fd);
+  UNUSED(iov);
+  UNUSED(niov);
+  UNUSED(user_data);
+  return OB_NOT_SUPPORTED;
+#endif
+}
+
+int ObIOUring::prep_writev(const int fd, const struct iovec *iov, const int32_t niov, const uint64_t user_data)
+{
+#if OB_HAVE_IO_URING
+  return prep_rw(IORING_OP_WRITEV, fd, iov, niov, user_data);
+#else
+  UNUSED(fd);
+  UNUSED(iov);
+  UNUSED(niov);
+  UNUSED(user_data);
+  return OB_NOT_SUPPORTED;
+#endif
+}
+
+int ObIOUring::prep_rw(const uint8_t opcode, const int fd, const struct iovec *iov,
+                       const int32_t niov, const uint64_t user_data)
+{
+  int ret = OB_SUCCESS;
+#if OB_HAVE_IO_URING
+  if (OB_UNLIKELY(!is_inited_)) {
+    ret = OB_NOT_INIT;
+    LOG_WARN("io uring is not inited", K(ret));
+  } else if (OB_UNLIKELY(fd < 0) || OB_ISNULL(iov) || OB_UNLIKELY(niov <= 0)) {
+    ret = OB_INVALID_ARGUMENT;
+    LOG_WARN("invalid argument", K(fd), K(iov), K(niov), K(ret));
+  } else if (OB_UNLIKELY(sqe_tail_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_)) {
+    ret = OB_SIZE_OVERFLOW;
+    LOG_DEBUG("io uring sq is full", KPC(this), K(ret));
+  } else {
+    const uint32_t index = sqe_tail_ & *sq_ring_mask_;
+    struct io_uring_sqe *sqe = static_cast<struct io_uring_sqe *>(sqes_) + index;
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<uint64_t>(iov);
+    sqe->len = static_cast<uint32_t>(niov);
+    sqe->user_data = user_data;
+    sq_array_[index] = index;
+    ++sqe_tail_;
+    ++to_submit_;
+  }
+#else
+  UNUSED(opcode);
+  UNUSED(fd);
+  UNUSED(iov);
+  UNUSED(niov);
+  UNUSED(user_data);
+  ret = OB_NOT_SUPPORTED;
+#endif
+  return ret;
+}
+
+int ObIOUring::submit_and_wait(const int64_t wait_nr)
+{
+  int ret = OB_SUCCESS;
+#if OB_HAVE_IO_URING
+  if (OB_UNLIKELY(!is_inited_)) {
+    ret = OB_NOT_INIT;
+    LOG_WARN("io uring is not inited", K(ret));
+  } else if (OB_UNLIKELY(wait_nr < 0) || OB_UNLIKELY(wait_nr > cq_entries_)) {
+    ret = OB_INVALID_ARGUMENT;
+    LOG_WARN("invalid argument", K(wait_nr), KPC(this), K(ret));
+  } else if (to_submit_ > 0 || wait_nr > 0) {
+    // publish the new tail to kernel
+    __atomic_store_n(sq_tail_, sqe_tail_, __ATOMIC_RELEASE);
+    uint32_t flags = (wait_nr > 0 ? IORING_ENTER_GETEVENTS : 0);
+    int submitted = -1;
+    do {
+      submitted = sys_io_uring_enter(ring_fd_, to_submit_, static_cast<uint32_t>(wait_nr), flags);
+    } while (submitted < 0 && EINTR == errno);
+
+    if (OB_UNLIKELY(submitted < 0)) {
+      ret = ob_get_sys_errno();
+      LOG_WARN("fail to io_uring_enter", KPC(this), K(wait_nr), KERRMSGS, K(ret));
+    } else {
+      to_submit_ -= std::min(to_submit_, static_cast<uint32_t>(submitted));
+    }
+  }
+#else
+  UNUSED(wait_nr);
+  ret = OB_NOT_SUPPORTED;
+#endif
+  return ret;
+}
+
+bool ObIOUring::get_cqe(uint64_t &user_data, int32_t &res)
+{
+  bool bret = false;
+#if OB_HAVE_IO_URING
+  if (OB_LIKELY(is_inited_)) {
+    const uint32_t head = *cq_head_;
+    if (head != __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+      const struct io_uring_cqe *cqe = static_cast<struct io_uring_cqe *>(cqes_) + (head & *cq_ring_mask_);
+      user_data = cqe->user_data;
+      res = cqe->res;
+      __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+      bret = true;
+    }
+  }
+#else
+  UNUSED(user_data);
+  UNUSED(res);
+#endif
+  return bret;
+}
+
+} // end of namespace net
+} // end of namespace obproxy
+} // end of namespace oceanbase
@@ -0,0 +1,158 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#ifndef OBPROXY_IO_URING_H
+#define OBPROXY_IO_URING_H
+
+#include <sys/uio.h>
+#include "lib/ob_define.h"
+#include "iocore/eventsystem/ob_lock.h"
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define OB_HAVE_IO_URING 1
+#endif
+#endif
+
+#ifndef OB_HAVE_IO_URING
+#define OB_HAVE_IO_URING 0
+#endif
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace event
+{
+class ObIOBufferBlock;
+}
+namespace net
+{
+
+class ObUnixNetVConnection;
+
+// A minimal io_uring wrapper based on raw syscalls, proxy has no liburing dependency.
+// It is owned by one net thread and never shared, so no lock is needed.
+//
+// Usage in one net loop:
+//   prep_readv()/prep_writev() for every ready vc,
+//   submit_and_wait() once,
+//   get_cqe() until all completions are consumed.
+//
+// init() returns OB_NOT_SUPPORTED if the proxy is built without io_uring headers
+// or the running kernel does not support it, caller must fall back to readv/writev.
+class ObIOUring
+{
+public:
+  ObIOUring();
+  ~ObIOUring() { destroy(); }
+
+  int init(const uint32_t entries);
+  void destroy();
+  bool is_inited() const { return is_inited_; }
+
+  int prep_readv(const int fd, const struct iovec *iov, const int32_t niov, const uint64_t user_data);
+  int prep_writev(const int fd, const struct iovec *iov, const int32_t niov, const uint64_t user_data);
+
+  // submit all prepared sqes and wait until wait_nr cqes are ready
+  int submit_and_wait(const int64_t wait_nr);
+
+  // pop one completion, res is the readv/writev return value or -errno
+  bool get_cqe(uint64_t &user_data, int32_t &res);
+
+  int64_t get_sq_entries() const { return sq_entries_; }
+  int64_t get_to_submit() const { return to_submit_; }
+
+  TO_STRING_KV(K_(is_inited), K_(ring_fd), K_(sq_entries), K_(cq_entries), K_(to_submit));
+
+private:
+  int prep_rw(const uint8_t opcode, const int fd, const struct iovec *iov,
+              const int32_t niov, const uint64_t user_data);
+
+private:
+  bool is_inited_;
+  int ring_fd_;
+
+  uint32_t sq_entries_;
+  uint32_t cq_entries_;
+  uint32_t to_submit_;
+  uint32_t sqe_tail_;
+
+  // submission queue
+  void *sq_ring_ptr_;
+  int64_t sq_ring_size_;
+  uint32_t *sq_head_;
+  uint32_t *sq_tail_;
+  uint32_t *sq_ring_mask_;
+  uint32_t *sq_array_;
+  void *sqes_;
+  int64_t sqes_size_;
+
+  // completion queue
+  void *cq_ring_ptr_;
+  int64_t cq_ring_size_;
+  uint32_t *cq_head_;
+  uint32_t *cq_tail_;
+  uint32_t *cq_ring_mask_;
+  void *cqes_;
+
+  DISALLOW_COPY_AND_ASSIGN(ObIOUring);
+};
+
+enum ObNetIOUringPrepResult
+{
+  IO_URING_PREP_SUBMIT = 0, // request is prepared, submit it with this batch
+  IO_URING_PREP_DONE,       // nothing to read/write, vc has been disabled or rescheduled
+  IO_URING_PREP_FALLBACK,   // can not batch, do readv/writev inline after this batch
+};
+
+// One in-flight readv/writev of a vc in a net loop batch.
+// The vio mutex stays locked from prepare to completion.
+struct ObNetIOUringRequest
+{
+  static const int64_t MAX_IOV = 16;
+
+  ObNetIOUringRequest() { reset(); }
+  ~ObNetIOUringRequest() { }
+
+  void reset()
+  {
+    vc_ = NULL;
+    mutex_.release();
+    buffer_ = NULL;
+    niov_ = 0;
+    attempted_ = 0;
+    toread_ = 0;
+    next_block_ = NULL;
+    res_ = 0;
+  }
+
+  ObUnixNetVConnection *vc_;
+  common::ObPtr<event::ObProxyMutex> mutex_;
+  // the writer(read request) or reader(write request) used to build iov,
+  // completion is dropped if vio buffer has been changed by callback
+  void *buffer_;
+  struct iovec iov_[MAX_IOV];
+  int32_t niov_;
+  int64_t attempted_;
+  // read request only, the bytes wanted and the block after the last iov,
+  // a full completion goes on reading from next_block_ like read_from_net()
+  int64_t toread_;
+  event::ObIOBufferBlock *next_block_;
+  int32_t res_;
+};
+
+} // end of namespace net
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+#endif // OBPROXY_IO_URING_H
@@ -47,6 +47,8 @@ namespace net
 // This will get set via either command line or ObProxyConfig.
 // epoll timeout
 int net_config_poll_timeout = -1;
+// batch socket io of one net loop by io_uring, only used when net threads start
+bool net_config_enable_io_uring = false;
 
 int init_net(ObModuleVersion version, const ObNetOptions &net_options)
 {
@@ -70,6 +72,7 @@ int update_net_options(const ObNetOptions &net_options)
 {
   int ret = OB_SUCCESS;
   net_config_poll_timeout = static_cast<int32_t>(net_options.poll_timeout_);
+  net_config_enable_io_uring = net_options.enable_io_uring_;
   if (OB_FAIL(update_cop_config(net_options.default_inactivity_timeout_, net_options.max_client_connections_))) {
     PROXY_NET_LOG(WARN, "fail to update_cop_config",
                   K(net_options.default_inactivity_timeout_),
@@ -83,6 +83,7 @@ struct ObNetOptions
   int64_t max_connections_;
   int64_t default_inactivity_timeout_;
   int64_t max_client_connections_;
+  bool enable_io_uring_;
 };
 
 int init_net(ObModuleVersion version, const ObNetOptions &net_options);
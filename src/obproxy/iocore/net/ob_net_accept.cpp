@@ -32,6 +32,7 @@
 #include "iocore/net/ob_net_accept.h"
 #include "iocore/net/ob_net.h"
 #include "iocore/net/ob_event_io.h"
+#include <linux/filter.h>
 
 using namespace oceanbase::common;
 using namespace oceanbase::obproxy::event;
@@ -198,11 +199,22 @@ int ObNetAccept::init_accept()
   return ret;
 }
 
+// Initialize the ObNetAccept for execution in every net thread.
+// By default all net threads share one listen socket, and only the thread
+// which has minimal client connections does accept(see accept_balance).
+// If server_.reuse_port_ is set, each net thread owns its own SO_REUSEPORT
+// listen socket, kernel distributes new connections and net threads accept
+// in parallel.
 int ObNetAccept::init_accept_per_thread()
 {
   int ret = OB_SUCCESS;
   ObEThread *t = NULL;
 
+  if (server_.reuse_port_ && NO_FD != server_.fd_ && !check_inherited_reuse_port()) {
+    server_.reuse_port_ = false;
+    reuse_port_cpu_steering_ = false;
+  }
+
   if (OB_FAIL(do_listen(NON_BLOCKING))) {
     PROXY_NET_LOG(ERROR, "fail to listen", K(ret));
   } else {
@@ -224,9 +236,20 @@ int ObNetAccept::init_accept_per_thread()
         } else if (OB_FAIL(na->deep_copy(*this))) {
           NET_SUM_GLOBAL_DYN_STAT(NET_GLOBAL_ACCEPTS_CURRENTLY_OPEN, -1);
           PROXY_NET_LOG(ERROR, "fail to deep_copy", K(i), K(ret));
+        } else if (server_.reuse_port_ && OB_FAIL(na->listen_reuse_port())) {
+          NET_SUM_GLOBAL_DYN_STAT(NET_GLOBAL_ACCEPTS_CURRENTLY_OPEN, -1);
+          PROXY_NET_LOG(ERROR, "fail to listen reuse port", K(i), K(ret));
         }
       } else {
         na = this;
+        if (server_.reuse_port_ && reuse_port_cpu_steering_) {
+          // listen sockets of all threads are ready, steering is optional
+          int tmp_ret = OB_SUCCESS;
+          if (OB_UNLIKELY(OB_SUCCESS != (tmp_ret = attach_reuse_port_cpu_steering(n)))) {
+            PROXY_NET_LOG(WARN, "fail to attach reuse port cpu steering, "
+                          "kernel will distribute connections by hash", K(n), K(tmp_ret));
+          }
+        }
       }
 
       if (OB_SUCC(ret)) {
@@ -250,6 +273,80 @@ int ObNetAccept::init_accept_per_thread()
   return ret;
 }
 
+int ObNetAccept::listen_reuse_port()
+{
+  int ret = OB_SUCCESS;
+  ObHotUpgraderInfo &info = get_global_hot_upgrade_info();
+  // only the first listen socket is passed to sub process when hot upgrade
+  const int inherited_fd = info.fd_;
+  server_.fd_ = NO_FD;
+  if (OB_FAIL(server_.listen(NON_BLOCKING, recv_bufsize_, send_bufsize_))) {
+    PROXY_NET_LOG(ERROR, "fail to listen", K(server_.accept_addr_), KERRMSGS, K(ret));
+  } else {
+    PROXY_NET_LOG(INFO, "succ to listen reuse port", K(server_.accept_addr_), K(server_.fd_));
+  }
+  info.fd_ = inherited_fd;
+  return ret;
+}
+
+int ObNetAccept::attach_reuse_port_cpu_steering(const int64_t listener_count)
+{
+  int ret = OB_SUCCESS;
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+  // steer the connection to net thread (cpu id % listener_count).
+  // index in reuse port group follows listen order, the first listen socket(index 0)
+  // is owned by the last net thread and net thread i(i < n - 1) owns index i + 1,
+  // so return ((cpu id % listener_count) + 1) % listener_count as the index
+  struct sock_filter code[] = {
+    { BPF_LD | BPF_W | BPF_ABS, 0, 0, static_cast<uint32_t>(SKF_AD_OFF + SKF_AD_CPU) },
+    { BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<uint32_t>(listener_count) },
+    { BPF_ALU | BPF_ADD | BPF_K, 0, 0, 1 },
+    { BPF_ALU | BPF_MOD | BPF_K, 0, 0, static_cast<uint32_t>(listener_count) },
+    { BPF_RET | BPF_A, 0, 0, 0 },
+  };
+  struct sock_fprog prog;
+  prog.len = static_cast<unsigned short>(sizeof(code) / sizeof(code[0]));
+  prog.filter = code;
+  if (OB_UNLIKELY(listener_count <= 0)) {
+    ret = OB_INVALID_ARGUMENT;
+    PROXY_NET_LOG(WARN, "invalid argument", K(listener_count), K(ret));
+  } else if (OB_FAIL(ObSocketManager::setsockopt(server_.fd_, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF,
+                                                 &prog, sizeof(prog)))) {
+    PROXY_NET_LOG(WARN, "fail to set sockopt SO_ATTACH_REUSEPORT_CBPF",
+                  K(server_.fd_), K(listener_count), K(ret));
+  } else {
+    PROXY_NET_LOG(INFO, "succ to attach reuse port cpu steering", K(server_.fd_), K(listener_count));
+  }
+#else
+  UNUSED(listener_count);
+  ret = OB_NOT_SUPPORTED;
+#endif
+  return ret;
+}
+
+// the inherited listen socket must have SO_REUSEPORT,
+// otherwise other listen sockets can not bind the same address
+bool ObNetAccept::check_inherited_reuse_port()
+{
+  bool bret = false;
+#ifdef SO_REUSEPORT
+  int ret = OB_SUCCESS;
+  int32_t optval = 0;
+  int32_t optlen = sizeof(optval);
+  if (OB_FAIL(ObSocketManager::getsockopt(server_.fd_, SOL_SOCKET, SO_REUSEPORT,
+                                          reinterpret_cast<void *>(&optval), &optlen))) {
+    PROXY_NET_LOG(WARN, "fail to get sockopt SO_REUSEPORT", K(server_.fd_), K(ret));
+  } else {
+    bret = (0 != optval);
+  }
+#endif
+  if (!bret) {
+    PROXY_NET_LOG(WARN, "inherited listen socket has no SO_REUSEPORT, "
+                  "all net threads will share it", K(server_.fd_));
+  }
+  return bret;
+}
+
 int ObNetAccept::do_listen(const bool non_blocking)
 {
 
@@ -483,19 +580,26 @@ int ObNetAccept::accept_fast_event(int event, void *ep)
   if (OB_ISNULL(ep)) {
     ret = OB_INVALID_ARGUMENT;
     PROXY_NET_LOG(WARN, "invalid argument", K(ep), K(ret));
-  } else if (OB_UNLIKELY(!info.need_conn_accept_)) {
-    //do nothing
+  } else if (OB_UNLIKELY(NO_FD == server_.fd_)) {
+    // listen socket has been closed, do nothing
+  } else if (OB_UNLIKELY(!info.need_conn_accept_)
+             && (!server_.reuse_port_ || info.fd_ == server_.fd_)) {
+    // the inherited listen socket is accepted by sub process when hot upgrade
   } else {
     ObEvent *e = reinterpret_cast<ObEvent *>(ep);
     bool need_close_vc = false;
     bool loop = accept_till_done;
+    // only the first listen socket is passed to sub process when hot upgrade,
+    // the others are closed, accept the connections already queued on them
+    // until EAGAIN first, otherwise kernel resets them when close
+    const bool need_drain = !info.need_conn_accept_;
 
     if (OB_ISNULL(e->ethread_)) {
       ret = OB_ERR_UNEXPECTED;
       PROXY_NET_LOG(ERROR, "fail to get ethread", K(ret));
     } else {
       while (loop && OB_SUCC(ret)) {
-        if (!accept_balance(e->ethread_)) { // for balance
+        if (!server_.reuse_port_ && !accept_balance(e->ethread_)) { // for balance
           ret = OB_SYS_EAGAIN;
           net_ret = ret;
           con.fd_ = NO_FD;
@@ -597,6 +701,16 @@ int ObNetAccept::accept_fast_event(int event, void *ep)
           PROXY_NET_LOG(WARN, "failed to close connection", K(tmp_ret), K(ret));
         }
       }
+
+      if (need_drain && EVENT_DONE != event_ret && OB_SYS_EAGAIN == net_ret) {
+        if (OB_UNLIKELY(OB_SUCCESS != (tmp_ret = ep_->stop()))) {
+          PROXY_NET_LOG(WARN, "fail to stop ObEventIO", K(server_.fd_), K(tmp_ret));
+        }
+        PROXY_NET_LOG(INFO, "close drained reuse port listen socket", K(server_.fd_));
+        if (OB_UNLIKELY(OB_SUCCESS != (tmp_ret = server_.close()))) {
+          PROXY_NET_LOG(WARN, "failed to close server connection", K(tmp_ret));
+        }
+      }
     }
   }
 
@@ -687,6 +801,7 @@ ObNetAccept::ObNetAccept()
       sockopt_flags_(0),
       packet_mark_(0),
       packet_tos_(0),
+      reuse_port_cpu_steering_(false),
       etype_(ET_CALL),
       is_inited_(false),
       period_(0),
@@ -116,6 +116,11 @@ private:
   int accept_event(int event, void *e);
 
   void cancel();
+  // create another SO_REUSEPORT listen socket on the same address for this copy
+  int listen_reuse_port();
+  // spread connections to listen sockets by the cpu which received them
+  int attach_reuse_port_cpu_steering(const int64_t listener_count);
+  bool check_inherited_reuse_port();
   // for loading balance, get the ethread which has minimal client connections
   event::ObEThread *get_schedule_ethread();
   // for connection balance in each ethread,
@@ -134,6 +139,7 @@ public:
   uint32_t sockopt_flags_;
   uint32_t packet_mark_;
   uint32_t packet_tos_;
+  bool reuse_port_cpu_steering_;
   event::ObEventThreadType etype_;
 
 private:
@@ -102,6 +102,14 @@ public:
     bool frequent_accept_;
     bool backdoor_;
 
+    // Each net thread owns one SO_REUSEPORT listen socket.
+    // Only used if frequent_accept_ is true and accept_threads_ is 0.
+    // Default: false.
+    bool reuse_port_;
+    // Attach a cbpf program to steer connections by the receiving cpu.
+    // Only used if reuse_port_ is true.
+    bool reuse_port_cpu_steering_;
+
     // tcp defer accept timeout, if it set, accept until there is
     // data on the socket ready to be read. unit second.
     int64_t defer_accept_timeout_;
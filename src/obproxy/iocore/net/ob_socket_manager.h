@@ -32,6 +32,7 @@
 #ifndef OBPROXY_SOCKET_MANAGER_H
 #define OBPROXY_SOCKET_MANAGER_H
 
+#include <fcntl.h>
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 
@@ -45,6 +46,7 @@ namespace net
 {
 
 extern int net_config_poll_timeout;
+extern bool net_config_enable_io_uring;
 
 class ObSocketManager
 {
@@ -73,7 +75,8 @@ class ObSocketManager
 
   static int write(int sockfd, const void *buf, const int64_t size, int64_t &count);
   static int writev(int sockfd, const struct iovec *vector, const int size, int64_t &count);
-
+  // one of fd_in and fd_out must be a pipe
+  static int splice(int fd_in, int fd_out, const int64_t size, const uint32_t flags, int64_t &count);
 
   static int fcntl(int sockfd, const int cmd, const int arg, int &result);
   static int set_fl(int sockfd, const int arg, int &result);
@@ -325,6 +328,21 @@ inline int ObSocketManager::writev(int sockfd, const struct iovec *vector, const
   return ret;
 }
 
+inline int ObSocketManager::splice(int fd_in, int fd_out, const int64_t size,
+                                   const uint32_t flags, int64_t &count)
+{
+  int ret = common::OB_SUCCESS;
+  if (OB_UNLIKELY(fd_in < 3) || OB_UNLIKELY(fd_out < 3) || OB_UNLIKELY(size < 0)) {
+    ret = common::OB_INVALID_ARGUMENT;
+  } else {
+    count = ::splice(fd_in, NULL, fd_out, NULL, size, flags);
+    if (OB_UNLIKELY(count < 0)) {
+      ret = ob_get_sys_errno();
+    }
+  }
+  return ret;
+}
+
 inline int ObSocketManager::fcntl(int sockfd, const int cmd, const int arg, int &result)
 {
   int ret = common::OB_SUCCESS;
@@ -14,11 +14,14 @@
 
 #include "iocore/net/ob_ssl_processor.h"
 #include "iocore/eventsystem/ob_ethread.h"
+#include "iocore/eventsystem/ob_event_system.h"
 #include "lib/ob_errno.h"
 #include "lib/oblog/ob_log.h"
 #include "obutils/ob_proxy_config.h"
 #include "lib/atomic/ob_atomic.h"
 #include "lib/alloc/malloc_hook.h"
+#include "lib/time/ob_time_utility.h"
+#include <openssl/rand.h>
 
 using namespace oceanbase::common;
 using namespace oceanbase::obproxy::obutils;
@@ -31,8 +34,54 @@ namespace obproxy
 namespace net
 {
 
+ObEventThreadType ET_SSL_HANDSHAKE = ET_CALL;
 ObSSLProcessor g_ssl_processor;
 
+static const char SSL_SESSION_ID_CONTEXT[] = "obproxy";
+
+// HMAC-SHA256(secret, label || epoch), epoch is encoded in big endian
+static int derive_ticket_key_part(const unsigned char *secret, const int64_t secret_len,
+                                  const char *label, const int64_t epoch,
+                                  unsigned char *out, const int64_t out_len)
+{
+  int ret = OB_SUCCESS;
+  unsigned char data[64];
+  unsigned char md[EVP_MAX_MD_SIZE];
+  unsigned int md_len = 0;
+  const int64_t label_len = static_cast<int64_t>(strlen(label));
+  MEMCPY(data, label, label_len);
+  for (int64_t i = 0; i < 8; ++i) {
+    data[label_len + i] = static_cast<unsigned char>((static_cast<uint64_t>(epoch) >> (56 - 8 * i)) & 0xFF);
+  }
+  if (NULL == HMAC(EVP_sha256(), secret, static_cast<int>(secret_len), data,
+                   static_cast<size_t>(label_len + 8), md, &md_len)
+      || static_cast<int64_t>(md_len) < out_len) {
+    ret = OB_SSL_ERROR;
+    LOG_WARN("derive ssl ticket key failed", K(label), K(epoch), K(ret));
+  } else {
+    MEMCPY(out, md, out_len);
+  }
+  memset(md, 0, sizeof(md));
+  return ret;
+}
+
+int ObSSLTicketKey::derive(const unsigned char *secret, const int64_t secret_len, const int64_t epoch)
+{
+  int ret = OB_SUCCESS;
+  if (OB_ISNULL(secret) || secret_len <= 0) {
+    ret = OB_INVALID_ARGUMENT;
+    LOG_WARN("invalid ssl ticket key secret", K(secret_len), K(ret));
+  } else if (OB_FAIL(derive_ticket_key_part(secret, secret_len, "obproxy ticket name", epoch, name_, NAME_LEN))
+             || OB_FAIL(derive_ticket_key_part(secret, secret_len, "obproxy ticket aes", epoch, aes_key_, AES_KEY_LEN))
+             || OB_FAIL(derive_ticket_key_part(secret, secret_len, "obproxy ticket hmac", epoch, hmac_key_, HMAC_KEY_LEN))) {
+    reset();
+  } else {
+    epoch_ = epoch;
+    is_valid_ = true;
+  }
+  return ret;
+}
+
 int ObSSLProcessor::init()
 {
   int ret = OB_SUCCESS;
@@ -52,11 +101,51 @@ int ObSSLProcessor::init()
   } else {
     ssl_ctx_ = ssl_ctx;
     SSL_CTX_set_verify(ssl_ctx_, SSL_VERIFY_PEER, NULL);
+    // small blocks are coalesced into a buffer of net thread before SSL_write,
+    // the retry after SSL_ERROR_WANT_WRITE may come from another address
+    SSL_CTX_set_mode(ssl_ctx_, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    // with peer verification, a session is only resumed in the same session id context
+    if (OB_SSL_SUCC_RET != SSL_CTX_set_session_id_context(ssl_ctx_,
+        reinterpret_cast<const unsigned char *>(SSL_SESSION_ID_CONTEXT),
+        static_cast<unsigned int>(sizeof(SSL_SESSION_ID_CONTEXT) - 1))) {
+      ret = OB_SSL_ERROR;
+      LOG_WARN("set ssl session id context failed", K(ret));
+    } else if (OB_SSL_SUCC_RET != SSL_CTX_set_tlsext_ticket_key_cb(ssl_ctx_, ObSSLProcessor::ticket_key_cb)) {
+      ret = OB_SSL_ERROR;
+      LOG_WARN("set ssl ticket key callback failed", K(ret));
+    } else {
+      const int64_t cache_size = get_global_proxy_config().ssl_session_cache_size;
+      const int64_t timeout_s = usec_to_sec(get_global_proxy_config().ssl_session_timeout);
+      if (cache_size > 0) {
+        SSL_CTX_set_session_cache_mode(ssl_ctx_, SSL_SESS_CACHE_SERVER);
+        SSL_CTX_sess_set_cache_size(ssl_ctx_, cache_size);
+      } else {
+        SSL_CTX_set_session_cache_mode(ssl_ctx_, SSL_SESS_CACHE_OFF);
+      }
+      // also the lifetime of session tickets
+      SSL_CTX_set_timeout(ssl_ctx_, static_cast<long>(timeout_s));
+      LOG_INFO("ssl session resumption inited", K(cache_size), K(timeout_s));
+    }
   }
 
   return ret;
 }
 
+int ObSSLProcessor::start_handshake_threads(const int64_t thread_count, const int64_t stacksize)
+{
+  int ret = OB_SUCCESS;
+  if (thread_count <= 0) {
+    LOG_INFO("ssl handshake threads are disabled, handshakes run on work threads", K(thread_count));
+  } else if (OB_FAIL(g_event_processor.spawn_event_threads(thread_count, "ET_SSL_HANDSHAKE",
+                                                           stacksize, ET_SSL_HANDSHAKE))) {
+    LOG_WARN("fail to spawn event threads for ET_SSL_HANDSHAKE", K(thread_count), K(ret));
+  } else {
+    handshake_thread_count_ = thread_count;
+    LOG_INFO("succ to start ssl handshake threads", K(thread_count));
+  }
+  return ret;
+}
+
 void *ObSSLProcessor::malloc_for_ssl(size_t size)
 {
   void *ptr = NULL;
@@ -88,10 +177,16 @@ void ObSSLProcessor::free_for_ssl(void *ptr)
 int ObSSLProcessor::update_key(const ObString &source_type,
                                const ObString &ca,
                                const ObString &public_key,
-                               const ObString &private_key)
+                               const ObString &private_key,
+                               const ObString &ticket_key)
 {
   int ret = OB_SUCCESS;
-  if (source_type == "DBMESH") {
+  if (!ticket_key.empty()
+      && (ticket_key.length() < MIN_TICKET_KEY_SECRET_LEN || ticket_key.length() > MAX_TICKET_KEY_SECRET_LEN)) {
+    ret = OB_INVALID_ARGUMENT;
+    LOG_WARN("invalid ssl ticket key length", "length", ticket_key.length(),
+             LITERAL_K(MIN_TICKET_KEY_SECRET_LEN), LITERAL_K(MAX_TICKET_KEY_SECRET_LEN), K(ret));
+  } else if (source_type == "DBMESH") {
     if (OB_FAIL(update_key_from_dbmesh(ca, public_key, private_key))) {
       LOG_WARN("update key from dbmesh failed", K(ret), K(ca), K(public_key), K(private_key));
     }
@@ -104,6 +199,11 @@ int ObSSLProcessor::update_key(const ObString &source_type,
     LOG_WARN("unknown source type", K(source_type), K(ret));
   }
 
+  if (OB_SUCC(ret)) {
+    reset_session_resumption(ticket_key);
+    ATOMIC_STORE(&ssl_inited_, true);
+  }
+
   return ret;
 }
 
@@ -129,7 +229,6 @@ int ObSSLProcessor::update_key_from_file(const ObString &ca,
       ret = OB_SSL_ERROR;
       LOG_WARN("check private key failed", K(ret), K(ca), K(public_key), K(private_key));
     } else {
-      ATOMIC_STORE(&ssl_inited_, true);
       LOG_INFO("ssl inited using file succ");
     }
   }
@@ -209,7 +308,6 @@ int ObSSLProcessor::update_key_from_dbmesh(const ObString &ca,
     }
 
     if (OB_SUCC(ret)) {
-      ATOMIC_STORE(&ssl_inited_, true);
       LOG_INFO("ssl inited using dbmesh succ");
     }
   }
@@ -221,6 +319,11 @@ SSL* ObSSLProcessor::create_new_ssl()
 {
   SSL *new_ssl = NULL;
   new_ssl = SSL_new(ssl_ctx_);
+  // tickets are only issued with the shared secret, a ticket of one proxy
+  // can be resumed by all the others
+  if (NULL != new_ssl && (!get_global_proxy_config().enable_ssl_session_ticket || !has_ticket_key_secret())) {
+    SSL_set_options(new_ssl, SSL_OP_NO_TICKET);
+  }
 
   return new_ssl;
 }
@@ -235,6 +338,125 @@ void ObSSLProcessor::release_ssl(SSL* ssl, const bool can_shutdown_ssl)
   }
 }
 
+void ObSSLProcessor::reset_session_resumption(const ObString &ticket_key)
+{
+  if (NULL != ssl_ctx_) {
+    // 0 means flush all sessions regardless of their time
+    SSL_CTX_flush_sessions(ssl_ctx_, 0);
+  }
+  DRWLock::WRLockGuard guard(ticket_key_lock_);
+  memset(ticket_key_secret_, 0, sizeof(ticket_key_secret_));
+  ticket_key_secret_len_ = 0;
+  if (!ticket_key.empty() && ticket_key.length() <= MAX_TICKET_KEY_SECRET_LEN) {
+    MEMCPY(ticket_key_secret_, ticket_key.ptr(), ticket_key.length());
+    ticket_key_secret_len_ = ticket_key.length();
+  }
+  cur_ticket_key_.reset();
+  prev_ticket_key_.reset();
+  LOG_INFO("ssl session ticket key secret updated", "has_secret", ticket_key_secret_len_ > 0);
+}
+
+bool ObSSLProcessor::has_ticket_key_secret()
+{
+  DRWLock::RDLockGuard guard(ticket_key_lock_);
+  return ticket_key_secret_len_ > 0;
+}
+
+void ObSSLProcessor::rotate_ticket_key_if_needed(const int64_t now_us)
+{
+  const int64_t interval_us = get_global_proxy_config().ssl_session_ticket_key_rotate_interval;
+  // proxies sharing the secret are in the same epoch, except around the
+  // boundary with clock skew, when the other proxy does a full handshake
+  const int64_t epoch = interval_us > 0 ? now_us / interval_us : 0;
+  bool need_rotate = false;
+  {
+    DRWLock::RDLockGuard guard(ticket_key_lock_);
+    need_rotate = ticket_key_secret_len_ > 0 && (!cur_ticket_key_.is_valid_ || epoch != cur_ticket_key_.epoch_);
+  }
+  if (need_rotate) {
+    DRWLock::WRLockGuard guard(ticket_key_lock_);
+    // double check, another thread may have rotated it
+    if (ticket_key_secret_len_ > 0 && (!cur_ticket_key_.is_valid_ || epoch != cur_ticket_key_.epoch_)) {
+      ObSSLTicketKey new_key;
+      ObSSLTicketKey new_prev_key;
+      if (OB_SUCCESS == new_key.derive(ticket_key_secret_, ticket_key_secret_len_, epoch)
+          && OB_SUCCESS == new_prev_key.derive(ticket_key_secret_, ticket_key_secret_len_, epoch - 1)) {
+        prev_ticket_key_ = new_prev_key;
+        cur_ticket_key_ = new_key;
+        LOG_INFO("ssl session ticket key rotated", K(epoch), K(interval_us));
+      }
+      new_key.reset();
+      new_prev_key.reset();
+    }
+  }
+}
+
+int ObSSLProcessor::get_ticket_key(const unsigned char *name, ObSSLTicketKey &key)
+{
+  int found = 0;
+  DRWLock::RDLockGuard guard(ticket_key_lock_);
+  if (!cur_ticket_key_.is_valid_) {
+    // no key yet, or reset by key update
+  } else if (NULL == name || 0 == memcmp(name, cur_ticket_key_.name_, ObSSLTicketKey::NAME_LEN)) {
+    key = cur_ticket_key_;
+    found = 1;
+  } else if (prev_ticket_key_.is_valid_
+             && 0 == memcmp(name, prev_ticket_key_.name_, ObSSLTicketKey::NAME_LEN)) {
+    key = prev_ticket_key_;
+    found = 2;
+  }
+  return found;
+}
+
+// returns -1 on error, 0 to do full handshake, 1 on success,
+// 2 on success and the ticket needs to be renewed
+int ObSSLProcessor::handle_ticket_key(unsigned char *name, unsigned char *iv, EVP_CIPHER_CTX *cipher_ctx,
+                                      HMAC_CTX *hmac_ctx, const int enc, const int64_t now_us)
+{
+  int cb_ret = -1;
+  ObSSLTicketKey key;
+  // the key of a ticket to decrypt may be rotated out just now, so rotate for both
+  rotate_ticket_key_if_needed(now_us);
+  if (1 == enc) {
+    if (1 != get_ticket_key(NULL, key)) {
+      LOG_WARN("no ssl ticket key to encrypt session ticket");
+    } else if (OB_SSL_SUCC_RET != RAND_bytes(iv, EVP_CIPHER_iv_length(EVP_aes_256_cbc()))) {
+      LOG_WARN("generate ssl ticket iv failed");
+    } else if (OB_SSL_SUCC_RET != EVP_EncryptInit_ex(cipher_ctx, EVP_aes_256_cbc(), NULL, key.aes_key_, iv)) {
+      LOG_WARN("init ssl ticket encrypt failed");
+    } else if (OB_SSL_SUCC_RET != HMAC_Init_ex(hmac_ctx, key.hmac_key_,
+                                               static_cast<int>(ObSSLTicketKey::HMAC_KEY_LEN), EVP_sha256(), NULL)) {
+      LOG_WARN("init ssl ticket hmac failed");
+    } else {
+      memcpy(name, key.name_, ObSSLTicketKey::NAME_LEN);
+      cb_ret = 1;
+    }
+  } else {
+    const int found = get_ticket_key(name, key);
+    if (0 == found) {
+      // unknown or expired key, fall back to full handshake
+      cb_ret = 0;
+    } else if (OB_SSL_SUCC_RET != HMAC_Init_ex(hmac_ctx, key.hmac_key_,
+                                               static_cast<int>(ObSSLTicketKey::HMAC_KEY_LEN), EVP_sha256(), NULL)) {
+      LOG_WARN("init ssl ticket hmac failed");
+    } else if (OB_SSL_SUCC_RET != EVP_DecryptInit_ex(cipher_ctx, EVP_aes_256_cbc(), NULL, key.aes_key_, iv)) {
+      LOG_WARN("init ssl ticket decrypt failed");
+    } else {
+      cb_ret = found;
+    }
+  }
+  key.reset();
+  return cb_ret;
+}
+
+// called by openssl on net threads
+int ObSSLProcessor::ticket_key_cb(SSL *ssl, unsigned char *name, unsigned char *iv,
+                                  EVP_CIPHER_CTX *cipher_ctx, HMAC_CTX *hmac_ctx, int enc)
+{
+  UNUSED(ssl);
+  return g_ssl_processor.handle_ticket_key(name, iv, cipher_ctx, hmac_ctx, enc, ObTimeUtility::current_time());
+}
+
 bool ObSSLProcessor::is_client_ssl_supported()
 {
   return get_global_proxy_config().enable_client_ssl && ATOMIC_LOAD(&ssl_inited_);
@@ -15,8 +15,10 @@
 
 #include <openssl/ssl.h>
 #include <openssl/err.h>
+#include <openssl/hmac.h>
 
 #include "iocore/eventsystem/ob_lock.h"
+#include "iocore/eventsystem/ob_event.h"
 #include "lib/lock/ob_drw_lock.h"
 
 #define OB_SSL_SUCC_RET 1
@@ -28,22 +30,53 @@ namespace obproxy
 namespace net
 {
 
+// Key used to encrypt and authenticate session tickets, see RFC 5077.
+// it is derived from the ticket key secret of the shared security config and
+// the rotation epoch, so all proxies of the config issue and accept the same tickets
+struct ObSSLTicketKey
+{
+  static const int64_t NAME_LEN = 16;
+  static const int64_t AES_KEY_LEN = 32;
+  static const int64_t HMAC_KEY_LEN = 32;
+
+  ObSSLTicketKey() { reset(); }
+  void reset() { memset(this, 0, sizeof(ObSSLTicketKey)); }
+  int derive(const unsigned char *secret, const int64_t secret_len, const int64_t epoch);
+
+  unsigned char name_[NAME_LEN];
+  unsigned char aes_key_[AES_KEY_LEN];
+  unsigned char hmac_key_[HMAC_KEY_LEN];
+  int64_t epoch_;
+  bool is_valid_;
+};
+
 class ObSSLProcessor
 {
 public:
-  ObSSLProcessor() : ssl_ctx_(NULL), ssl_inited_(false) {}
+  static const int64_t MIN_TICKET_KEY_SECRET_LEN = 32;
+  static const int64_t MAX_TICKET_KEY_SECRET_LEN = 256;
+
+  ObSSLProcessor() : ssl_ctx_(NULL), ssl_inited_(false), handshake_thread_count_(0), ticket_key_lock_(),
+                     ticket_key_secret_len_(0) {}
   ~ObSSLProcessor() {}
   int init();
+  // server side handshakes are run on these threads instead of net threads,
+  // 0 means disable
+  int start_handshake_threads(const int64_t thread_count, const int64_t stacksize);
+  bool is_handshake_offload_enabled() const { return handshake_thread_count_ > 0; }
   SSL* create_new_ssl();
   void release_ssl(SSL* ssl, const bool can_shutdown_ssl);
   void openssl_lock(int n);
   void openssl_unlock(int n);
   bool is_client_ssl_supported();
   bool is_server_ssl_supported();
+  // ticket_key is the secret of session ticket keys, session tickets are not
+  // issued if it is empty
   int update_key(const common::ObString &source_type,
                  const common::ObString &ca,
                  const common::ObString &public_key,
-                 const common::ObString &private_key);
+                 const common::ObString &private_key,
+                 const common::ObString &ticket_key);
 
 private:
   int update_key_from_file(const common::ObString &ca,
@@ -53,6 +86,19 @@ private:
   int update_key_from_dbmesh(const common::ObString &ca,
                              const common::ObString &public_key,
                              const common::ObString &private_key);
+
+  // sessions and tickets of old certificates must not be resumed
+  void reset_session_resumption(const common::ObString &ticket_key);
+  bool has_ticket_key_secret();
+  void rotate_ticket_key_if_needed(const int64_t now_us);
+  // 1 for current key, 2 for previous key which means the ticket needs renew,
+  // 0 if not found
+  int get_ticket_key(const unsigned char *name, ObSSLTicketKey &key);
+  int handle_ticket_key(unsigned char *name, unsigned char *iv, EVP_CIPHER_CTX *cipher_ctx,
+                        HMAC_CTX *hmac_ctx, const int enc, const int64_t now_us);
+
+  static int ticket_key_cb(SSL *ssl, unsigned char *name, unsigned char *iv,
+                           EVP_CIPHER_CTX *cipher_ctx, HMAC_CTX *hmac_ctx, int enc);
 private:
   static void *malloc_for_ssl(size_t num);
   static void *realloc_for_ssl(void *p, size_t num);
@@ -61,8 +107,18 @@ private:
 private:
   SSL_CTX *ssl_ctx_;
   bool ssl_inited_;
+  int64_t handshake_thread_count_;
+
+  // tickets encrypted by the previous key are still accepted and renewed,
+  // so that clients holding them resume once more after rotation
+  common::DRWLock ticket_key_lock_;
+  unsigned char ticket_key_secret_[MAX_TICKET_KEY_SECRET_LEN];
+  int64_t ticket_key_secret_len_;
+  ObSSLTicketKey cur_ticket_key_;
+  ObSSLTicketKey prev_ticket_key_;
 };
 
+extern event::ObEventThreadType ET_SSL_HANDSHAKE;
 extern ObSSLProcessor g_ssl_processor;
 
 } // end net
@@ -30,6 +30,7 @@
  */
 
 #include <pthread.h>
+#include <fcntl.h>
 #include "iocore/net/ob_net.h"
 #include "iocore/net/ob_unix_net.h"
 #include "iocore/net/ob_event_io.h"
@@ -204,6 +205,8 @@ int initialize_thread_for_net(ObEThread *thread)
 
 ObNetPoll::ObNetPoll(ObNetHandler &nh)
     : poll_descriptor_(NULL),
+      io_uring_(NULL),
+      io_uring_reqs_(NULL),
       nh_(nh),
       poll_timeout_(-1)
 {
@@ -213,6 +216,7 @@ ObNetPoll::~ObNetPoll()
 {
   delete poll_descriptor_;
   poll_descriptor_ = NULL;
+  destroy_io_uring();
 }
 
 int ObNetPoll::init()
@@ -230,11 +234,54 @@ int ObNetPoll::init()
       PROXY_NET_LOG(WARN, "fail to init poll_descriptor");
       delete poll_descriptor_;
       poll_descriptor_ = NULL;
+    } else if (net_config_enable_io_uring) {
+      // io_uring is optional, if it is not supported, we still use readv/writev
+      int tmp_ret = OB_SUCCESS;
+      if (OB_UNLIKELY(OB_SUCCESS != (tmp_ret = init_io_uring()))) {
+        PROXY_NET_LOG(WARN, "fail to init io_uring, use readv/writev instead", K(tmp_ret));
+      }
     }
   }
   return ret;
 }
 
+int ObNetPoll::init_io_uring()
+{
+  int ret = OB_SUCCESS;
+  if (OB_UNLIKELY(NULL != io_uring_)) {
+    ret = OB_INIT_TWICE;
+    PROXY_NET_LOG(WARN, "init io_uring twice", K(io_uring_), K(ret));
+  } else if (OB_ISNULL(io_uring_ = new (std::nothrow) ObIOUring())) {
+    ret = OB_ALLOCATE_MEMORY_FAILED;
+    PROXY_NET_LOG(WARN, "fail to new ObIOUring", K(ret));
+  } else if (OB_FAIL(io_uring_->init(static_cast<uint32_t>(IO_URING_ENTRIES)))) {
+    PROXY_NET_LOG(WARN, "fail to init ObIOUring", K(ret));
+  } else if (OB_UNLIKELY(io_uring_->get_sq_entries() < IO_URING_ENTRIES)) {
+    ret = OB_ERR_UNEXPECTED;
+    PROXY_NET_LOG(WARN, "io_uring sq entries is too small", KPC_(io_uring), K(ret));
+  } else if (OB_ISNULL(io_uring_reqs_ = new (std::nothrow) ObNetIOUringRequest[IO_URING_ENTRIES])) {
+    ret = OB_ALLOCATE_MEMORY_FAILED;
+    PROXY_NET_LOG(WARN, "fail to new ObNetIOUringRequest array", K(ret));
+  }
+
+  if (OB_FAIL(ret)) {
+    destroy_io_uring();
+  }
+  return ret;
+}
+
+void ObNetPoll::destroy_io_uring()
+{
+  if (NULL != io_uring_) {
+    delete io_uring_;
+    io_uring_ = NULL;
+  }
+  if (NULL != io_uring_reqs_) {
+    delete [] io_uring_reqs_;
+    io_uring_reqs_ = NULL;
+  }
+}
+
 ObInactivityCop::ObInactivityCop(ObProxyMutex *m)
     : ObContinuation(m), default_inactivity_timeout_(1800),
       total_connections_in_(0), max_connections_in_(0), connections_per_thread_in_(0)
@@ -438,9 +485,39 @@ ObNetHandler::ObNetHandler()
       trigger_event_(NULL),
       keep_alive_lru_size_(0)
 {
+  splice_pipe_[0] = NO_FD;
+  splice_pipe_[1] = NO_FD;
   SET_HANDLER(reinterpret_cast<NetContHandler>(&ObNetHandler::start_net_event));
 }
 
+int ObNetHandler::get_splice_pipe(int &read_fd, int &write_fd)
+{
+  int ret = OB_SUCCESS;
+  if (NO_FD == splice_pipe_[0]) {
+    if (OB_UNLIKELY(0 != ::pipe2(splice_pipe_, O_NONBLOCK | O_CLOEXEC))) {
+      ret = ob_get_sys_errno();
+      splice_pipe_[0] = NO_FD;
+      splice_pipe_[1] = NO_FD;
+      PROXY_NET_LOG(WARN, "fail to create splice pipe", K(ret));
+    }
+  }
+  if (OB_SUCC(ret)) {
+    read_fd = splice_pipe_[0];
+    write_fd = splice_pipe_[1];
+  }
+  return ret;
+}
+
+void ObNetHandler::close_splice_pipe()
+{
+  if (NO_FD != splice_pipe_[0]) {
+    ::close(splice_pipe_[0]);
+    ::close(splice_pipe_[1]);
+    splice_pipe_[0] = NO_FD;
+    splice_pipe_[1] = NO_FD;
+  }
+}
+
 // Initialization here
 // in the thread in which we will be executing from now on.
 int ObNetHandler::start_net_event(int event, ObEvent *e)
@@ -485,6 +562,186 @@ inline void ObNetHandler::process_enabled_list()
   }
 }
 
+inline void ObNetHandler::process_ready_list(ObEThread &ethread)
+{
+  ObUnixNetVConnection *vc = NULL;
+  int close_ret = OB_SUCCESS;
+#if defined(USE_EDGE_TRIGGER)
+  // ObUnixNetVConnection *
+  while (NULL != (vc = read_ready_list_.dequeue())) {
+    if (vc->closed_) {
+      if (OB_UNLIKELY(OB_SUCCESS != (close_ret = vc->close()))) {
+        PROXY_NET_LOG(WARN, "fail to close unix net vconnection", K(vc), K(close_ret));
+      }
+    } else if (vc->using_ssl() && (vc->read_.enabled_ || vc->write_.enabled_)) {
+      vc->do_ssl_io(ethread);
+    } else if (vc->read_.enabled_ && vc->read_.triggered_ && !vc->using_ssl()) {
+      vc->read_from_net(ethread);
+    } else if (!vc->read_.enabled_) {
+      read_ready_list_.remove(vc);
+    }
+  }
+
+  while (NULL != (vc = write_ready_list_.dequeue())) {
+    if (vc->closed_) {
+      if (OB_UNLIKELY(OB_SUCCESS != (close_ret = vc->close()))) {
+        PROXY_NET_LOG(WARN, "fail to close unix net vconnection", K(vc), K(close_ret));
+      }
+    } else if (vc->using_ssl() && (vc->read_.enabled_ || vc->write_.enabled_)) {
+      vc->do_ssl_io(ethread);
+    } else if (vc->write_.enabled_ && vc->write_.triggered_ && !vc->using_ssl()) {
+      vc->write_to_net(ethread);
+    } else if (!vc->write_.enabled_) {
+      write_ready_list_.remove(vc);
+    }
+  }
+
+#else // USE_EDGE_TRIGGER
+  while (NULL != (vc = read_ready_list_.dequeue())) {
+    if (vc->closed_) {
+      if (OB_UNLIKELY(OB_SUCCESS != (close_ret = vc->close()))) {
+        PROXY_NET_LOG(WARN, "fail to close unix net vconnection", K(vc), K(close_ret));
+      }
+    } else if (vc->using_ssl() || (vc->read_.enabled_ || vc->write_.enabled_)) {
+      vc->do_ssl_io(ethread);
+    } else if (vc->read_.enabled_ && vc->read_.triggered_ && !vc->using_ssl()) {
+      vc->read_from_net(ethread);
+    } else if (!vc->read_.enabled_) {
+      vc->ep_->modify(-EVENTIO_READ);
+    }
+  }
+
+  while (NULL != (vc = write_ready_list_.dequeue())) {
+    if (vc->closed_) {
+      if (OB_UNLIKELY(OB_SUCCESS != (close_ret = vc->close()))) {
+        PROXY_NET_LOG(WARN, "fail to close unix net vconnection", K(vc), K(close_ret));
+      }
+    } else if (vc->using_ssl() && (vc->read_.enabled_ || vc->write_.enabled_)) {
+      vc->do_ssl_io(ethread);
+    } else if (vc->write_.enabled_ && vc->write_.triggered_ && !vc->using_ssl()) {
+      vc->write_to_net(ethread);
+    } else if (!vc->write_.enabled_) {
+      vc->ep_->modify(-EVENTIO_WRITE);
+    }
+  }
+#endif // !USE_EDGE_TRIGGER
+}
+
+// Batch one readv/writev of every ready vc into a single io_uring_enter.
+// The vio mutex of a batched vc is held until its completion is handled,
+// and the vcs which can not be batched(ssl, shared vio mutex, need signal
+// before write) are handled inline by the same way as process_ready_list.
+int ObNetHandler::process_ready_list_by_io_uring(ObEThread &ethread, ObNetPoll &net_poll, const bool is_read)
+{
+  int ret = OB_SUCCESS;
+  ObIOUring &io_uring = *net_poll.get_io_uring();
+  ObNetIOUringRequest *reqs = net_poll.get_io_uring_reqs();
+  ObUnixNetVConnection *fallback_vcs[ObNetPoll::IO_URING_ENTRIES];
+  ObUnixNetVConnection *vc = NULL;
+  int64_t req_count = 0;
+  int64_t fallback_count = 0;
+  int64_t handled_count = 0;
+  int close_ret = OB_SUCCESS;
+  ObNetIOUringPrepResult result = IO_URING_PREP_DONE;
+
+  // 1. prepare requests
+  while (handled_count < ObNetPoll::IO_URING_ENTRIES
+         && NULL != (vc = (is_read ? read_ready_list_.dequeue() : write_ready_list_.dequeue()))) {
+    ++handled_count;
+    ObNetState &state = (is_read ? vc->read_ : vc->write_);
+    if (vc->closed_) {
+      if (OB_UNLIKELY(OB_SUCCESS != (close_ret = vc->close()))) {
+        PROXY_NET_LOG(WARN, "fail to close unix net vconnection", K(vc), K(close_ret));
+      }
+    } else if (vc->using_ssl()) {
+      if (vc->read_.enabled_ || vc->write_.enabled_) {
+        // avoid being freed by the callback of other vc in this batch
+        ++vc->recursion_;
+        fallback_vcs[fallback_count++] = vc;
+      }
+    } else if (state.enabled_ && state.triggered_) {
+      ObNetIOUringRequest &req = reqs[req_count];
+      result = (is_read ? vc->prep_read_from_net(ethread, req) : vc->prep_write_to_net(ethread, req));
+      if (IO_URING_PREP_SUBMIT == result) {
+        int tmp_ret = (is_read ? io_uring.prep_readv(vc->con_.fd_, req.iov_, req.niov_, req_count)
+                               : io_uring.prep_writev(vc->con_.fd_, req.iov_, req.niov_, req_count));
+        if (OB_UNLIKELY(OB_SUCCESS != tmp_ret)) {
+          // res_ is -ECANCELED, vc will be rescheduled when finish
+          PROXY_NET_LOG(WARN, "fail to prep io_uring request", K(vc), K(is_read), K(tmp_ret));
+        }
+        ++req_count;
+      } else if (IO_URING_PREP_FALLBACK == result) {
+        ++vc->recursion_;
+        fallback_vcs[fallback_count++] = vc;
+      }
+    }
+  }
+
+  // 2. submit and wait all completions,
+  //    sockets are nonblocking, so kernel completes them without waiting for data
+  if (req_count > 0) {
+    int64_t wait_count = io_uring.get_to_submit();
+    uint64_t user_data = 0;
+    int32_t res = 0;
+    while (OB_SUCC(ret) && wait_count > 0) {
+      if (OB_FAIL(io_uring.submit_and_wait(wait_count))) {
+        PROXY_NET_LOG(WARN, "fail to submit io_uring requests", K(wait_count), K(req_count), K(ret));
+      } else {
+        NET_INCREMENT_DYN_STAT(NET_CALLS_TO_IO_URING_ENTER);
+        while (io_uring.get_cqe(user_data, res)) {
+          if (OB_LIKELY(user_data < static_cast<uint64_t>(req_count))) {
+            reqs[user_data].res_ = res;
+            --wait_count;
+          } else {
+            PROXY_NET_LOG(ERROR, "unexpected io_uring completion", K(user_data), K(res), K(req_count));
+          }
+        }
+        if (OB_UNLIKELY(wait_count > 0) && OB_UNLIKELY(io_uring.get_to_submit() > 0)) {
+          // the sqes left in ring refer to our iov, can not be submitted in other loop
+          ret = OB_ERR_UNEXPECTED;
+          PROXY_NET_LOG(WARN, "io_uring requests are not fully submitted", K(wait_count), KPC(&io_uring), K(ret));
+        }
+      }
+    }
+  }
+
+  // 3. handle completions in submitted order
+  for (int64_t i = 0; i < req_count; ++i) {
+    ObNetIOUringRequest &req = reqs[i];
+    ObProxyMutex *vio_mutex = req.mutex_.ptr_;
+    if (is_read) {
+      req.vc_->finish_read_from_net(ethread, req);
+    } else {
+      req.vc_->finish_write_to_net(ethread, req);
+    }
+    mutex_unlock(vio_mutex, &ethread);
+    req.reset();
+  }
+
+  // 4. the vcs can not be batched
+  for (int64_t i = 0; i < fallback_count; ++i) {
+    vc = fallback_vcs[i];
+    if (0 == --vc->recursion_ && vc->closed_) {
+      if (OB_UNLIKELY(OB_SUCCESS != (close_ret = vc->close()))) {
+        PROXY_NET_LOG(WARN, "fail to close unix net vconnection", K(vc), K(close_ret));
+      }
+    } else if (vc->closed_) {
+      // do nothing
+    } else if (vc->using_ssl()) {
+      if (vc->read_.enabled_ || vc->write_.enabled_) {
+        vc->do_ssl_io(ethread);
+      }
+    } else if (is_read) {
+      if (vc->read_.enabled_ && vc->read_.triggered_) {
+        vc->read_from_net(ethread);
+      }
+    } else if (vc->write_.enabled_ && vc->write_.triggered_) {
+      vc->write_to_net(ethread);
+    }
+  }
+  return ret;
+}
+
 // The main event for ObNetHandler
 // This is called every NET_PERIOD, and handles all IO operations scheduled
 // for this period.
@@ -569,66 +826,18 @@ int ObNetHandler::main_net_event(int event, ObEvent *e)
     }
 
     if (OB_SUCC(ret)) {
-      int close_ret = OB_SUCCESS;
-#if defined(USE_EDGE_TRIGGER)
-      // ObUnixNetVConnection *
-      while (NULL != (vc = read_ready_list_.dequeue())) {
-        if (vc->closed_) {
-          if (OB_UNLIKELY(OB_SUCCESS != (close_ret = vc->close()))) {
-            PROXY_NET_LOG(WARN, "fail to close unix net vconnection", K(vc), K(close_ret));
-          }
-        } else if (vc->using_ssl() && (vc->read_.enabled_ || vc->write_.enabled_)) {
-          vc->do_ssl_io(*ethread);
-        } else if (vc->read_.enabled_ && vc->read_.triggered_ && !vc->using_ssl()) {
-          vc->read_from_net(*ethread);
-        } else if (!vc->read_.enabled_) {
-          read_ready_list_.remove(vc);
-        }
-      }
-
-      while (NULL != (vc = write_ready_list_.dequeue())) {
-        if (vc->closed_) {
-          if (OB_UNLIKELY(OB_SUCCESS != (close_ret = vc->close()))) {
-            PROXY_NET_LOG(WARN, "fail to close unix net vconnection", K(vc), K(close_ret));
-          }
-        } else if (vc->using_ssl() && (vc->read_.enabled_ || vc->write_.enabled_)) {
-          vc->do_ssl_io(*ethread);
-        } else if (vc->write_.enabled_ && vc->write_.triggered_ && !vc->using_ssl()) {
-          vc->write_to_net(*ethread);
-        } else if (!vc->write_.enabled_) {
-          write_ready_list_.remove(vc);
-        }
-      }
-
-#else // USE_EDGE_TRIGGER
-      while (NULL != (vc = read_ready_list_.dequeue())) {
-        if (vc->closed_) {
-          if (OB_UNLIKELY(OB_SUCCESS != (close_ret = vc->close()))) {
-            PROXY_NET_LOG(WARN, "fail to close unix net vconnection", K(vc), K(close_ret));
-          }
-        } else if (vc->using_ssl() || (vc->read_.enabled_ || vc->write_.enabled_)) {
-          vc->do_ssl_io(*ethread);
-        } else if (vc->read_.enabled_ && vc->read_.triggered_ && !vc->using_ssl()) {
-          vc->read_from_net(*ethread);
-        } else if (!vc->read_.enabled_) {
-          vc->ep_->modify(-EVENTIO_READ);
-        }
-      }
-
-      while (NULL != (vc = write_ready_list_.dequeue())) {
-        if (vc->closed_) {
-          if (OB_UNLIKELY(OB_SUCCESS != (close_ret = vc->close()))) {
-            PROXY_NET_LOG(WARN, "fail to close unix net vconnection", K(vc), K(close_ret));
-          }
-        } else if (vc->using_ssl() && (vc->read_.enabled_ || vc->write_.enabled_)) {
-          vc->do_ssl_io(*ethread);
-        } else if (vc->write_.enabled_ && vc->write_.triggered_ && !vc->using_ssl()) {
-          vc->write_to_net(*ethread);
-        } else if (!vc->write_.enabled_) {
-          vc->ep_->modify(-EVENTIO_WRITE);
+      ObNetPoll &net_poll = ethread->get_net_poll();
+      if (NULL != net_poll.get_io_uring()) {
+        int tmp_ret = OB_SUCCESS;
+        if (OB_UNLIKELY(OB_SUCCESS != (tmp_ret = process_ready_list_by_io_uring(*ethread, net_poll, true)))
+            || OB_UNLIKELY(OB_SUCCESS != (tmp_ret = process_ready_list_by_io_uring(*ethread, net_poll, false)))) {
+          // the vcs left in ready list will be handled by readv/writev in next loop
+          PROXY_NET_LOG(ERROR, "fail to process ready list by io_uring, disable it", K(tmp_ret));
+          net_poll.destroy_io_uring();
         }
+      } else {
+        process_ready_list(*ethread);
       }
-#endif // !USE_EDGE_TRIGGER
     }
   }
   return (OB_SUCCESS == ret) ? EVENT_CONT : EVENT_ERROR;
@@ -60,9 +60,20 @@ public:
   ~ObNetPoll();
   int init();
   ObPollDescriptor &get_poll_descriptor() { return *poll_descriptor_; }
+  // return NULL if io_uring is disabled or not supported
+  ObIOUring *get_io_uring() { return io_uring_; }
+  ObNetIOUringRequest *get_io_uring_reqs() { return io_uring_reqs_; }
+  void destroy_io_uring();
+
+private:
+  int init_io_uring();
 
 public:
+  static const int64_t IO_URING_ENTRIES = 256;
+
   ObPollDescriptor *poll_descriptor_;
+  ObIOUring *io_uring_;
+  ObNetIOUringRequest *io_uring_reqs_;
 
 private:
   ObNetHandler &nh_;
@@ -107,9 +118,22 @@ public:
 
   int start_net_event(int event, event::ObEvent *data);
 
+  // pipe of this net thread used by ObUnixNetVConnection to splice between sockets,
+  // created on first use
+  int get_splice_pipe(int &read_fd, int &write_fd);
+  void close_splice_pipe();
+  // buffer of this net thread used by ObUnixNetVConnection to coalesce small
+  // blocks into one ssl record
+  char *get_ssl_record_buf() { return ssl_record_buf_; }
+
+  // max plaintext of one tls record
+  static const int64_t SSL_RECORD_BUF_SIZE = 16 * 1024;
+
 private:
   int main_net_event(int event, event::ObEvent *data);
   void process_enabled_list();
+  void process_ready_list(event::ObEThread &ethread);
+  int process_ready_list_by_io_uring(event::ObEThread &ethread, ObNetPoll &net_poll, const bool is_read);
 
 public:
   event::ObEvent *trigger_event_;
@@ -124,6 +148,8 @@ public:
   int64_t keep_alive_lru_size_;
 
 private:
+  int splice_pipe_[2];
+  char ssl_record_buf_[SSL_RECORD_BUF_SIZE];
   DISALLOW_COPY_AND_ASSIGN(ObNetHandler);
 };
 
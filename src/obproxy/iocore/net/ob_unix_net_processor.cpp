@@ -74,6 +74,8 @@ void ObNetProcessor::ObAcceptOptions::reset()
   localhost_only_ = false;
   frequent_accept_ = true;
   backdoor_ = false;
+  reuse_port_ = false;
+  reuse_port_cpu_steering_ = false;
   defer_accept_timeout_ = 0;
   recv_bufsize_ = 0;
   send_bufsize_ = 0;
@@ -210,6 +212,8 @@ inline ObAction *ObUnixNetProcessor::accept_internal(ObContinuation &cont, int f
           }
         } // end na->do_listen(BLOCKING)
       } else { // true == opt.frequent_accept_ && 0 == accept_threads_
+        na->server_.reuse_port_ = opt.reuse_port_;
+        na->reuse_port_cpu_steering_ = opt.reuse_port_cpu_steering_;
         if(OB_FAIL(na->init_accept_per_thread())) {
           PROXY_NET_LOG(ERROR, "fail to init_accept_per_thread", K(ret));
         }
@@ -504,7 +504,8 @@ inline int ObUnixNetVConnection::close()
 }
 
 inline int ObUnixNetVConnection::read_from_net_internal(
-    ObMIOBuffer &iobuf, const int64_t toread, int64_t &total_read, int &tmp_code)
+    ObMIOBuffer &iobuf, const int64_t toread, int64_t &total_read, int &tmp_code,
+    ObIOBufferBlock *start_block)
 {
   int ret = OB_SUCCESS;
   ObProxyMutex *mutex_ = &self_ethread().get_mutex();
@@ -521,7 +522,7 @@ inline int ObUnixNetVConnection::read_from_net_internal(
 
   if (OB_UNLIKELY(toread <= 0)) {
     ret = OB_INVALID_ARGUMENT;
-  } else if (OB_ISNULL(block = iobuf.first_write_block())) {
+  } else if (OB_ISNULL(block = (NULL != start_block ? start_block : iobuf.first_write_block()))) {
     ret = OB_BUF_NOT_ENOUGH;
   } else if ((len = block->write_avail()) > 0) {
     do {
@@ -585,6 +586,115 @@ inline int ObUnixNetVConnection::read_from_net_internal(
   return ret;
 }
 
+bool ObUnixNetVConnection::can_splice_to_net() const
+{
+  bool bret = false;
+  if (NULL != splice_dst_ && splice_todo_ > 0 && !using_ssl_ && !splice_dst_->using_ssl()
+      && 0 == splice_dst_->closed_ && 0 == (splice_dst_->f_.shutdown_ & NET_VC_SHUTDOWN_WRITE)
+      && ObVIO::WRITE == splice_dst_->write_.vio_.op_
+      && splice_dst_->write_.vio_.mutex_.ptr_ == read_.vio_.mutex_.ptr_
+      && splice_dst_->write_.vio_.ntodo() > splice_todo_) {
+    const ObIOBufferReader *reader = splice_dst_->write_.vio_.buffer_.reader();
+    // all data before the spliced bytes must have been written to dst
+    bret = (NULL != reader && 0 == reader->reserved_size_ && !reader->is_read_avail_more_than(0));
+  }
+  return bret;
+}
+
+// Move data from our socket to the socket of splice_dst_ through the pipe of this net thread.
+// If dst can not take all the bytes in the pipe, the rest is read into iobuf as if it was
+// read from our socket, so the pipe is always empty when return.
+int ObUnixNetVConnection::splice_from_net(
+    ObEThread &thread, ObMIOBuffer &iobuf, const int64_t toread,
+    int64_t &total_spliced, int64_t &total_read)
+{
+  int ret = OB_SUCCESS;
+  ObProxyMutex *mutex_ = thread.mutex_;
+  int pipe_rfd = NO_FD;
+  int pipe_wfd = NO_FD;
+  int64_t space = 0;
+  int32_t niov = 0;
+  struct iovec tiovec[NET_MAX_IOV];
+  ObIOBufferBlock *block = iobuf.first_write_block();
+  const uint32_t flags = SPLICE_F_MOVE | SPLICE_F_NONBLOCK;
+
+  total_spliced = 0;
+  total_read = 0;
+  // bytes left in pipe are read into these blocks, so never splice more than they can hold
+  for (; NULL != block && niov < NET_MAX_IOV && space < toread; block = block->next_) {
+    int64_t len = std::min(block->write_avail(), toread - space);
+    if (len > 0) {
+      tiovec[niov].iov_base = block->end_;
+      tiovec[niov].iov_len = len;
+      space += len;
+      ++niov;
+    }
+  }
+
+  if (space <= 0) {
+    // no room for the bytes which may be left in pipe
+  } else if (OB_FAIL(nh_->get_splice_pipe(pipe_rfd, pipe_wfd))) {
+    PROXY_NET_LOG(WARN, "fail to get splice pipe", K(ret));
+  } else {
+    int64_t in_count = 0;
+    int64_t out_count = 0;
+    while (OB_SUCC(ret) && splice_todo_ > 0) {
+      in_count = 0;
+      out_count = 0;
+      if (OB_FAIL(ObSocketManager::splice(con_.fd_, pipe_wfd, std::min(splice_todo_, space),
+                                          flags, in_count)) || 0 == in_count) {
+        // EAGAIN or EOS, leave it to normal read
+        ret = OB_SUCCESS;
+        break;
+      } else {
+        int64_t count = 0;
+        while (out_count < in_count
+               && OB_SUCCESS == ObSocketManager::splice(pipe_rfd, splice_dst_->con_.fd_,
+                                                        in_count - out_count, flags, count)
+               && count > 0) {
+          out_count += count;
+        }
+        NET_INCREMENT_DYN_STAT(NET_CALLS_TO_READ);
+        total_spliced += out_count;
+        splice_todo_ -= in_count;
+        read_.vio_.ndone_ += out_count;
+        splice_dst_->write_.vio_.ndone_ += out_count;
+        splice_done_ += out_count;
+
+        if (out_count < in_count) {
+          // dst is full or broken, give the rest to read buffer, dst writes them later
+          int64_t left = in_count - out_count;
+          int64_t count = 0;
+          int32_t i = 0;
+          for (i = 0; i < niov && left > 0; ++i) {
+            if (static_cast<int64_t>(tiovec[i].iov_len) > left) {
+              tiovec[i].iov_len = left;
+            }
+            left -= tiovec[i].iov_len;
+          }
+          if (OB_FAIL(ObSocketManager::readv(pipe_rfd, tiovec, i, count))
+              || OB_UNLIKELY(count != in_count - out_count)) {
+            PROXY_NET_LOG(ERROR, "fail to drain splice pipe", K(in_count), K(out_count), K(count), K(ret));
+            ret = OB_ERR_UNEXPECTED;
+            nh_->close_splice_pipe();
+          } else {
+            total_read = count;
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  if (total_spliced > 0) {
+    NET_SUM_DYN_STAT(NET_READ_BYTES, total_spliced);
+    NET_SUM_DYN_STAT(NET_WRITE_BYTES, total_spliced);
+    splice_dst_->net_activity();
+    PROXY_NET_LOG(DEBUG, "splice to net", K(total_spliced), K(total_read), K_(splice_todo), K(this));
+  }
+  return ret;
+}
+
 // Read the data for a ObUnixNetVConnection.
 // Rescheduling the ObUnixNetVConnection by moving the VC
 // onto or off of the ready_list.
@@ -625,7 +735,14 @@ inline void ObUnixNetVConnection::read_from_net(ObEThread &thread)
     // read data
     if (toread > 0) {
       int tmp_code = 0;
-      if (OB_FAIL(read_from_net_internal(writer, toread, total_read, tmp_code)) || (0 == total_read)) {
+      int64_t total_spliced = 0;
+      if (can_splice_to_net()
+          && OB_FAIL(splice_from_net(thread, writer, toread, total_spliced, total_read))) {
+        is_done = handle_read_from_net_error(thread, 0, ret, tmp_code);
+      } else if (total_spliced > 0 || total_read > 0) {
+        ++read_.active_count_;
+        is_done = handle_read_from_net_success(thread, lock.get_mutex(), total_read);
+      } else if (OB_FAIL(read_from_net_internal(writer, toread, total_read, tmp_code)) || (0 == total_read)) {
         is_done = handle_read_from_net_error(thread, total_read, ret, tmp_code);
       } else {
         ++read_.active_count_;
@@ -633,6 +750,8 @@ inline void ObUnixNetVConnection::read_from_net(ObEThread &thread)
         if (ntodo < 0) {
           PROXY_NET_LOG(ERROR, "occur fatal error", K(ntodo), K(this));
         }
+        // bytes read into buffer can not be spliced any more
+        splice_todo_ = (splice_todo_ > total_read) ? (splice_todo_ - total_read) : 0;
         is_done = handle_read_from_net_success(thread, lock.get_mutex(), total_read);
       }
     } else {
@@ -652,7 +771,7 @@ inline void ObUnixNetVConnection::read_from_net(ObEThread &thread)
   }
 }
 
-inline int ObUnixNetVConnection::write_to_net_internal(ObIOBufferReader &reader,
+int ObUnixNetVConnection::write_to_net_internal(ObIOBufferReader &reader,
                        const int64_t towrite, int64_t &total_write, int &tmp_code)
 {
   int ret = OB_SUCCESS;
@@ -705,17 +824,34 @@ inline int ObUnixNetVConnection::write_to_net_internal(ObIOBufferReader &reader,
 
           block = block->next_;
 
-          //openssl not support iovec, just need one buffer
+          // openssl not support iovec, whole blocks are coalesced until one
+          // tls record is full, instead of sending one small record per block
           if (using_ssl_) {
             if (NULL != block) {
               len = block->read_avail();
             }
-            break;
+            if (NULL == block || len <= 0 || niov >= NET_MAX_IOV
+                || wattempted + total_write >= towrite
+                || wattempted + len > ObNetHandler::SSL_RECORD_BUF_SIZE) {
+              break;
+            }
           }
         } while (NULL != block && (0 < (len = block->read_avail())) && niov < NET_MAX_IOV);
 
         if (using_ssl_) {
-          if (OB_FAIL(ObSocketManager::ssl_write(ssl_, tiovec[0].iov_base, tiovec[0].iov_len, count, tmp_code))) {
+          const void *buf = tiovec[0].iov_base;
+          if (niov > 1) {
+            // the retry after SSL_ERROR_WANT_WRITE copies the same bytes again,
+            // the ssl ctx accepts a moving write buffer
+            char *record_buf = nh_->get_ssl_record_buf();
+            int64_t pos = 0;
+            for (int32_t i = 0; i < niov; ++i) {
+              MEMCPY(record_buf + pos, tiovec[i].iov_base, tiovec[i].iov_len);
+              pos += tiovec[i].iov_len;
+            }
+            buf = record_buf;
+          }
+          if (OB_FAIL(ObSocketManager::ssl_write(ssl_, buf, wattempted, count, tmp_code))) {
             PROXY_NET_LOG(WARN, "ssl write failed", K(ret));
           } else if (count > 0)  {
             total_write += count;
@@ -807,6 +943,254 @@ inline void ObUnixNetVConnection::write_to_net(ObEThread &thread)
   }
 }
 
+static inline bool io_uring_trylock(ObProxyMutex *mutex, ObEThread &thread)
+{
+#ifdef OB_HAS_EVENT_DEBUG
+  return mutex_trylock(MAKE_LOCATION(), NULL, mutex, &thread);
+#else
+  return mutex_trylock(mutex, &thread);
+#endif
+}
+
+ObNetIOUringPrepResult ObUnixNetVConnection::prep_read_from_net(ObEThread &thread, ObNetIOUringRequest &req)
+{
+  ObNetIOUringPrepResult result = IO_URING_PREP_DONE;
+  ObProxyMutex *mutex = read_.vio_.mutex_.ptr_;
+
+  if (OB_ISNULL(mutex) || mutex->thread_holding_ == &thread) {
+    // the vio mutex is shared with a vc already in this batch,
+    // callback of that vc may change our vio, so read it inline after batch
+    result = IO_URING_PREP_FALLBACK;
+  } else if (NULL != splice_dst_ && splice_todo_ > 0) {
+    // splice is done in read_from_net()
+    result = IO_URING_PREP_FALLBACK;
+  } else if (!io_uring_trylock(mutex, thread)) {
+    read_reschedule();
+  } else if (!check_read_state()) {
+    mutex_unlock(mutex, &thread);
+    PROXY_NET_LOG(DEBUG, "fail to check_read_state", K(this));
+  } else {
+    reenable_read_time_at_ = 0;
+    int64_t ntodo = read_.vio_.ntodo();
+    int64_t toread = 0;
+    int64_t len = 0;
+    ObMIOBuffer &writer = *(read_.vio_.buffer_.writer());
+    ObIOBufferBlock *block = writer.first_write_block();
+
+    if (0 == read_.active_count_ || (NULL != block && block->write_avail() > 0)) {
+      toread = writer.write_avail();
+    } else {
+      toread = writer.write_avail(ntodo);
+    }
+    if (toread > ntodo) {
+      toread = ntodo;
+    }
+
+    req.reset();
+    if (toread > 0 && NULL != (block = writer.first_write_block()) && (len = block->write_avail()) > 0) {
+      do {
+        if (len > toread - req.attempted_) {
+          len = toread - req.attempted_;
+        }
+        req.iov_[req.niov_].iov_base = block->end_;
+        req.iov_[req.niov_].iov_len = len;
+        req.attempted_ += len;
+        ++req.niov_;
+        block = block->next_;
+      } while (NULL != block && req.attempted_ < toread && (len = block->write_avail()) > 0
+               && req.niov_ < ObNetIOUringRequest::MAX_IOV);
+      req.toread_ = toread;
+      req.next_block_ = block;
+    }
+
+    if (req.niov_ > 0) {
+      req.vc_ = this;
+      req.mutex_ = mutex;
+      req.buffer_ = &writer;
+      req.res_ = -ECANCELED;
+      ++recursion_;
+      result = IO_URING_PREP_SUBMIT;
+    } else {
+      // writer.write_avail() <= 0
+      if (read_.vio_.ntodo() <= 0 || !read_.enabled_ || (read_.triggered_ && 0 == writer.write_avail())) {
+        read_disable();
+      } else {
+        read_reschedule();
+      }
+      mutex_unlock(mutex, &thread);
+    }
+  }
+  return result;
+}
+
+void ObUnixNetVConnection::finish_read_from_net(ObEThread &thread, ObNetIOUringRequest &req)
+{
+  ObProxyMutex *mutex_ = thread.mutex_;
+  NET_INCREMENT_DYN_STAT(NET_CALLS_TO_READFROMNET);
+  NET_INCREMENT_DYN_STAT(NET_CALLS_TO_READ);
+
+  int ret = OB_SUCCESS;
+  bool is_done = true;
+  if (0 == --recursion_ && closed_) {
+    // closed by the callback of other vc in this batch
+    if (OB_FAIL(close())) {
+      PROXY_NET_LOG(WARN, "fail to close unix net vconnection", K(this), K(ret));
+    }
+  } else if (closed_) {
+    // will be closed by the outer caller
+  } else if (-ECANCELED == req.res_) {
+    // not executed, keep triggered and try again in next loop
+    read_reschedule();
+  } else if (ObVIO::READ != read_.vio_.op_ || req.buffer_ != read_.vio_.buffer_.writer()) {
+    PROXY_NET_LOG(WARN, "read vio is changed during io uring read, close it",
+                  K(this), "res", req.res_, K(req.attempted_));
+    is_done = (EVENT_DONE == read_signal_error(OB_ERR_UNEXPECTED));
+  } else {
+    int64_t total_read = (req.res_ > 0 ? req.res_ : 0);
+    const int error = (req.res_ < 0 ? ob_get_sys_errno(-req.res_) : OB_SUCCESS);
+    if (req.res_ == req.attempted_ && total_read < req.toread_ && NULL != req.next_block_) {
+      // the iovs are filled up, read until EAGAIN or buffer full like read_from_net(),
+      // vio mutex is still held since prep, so the blocks are not changed
+      int tmp_code = 0;
+      ObMIOBuffer &writer = *(read_.vio_.buffer_.writer());
+      if (OB_FAIL(read_from_net_internal(writer, req.toread_, total_read, tmp_code, req.next_block_))) {
+        PROXY_NET_LOG(WARN, "fail to read remaining data after io uring read", K(this), K(total_read), K(ret));
+      }
+    }
+    if (0 == total_read) {
+      is_done = handle_read_from_net_error(thread, total_read, error, 0);
+    } else {
+      ++read_.active_count_;
+      is_done = handle_read_from_net_success(thread, req.mutex_.ptr_, total_read);
+    }
+
+    if (!is_done) {
+      ObMIOBuffer *writer = read_.vio_.buffer_.writer();
+      if (read_.vio_.ntodo() <= 0 || !read_.enabled_
+          || (read_.triggered_ && (NULL == writer || 0 == writer->write_avail()))) {
+        read_disable();
+      } else {
+        read_reschedule();
+      }
+    }
+  }
+}
+
+ObNetIOUringPrepResult ObUnixNetVConnection::prep_write_to_net(ObEThread &thread, ObNetIOUringRequest &req)
+{
+  ObNetIOUringPrepResult result = IO_URING_PREP_DONE;
+  ObProxyMutex *mutex = write_.vio_.mutex_.ptr_;
+
+  if (OB_ISNULL(mutex) || mutex->thread_holding_ == &thread) {
+    result = IO_URING_PREP_FALLBACK;
+  } else if (!io_uring_trylock(mutex, thread)) {
+    write_reschedule();
+  } else if (!check_write_state()) {
+    mutex_unlock(mutex, &thread);
+    PROXY_NET_LOG(DEBUG, "fail to check_write_state", K(this));
+  } else {
+    ObIOBufferReader &reader = *(write_.vio_.buffer_.reader());
+    int64_t towrite = reader.read_avail();
+    if (towrite > write_.vio_.ntodo()) {
+      towrite = write_.vio_.ntodo();
+    }
+
+    req.reset();
+    if (towrite > 0) {
+      // XXX because of reserved_size_ in ObIOBufferReader,
+      // we can't use skip_empty_blocks() to do this.
+      ObIOBufferBlock *block = reader.block_;
+      int64_t offset = reader.start_offset_;
+      int64_t len = -1;
+      while (NULL != block && len <= 0) {
+        len = block->read_avail();
+        len -= offset;
+        if (len <= 0) {
+          offset = -len;
+          block = block->next_;
+        }
+      }
+
+      if (len > 0) {
+        do {
+          if (len > towrite - req.attempted_) {
+            len = towrite - req.attempted_;
+          }
+          req.iov_[req.niov_].iov_base = block->start() + offset;
+          req.iov_[req.niov_].iov_len = len;
+          offset = 0;
+          req.attempted_ += len;
+          ++req.niov_;
+          block = block->next_;
+        } while (NULL != block && req.attempted_ < towrite && (len = block->read_avail()) > 0
+                 && req.niov_ < ObNetIOUringRequest::MAX_IOV);
+      }
+    }
+
+    if (req.niov_ > 0) {
+      req.vc_ = this;
+      req.mutex_ = mutex;
+      req.buffer_ = &reader;
+      req.res_ = -ECANCELED;
+      ++recursion_;
+      result = IO_URING_PREP_SUBMIT;
+    } else {
+      // nothing to write, write_to_net will signal WRITE_READY to fill the buffer
+      mutex_unlock(mutex, &thread);
+      result = IO_URING_PREP_FALLBACK;
+    }
+  }
+  return result;
+}
+
+void ObUnixNetVConnection::finish_write_to_net(ObEThread &thread, ObNetIOUringRequest &req)
+{
+  ObProxyMutex *mutex_ = thread.mutex_;
+  NET_INCREMENT_DYN_STAT(NET_CALLS_TO_WRITETONET);
+  NET_INCREMENT_DYN_STAT(NET_CALLS_TO_WRITE);
+
+  int ret = OB_SUCCESS;
+  bool is_done = true;
+  if (0 == --recursion_ && closed_) {
+    if (OB_FAIL(close())) {
+      PROXY_NET_LOG(WARN, "fail to close unix net vconnection", K(this), K(ret));
+    }
+  } else if (closed_) {
+    // will be closed by the outer caller
+  } else if (-ECANCELED == req.res_) {
+    write_reschedule();
+  } else if (ObVIO::WRITE != write_.vio_.op_ || req.buffer_ != write_.vio_.buffer_.reader()) {
+    PROXY_NET_LOG(WARN, "write vio is changed during io uring write, close it",
+                  K(this), "res", req.res_, K(req.attempted_));
+    is_done = (EVENT_DONE == write_signal_error(OB_ERR_UNEXPECTED));
+  } else {
+    ObIOBufferReader *old_reader = write_.vio_.buffer_.reader();
+    const int64_t total_write = (req.res_ > 0 ? req.res_ : 0);
+    const int error = (req.res_ < 0 ? ob_get_sys_errno(-req.res_) : OB_SUCCESS);
+    if (0 == total_write) {
+      is_done = handle_write_to_net_error(thread, total_write, error, 0);
+    } else {
+      is_done = handle_write_to_net_success(thread, req.mutex_.ptr_, total_write, false);
+    }
+
+    if (!is_done) {
+      int64_t read_avail = old_reader->read_avail();
+      if (0 == read_avail) {
+        // reader maybe modified on write_complete event
+        ObIOBufferReader *new_reader = write_.vio_.buffer_.reader();
+        if (NULL != new_reader && new_reader != old_reader) {
+          read_avail = new_reader->read_avail();
+        }
+      }
+      if (0 == read_avail) {
+        write_disable();
+      } else {
+        write_reschedule();
+      }
+    }
+  }
+}
+
 ObUnixNetVConnection::ObUnixNetVConnection()
     : closed_(0),
       active_timeout_in_(0),
@@ -818,6 +1202,9 @@ ObUnixNetVConnection::ObUnixNetVConnection()
       nh_(NULL),
       id_(0),
       flags_(0),
+      splice_dst_(NULL),
+      splice_todo_(0),
+      splice_done_(0),
       recursion_(0),
       submit_time_(0),
       source_type_(VC_ACCEPT),
@@ -827,6 +1214,11 @@ ObUnixNetVConnection::ObUnixNetVConnection()
       ssl_(NULL),
       can_shutdown_ssl_(true),
       io_type_(IO_NONE),
+      ssl_offload_state_(SSL_OFFLOAD_IDLE),
+      ssl_offload_action_(NULL),
+      ssl_offload_ret_(OB_SUCCESS),
+      ssl_offload_code_(0),
+      ssl_handshake_cont_(),
       is_inited_(false)
 {
   memset(&server_addr_, 0, sizeof(server_addr_));
@@ -981,6 +1373,9 @@ ObVIO *ObUnixNetVConnection::do_io_read(
     ObMIOBuffer *buf)
 {
   read_.active_count_ = 0;
+  splice_dst_ = NULL;
+  splice_todo_ = 0;
+  splice_done_ = 0;
   read_.vio_.op_ = ObVIO::READ;
   read_.vio_.mutex_ = (NULL != c) ? c->mutex_ : mutex_;
   read_.vio_.cont_ = c;
@@ -1319,7 +1714,12 @@ inline void ObUnixNetVConnection::free()
   got_virtual_addr_ = false;
   read_.vio_.mutex_.release();
   write_.vio_.mutex_.release();
+  ssl_handshake_cont_.mutex_.release();
+  ssl_handshake_cont_.vc_ = NULL;
   flags_ = 0;
+  splice_dst_ = NULL;
+  splice_todo_ = 0;
+  splice_done_ = 0;
   SET_CONTINUATION_HANDLER(this, (NetVConnHandler)&ObUnixNetVConnection::start_event);
   nh_ = NULL;
   read_.triggered_ = false;
@@ -1702,12 +2102,30 @@ int ObUnixNetVConnection::ssl_server_handshake(ObEThread &thread)
 {
   int ret = OB_SUCCESS;
   int tmp_code = 0;
+  bool is_offloaded = false;
   MUTEX_TRY_LOCK(lock, read_.vio_.mutex_, &thread);
 
   if (NULL == ssl_) {
     ret = OB_ERR_UNEXPECTED;
     PROXY_NET_LOG(WARN, "ssl server handshake event", K(ret));
-  } else if (OB_FAIL(ObSocketManager::ssl_accept(ssl_, ssl_connected_, tmp_code))) {
+  } else if (SSL_OFFLOAD_FAILED == ATOMIC_LOAD(&ssl_offload_state_)) {
+    // failed on ssl handshake thread, signal the error here
+    ret = ssl_offload_ret_;
+    tmp_code = ssl_offload_code_;
+    ATOMIC_STORE(&ssl_offload_state_, SSL_OFFLOAD_IDLE);
+  } else if (g_ssl_processor.is_handshake_offload_enabled()) {
+    if (OB_FAIL(offload_ssl_server_handshake(lock.is_locked()))) {
+      PROXY_NET_LOG(WARN, "fail to offload ssl server handshake", K(ret));
+    } else {
+      is_offloaded = true;
+    }
+  } else {
+    ret = ObSocketManager::ssl_accept(ssl_, ssl_connected_, tmp_code);
+  }
+
+  if (NULL == ssl_ || is_offloaded) {
+    // nothing to handle
+  } else if (OB_FAIL(ret)) {
     handle_ssl_err_code(tmp_code);
     read_.triggered_ = false;
     write_.triggered_ = false;
@@ -1716,6 +2134,7 @@ int ObUnixNetVConnection::ssl_server_handshake(ObEThread &thread)
     PROXY_NET_LOG(WARN, "ssl accepte failed", K(ret), K(tmp_code));
     read_signal_done(VC_EVENT_EOS);
   } else if (ssl_connected_) {
+    inc_ssl_server_handshake_stat(thread);
     reenable(&read_.vio_);
   } else if (SSL_ERROR_WANT_READ == tmp_code || SSL_ERROR_WANT_WRITE == tmp_code) {
     read_.triggered_ = false;
@@ -1727,6 +2146,96 @@ int ObUnixNetVConnection::ssl_server_handshake(ObEThread &thread)
   return ret;
 }
 
+// Called on net thread when the socket of a client connection in handshake gets
+// ready, SSL_accept is left to ET_SSL_HANDSHAKE threads. The vc stays in the epoll
+// of its net thread, the handshake thread hands it back by reenable() once the
+// handshake is done. If the socket gets ready again while SSL_accept is running,
+// the state tells the handshake thread to run it once more, so the edge of epoll
+// is never lost.
+int ObUnixNetVConnection::offload_ssl_server_handshake(const bool is_locked)
+{
+  int ret = OB_SUCCESS;
+  bool is_done = false;
+
+  nh_->read_ready_list_.remove(this);
+  nh_->write_ready_list_.remove(this);
+  while (!is_done) {
+    const int64_t state = ATOMIC_LOAD(&ssl_offload_state_);
+    if (SSL_OFFLOAD_RUNNING == state) {
+      is_done = ATOMIC_BCAS(&ssl_offload_state_, SSL_OFFLOAD_RUNNING, SSL_OFFLOAD_RUNNING_IO_PENDING);
+    } else if (SSL_OFFLOAD_IDLE != state) {
+      // io pending is marked already, or the failure is handed back to us
+      is_done = true;
+    } else if (!is_locked) {
+      // handshake thread is releasing the vio mutex, retry in next net loop
+      nh_->read_ready_list_.in_or_enqueue(this);
+      is_done = true;
+    } else {
+      ATOMIC_STORE(&ssl_offload_state_, SSL_OFFLOAD_RUNNING);
+      ssl_handshake_cont_.vc_ = this;
+      ssl_handshake_cont_.mutex_ = read_.vio_.mutex_;
+      if (OB_ISNULL(ssl_offload_action_ = g_event_processor.schedule_imm(&ssl_handshake_cont_, ET_SSL_HANDSHAKE))) {
+        ret = OB_ERR_UNEXPECTED;
+        ATOMIC_STORE(&ssl_offload_state_, SSL_OFFLOAD_IDLE);
+        PROXY_NET_LOG(WARN, "fail to schedule ssl handshake", K(ret));
+      }
+      is_done = true;
+    }
+  }
+  return ret;
+}
+
+void ObUnixNetVConnection::handle_ssl_offload_handshake(ObEThread &thread)
+{
+  int ret = OB_SUCCESS;
+  int tmp_code = 0;
+  bool is_done = false;
+  bool need_hand_back = false;
+
+  ssl_offload_action_ = NULL;
+  if (OB_ISNULL(ssl_)) {
+    is_done = true;
+    ATOMIC_STORE(&ssl_offload_state_, SSL_OFFLOAD_IDLE);
+    PROXY_NET_LOG(WARN, "ssl is null, handshake is cancelled", K(this));
+  }
+  while (!is_done) {
+    if (OB_FAIL(ObSocketManager::ssl_accept(ssl_, ssl_connected_, tmp_code))) {
+      ssl_offload_ret_ = ret;
+      ssl_offload_code_ = tmp_code;
+      ATOMIC_STORE(&ssl_offload_state_, SSL_OFFLOAD_FAILED);
+      need_hand_back = true;
+      is_done = true;
+    } else if (ssl_connected_) {
+      inc_ssl_server_handshake_stat(thread);
+      ATOMIC_STORE(&ssl_offload_state_, SSL_OFFLOAD_IDLE);
+      need_hand_back = true;
+      is_done = true;
+    } else if (ATOMIC_BCAS(&ssl_offload_state_, SSL_OFFLOAD_RUNNING, SSL_OFFLOAD_IDLE)) {
+      // wait for the next epoll event on net thread
+      is_done = true;
+    } else {
+      // socket got ready while SSL_accept was running
+      ATOMIC_STORE(&ssl_offload_state_, SSL_OFFLOAD_RUNNING);
+    }
+  }
+
+  if (need_hand_back) {
+    // ssl may have buffered the data following the handshake, so net thread must
+    // read without waiting for epoll
+    read_.triggered_ = true;
+    reenable(&read_.vio_);
+  }
+}
+
+inline void ObUnixNetVConnection::inc_ssl_server_handshake_stat(ObEThread &thread)
+{
+  if (SSL_session_reused(ssl_)) {
+    NET_ATOMIC_INCREMENT_DYN_STAT(&thread, SSL_RESUMED_HANDSHAKES);
+  } else {
+    NET_ATOMIC_INCREMENT_DYN_STAT(&thread, SSL_FULL_HANDSHAKES);
+  }
+}
+
 int ObUnixNetVConnection::ssl_client_handshake(ObEThread &thread)
 {
   int ret = OB_SUCCESS;
@@ -1805,6 +2314,14 @@ void ObUnixNetVConnection::handle_ssl_err_code(const int err_code)
 
 void ObUnixNetVConnection::close_ssl()
 {
+  if (NULL != ssl_offload_action_) {
+    // vio mutex is held, so the handshake is not running on handshake thread
+    if (OB_SUCCESS != ssl_offload_action_->cancel(&ssl_handshake_cont_)) {
+      PROXY_NET_LOG(WARN, "fail to cancel ssl handshake", K(this));
+    }
+    ssl_offload_action_ = NULL;
+  }
+  ATOMIC_STORE(&ssl_offload_state_, SSL_OFFLOAD_IDLE);
   using_ssl_ = false;
   ssl_connected_ = false;
   ssl_type_ = SSL_NONE;
@@ -1817,6 +2334,16 @@ void ObUnixNetVConnection::close_ssl()
   read_.enabled_ = false;
 }
 
+int ObSSLHandshakeCont::handle_handshake(int event, void *data)
+{
+  UNUSED(event);
+  UNUSED(data);
+  if (OB_LIKELY(NULL != vc_)) {
+    vc_->handle_ssl_offload_handshake(self_ethread());
+  }
+  return EVENT_DONE;
+}
+
 } // end of namespace net
 } // end of namespace obproxy
 } // end of namespace oceanbase
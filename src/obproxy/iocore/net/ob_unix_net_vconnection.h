@@ -36,6 +36,7 @@
 #include "iocore/net/ob_net_vconnection.h"
 #include "iocore/net/ob_net_state.h"
 #include "iocore/net/ob_connection.h"
+#include "iocore/net/ob_io_uring.h"
 
 namespace oceanbase
 {
@@ -46,6 +47,25 @@ namespace net
 
 class ObNetHandler;
 struct ObEventIO;
+class ObUnixNetVConnection;
+
+// Runs the ssl handshake of a client connection on ET_SSL_HANDSHAKE threads,
+// the vio mutex of the connection is its mutex
+class ObSSLHandshakeCont : public event::ObContinuation
+{
+public:
+  ObSSLHandshakeCont() : event::ObContinuation(NULL), vc_(NULL)
+  {
+    SET_HANDLER(&ObSSLHandshakeCont::handle_handshake);
+  }
+  virtual ~ObSSLHandshakeCont() {}
+  int handle_handshake(int event, void *data);
+
+  ObUnixNetVConnection *vc_;
+
+private:
+  DISALLOW_COPY_AND_ASSIGN(ObSSLHandshakeCont);
+};
 
 class ObUnixNetVConnection : public ObNetVConnection
 {
@@ -129,6 +149,22 @@ public:
   void write_to_net(event::ObEThread &thread);
   void read_from_net(event::ObEThread &thread);
 
+  // used by net handler to batch readv/writev of one net loop into io_uring,
+  // the vio mutex and recursion_ are held from prep to finish
+  ObNetIOUringPrepResult prep_read_from_net(event::ObEThread &thread, ObNetIOUringRequest &req);
+  void finish_read_from_net(event::ObEThread &thread, ObNetIOUringRequest &req);
+  ObNetIOUringPrepResult prep_write_to_net(event::ObEThread &thread, ObNetIOUringRequest &req);
+  void finish_write_to_net(event::ObEThread &thread, ObNetIOUringRequest &req);
+
+  // The next len bytes read from this vc may be moved to the socket of dst with splice(),
+  // without passing through the read buffer. It is only done when everything dst is asked
+  // to write has been written, so the byte order on dst is kept. Bytes moved are added to
+  // ndone of both our read vio and dst's write vio.
+  // dst must share the vio mutex with us, len 0 turns it off.
+  void set_splice_target(ObUnixNetVConnection *dst, const int64_t len);
+  // bytes moved to splice target since last call
+  int64_t consume_spliced_bytes();
+
 private:
   int start_event(int event, event::ObEvent *e);
 
@@ -156,7 +192,11 @@ private:
   bool handle_write_to_net_success(event::ObEThread &thread, const event::ObProxyMutex *mutex,
                                    const int64_t total_write, const bool signalled);
 
-  int read_from_net_internal(event::ObMIOBuffer &iobuf, const int64_t toread, int64_t &total_read, int &tmp_code);
+  int read_from_net_internal(event::ObMIOBuffer &iobuf, const int64_t toread, int64_t &total_read, int &tmp_code,
+                             event::ObIOBufferBlock *start_block = NULL);
+  bool can_splice_to_net() const;
+  int splice_from_net(event::ObEThread &thread, event::ObMIOBuffer &iobuf, const int64_t toread,
+                      int64_t &total_spliced, int64_t &total_read);
   int write_to_net_internal(event::ObIOBufferReader &reader, const int64_t towrite, int64_t &total_write, int &tmp_code);
 
 public:
@@ -213,6 +253,9 @@ public:
   };
 
   ObConnection con_;
+  ObUnixNetVConnection *splice_dst_;
+  int64_t splice_todo_;
+  int64_t splice_done_;
   int32_t recursion_;
   ObHRTime submit_time_;
   ObVCSourceType source_type_;
@@ -233,15 +276,30 @@ public:
     IO_WRITE,
   };
 
+  // state of the server handshake run by ET_SSL_HANDSHAKE threads
+  enum SSLOffloadState
+  {
+    SSL_OFFLOAD_IDLE = 0,
+    SSL_OFFLOAD_RUNNING,
+    // socket got ready while SSL_accept was running, it needs to run again
+    SSL_OFFLOAD_RUNNING_IO_PENDING,
+    // handshake failed, the error is signalled on net thread
+    SSL_OFFLOAD_FAILED,
+  };
+
   int ssl_init(const SSLType ssL_type);
   inline bool using_ssl() const { return using_ssl_; }
   inline bool ssl_connected() const { return ssl_connected_; }
   void do_ssl_io(event::ObEThread &thread);
   void close_ssl();
+  // called by ObSSLHandshakeCont on ET_SSL_HANDSHAKE thread with vio mutex held
+  void handle_ssl_offload_handshake(event::ObEThread &thread);
 
 private:
   int ssl_start_handshake(event::ObEThread &thread);
   int ssl_server_handshake(event::ObEThread &thread);
+  int offload_ssl_server_handshake(const bool is_locked);
+  void inc_ssl_server_handshake_stat(event::ObEThread &thread);
   int ssl_client_handshake(event::ObEThread &thread);
   void handle_ssl_err_code(const int err_code);
   void handle_ssl_want_read();
@@ -254,6 +312,12 @@ private:
   bool can_shutdown_ssl_;
   IOType io_type_;
 
+  volatile int64_t ssl_offload_state_;
+  event::ObEvent *ssl_offload_action_;
+  int ssl_offload_ret_;
+  int ssl_offload_code_;
+  ObSSLHandshakeCont ssl_handshake_cont_;
+
 private:
   bool is_inited_;
   DISALLOW_COPY_AND_ASSIGN(ObUnixNetVConnection);
@@ -318,6 +382,24 @@ inline bool ObUnixNetVConnection::set_remote_addr()
 
 }
 
+inline void ObUnixNetVConnection::set_splice_target(ObUnixNetVConnection *dst, const int64_t len)
+{
+  if (NULL == dst || len <= 0) {
+    splice_dst_ = NULL;
+    splice_todo_ = 0;
+  } else {
+    splice_dst_ = dst;
+    splice_todo_ = len;
+  }
+}
+
+inline int64_t ObUnixNetVConnection::consume_spliced_bytes()
+{
+  int64_t ret = splice_done_;
+  splice_done_ = 0;
+  return ret;
+}
+
 inline int ObUnixNetVConnection::get_socket()
 {
   return con_.fd_;
@@ -47,6 +47,7 @@
 #include "proxy/route/ob_sql_table_cache.h"
 #include "proxy/route/ob_cache_cleaner.h"
 #include "proxy/route/ob_route_utils.h"
+#include "proxy/mysql/ob_prepare_statement_struct.h"
 #include "proxy/mysqllib/ob_proxy_auth_parser.h"
 
 #include "cmd/ob_show_net_handler.h"
@@ -198,6 +199,7 @@ int ObProxy::init(ObProxyOptions &opts, ObAppVersionInfo &proxy_version)
         net_options.poll_timeout_ = usec_to_msec(config_->net_config_poll_timeout);
         net_options.default_inactivity_timeout_ = usec_to_sec(config_->default_inactivity_timeout);
         net_options.max_client_connections_ = config_->client_max_connections;
+        net_options.enable_io_uring_ = config_->enable_io_uring;
 
         if (OB_FAIL(init_net(NET_SYSTEM_MODULE_VERSION, net_options))) {
           LOG_WARN("fail to init net", K(NET_SYSTEM_MODULE_VERSION), K(ret));
@@ -240,6 +242,8 @@ void ObProxy::destroy()
     if (OB_FAIL(ObAsyncCommonTask::destroy_repeat_task(mmp_init_cont_))) {
       LOG_WARN("fail to destroy meta proxy init task", K(ret));
     }
+    // entries still used by client sessions are kept by their own refs
+    get_global_ps_entry_cache().destroy();
 
     proxy_opts_ = NULL;
     mysql_config_params_ = NULL;
@@ -877,6 +881,7 @@ int ObProxy::do_reload_config(obutils::ObProxyConfig &config)
     net_options.poll_timeout_ = usec_to_msec(config_->net_config_poll_timeout);
     net_options.default_inactivity_timeout_ = usec_to_sec(config.default_inactivity_timeout);
     net_options.max_client_connections_ = config.client_max_connections;
+    net_options.enable_io_uring_ = config.enable_io_uring;
     update_net_options(net_options);
     ObMysqlConfigProcessor &mysql_config_processor = get_global_mysql_config_processor();
     if (OB_FAIL(mysql_config_processor.reconfigure(*config_))) {
@@ -18,6 +18,7 @@
 #include "iocore/eventsystem/ob_buf_allocator.h"
 #include "iocore/eventsystem/ob_event_system.h"
 #include "lib/lock/ob_drw_lock.h"
+#include "lib/allocator/ob_qsync.h"
 
 namespace oceanbase
 {
@@ -49,11 +50,24 @@ struct ObHashTableEntry
   Key key_;
   Value data_;
   ObHashTableEntry *next_;
+  // link of the retired list, next_ must stay intact for lockless readers
+  ObHashTableEntry *retired_next_;
 
 private:
   DISALLOW_COPY_AND_ASSIGN(ObHashTableEntry);
 };
 
+template <class Key, class Value>
+struct ObHashTableRetiredBuckets
+{
+  ObHashTableRetiredBuckets() : buckets_(NULL), bucket_num_(0), next_(NULL) { }
+  ~ObHashTableRetiredBuckets() { }
+
+  ObHashTableEntry<Key, Value> **buckets_;
+  int64_t bucket_num_;
+  ObHashTableRetiredBuckets *next_;
+};
+
 template <class Key, class Value>
 class ObHashTableIteratorState
 {
@@ -65,6 +79,13 @@ public:
   ObHashTableEntry<Key, Value> **ppcur_;
 };
 
+// If qsync is set, lookup_entry_lockless() can run without any lock while writers
+// (still serialized by the partition lock) modify the table. Writers publish links
+// with release stores and readers follow them with acquire loads. Unlinked nodes
+// (holding a ref of their value) and old bucket arrays are only retired under the
+// lock, reclaim() frees them after WaitQuiescent and must be called after the lock
+// is released, so that writers never spin on readers while holding it. A reader
+// racing with a writer may miss an entry, it should fall back to the locked lookup then.
 template <class Key, class Value>
 class ObIMTHashTable
 {
@@ -73,13 +94,17 @@ public:
   typedef ObHashTableEntry<Key, Value> HashTableEntry;
 
   ObIMTHashTable(bool (*a_gc_func)(Value) = NULL,
-                 void (*a_pre_gc_func)(void) = NULL)
+                 void (*a_pre_gc_func)(void) = NULL,
+                 common::ObQSync *qsync = NULL)
   {
     gc_func = a_gc_func;
     pre_gc_func = a_pre_gc_func;
+    qsync_ = qsync;
     buckets_ = NULL;
     cur_size_ = 0;
     bucket_num_ = 0;
+    retired_entries_ = NULL;
+    retired_buckets_ = NULL;
   }
 
   ~ObIMTHashTable() { destroy(); }
@@ -139,17 +164,37 @@ public:
       op_fixed_mem_free(buckets_, bucket_num_ * sizeof(HashTableEntry *));
       buckets_ = NULL;
     }
+    // no reader left when the table is destroyed
+    free_retired(ATOMIC_TAS(&retired_entries_, NULL), ATOMIC_TAS(&retired_buckets_, NULL));
   }
 
   Value insert_entry(const uint64_t hash, const Key &key, Value data);
   Value remove_entry(const uint64_t hash, const Key &key);
   Value lookup_entry(const uint64_t hash, const Key &key);
+  // must be called in CriticalGuard of qsync_
+  Value lookup_entry_lockless(const uint64_t hash, const Key &key) const;
 
   Value first_entry(const int64_t bucket_id, IteratorState &s);
   static Value next_entry(IteratorState &s);
   static Value cur_entry(IteratorState &s);
   Value remove_entry(IteratorState &s);
 
+  bool has_retired() const
+  {
+    return NULL != ATOMIC_LOAD(&retired_entries_) || NULL != ATOMIC_LOAD(&retired_buckets_);
+  }
+
+  // wait once for all nodes retired so far, must not be called with the partition lock held
+  void reclaim()
+  {
+    if (NULL != qsync_ && has_retired()) {
+      HashTableEntry *entries = ATOMIC_TAS(&retired_entries_, NULL);
+      RetiredBuckets *buckets = ATOMIC_TAS(&retired_buckets_, NULL);
+      WaitQuiescent(*qsync_);
+      free_retired(entries, buckets);
+    }
+  }
+
   void gc(void)
   {
     if (NULL != gc_func) {
@@ -158,25 +203,31 @@ public:
       }
 
       HashTableEntry *cur = NULL;
-      HashTableEntry *prev = NULL;
+      HashTableEntry **pcur = NULL;
       HashTableEntry *next = NULL;
       for (int64_t i = 0; i < bucket_num_; ++i) {
-        cur = buckets_[i];
-        prev = NULL;
+        pcur = &buckets_[i];
+        cur = *pcur;
         next = NULL;
         while (NULL != cur) {
           next = cur->next_;
+          if (NULL != qsync_) {
+            // gc_func releases the table's ref, hold another one until readers quiesce
+            cur->data_->inc_ref();
+          }
           if (gc_func(cur->data_)) {
-            if (NULL != prev) {
-              prev->next_ = next;
+            __atomic_store_n(pcur, next, __ATOMIC_RELEASE);
+            --cur_size_;
+            if (NULL != qsync_) {
+              retire_entry(cur);
             } else {
-              buckets_[i] = next;
+              HashTableEntry::free(cur);
             }
-
-            HashTableEntry::free(cur);
-            --cur_size_;
           } else {
-            prev = cur;
+            if (NULL != qsync_) {
+              cur->data_->dec_ref();
+            }
+            pcur = &cur->next_;
           }
 
           cur = next;
@@ -206,31 +257,93 @@ public:
         while (NULL != cur) {
           next = cur->next_;
           new_id = bucket_id(cur->hash_, new_bucket_num);
-          cur->next_ = new_buckets[new_id];
+          // readers in the old array may be following this link
+          __atomic_store_n(&cur->next_, new_buckets[new_id], __ATOMIC_RELEASE);
           new_buckets[new_id] = cur;
           cur = next;
         }
 
-        buckets_[i] = NULL;
+        if (NULL == qsync_) {
+          buckets_[i] = NULL;
+        }
       }
 
-      op_fixed_mem_free(buckets_, bucket_num_ * sizeof(HashTableEntry *));
-      buckets_ = new_buckets;
-      bucket_num_ = new_bucket_num;
+      HashTableEntry **old_buckets = buckets_;
+      const int64_t old_bucket_num = bucket_num_;
+      // bigger array first, lockless readers load bucket_num_ before buckets_
+      __atomic_store_n(&buckets_, new_buckets, __ATOMIC_RELEASE);
+      __atomic_store_n(&bucket_num_, new_bucket_num, __ATOMIC_RELEASE);
+      if (NULL != qsync_) {
+        retire_buckets(old_buckets, old_bucket_num);
+      } else {
+        op_fixed_mem_free(old_buckets, old_bucket_num * sizeof(HashTableEntry *));
+      }
     }
     return ret;
   }
 
 private:
+  typedef ObHashTableRetiredBuckets<Key, Value> RetiredBuckets;
+
   ObIMTHashTable();
 
+  // entry has been unlinked under the partition lock and holds a ref of its value,
+  // pushed with CAS as reclaim() may take the list at the same time
+  void retire_entry(HashTableEntry *entry)
+  {
+    HashTableEntry *head = NULL;
+    do {
+      head = ATOMIC_LOAD(&retired_entries_);
+      entry->retired_next_ = head;
+    } while (!ATOMIC_BCAS(&retired_entries_, head, entry));
+  }
+
+  void retire_buckets(HashTableEntry **buckets, const int64_t bucket_num)
+  {
+    RetiredBuckets *retired = op_alloc(RetiredBuckets);
+    if (OB_LIKELY(NULL != retired)) {
+      RetiredBuckets *head = NULL;
+      retired->buckets_ = buckets;
+      retired->bucket_num_ = bucket_num;
+      do {
+        head = ATOMIC_LOAD(&retired_buckets_);
+        retired->next_ = head;
+      } while (!ATOMIC_BCAS(&retired_buckets_, head, retired));
+    } else {
+      PROXY_LOG(WARN, "fail to alloc retired buckets, wait readers in place");
+      WaitQuiescent(*qsync_);
+      op_fixed_mem_free(buckets, bucket_num * sizeof(HashTableEntry *));
+    }
+  }
+
+  static void free_retired(HashTableEntry *entries, RetiredBuckets *buckets)
+  {
+    HashTableEntry *entry = NULL;
+    RetiredBuckets *retired = NULL;
+    while (NULL != entries) {
+      entry = entries;
+      entries = entry->retired_next_;
+      entry->data_->dec_ref();
+      HashTableEntry::free(entry);
+    }
+    while (NULL != buckets) {
+      retired = buckets;
+      buckets = retired->next_;
+      op_fixed_mem_free(retired->buckets_, retired->bucket_num_ * sizeof(HashTableEntry *));
+      op_free(retired);
+    }
+  }
+
   bool (*gc_func)(Value);
   void (*pre_gc_func)(void);
+  common::ObQSync *qsync_;
 
 private:
   HashTableEntry **buckets_;
   int64_t cur_size_;
   int64_t bucket_num_;
+  HashTableEntry *retired_entries_;
+  RetiredBuckets *retired_buckets_;
   DISALLOW_COPY_AND_ASSIGN(ObIMTHashTable);
 };
 
@@ -239,15 +352,35 @@ inline Value ObIMTHashTable<Key, Value>::insert_entry(const uint64_t hash, const
 {
   Value ret = static_cast<Value>(0);
   int64_t id = bucket_id(hash);
-  HashTableEntry *cur = buckets_[id];
+  HashTableEntry **pcur = &buckets_[id];
+  HashTableEntry *cur = *pcur;
 
   while (NULL != cur && (hash != cur->hash_ || cur->key_ != key)) {
-    cur = cur->next_;
+    pcur = &cur->next_;
+    cur = *pcur;
   }
 
   if (NULL != cur) {
     if (data == cur->data_) {
       // return NULL;
+    } else if (NULL != qsync_) {
+      // lockless readers may be comparing cur->key_, replace the whole node
+      HashTableEntry *new_entry = HashTableEntry::alloc();
+      if (OB_LIKELY(NULL != new_entry)) {
+        new_entry->hash_ = hash;
+        new_entry->key_ = key;
+        new_entry->data_ = data;
+        new_entry->next_ = cur->next_;
+        __atomic_store_n(pcur, new_entry, __ATOMIC_RELEASE);
+        ret = cur->data_;
+        // the caller may release ret once we return
+        ret->inc_ref();
+        retire_entry(cur);
+      } else {
+        // keep the old one, let the caller release the new data
+        PROXY_LOG(WARN, "fail to alloc hash table entry, new data is not inserted");
+        ret = data;
+      }
     } else {
       ret = cur->data_;
       cur->data_ = data;
@@ -261,7 +394,7 @@ inline Value ObIMTHashTable<Key, Value>::insert_entry(const uint64_t hash, const
       new_entry->key_ = key;
       new_entry->data_ = data;
       new_entry->next_ = buckets_[id];
-      buckets_[id] = new_entry;
+      __atomic_store_n(&buckets_[id], new_entry, __ATOMIC_RELEASE);
       ++cur_size_;
       if (cur_size_ / bucket_num_ > MT_HASHTABLE_MAX_CHAIN_AVG_LEN) {
         gc();
@@ -282,23 +415,24 @@ inline Value ObIMTHashTable<Key, Value>::remove_entry(const uint64_t hash, const
 {
   int64_t id = bucket_id(hash);
   Value ret = static_cast<Value>(0);
-  HashTableEntry *cur = buckets_[id];
-  HashTableEntry *prev = NULL;
+  HashTableEntry **pcur = &buckets_[id];
+  HashTableEntry *cur = *pcur;
 
   while (NULL != cur && (hash != cur->hash_ || cur->key_ != key)) {
-    prev = cur;
-    cur = cur->next_;
+    pcur = &cur->next_;
+    cur = *pcur;
   }
 
   if (NULL != cur) {
-    if (NULL != prev) {
-      prev->next_ = cur->next_;
+    __atomic_store_n(pcur, cur->next_, __ATOMIC_RELEASE);
+    ret = cur->data_;
+    if (NULL != qsync_) {
+      // the caller may release ret once we return
+      ret->inc_ref();
+      retire_entry(cur);
     } else {
-      buckets_[id] = cur->next_;
+      HashTableEntry::free(cur);
     }
-
-    ret = cur->data_;
-    HashTableEntry::free(cur);
     cur = NULL;
     --cur_size_;
   }
@@ -324,6 +458,28 @@ inline Value ObIMTHashTable<Key, Value>::lookup_entry(const uint64_t hash, const
   return ret;
 }
 
+template <class Key, class Value>
+inline Value ObIMTHashTable<Key, Value>::lookup_entry_lockless(const uint64_t hash, const Key &key) const
+{
+  Value ret = static_cast<Value>(0);
+  const int64_t bucket_num = __atomic_load_n(&bucket_num_, __ATOMIC_ACQUIRE);
+  HashTableEntry **buckets = __atomic_load_n(&buckets_, __ATOMIC_ACQUIRE);
+  HashTableEntry *cur = NULL;
+
+  if (OB_LIKELY(NULL != buckets && bucket_num > 0)) {
+    cur = __atomic_load_n(&buckets[bucket_id(hash, bucket_num)], __ATOMIC_ACQUIRE);
+    while (NULL != cur && (hash != cur->hash_ || cur->key_ != key)) {
+      cur = __atomic_load_n(&cur->next_, __ATOMIC_ACQUIRE);
+    }
+  }
+
+  if (NULL != cur) {
+    ret = cur->data_;
+  }
+
+  return ret;
+}
+
 template <class Key, class Value>
 inline Value ObIMTHashTable<Key, Value>::first_entry(const int64_t bucket_id, IteratorState &s)
 {
@@ -368,8 +524,13 @@ inline Value ObIMTHashTable<Key, Value>::remove_entry(IteratorState &s)
   HashTableEntry *entry = *(s.ppcur_);
   if (NULL != entry) {
     ret = entry->data_;
-    *(s.ppcur_) = entry->next_;
-    HashTableEntry::free(entry);
+    __atomic_store_n(s.ppcur_, entry->next_, __ATOMIC_RELEASE);
+    if (NULL != qsync_) {
+      ret->inc_ref();
+      retire_entry(entry);
+    } else {
+      HashTableEntry::free(entry);
+    }
     entry = NULL;
     --cur_size_;
   }
@@ -406,8 +567,11 @@ public:
     }
   }
 
+  // if enable_lockless_lookup, Value must be ref counted (inc_ref/dec_ref),
+  // see ObIMTHashTable for the reclamation rules
   int init(const int64_t size, const event::ObLockStats lock_stats = event::COMMON_LOCK,
-           bool (*gc_func)(Value) = NULL, void (*pre_gc_func)(void) = NULL)
+           bool (*gc_func)(Value) = NULL, void (*pre_gc_func)(void) = NULL,
+           const bool enable_lockless_lookup = false)
   {
     int ret = common::OB_SUCCESS;
     if (OB_UNLIKELY(is_inited_)) {
@@ -418,7 +582,8 @@ public:
         if (OB_ISNULL(locks_[i] = event::new_proxy_mutex(lock_stats))) {
           ret = common::OB_ALLOCATE_MEMORY_FAILED;
           PROXY_LOG(ERROR, "fail to alloc mem for proxymutex", K(ret));
-        } else if (OB_ISNULL(hash_tables_[i] = op_alloc_args(IMTHashTable, gc_func, pre_gc_func))) {
+        } else if (OB_ISNULL(hash_tables_[i] = op_alloc_args(IMTHashTable, gc_func, pre_gc_func,
+                                                          enable_lockless_lookup ? &qsync_ : NULL))) {
           ret = common::OB_ALLOCATE_MEMORY_FAILED;
           PROXY_LOG(ERROR, "fail to alloc mem for hash table", K(ret));
         } else if (OB_FAIL(hash_tables_[i]->init(size))) {
@@ -493,6 +658,21 @@ public:
     return hash_tables_[part_num(hash)]->lookup_entry(hash, key);
   }
 
+  // return the entry with a ref held without taking any lock, NULL if not found.
+  // a miss is not authoritative, check it again under lock_for_key()
+  Value lookup_entry_lockless(const uint64_t hash, const Key &key)
+  {
+    Value ret = static_cast<Value>(0);
+    if (OB_LIKELY(is_inited_)) {
+      CriticalGuard(qsync_);
+      ret = hash_tables_[part_num(hash)]->lookup_entry_lockless(hash, key);
+      if (static_cast<Value>(0) != ret) {
+        ret->inc_ref();
+      }
+    }
+    return ret;
+  }
+
   Value first_entry(const int64_t part_id, IteratorState &s)
   {
     Value ret = static_cast<Value>(0);
@@ -538,11 +718,25 @@ public:
     return hash_tables_[part_id]->remove_entry(s);
   }
 
+  // free the nodes writers of this part unlinked, call it once the partition lock
+  // is released. A thread still holding the (recursive) lock leaves them to a later call
+  void reclaim(const int64_t part_id)
+  {
+    if (OB_LIKELY(is_inited_) && part_id >= 0 && part_id < MT_HASHTABLE_PARTITIONS
+        && hash_tables_[part_id]->has_retired()) {
+      event::ObProxyMutex *mutex = locks_[part_id];
+      if (NULL == event::this_ethread() || mutex->thread_holding_ != event::this_ethread()) {
+        hash_tables_[part_id]->reclaim();
+      }
+    }
+  }
+
 private:
   bool is_inited_;
   IMTHashTable *hash_tables_[MT_HASHTABLE_PARTITIONS];
   common::ObPtr<event::ObProxyMutex> locks_[MT_HASHTABLE_PARTITIONS];
   common::DRWLock rw_locks_[MT_HASHTABLE_PARTITIONS];
+  common::ObQSync qsync_;
 };
 
 } // end of namespace obutils
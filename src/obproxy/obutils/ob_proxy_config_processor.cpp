@@ -88,6 +88,8 @@ const static char *SECURITY_SOURCE_TYPE     = "sourceType";
 const static char *SECURITY_CA              = "CA";
 const static char *SECURITY_PUBLIC_KEY      = "publicKey";
 const static char *SECURITY_PRIVATE_KEY     = "privateKey";
+// secret of ssl session ticket keys, shared by all proxies of the app
+const static char *SECURITY_TICKET_KEY      = "ticketKey";
 
 #define MONITOR_LIMIT_LOG_FORMAT "%s,%s,%s," \
                                  "%s,%.*s:%.*s:%.*s,%s,"  \
@@ -2149,6 +2151,7 @@ int ObProxyConfigProcessor::update_app_security_config(const ObString &appname,
             security_config_.ca_.reset();
             security_config_.public_key_.reset();
             security_config_.private_key_.reset();
+            security_config_.ticket_key_.reset();
           } else {
             security_config_.source_type_.set_value(it->value_->get_string());
           }
@@ -2158,6 +2161,8 @@ int ObProxyConfigProcessor::update_app_security_config(const ObString &appname,
           security_config_.public_key_.set_value(it->value_->get_string());
         } else if (it->name_ == SECURITY_PRIVATE_KEY) {
           security_config_.private_key_.set_value(it->value_->get_string());
+        } else if (it->name_ == SECURITY_TICKET_KEY) {
+          security_config_.ticket_key_.set_value(it->value_->get_string());
         }
       }
 
@@ -2166,7 +2171,8 @@ int ObProxyConfigProcessor::update_app_security_config(const ObString &appname,
         if (OB_FAIL(g_ssl_processor.update_key(security_config_.source_type_.get_string(),
                 security_config_.ca_.get_string(),
                 security_config_.public_key_.get_string(),
-                security_config_.private_key_.get_string()))) {
+                security_config_.private_key_.get_string(),
+                security_config_.ticket_key_.get_string()))) {
           LOG_WARN("update key failed", K(ret), K(security_config_.source_type_), K(security_config_.ca_),
               K(security_config_.public_key_), K(security_config_.private_key_));
         }
@@ -423,7 +423,7 @@ enum AppConfigVersionIndex
 class ObProxyAppSecurityConfig
 {
 public:
-  ObProxyAppSecurityConfig() : source_type_(), ca_(), public_key_(), private_key_() {}
+  ObProxyAppSecurityConfig() : source_type_(), ca_(), public_key_(), private_key_(), ticket_key_() {}
   ~ObProxyAppSecurityConfig() {}
 
   int update_config();
@@ -434,6 +434,7 @@ public:
   ObProxySizeConfigString<SECURITY_CONFIG_STRING_LEN> ca_;
   ObProxySizeConfigString<SECURITY_CONFIG_STRING_LEN> public_key_;
   ObProxySizeConfigString<SECURITY_CONFIG_STRING_LEN> private_key_;
+  ObProxySizeConfigString<SECURITY_CONFIG_STRING_LEN> ticket_key_;
 
 private:
   DISALLOW_COPY_AND_ASSIGN(ObProxyAppSecurityConfig);
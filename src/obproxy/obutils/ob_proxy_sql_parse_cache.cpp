@@ -0,0 +1,371 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+#include "obutils/ob_proxy_sql_parse_cache.h"
+#include "lib/hash_func/murmur_hash.h"
+#include "lib/allocator/ob_malloc.h"
+
+using namespace oceanbase::common;
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace obutils
+{
+
+static inline bool is_ident_char(const char c)
+{
+  return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || ('0' <= c && c <= '9')
+         || '_' == c || '$' == c || (c & 0x80);
+}
+
+static inline bool is_digit_char(const char c)
+{
+  return '0' <= c && c <= '9';
+}
+
+static inline bool is_hex_char(const char c)
+{
+  return is_digit_char(c) || ('a' <= c && c <= 'f') || ('A' <= c && c <= 'F');
+}
+
+ObSqlParseResultCache::ObSqlParseResultCache()
+    : is_inited_(false), entry_count_(0), entries_(NULL),
+      is_key_valid_(false), key_hash_(0), key_flags_(0), key_len_(0),
+      first_literal_pos_(NO_LITERAL_POS), hit_count_(0), miss_count_(0)
+{
+}
+
+int ObSqlParseResultCache::init(const int64_t entry_count)
+{
+  int ret = OB_SUCCESS;
+  int64_t count = 1;
+  if (OB_UNLIKELY(is_inited_)) {
+    ret = OB_INIT_TWICE;
+    LOG_WARN("init twice", K(ret));
+  } else if (OB_UNLIKELY(entry_count <= 0)) {
+    ret = OB_INVALID_ARGUMENT;
+    LOG_WARN("invalid argument", K(entry_count), K(ret));
+  } else {
+    // round up to power of 2, so the slot can be got by mask
+    while (count < entry_count) {
+      count <<= 1;
+    }
+    const int64_t size = count * static_cast<int64_t>(sizeof(ObSqlParseCacheEntry *));
+    if (OB_ISNULL(entries_ = static_cast<ObSqlParseCacheEntry **>(ob_malloc(size, ObModIds::OB_PROXY_SQL_PARSE)))) {
+      ret = OB_ALLOCATE_MEMORY_FAILED;
+      LOG_WARN("fail to alloc mem for sql parse cache", K(size), K(ret));
+    } else {
+      MEMSET(entries_, 0, size);
+      entry_count_ = count;
+      is_inited_ = true;
+    }
+  }
+  return ret;
+}
+
+void ObSqlParseResultCache::destroy()
+{
+  if (NULL != entries_) {
+    for (int64_t i = 0; i < entry_count_; ++i) {
+      ObSqlParseCacheEntry *entry = entries_[i];
+      if (NULL != entry) {
+        if (NULL != entry->key_) {
+          ob_free(entry->key_);
+          entry->key_ = NULL;
+        }
+        entry->~ObSqlParseCacheEntry();
+        ob_free(entry);
+        entries_[i] = NULL;
+      }
+    }
+    ob_free(entries_);
+    entries_ = NULL;
+  }
+  entry_count_ = 0;
+  is_key_valid_ = false;
+  is_inited_ = false;
+}
+
+int64_t ObSqlParseResultCache::make_flags(const ObProxyParseMode parse_mode,
+                                          const bool use_lower_case_name,
+                                          const bool drop_origin_db_table_name)
+{
+  return (static_cast<int64_t>(parse_mode) << 2)
+         | (use_lower_case_name ? 0x1 : 0)
+         | (drop_origin_db_table_name ? 0x2 : 0);
+}
+
+int ObSqlParseResultCache::mask_literals(const ObString &sql, char *buf, const int64_t buf_len,
+                                         int64_t &pos, int64_t &first_literal_pos)
+{
+  int64_t span_count = 0;
+  return mask_literals(sql, buf, buf_len, pos, first_literal_pos, NULL, 0, span_count);
+}
+
+int ObSqlParseResultCache::mask_literals(const ObString &sql, char *buf, const int64_t buf_len,
+                                         int64_t &pos, int64_t &first_literal_pos,
+                                         ObSqlLiteralSpan *spans, const int64_t max_span_count,
+                                         int64_t &span_count)
+{
+  int ret = OB_SUCCESS;
+  const char *str = sql.ptr();
+  const int64_t len = sql.length();
+  int64_t i = 0;
+  pos = 0;
+  first_literal_pos = NO_LITERAL_POS;
+  span_count = 0;
+  if (OB_ISNULL(str) || OB_ISNULL(buf) || OB_UNLIKELY(buf_len <= 0)) {
+    ret = OB_INVALID_ARGUMENT;
+    LOG_WARN("invalid argument", KP(str), KP(buf), K(buf_len), K(ret));
+  }
+
+  while (OB_SUCC(ret) && i < len) {
+    const char c = str[i];
+    int64_t start = i;
+    bool is_literal = false;
+    if ('\'' == c) {
+      // string literal, '' and backslash are escapes
+      ++i;
+      while (i < len) {
+        if ('\\' == str[i]) {
+          i += 2;
+        } else if ('\'' == str[i]) {
+          if (i + 1 < len && '\'' == str[i + 1]) {
+            i += 2;
+          } else {
+            ++i;
+            break;
+          }
+        } else {
+          ++i;
+        }
+      }
+      is_literal = true;
+    } else if ('"' == c || '`' == c) {
+      // double quoted may be identifier in oracle mode, keep it as it is
+      ++i;
+      while (i < len && c != str[i]) {
+        ++i;
+      }
+      ++i;
+    } else if ('/' == c && i + 1 < len && '*' == str[i + 1]) {
+      // comments are kept, hints in it are part of parse result
+      i += 2;
+      while (i + 1 < len && !('*' == str[i] && '/' == str[i + 1])) {
+        ++i;
+      }
+      i += 2;
+    } else if ('#' == c || ('-' == c && i + 2 < len && '-' == str[i + 1] && isspace(str[i + 2]))) {
+      while (i < len && '\n' != str[i]) {
+        ++i;
+      }
+    } else if ((is_digit_char(c) || ('.' == c && i + 1 < len && is_digit_char(str[i + 1])))
+               && (0 == i || !is_ident_char(str[i - 1]))) {
+      if ('0' == c && i + 1 < len && ('x' == str[i + 1] || 'X' == str[i + 1])) {
+        i += 2;
+        while (i < len && is_hex_char(str[i])) {
+          ++i;
+        }
+      } else {
+        while (i < len && (is_digit_char(str[i]) || '.' == str[i])) {
+          ++i;
+        }
+        if (i < len && ('e' == str[i] || 'E' == str[i])) {
+          int64_t j = i + 1;
+          if (j < len && ('+' == str[j] || '-' == str[j])) {
+            ++j;
+          }
+          if (j < len && is_digit_char(str[j])) {
+            i = j;
+            while (i < len && is_digit_char(str[i])) {
+              ++i;
+            }
+          }
+        }
+      }
+      if (i < len && is_ident_char(str[i])) {
+        // identifier can start with digits in mysql, such as 1abc
+        while (i < len && is_ident_char(str[i])) {
+          ++i;
+        }
+      } else {
+        is_literal = true;
+      }
+    } else {
+      ++i;
+    }
+
+    i = std::min(i, len);
+    if (is_literal) {
+      if (NO_LITERAL_POS == first_literal_pos) {
+        first_literal_pos = start;
+      }
+      if (NULL != spans) {
+        if (OB_UNLIKELY(span_count >= max_span_count)) {
+          ret = OB_SIZE_OVERFLOW;
+        } else {
+          spans[span_count].start_ = start;
+          spans[span_count].len_ = i - start;
+          ++span_count;
+        }
+      }
+      if (OB_FAIL(ret)) {
+      } else if (OB_UNLIKELY(pos >= buf_len)) {
+        ret = OB_SIZE_OVERFLOW;
+      } else {
+        buf[pos++] = '?';
+      }
+    } else if (OB_UNLIKELY(pos + (i - start) > buf_len)) {
+      ret = OB_SIZE_OVERFLOW;
+    } else {
+      MEMCPY(buf + pos, str + start, i - start);
+      pos += (i - start);
+    }
+  }
+  return ret;
+}
+
+bool ObSqlParseResultCache::can_cache(const ObSqlParseResult &result)
+{
+  return (result.is_select_stmt()
+          || result.is_insert_stmt()
+          || result.is_update_stmt()
+          || result.is_replace_stmt()
+          || result.is_delete_stmt()
+          || result.is_merge_stmt())
+         && !result.is_internal_error_cmd()
+         && !result.has_shard_comment()
+         && !result.is_dual_request()
+         && result.get_parsed_length() > 0;
+}
+
+int ObSqlParseResultCache::get(const ObString &sql, const int64_t flags,
+                               ObSqlParseResult &result, bool &is_hit)
+{
+  int ret = OB_SUCCESS;
+  is_hit = false;
+  is_key_valid_ = false;
+  if (OB_UNLIKELY(!is_inited_)) {
+    ret = OB_NOT_INIT;
+    LOG_WARN("not inited", K(ret));
+  } else if (sql.empty() || sql.length() > MAX_CACHED_SQL_LENGTH) {
+    // do not cache
+  } else if (OB_FAIL(mask_literals(sql, key_buf_, MAX_CACHED_SQL_LENGTH, key_len_, first_literal_pos_))) {
+    if (OB_SIZE_OVERFLOW == ret) {
+      ret = OB_SUCCESS;
+    } else {
+      LOG_WARN("fail to mask literals", K(sql), K(ret));
+    }
+  } else {
+    key_flags_ = flags;
+    key_hash_ = murmurhash(key_buf_, static_cast<int32_t>(key_len_), static_cast<uint64_t>(flags));
+    is_key_valid_ = true;
+
+    ObSqlParseCacheEntry *entry = entries_[key_hash_ & (entry_count_ - 1)];
+    if (NULL != entry
+        && entry->hash_ == key_hash_
+        && entry->flags_ == key_flags_
+        && entry->key_len_ == key_len_
+        && 0 == MEMCMP(entry->key_, key_buf_, key_len_)) {
+      result = entry->result_;
+      is_hit = true;
+      is_key_valid_ = false;
+      ++hit_count_;
+    } else {
+      ++miss_count_;
+    }
+  }
+  return ret;
+}
+
+int ObSqlParseResultCache::put(const ObSqlParseResult &result)
+{
+  int ret = OB_SUCCESS;
+  if (OB_UNLIKELY(!is_inited_)) {
+    ret = OB_NOT_INIT;
+    LOG_WARN("not inited", K(ret));
+  } else if (!is_key_valid_) {
+    // no key or already hit
+  } else if (!can_cache(result) || first_literal_pos_ < result.get_parsed_length()) {
+    // parsed_length depends on the literals before it
+    is_key_valid_ = false;
+  } else {
+    const int64_t idx = key_hash_ & (entry_count_ - 1);
+    ObSqlParseCacheEntry *entry = entries_[idx];
+    void *buf = NULL;
+    if (NULL == entry) {
+      if (OB_ISNULL(buf = ob_malloc(sizeof(ObSqlParseCacheEntry), ObModIds::OB_PROXY_SQL_PARSE))) {
+        ret = OB_ALLOCATE_MEMORY_FAILED;
+        LOG_WARN("fail to alloc mem for sql parse cache entry", K(ret));
+      } else {
+        entry = new (buf) ObSqlParseCacheEntry();
+        entries_[idx] = entry;
+      }
+    }
+
+    if (OB_SUCC(ret) && entry->key_buf_len_ < key_len_) {
+      if (NULL != entry->key_) {
+        ob_free(entry->key_);
+        entry->key_ = NULL;
+        entry->key_buf_len_ = 0;
+      }
+      if (OB_ISNULL(entry->key_ = static_cast<char *>(ob_malloc(key_len_, ObModIds::OB_PROXY_SQL_PARSE)))) {
+        ret = OB_ALLOCATE_MEMORY_FAILED;
+        LOG_WARN("fail to alloc mem for sql parse cache key", K_(key_len), K(ret));
+      } else {
+        entry->key_buf_len_ = key_len_;
+      }
+    }
+
+    if (OB_SUCC(ret)) {
+      MEMCPY(entry->key_, key_buf_, key_len_);
+      entry->key_len_ = key_len_;
+      entry->hash_ = key_hash_;
+      entry->flags_ = key_flags_;
+      entry->result_ = result;
+    } else if (NULL != entry) {
+      // the slot is invalid now
+      entry->key_len_ = 0;
+      entry->hash_ = 0;
+    }
+    is_key_valid_ = false;
+  }
+  return ret;
+}
+
+int ObSqlParseResultCache::get_thread_cache(const int64_t entry_count, ObSqlParseResultCache *&cache)
+{
+  int ret = OB_SUCCESS;
+  static __thread ObSqlParseResultCache *thread_cache = NULL;
+  if (NULL == thread_cache) {
+    ObSqlParseResultCache *tmp_cache = NULL;
+    if (OB_ISNULL(tmp_cache = new (std::nothrow) ObSqlParseResultCache())) {
+      ret = OB_ALLOCATE_MEMORY_FAILED;
+      LOG_WARN("fail to alloc sql parse cache", K(ret));
+    } else if (OB_FAIL(tmp_cache->init(entry_count))) {
+      LOG_WARN("fail to init sql parse cache", K(entry_count), K(ret));
+      delete tmp_cache;
+      tmp_cache = NULL;
+    } else {
+      thread_cache = tmp_cache;
+    }
+  }
+  cache = thread_cache;
+  return ret;
+}
+
+} // end of namespace obutils
+} // end of namespace obproxy
+} // end of namespace oceanbase
@@ -0,0 +1,117 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#ifndef OBPROXY_SQL_PARSE_CACHE_H
+#define OBPROXY_SQL_PARSE_CACHE_H
+
+#include "lib/ob_define.h"
+#include "lib/string/ob_string.h"
+#include "obutils/ob_proxy_sql_parser.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace obutils
+{
+
+// a literal in sql text, quotes are included for string literal
+struct ObSqlLiteralSpan
+{
+  int64_t start_;
+  int64_t len_;
+};
+
+struct ObSqlParseCacheEntry
+{
+  ObSqlParseCacheEntry() : hash_(0), flags_(0), key_len_(0), key_buf_len_(0), key_(NULL), result_() {}
+  ~ObSqlParseCacheEntry() {}
+
+  uint64_t hash_;
+  int64_t flags_;
+  int64_t key_len_;
+  int64_t key_buf_len_;
+  char *key_;
+  ObSqlParseResult result_;
+};
+
+// Per thread cache of obproxy parser result.
+//
+// Statements which only differ in literals get the same parse result, so the key
+// is the sql text with every literal replaced by '?', and the parser can be
+// skipped on hit. Only simple dml is cached, and only if there is no literal before
+// parsed_length, so parsed_length of the cached result is still valid for the
+// statement which hits, and expr parser can extract literal values from there.
+//
+// Usage:
+//   get() to look up the sql, on miss parse it and put() the result,
+//   put() uses the key built by the last get().
+//
+// It is a direct mapped table and only accessed by its owner thread, no lock is needed.
+class ObSqlParseResultCache
+{
+public:
+  static const int64_t MAX_CACHED_SQL_LENGTH = 4096;
+  static const int64_t NO_LITERAL_POS = INT64_MAX;
+
+  ObSqlParseResultCache();
+  ~ObSqlParseResultCache() { destroy(); }
+
+  int init(const int64_t entry_count);
+  void destroy();
+
+  int get(const common::ObString &sql, const int64_t flags, ObSqlParseResult &result, bool &is_hit);
+  int put(const ObSqlParseResult &result);
+
+  static int get_thread_cache(const int64_t entry_count, ObSqlParseResultCache *&cache);
+  static int64_t make_flags(const ObProxyParseMode parse_mode, const bool use_lower_case_name,
+                            const bool drop_origin_db_table_name);
+
+  // mask literals of sql into buf, first_literal_pos is the offset of the first
+  // literal in sql, or NO_LITERAL_POS if there is none
+  static int mask_literals(const common::ObString &sql, char *buf, const int64_t buf_len,
+                           int64_t &pos, int64_t &first_literal_pos);
+  // also record the position of every literal into spans, return OB_SIZE_OVERFLOW
+  // if there are more than max_span_count literals
+  static int mask_literals(const common::ObString &sql, char *buf, const int64_t buf_len,
+                           int64_t &pos, int64_t &first_literal_pos,
+                           ObSqlLiteralSpan *spans, const int64_t max_span_count, int64_t &span_count);
+
+  TO_STRING_KV(K_(is_inited), K_(entry_count), K_(hit_count), K_(miss_count));
+
+private:
+  static bool can_cache(const ObSqlParseResult &result);
+
+private:
+  bool is_inited_;
+  int64_t entry_count_;
+  ObSqlParseCacheEntry **entries_;
+
+  // key built by last get()
+  bool is_key_valid_;
+  uint64_t key_hash_;
+  int64_t key_flags_;
+  int64_t key_len_;
+  int64_t first_literal_pos_;
+  char key_buf_[MAX_CACHED_SQL_LENGTH];
+
+  int64_t hit_count_;
+  int64_t miss_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(ObSqlParseResultCache);
+};
+
+} // end of namespace obutils
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+#endif // OBPROXY_SQL_PARSE_CACHE_H
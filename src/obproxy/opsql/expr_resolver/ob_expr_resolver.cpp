@@ -289,6 +289,10 @@ int ObExprResolver::get_obj_with_param(ObObj &target_obj, ObProxyMysqlRequest *c
       if (OB_ISNULL(ps_entry)) {
         ret = OB_ERR_UNEXPECTED;
         LOG_WARN("ps entry is null", K(ret));
+      } else if (OB_UNLIKELY(!ps_entry->is_ps_sql_meta_ready())) {
+        // ps meta is being filled by the prepare of other session
+        ret = OB_EAGAIN;
+        LOG_DEBUG("ps sql meta is not ready", KPC(ps_entry), K(ret));
       } else if (OB_UNLIKELY(execute_param_index >= ps_entry->get_param_count())
                  || execute_param_index < 0) {
         ret = OB_ERR_UNEXPECTED;
@@ -0,0 +1,292 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+
+#include "opsql/func_expr_resolver/proxy_expr/ob_proxy_compiled_expr.h"
+#include "opsql/func_expr_resolver/proxy_expr/ob_proxy_expr.h"
+#include "obutils/ob_proxy_sql_parser.h"
+#include "dbconfig/ob_proxy_db_config_info.h"
+
+namespace oceanbase
+{
+using namespace common;
+namespace obproxy
+{
+using namespace obutils;
+using namespace dbconfig;
+namespace opsql
+{
+
+static bool get_const_int_param(ObProxyExpr *expr, int64_t &value)
+{
+  bool bret = false;
+  if (NULL != expr && OB_PROXY_EXPR_TYPE_CONST == expr->get_expr_type()) {
+    ObObj &obj = static_cast<ObProxyExprConst*>(expr)->get_object();
+    if (obj.is_int()) {
+      value = obj.get_int();
+      bret = true;
+    }
+  }
+  return bret;
+}
+
+void ObProxyCompiledExpr::reset()
+{
+  column_name_.reset();
+  op_count_ = 0;
+  for (int64_t i = 0; i < MAX_OP_COUNT; i++) {
+    ops_[i] = ObProxyCompiledOp();
+  }
+}
+
+void ObProxyCompiledExpr::assign(const ObProxyCompiledExpr &other)
+{
+  if (this != &other) {
+    column_name_ = other.column_name_;
+    op_count_ = other.op_count_;
+    for (int64_t i = 0; i < MAX_OP_COUNT; i++) {
+      ops_[i] = other.ops_[i];
+    }
+  }
+}
+
+int ObProxyCompiledExpr::compile(ObProxyExpr *expr)
+{
+  int ret = OB_SUCCESS;
+  // ops are found from the outermost function
+  ObProxyCompiledOp ops[MAX_OP_COUNT];
+  int64_t op_count = 0;
+  ObString column_name;
+  ObProxyExpr *cur_expr = expr;
+
+  reset();
+  while (OB_SUCC(ret) && column_name.empty()) {
+    if (OB_ISNULL(cur_expr)) {
+      ret = OB_NOT_SUPPORTED;
+    } else if (OB_PROXY_EXPR_TYPE_COLUMN == cur_expr->get_expr_type()) {
+      column_name = static_cast<ObProxyExprColumn*>(cur_expr)->get_column_name();
+      if (column_name.empty()) {
+        ret = OB_NOT_SUPPORTED;
+      }
+    } else if (!cur_expr->is_func_expr() || op_count >= MAX_OP_COUNT) {
+      ret = OB_NOT_SUPPORTED;
+    } else {
+      ObSEArray<ObProxyExpr*, 4> &param_array = static_cast<ObProxyFuncExpr*>(cur_expr)->get_param_array();
+      ObProxyCompiledOp &op = ops[op_count];
+      const int64_t param_count = param_array.count();
+      switch (cur_expr->get_expr_type()) {
+        case OB_PROXY_EXPR_TYPE_FUNC_SUBSTR:
+          op.type_ = OB_PROXY_COMPILED_OP_SUBSTR;
+          if ((2 != param_count && 3 != param_count)
+              || !get_const_int_param(param_array.at(1), op.arg1_)
+              || (3 == param_count && (!get_const_int_param(param_array.at(2), op.arg2_) || op.arg2_ <= 0))) {
+            ret = OB_NOT_SUPPORTED;
+          }
+          break;
+        case OB_PROXY_EXPR_TYPE_FUNC_TOINT:
+          op.type_ = OB_PROXY_COMPILED_OP_TOINT;
+          if (1 != param_count) {
+            ret = OB_NOT_SUPPORTED;
+          }
+          break;
+        case OB_PROXY_EXPR_TYPE_FUNC_HASH:
+          op.type_ = OB_PROXY_COMPILED_OP_HASH;
+          if ((1 != param_count && 2 != param_count)
+              || (2 == param_count && (!get_const_int_param(param_array.at(1), op.arg1_) || op.arg1_ < 0))) {
+            ret = OB_NOT_SUPPORTED;
+          }
+          break;
+        case OB_PROXY_EXPR_TYPE_FUNC_DIV:
+          op.type_ = OB_PROXY_COMPILED_OP_DIV;
+          if (2 != param_count || !get_const_int_param(param_array.at(1), op.arg1_) || 0 == op.arg1_) {
+            ret = OB_NOT_SUPPORTED;
+          }
+          break;
+        default:
+          ret = OB_NOT_SUPPORTED;
+          break;
+      }
+      if (OB_SUCC(ret)) {
+        op_count++;
+        cur_expr = param_array.at(0);
+      }
+    }
+  }
+
+  if (OB_SUCC(ret)) {
+    for (int64_t i = 0; i < op_count; i++) {
+      ops_[i] = ops[op_count - 1 - i];
+    }
+    // div of varchar or int column values is calculated on ObNumber,
+    // only div of int results is compiled
+    for (int64_t i = 0; OB_SUCC(ret) && i < op_count; i++) {
+      if (OB_PROXY_COMPILED_OP_DIV == ops_[i].type_
+          && (0 == i || (OB_PROXY_COMPILED_OP_SUBSTR == ops_[i - 1].type_))) {
+        ret = OB_NOT_SUPPORTED;
+      }
+    }
+  }
+
+  if (OB_SUCC(ret)) {
+    column_name_ = column_name;
+    op_count_ = op_count;
+    LOG_DEBUG("succ to compile sharding expr", KPC(this));
+  } else {
+    reset();
+  }
+
+  return ret;
+}
+
+int ObProxyCompiledExpr::calc(const ObProxyExprCtx &ctx, const SqlFieldResult &sql_result,
+                              ObIArray<ObObj> &result_obj_array) const
+{
+  int ret = OB_SUCCESS;
+  const int64_t len = result_obj_array.count();
+  bool found = false;
+
+  if (OB_UNLIKELY(!is_valid())) {
+    ret = OB_NOT_INIT;
+    LOG_WARN("compiled expr is not valid", K(ret));
+  }
+
+  for (int64_t i = 0; OB_SUCC(ret) && i < sql_result.field_num_; i++) {
+    const SqlField &field = sql_result.fields_.at(i);
+    if (0 == field.column_name_.string_.case_compare(column_name_)) {
+      found = true;
+      for (int64_t j = 0; OB_SUCC(ret) && j < field.column_values_.count(); j++) {
+        const SqlColumnValue &sql_column_value = field.column_values_.at(j);
+        ObObj obj;
+        if (TOKEN_INT_VAL == sql_column_value.value_type_) {
+          obj.set_int(sql_column_value.column_int_value_);
+        } else if (TOKEN_STR_VAL == sql_column_value.value_type_) {
+          obj.set_varchar(sql_column_value.column_value_.string_);
+          obj.set_collation_type(CS_TYPE_UTF8MB4_GENERAL_CI);
+        } else {
+          ret = OB_ERR_COULUMN_VALUE_NOT_MATCH;
+          LOG_WARN("sql_column_value value type invalid", K(sql_column_value.value_type_));
+        }
+        if (OB_SUCC(ret) && OB_FAIL(result_obj_array.push_back(obj))) {
+          LOG_WARN("push back obj failed", K(ret), K(obj));
+        }
+      }
+    }
+  }
+
+  if (OB_SUCC(ret) && !found) {
+    ret = OB_EXPR_COLUMN_NOT_EXIST;
+  }
+
+  for (int64_t i = 0; OB_SUCC(ret) && i < op_count_; i++) {
+    for (int64_t j = len; OB_SUCC(ret) && j < result_obj_array.count(); j++) {
+      if (OB_FAIL(calc_op(ctx, ops_[i], result_obj_array.at(j)))) {
+        LOG_WARN("calc compiled op failed", K(ret), K(i), "op", ops_[i], K(column_name_));
+      }
+    }
+  }
+
+  return ret;
+}
+
+int ObProxyCompiledExpr::calc_op(const ObProxyExprCtx &ctx, const ObProxyCompiledOp &op, ObObj &obj) const
+{
+  int ret = OB_SUCCESS;
+  switch (op.type_) {
+    case OB_PROXY_COMPILED_OP_SUBSTR: {
+      ObObj varchar_obj;
+      ObString value;
+      int64_t start_pos = op.arg1_;
+      int64_t substr_len = op.arg2_;
+      if (OB_ISNULL(ctx.allocator_)) {
+        ret = OB_ERR_UNEXPECTED;
+        LOG_WARN("allocator is null", K(ret));
+      } else if (OB_FAIL(ObProxyFuncExpr::get_varchar_obj(obj, varchar_obj, *ctx.allocator_))) {
+        LOG_WARN("get varchar obj failed", K(ret));
+      } else if (OB_FAIL(varchar_obj.get_varchar(value))) {
+        LOG_WARN("get varchar failed", K(ret), K(varchar_obj));
+      } else if (value.empty()) {
+        ret = OB_EXPR_CALC_ERROR;
+        LOG_WARN("substr first parm is emtpy", K(ret));
+      } else {
+        const int64_t value_length = value.length();
+        if (start_pos < 0) {
+          start_pos = value_length + start_pos + 1;
+        }
+        if (-1 == substr_len || start_pos + substr_len - 1 > value_length) {
+          substr_len = value_length - start_pos + 1;
+        }
+        if (start_pos <= 0 || start_pos > value_length || substr_len <= 0 || substr_len > value_length) {
+          ret = OB_INVALID_ARGUMENT_FOR_SUBSTR;
+          LOG_WARN("column value length does not match", K(start_pos),
+                   K(substr_len), K(value_length), K(value), K(ret));
+        } else {
+          obj.set_varchar(value.ptr() + start_pos - 1, static_cast<int32_t>(substr_len));
+          obj.set_collation_type(CS_TYPE_UTF8MB4_GENERAL_CI);
+        }
+      }
+      break;
+    }
+    case OB_PROXY_COMPILED_OP_TOINT: {
+      ObObj int_obj;
+      if (OB_FAIL(ObProxyFuncExpr::get_int_obj(obj, int_obj))) {
+        LOG_WARN("get int obj failed", K(ret));
+      } else {
+        obj = int_obj;
+      }
+      break;
+    }
+    case OB_PROXY_COMPILED_OP_HASH: {
+      ObObj int_obj;
+      int64_t index = -1;
+      const int64_t num = (-1 == op.arg1_ ? ctx.sharding_physical_size_ : op.arg1_);
+      if (testload_need_handle_special_char(ctx.test_load_type_) && obj.is_varchar()) {
+        ObString str = obj.get_varchar();
+        ObShardRule::handle_special_char(str.ptr(), str.length());
+      }
+      if (OB_FAIL(ObProxyFuncExpr::get_int_obj(obj, int_obj))) {
+        LOG_WARN("get int obj failed", K(ret), K(obj));
+      } else if (OB_FAIL(int_obj.get_int(index))) {
+        LOG_WARN("get int failed", K(ret), K(int_obj));
+      } else if (!ctx.is_elastic_index_) {
+        if (0 == num) {
+          ret = OB_EXPR_CALC_ERROR;
+          LOG_WARN("num is 0", K(ret));
+        } else {
+          index = index % num;
+        }
+      }
+      if (OB_SUCC(ret)) {
+        obj.set_int(index);
+      }
+      break;
+    }
+    case OB_PROXY_COMPILED_OP_DIV: {
+      if (OB_UNLIKELY(!obj.is_int())) {
+        ret = OB_ERR_UNEXPECTED;
+        LOG_WARN("div of compiled expr should be on int", K(ret), K(obj));
+      } else {
+        obj.set_int(obj.get_int() / op.arg1_);
+      }
+      break;
+    }
+    default:
+      ret = OB_ERR_UNEXPECTED;
+      LOG_WARN("unknown compiled op", K(ret), K(op));
+      break;
+  }
+  return ret;
+}
+
+} // end of namespace opsql
+} // end of namespace obproxy
+} // end of namespace oceanbase
@@ -0,0 +1,102 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#ifndef OB_FUNC_EXPR_PROXY_COMPILED_EXPR_H
+#define OB_FUNC_EXPR_PROXY_COMPILED_EXPR_H
+
+#include "lib/ob_define.h"
+#include "lib/string/ob_string.h"
+#include "lib/container/ob_iarray.h"
+#include "lib/utility/ob_print_utils.h"
+#include "common/ob_object.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace obutils
+{
+struct SqlFieldResult;
+}
+namespace opsql
+{
+class ObProxyExpr;
+class ObProxyExprCtx;
+
+enum ObProxyCompiledOpType
+{
+  OB_PROXY_COMPILED_OP_NONE = 0,
+  OB_PROXY_COMPILED_OP_SUBSTR,   // substr(value, arg1, arg2), arg2 is -1 if not given
+  OB_PROXY_COMPILED_OP_TOINT,    // toint(value)
+  OB_PROXY_COMPILED_OP_HASH,     // hash(value, arg1), arg1 is -1 if not given
+  OB_PROXY_COMPILED_OP_DIV,      // div(value, arg1), only on the int result of another op
+};
+
+struct ObProxyCompiledOp
+{
+  ObProxyCompiledOp() : type_(OB_PROXY_COMPILED_OP_NONE), arg1_(-1), arg2_(-1) {}
+  TO_STRING_KV(K_(type), K_(arg1), K_(arg2));
+
+  ObProxyCompiledOpType type_;
+  int64_t arg1_;
+  int64_t arg2_;
+};
+
+// Sharding rule expression compiled at rule load time.
+//
+// Most rules are a chain of functions on one column with constant arguments,
+// like hash(substr(user_id, -2, 2)) or div(toint(substr(user_id, 1, 8)), 100).
+// Such an expression is flattened into the column name and the list of
+// functions applied from the innermost one, and calculated on an ObObj array
+// holding one value per column value, without building ObProxyExpr param
+// result arrays for every function.
+//
+// Every function is applied to all values before the next one, just like
+// ObProxyExpr::calc, so results, error codes and the test load side effect
+// on the column value are the same. Expressions of other shapes are not
+// compiled and are still calculated by ObProxyExpr.
+class ObProxyCompiledExpr
+{
+public:
+  static const int64_t MAX_OP_COUNT = 4;
+
+  ObProxyCompiledExpr() { reset(); }
+  ~ObProxyCompiledExpr() {}
+
+  void reset();
+  void assign(const ObProxyCompiledExpr &other);
+  bool is_valid() const { return !column_name_.empty(); }
+
+  // column_name_ refers to the memory of expr, which must outlive this.
+  // OB_NOT_SUPPORTED is returned if expr has an unknown shape
+  int compile(ObProxyExpr *expr);
+  // push the results of all values of the column into result_obj_array,
+  // OB_EXPR_COLUMN_NOT_EXIST is returned if the column is not in sql_result
+  int calc(const ObProxyExprCtx &ctx, const obutils::SqlFieldResult &sql_result,
+           common::ObIArray<common::ObObj> &result_obj_array) const;
+
+  TO_STRING_KV(K_(column_name), K_(op_count), "ops", common::ObArrayWrap<ObProxyCompiledOp>(ops_, op_count_));
+
+private:
+  int calc_op(const ObProxyExprCtx &ctx, const ObProxyCompiledOp &op, common::ObObj &obj) const;
+
+private:
+  common::ObString column_name_;
+  int64_t op_count_;
+  ObProxyCompiledOp ops_[MAX_OP_COUNT];
+};
+
+} // end of namespace opsql
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+#endif // OB_FUNC_EXPR_PROXY_COMPILED_EXPR_H
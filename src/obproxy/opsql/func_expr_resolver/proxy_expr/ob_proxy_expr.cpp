@@ -75,11 +75,15 @@ static void get_proxy_expr_result_tree_str(ObProxyExpr *root, const int level, c
 
 void ObProxyExpr::print_proxy_expr(ObProxyExpr *root)
 {
-  char buf[256 * 1024];
-  int pos = 0;
-  get_proxy_expr_result_tree_str(root, 0, buf, pos, 256 * 1024);
-  ObString tree_str(16  * 1024, buf);
-  LOG_DEBUG("proxy_expr is \n", K(tree_str));
+  // called by calc() of every expr for every row, skip building the tree string
+  // unless it is really printed
+  if (OB_LOG_NEED_TO_PRINT(DEBUG)) {
+    char buf[256 * 1024];
+    int pos = 0;
+    get_proxy_expr_result_tree_str(root, 0, buf, pos, 256 * 1024);
+    ObString tree_str(16  * 1024, buf);
+    LOG_DEBUG("proxy_expr is \n", K(tree_str));
+  }
 }
 
 int64_t ObProxyExpr::to_string(char *buf, int64_t buf_len) const
@@ -165,6 +165,7 @@ public:
   virtual int calc(const ObProxyExprCtx &ctx, const ObProxyExprCalcItem &calc_item,
             common::ObIArray<common::ObObj> &result_obj_array);
   void set_column_name(char *buf, const int32_t length) { column_name_.assign(buf, length); }
+  const common::ObString &get_column_name() const { return column_name_; }
 private:
   common::ObString column_name_;
 };
@@ -111,6 +111,20 @@ void ObPrometheusHistogram::atomic_add(const int64_t value)
   }
 }
 
+void ObPrometheusHistogram::atomic_add(const ObVector<int64_t> &bucket_counts, const int64_t sum)
+{
+  if (bucket_counts.size() != bucket_counts_.size()) {
+    LOG_WARN("bucket count is invalid", "bucket_counts size", bucket_counts.size(),
+             "expected size", bucket_counts_.size());
+  } else {
+    DRWLock::RDLockGuard lock(lock_);
+    ATOMIC_AAF(&sum_, sum);
+    for (int64_t i = 0; i < bucket_counts.size(); i++) {
+      ATOMIC_AAF(&bucket_counts_[i], bucket_counts[i]);
+    }
+  }
+}
+
 //------------------- ObPrometheusFamily ------------------
 ObPrometheusFamily::~ObPrometheusFamily()
 {
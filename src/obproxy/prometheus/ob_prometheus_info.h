@@ -174,6 +174,8 @@ public:
 
   void reset();
   void atomic_add(const int64_t value);
+  // add the observations which are already counted by bucket
+  void atomic_add(const common::ObVector<int64_t> &bucket_counts, const int64_t sum);
   virtual bool is_active() const { return ATOMIC_LOAD(&sum_); }
 
   common::DRWLock &get_lock() { return lock_; }
@@ -15,6 +15,7 @@
 #include "prometheus/ob_prometheus_processor.h"
 #include "prometheus/ob_prometheus_utils.h"
 #include "prometheus/ob_prometheus_convert.h"
+#include "prometheus/ob_sql_prometheus.h"
 #include "obutils/ob_proxy_table_processor_utils.h"
 #include "obutils/ob_proxy_config.h"
 #include "utils/ob_proxy_monitor_utils.h"
@@ -63,6 +64,12 @@ int ObPrometheusProcessor::start_prometheus_task()
 int ObPrometheusProcessor::prometheus_sync_task()
 {
   int ret = OB_SUCCESS;
+  if (get_global_proxy_config().enable_cmd_time_histogram
+      && OB_FAIL(ObSQLPrometheus::handle_cmd_time_histograms())) {
+    LOG_WARN("fail to handle cmd time histograms", K(ret));
+    ret = OB_SUCCESS;
+  }
+
   if (OB_FAIL(g_ob_prometheus_processor.do_prometheus_sync_task())) {
     LOG_WARN("fail to do prometheus sync task", K(ret));
   } else {
@@ -306,6 +313,34 @@ int ObPrometheusProcessor::handle_histogram(const char *name_ptr, const char *he
   return ret;
 }
 
+int ObPrometheusProcessor::handle_histogram(const char *name_ptr, const char *help_ptr,
+                                            ObVector<ObPrometheusLabel> &label_array,
+                                            ObVector<int64_t> &bucket_counts, int64_t sum,
+                                            ObSortedVector<int64_t>& buckets)
+{
+  int ret = OB_SUCCESS;
+
+  ObPrometheusFamily *family = NULL;
+  ObPrometheusHistogram *histogram = NULL;
+
+  if (OB_FAIL(get_or_create_family(name_ptr, help_ptr, PROMETHEUS_TYPE_HISTOGRAM,
+                                   default_constant_labels_, family))) {
+    LOG_WARN("fail to get or create family", K(name_ptr), K(ret));
+  } else if (OB_FAIL(get_or_create_metric(family, label_array, buckets, histogram))) {
+    if (OB_EXCEED_MEM_LIMIT == ret) {
+      ret = OB_SUCCESS;
+    } else {
+      LOG_WARN("fail to get or create metric", K(label_array), K(ret));
+    }
+  } else {
+    histogram->atomic_add(bucket_counts, sum);
+    family->dec_ref();
+    histogram->dec_ref();
+  }
+
+  return ret;
+}
+
 template <typename TA, typename T>
 int ObPrometheusProcessor::get_or_create_metric(ObPrometheusFamily *family,
                                                 ObVector<ObPrometheusLabel> &label_array,
@@ -49,6 +49,12 @@ public:
   int handle_histogram(const char *name_ptr, const char *help_ptr,
                        common::ObVector<ObPrometheusLabel> &label_array,
                        int64_t value, common::ObSortedVector<int64_t>& buckets);
+
+  // bucket_counts has one more element than buckets, for the values above the last boundary
+  int handle_histogram(const char *name_ptr, const char *help_ptr,
+                       common::ObVector<ObPrometheusLabel> &label_array,
+                       common::ObVector<int64_t> &bucket_counts, int64_t sum,
+                       common::ObSortedVector<int64_t>& buckets);
 private:
   static int prometheus_sync_task();
   static void update_prometheus_sync_interval();
@@ -30,6 +30,8 @@ namespace prometheus
 #define REQUEST_TOTAL_HELP "The num of user request"
 #define COST_TOTAL "odp_sql_cost_total"
 #define COST_TOTAL_HELP "user cost total"
+#define COST_HISTOGRAM "odp_sql_cost_histogram"
+#define COST_HISTOGRAM_HELP "user cost histogram of each request phase in us"
 #define CURRENT_SESSION "odp_current_session"
 #define CURRENT_SESSION_HELP "The num of current session"
 
@@ -15,6 +15,7 @@
 #include "prometheus/ob_sql_prometheus.h"
 #include "prometheus/ob_prometheus_utils.h"
 #include "obutils/ob_proxy_config.h"
+#include "proxy/mysql/ob_mysql_sm_time_histogram.h"
 
 using namespace oceanbase::obproxy::proxy;
 using namespace oceanbase::obproxy::obutils;
@@ -176,6 +177,65 @@ int ObSQLPrometheus::handle_prometheus(const ObString &logic_tenant_name,
   return ret;
 }
 
+int ObSQLPrometheus::handle_cmd_time_histograms()
+{
+  int ret = OB_SUCCESS;
+  static const int64_t BOUNDARIES[] = {100, 500, 1000, 5000, 10000, 50000, 100000, 500000, 1000000, 5000000};
+  static const int64_t BOUNDARY_COUNT = static_cast<int64_t>(ARRAYSIZEOF(BOUNDARIES));
+  // merged histograms are accumulated since start, keep what was exported to get the increment
+  static ObCmdTimeHistograms merged;
+  static int64_t last_bucket_counts[CMD_TIME_HISTOGRAM_MAX_TYPE][BOUNDARY_COUNT + 1];
+  static int64_t last_sums[CMD_TIME_HISTOGRAM_MAX_TYPE];
+
+  ObSortedVector<int64_t> buckets;
+  for (int64_t i = 0; i < BOUNDARY_COUNT; ++i) {
+    buckets.push_back(BOUNDARIES[i]);
+  }
+
+  get_merged_cmd_time_histograms(merged);
+  ObVector<ObPrometheusLabel> &label_vector = ObProxyPrometheusUtils::get_thread_label_vector();
+  ObVector<int64_t> bucket_counts(BOUNDARY_COUNT + 1);
+  int64_t counts[BOUNDARY_COUNT + 1];
+  for (int64_t type = 0; type < CMD_TIME_HISTOGRAM_MAX_TYPE && OB_SUCC(ret); ++type) {
+    const ObLatencyHistogram &histogram = merged.get_histogram(static_cast<ObCmdTimeHistogramType>(type));
+    MEMSET(counts, 0, sizeof(counts));
+    int64_t boundary_idx = 0;
+    int64_t count = 0;
+    for (int64_t i = 0; i < ObLatencyHistogram::BUCKET_COUNT; ++i) {
+      if (0 != (count = histogram.get_bucket_count(i))) {
+        const int64_t upper_bound = ObLatencyHistogram::get_bucket_upper_bound(i);
+        while (boundary_idx < BOUNDARY_COUNT && upper_bound > BOUNDARIES[boundary_idx]) {
+          ++boundary_idx;
+        }
+        counts[boundary_idx] += count;
+      }
+    }
+
+    bool has_new_value = false;
+    bucket_counts.reset();
+    for (int64_t i = 0; i <= BOUNDARY_COUNT; ++i) {
+      const int64_t delta = counts[i] - last_bucket_counts[type][i];
+      bucket_counts.push_back(delta > 0 ? delta : 0);
+      has_new_value = has_new_value || delta > 0;
+      last_bucket_counts[type][i] = counts[i];
+    }
+    const int64_t sum_delta = histogram.get_sum() - last_sums[type];
+    last_sums[type] = histogram.get_sum();
+
+    if (has_new_value) {
+      label_vector.reset();
+      ObProxyPrometheusUtils::build_label(label_vector, LABEL_TIME_TYPE,
+                                          get_cmd_time_histogram_name(static_cast<ObCmdTimeHistogramType>(type)), false);
+      if (OB_FAIL(g_ob_prometheus_processor.handle_histogram(COST_HISTOGRAM, COST_HISTOGRAM_HELP, label_vector,
+                                                             bucket_counts, (sum_delta > 0 ? sum_delta : 0), buckets))) {
+        LOG_WARN("fail to handle histogram with COST_HISTOGRAM", K(type), K(ret));
+      }
+    }
+  }
+
+  return ret;
+}
+
 } // end of namespace prometheus
 } // end of namespace obproxy
 } // end of namespace oceanbase
@@ -37,6 +37,10 @@ public:
 
   static int handle_prometheus(const proxy::ObClientSessionInfo &cs_info,
                                const ObPrometheusMetrics metric, ...);
+
+  // export the increment of the per thread cmd time histograms since last call,
+  // only called by the prometheus sync task
+  static int handle_cmd_time_histograms();
 private:
   static int handle_prometheus(const common::ObString &logic_tenant_name,
                                const common::ObString &logic_database_name,
@@ -1022,6 +1022,9 @@ int ObMysqlSMApi::setup_transfer_from_transform()
       } else {
         response_transform_info_.entry_->in_tunnel_ = true;
         sm_->client_entry_->in_tunnel_ = true;
+        if (sm_->result_cache_capture_.is_started()) {
+          c->capture_ = &sm_->result_cache_capture_;
+        }
         if (OB_FAIL(setup_plugin_clients(*p))) {
           LOG_WARN("failed to setup_plugin_clients", K(p), K_(sm_->sm_id), K(ret));
         } else if (OB_FAIL(p->set_response_packet_analyzer(0, MYSQL_RESPONSE, &sm_->analyzer_, NULL))) {
@@ -21,6 +21,7 @@
 #include "prometheus/ob_sql_prometheus.h"
 #include "dbconfig/ob_proxy_pb_utils.h"
 #include "proxy/mysql/ob_mysql_global_session_manager.h"
+#include "proxy/mysqllib/ob_proxy_session_info_handler.h"
 
 using namespace oceanbase::common;
 using namespace oceanbase::common::hash;
@@ -73,10 +74,12 @@ ObMysqlClientSession::ObMysqlClientSession()
       magic_(MYSQL_CS_MAGIC_DEAD), create_thread_(NULL), is_local_connection_(false),
       client_vc_(NULL), in_list_stat_(LIST_INIT), current_tid_(-1),
       cs_id_(0), proxy_sessid_(0), bound_ss_(NULL), cur_ss_(NULL), lii_ss_(NULL), last_bound_ss_(NULL), read_buffer_(NULL),
-      buffer_reader_(NULL), mysql_sm_(NULL), read_state_(MCS_INIT), ka_vio_(NULL),
+      buffer_reader_(NULL), recent_request_len_(0), mysql_sm_(NULL), read_state_(MCS_INIT), ka_vio_(NULL),
       server_ka_vio_(NULL), trace_stats_(NULL), select_plan_(NULL), ps_cache_(),
-      ps_id_(0), cursor_id_(CURSOR_ID_START), text_ps_cache_(), using_ldg_(false)
+      ps_id_(0), cursor_id_(CURSOR_ID_START), text_ps_cache_(), using_ldg_(false),
+      shared_pool_key_version_(-1), shared_pool_key_()
 {
+  shared_pool_key_buf_[0] = '\0';
   SET_HANDLER(&ObMysqlClientSession::main_handler);
   bool enable_session_pool = get_global_proxy_config().is_pool_mode
                              && get_global_proxy_config().enable_session_pool_for_no_sharding;
@@ -117,6 +120,7 @@ void ObMysqlClientSession::destroy()
     read_buffer_ = NULL;
   }
   buffer_reader_ = NULL;
+  recent_request_len_ = 0;
 
   set_sharding_select_log_plan(NULL);
 
@@ -155,6 +159,10 @@ void ObMysqlClientSession::destroy()
   is_first_dml_sql_got_ = false;
 
   schema_key_.reset();
+  shared_pool_key_version_ = -1;
+  shared_pool_key_.reset();
+  shared_pool_identity_.reset();
+  result_cache_dirty_tables_.reset();
   ObProxyClientSession::cleanup();
   create_thread_ = NULL;
   op_reclaim_free(this);
@@ -799,6 +807,7 @@ int ObMysqlClientSession::state_keep_alive(int event, void *data)
           // only after obproxy has sent handshake packet to client, client will send data to obproxy;
           // so in that case, client session must has been inited completed.
           // New transaction, need to spawn of new sm to process request
+          check_read_buffer_block_size();
           if (OB_FAIL(new_transaction())) {
             PROXY_CS_LOG(WARN, "fail to start new transaction", K(ret));
           }
@@ -1056,6 +1065,8 @@ int ObMysqlClientSession::release(ObIOBufferReader *r)
     handle_transaction_complete(r, close_cs);
 
     if (OB_LIKELY(!close_cs)) {
+      const bool need_release_buffer = mysql_sm_->trans_state_.mysql_config_params_->enable_client_read_buffer_release_;
+      const int64_t request_len = mysql_sm_->trans_state_.trans_info_.client_request_.get_packet_len();
       mysql_sm_ = NULL;
 
       // reset client read buffer water mark
@@ -1072,6 +1083,9 @@ int ObMysqlClientSession::release(ObIOBufferReader *r)
         }
       } else {
         read_state_ = MCS_KEEP_ALIVE;
+        if (need_release_buffer) {
+          release_idle_read_buffer(request_len);
+        }
         ka_vio_ = do_io_read(this, INT64_MAX, read_buffer_);
         if (OB_LIKELY(server_ka_vio_ != ka_vio_)) {
           client_vc_->add_to_keep_alive_lru();
@@ -1086,6 +1100,46 @@ int ObMysqlClientSession::release(ObIOBufferReader *r)
   return ret;
 }
 
+// An idle connection holds no read buffer block, the block is allocated again
+// when the next request arrives. Most connections only send small requests, so
+// the block size follows the recent request length instead of MYSQL_BUFFER_SIZE.
+void ObMysqlClientSession::release_idle_read_buffer(const int64_t request_len)
+{
+  static const int64_t MIN_READ_BUFFER_SIZE = BUFFER_SIZE_FOR_INDEX(BUFFER_SIZE_INDEX_1K);
+  recent_request_len_ = std::max(request_len, recent_request_len_ / 2);
+  if (read_buffer_->release_empty_blocks()) {
+    int64_t block_size = MIN_READ_BUFFER_SIZE;
+    while (block_size < recent_request_len_ && block_size < MYSQL_BUFFER_SIZE) {
+      block_size <<= 1;
+    }
+    read_buffer_->set_block_size(block_size);
+    MYSQL_INCREMENT_DYN_STAT(CLIENT_READ_BUFFER_RELEASE_COUNT);
+    PROXY_CS_LOG(DEBUG, "release idle client read buffer", K_(cs_id), K(request_len),
+                 K_(recent_request_len), K(block_size));
+  }
+}
+
+// The block sized by recent small requests is too small for a large request, it is
+// read into MYSQL_BUFFER_SIZE blocks as soon as the block is filled up or the packet
+// header shows a packet larger than the block, instead of a long chain of small blocks.
+void ObMysqlClientSession::check_read_buffer_block_size()
+{
+  const int64_t block_size = (NULL == read_buffer_ ? MYSQL_BUFFER_SIZE : read_buffer_->get_block_size());
+  if (block_size < MYSQL_BUFFER_SIZE && NULL != buffer_reader_) {
+    bool need_reset = (0 == read_buffer_->current_write_avail());
+    if (!need_reset && buffer_reader_->read_avail() >= MYSQL_NET_HEADER_LENGTH) {
+      char header[MYSQL_NET_HEADER_LENGTH];
+      buffer_reader_->copy(header, MYSQL_NET_HEADER_LENGTH);
+      need_reset = (static_cast<int64_t>(ob_uint3korr(header)) + MYSQL_NET_HEADER_LENGTH > block_size);
+    }
+    if (need_reset) {
+      read_buffer_->set_block_size(MYSQL_BUFFER_SIZE);
+      recent_request_len_ = MYSQL_BUFFER_SIZE;
+      PROXY_CS_LOG(DEBUG, "large request, reset client read buffer block size", K_(cs_id), K(block_size));
+    }
+  }
+}
+
 int ObMysqlClientSession::init_session_pool_info()
 {
   int ret = OB_SUCCESS;
@@ -1148,6 +1202,183 @@ int ObMysqlClientSession::acquire_svr_session_no_pool(const sockaddr &addr, ObMy
     if (OB_FAIL(session_manager_.acquire_server_session(addr, session_info_.get_full_username(), svr_session))) {
       PROXY_CS_LOG(DEBUG, "[acquire server session] fail to acquire server session from "
                           "server session pool", K_(cs_id), KPC(svr_session), K(ret));
+      if (can_use_shared_session_pool()) {
+        ret = acquire_svr_session_in_shared_pool(addr, svr_session);
+      }
+    }
+  }
+  return ret;
+}
+
+bool ObMysqlClientSession::can_use_shared_session_pool()
+{
+  return get_global_proxy_config().enable_shared_server_session_pool
+         && !is_proxy_mysql_client_
+         && !is_session_pool_client()
+         && !session_info_.is_sharding_user()
+         && NULL == session_info_.get_shard_connector()
+         && session_info_.is_oceanbase_server()
+         && NULL != this_ethread()->shared_ss_manager_;
+}
+
+int ObMysqlClientSession::get_shared_pool_key(ObString &key)
+{
+  int ret = OB_SUCCESS;
+  // last_insert_id is excluded, it changes too frequently and is checked by value when acquire
+  const int64_t version = session_info_.get_common_hot_sys_var_version()
+                          + session_info_.get_common_sys_var_version()
+                          + session_info_.get_hot_sys_var_version()
+                          + session_info_.get_sys_var_version()
+                          + session_info_.get_user_var_version()
+                          + session_info_.get_db_name_version();
+  if (version != shared_pool_key_version_ || shared_pool_key_.empty()) {
+    // the identity is the full session state, the key is only its hash,
+    // so the identity is compared again when a server session is acquired by the key
+    const ObString &database_name = session_info_.get_database_name();
+    shared_pool_identity_.reuse();
+    if (OB_FAIL(shared_pool_identity_.append_fmt("capability:%u database:%.*s;",
+                session_info_.get_orig_capability_flags().capability_,
+                database_name.length(), database_name.ptr()))) {
+      PROXY_CS_LOG(WARN, "fail to append shared pool identity", K_(cs_id), K(ret));
+    } else if (OB_FAIL(session_info_.field_mgr_.format_shared_pool_identity(shared_pool_identity_))) {
+      PROXY_CS_LOG(WARN, "fail to format shared pool identity", K_(cs_id), K(ret));
+    } else {
+      const ObString identity = shared_pool_identity_.string();
+      const uint64_t hash_val = murmurhash(identity.ptr(), identity.length(), 0);
+      const int64_t pos = snprintf(shared_pool_key_buf_, SHARED_POOL_KEY_BUF_LEN, "%lx", hash_val);
+      if (OB_UNLIKELY(pos <= 0) || OB_UNLIKELY(pos >= SHARED_POOL_KEY_BUF_LEN)) {
+        ret = OB_SIZE_OVERFLOW;
+        PROXY_CS_LOG(WARN, "fail to print shared pool key", K_(cs_id), K(pos), K(ret));
+      } else {
+        shared_pool_key_.assign_ptr(shared_pool_key_buf_, static_cast<int32_t>(pos));
+        shared_pool_key_version_ = version;
+      }
+    }
+    if (OB_FAIL(ret)) {
+      shared_pool_key_.reset();
+      shared_pool_identity_.reuse();
+    }
+  }
+  if (OB_SUCC(ret)) {
+    key = shared_pool_key_;
+  }
+  return ret;
+}
+
+int ObMysqlClientSession::acquire_svr_session_in_shared_pool(const sockaddr &addr, ObMysqlServerSession *&svr_session)
+{
+  int ret = OB_SUCCESS;
+  ObString key;
+  svr_session = NULL;
+  if (OB_FAIL(get_shared_pool_key(key))) {
+    PROXY_CS_LOG(WARN, "fail to get shared pool key", K_(cs_id), K(ret));
+  } else if (OB_FAIL(this_ethread()->get_shared_session_manager().acquire_server_session(
+                     key, addr, session_info_.get_full_username(), svr_session))) {
+    PROXY_CS_LOG(DEBUG, "[acquire server session] fail to acquire server session from "
+                        "shared server session pool", K_(cs_id), K(key), K(ret));
+  } else if (OB_ISNULL(svr_session)) {
+    ret = OB_ERR_UNEXPECTED;
+    PROXY_CS_LOG(WARN, "server session is null", K_(cs_id), K(ret));
+  } else if (OB_UNLIKELY(svr_session->shared_pool_identity_.string() != shared_pool_identity_.string())) {
+    // hash of the key collides, the session state is different, put it back
+    PROXY_CS_LOG(INFO, "[acquire server session] shared pool key collides, skip the server session",
+                 K_(cs_id), K(key), "ss_id", svr_session->ss_id_);
+    if (OB_FAIL(this_ethread()->get_shared_session_manager().release_session(key, *svr_session))) {
+      PROXY_CS_LOG(WARN, "fail to release server session back to shared pool, it will be closed",
+                   K_(cs_id), K(key), K(ret));
+      svr_session->do_io_close();
+    }
+    svr_session = NULL;
+    ret = OB_SESSION_NOT_FOUND;
+  } else {
+    ObServerSessionInfo &server_info = svr_session->get_session_info();
+    svr_session->shared_pool_identity_.reset();
+    uint64_t lii_hash = 0;
+    svr_session->set_client_session(*this);
+    SESSION_PROMETHEUS_STAT(session_info_, PROMETHEUS_CURRENT_SESSION, false, 1);
+    // server session has the same session vars as this client session,
+    // only take over the versions, so no sync is needed
+    if (OB_FAIL(ObProxySessionInfoHandler::assign_session_vars_version(session_info_, server_info))) {
+      PROXY_CS_LOG(WARN, "fail to assign session vars version", K_(cs_id), K(ret));
+    } else {
+      ObProxySessionInfoHandler::assign_database_version(session_info_, server_info);
+      if (OB_SUCCESS == session_info_.field_mgr_.calc_last_insert_id_hash(lii_hash)
+          && lii_hash == svr_session->shared_lii_hash_) {
+        ObProxySessionInfoHandler::assign_last_insert_id_version(session_info_, server_info);
+      } else {
+        // force sync last_insert_id
+        server_info.set_last_insert_id_version(-1);
+      }
+      PROXY_CS_LOG(DEBUG, "[acquire server session] succ to acquire server session from "
+                          "shared server session pool", K_(cs_id), K(key), "ss_id", svr_session->ss_id_);
+    }
+    if (OB_FAIL(ret)) {
+      svr_session->do_io_close();
+      svr_session = NULL;
+    }
+  }
+  return ret;
+}
+
+uint64_t ObMysqlClientSession::get_shared_server_session_hash(const sockaddr &addr)
+{
+  uint64_t hash = 0;
+  ObString key;
+  if (OB_SUCCESS == get_shared_pool_key(key)) {
+    hash = ObSharedServerSessionCounter::get_hash(key, addr);
+  }
+  return hash;
+}
+
+int ObMysqlClientSession::release_svr_session_to_shared_pool()
+{
+  int ret = OB_SUCCESS;
+  ObMysqlServerSession *svr_session = bound_ss_;
+  ObString key;
+  int64_t max_count = get_global_proxy_config().shared_server_session_pool_max_count;
+  if (OB_ISNULL(svr_session) || !can_use_shared_session_pool()) {
+    ret = OB_NOT_SUPPORTED;
+  } else if (svr_session->is_pool_session_
+             || svr_session->get_session_info().has_ps_or_cursor()
+             || 0 != svr_session->get_reader()->read_avail()) {
+    // server session which holds ps or cursor can not be shared
+    ret = OB_NOT_SUPPORTED;
+  } else if (this_ethread()->get_shared_session_manager().get_svr_session_count() >= max_count) {
+    ret = OB_SIZE_OVERFLOW;
+    PROXY_CS_LOG(DEBUG, "shared server session pool is full", K_(cs_id), K(max_count));
+  } else if (OB_FAIL(get_shared_pool_key(key))) {
+    PROXY_CS_LOG(WARN, "fail to get shared pool key", K_(cs_id), K(ret));
+  } else if (OB_FAIL(session_info_.field_mgr_.calc_last_insert_id_hash(svr_session->shared_lii_hash_))) {
+    PROXY_CS_LOG(WARN, "fail to calc last insert id hash", K_(cs_id), K(ret));
+  } else if (OB_FAIL(svr_session->shared_pool_identity_.assign(shared_pool_identity_.string()))) {
+    PROXY_CS_LOG(WARN, "fail to assign shared pool identity", K_(cs_id), K(ret));
+  } else {
+    // count it by the key it is lent with, the key changes if the session vars changed
+    ObSharedServerSessionCounter &counter = *this_ethread()->shared_ss_counter_;
+    const uint64_t conn_hash = ObSharedServerSessionCounter::get_hash(key, svr_session->server_ip_.sa_);
+    if (conn_hash != svr_session->shared_conn_hash_) {
+      if (0 != svr_session->shared_conn_hash_) {
+        counter.dec(svr_session->shared_conn_hash_);
+      }
+      svr_session->shared_conn_hash_ = counter.inc(conn_hash) ? conn_hash : 0;
+    }
+    attach_server_session(NULL);
+    if (svr_session == lii_ss_) {
+      lii_ss_ = NULL;
+    }
+    if (svr_session == last_bound_ss_) {
+      last_bound_ss_ = NULL;
+    }
+    SESSION_PROMETHEUS_STAT(session_info_, PROMETHEUS_CURRENT_SESSION, false, -1);
+    svr_session->clear_client_session();
+    if (OB_FAIL(this_ethread()->get_shared_session_manager().release_session(key, *svr_session))) {
+      PROXY_CS_LOG(WARN, "fail to release server session to shared pool, it will be closed",
+                   K_(cs_id), K(key), K(ret));
+      svr_session->do_io_close();
+    } else {
+      PROXY_CS_LOG(DEBUG, "[release server session] server session placed into shared pool",
+                   K_(cs_id), K(key), "ss_id", svr_session->ss_id_);
+      counter.wake_up_waiter(conn_hash);
     }
   }
   return ret;
@@ -21,6 +21,7 @@
 #include "proxy/mysql/ob_proxy_client_session.h"
 #include "proxy/mysql/ob_mysql_session_manager.h"
 #include "proxy/mysql/ob_prepare_statement_struct.h"
+#include "proxy/mysql/ob_result_cache.h"
 #include "proxy/route/ob_table_entry.h"
 #include "proxy/route/ob_ldc_location.h"
 #include "rpc/obmysql/packet/ompk_handshake.h"
@@ -96,6 +97,12 @@ public:
   int init_session_pool_info();
   int acquire_svr_session_in_session_pool(const sockaddr &addr, ObMysqlServerSession *&svr_session);
   int acquire_svr_session_no_pool(const sockaddr &addr, ObMysqlServerSession *&svr_session);
+  // shared server session pool of current net thread, see init_shared_session_manager_for_thread()
+  bool can_use_shared_session_pool();
+  int acquire_svr_session_in_shared_pool(const sockaddr &addr, ObMysqlServerSession *&svr_session);
+  int release_svr_session_to_shared_pool();
+  // hash of shared server sessions to addr with the same pool key in the counter of this thread, 0 if no pool key
+  uint64_t get_shared_server_session_hash(const sockaddr &addr);
   int64_t get_svr_session_count() const;
 
   ObMysqlServerSession *get_server_session() const { return bound_ss_; }
@@ -295,6 +302,11 @@ public:
   void set_using_ldg(const bool using_ldg) { using_ldg_ = using_ldg; }
   bool using_ldg() const { return using_ldg_; }
 
+  int get_shared_pool_key(common::ObString &key);
+  ObResultCacheDirtyTables &get_result_cache_dirty_tables() { return result_cache_dirty_tables_; }
+  // called when request data is read, see release_idle_read_buffer()
+  void check_read_buffer_block_size();
+
 private:
   static uint32_t get_next_ps_stmt_id();
 
@@ -305,6 +317,7 @@ private:
   int handle_delete_cluster();
 
   void set_tcp_init_cwnd();
+  void release_idle_read_buffer(const int64_t request_len);
 
   int fetch_tenant_by_vip();
   int get_vip_addr();
@@ -364,6 +377,7 @@ public:
 
 private:
   static const uint32_t LOCAL_IPV4_ADDR = 0x100007F;
+  static const int64_t SHARED_POOL_KEY_BUF_LEN = 32;
 
   enum ObClientReadState
   {
@@ -416,6 +430,7 @@ private:
 
   event::ObMIOBuffer *read_buffer_;
   event::ObIOBufferReader *buffer_reader_;
+  int64_t recent_request_len_; // max request len of recent transactions, halved every transaction
   ObMysqlSM *mysql_sm_;
   ObClientReadState read_state_;
 
@@ -436,6 +451,16 @@ private:
   uint32_t cursor_id_;
   ObBasePsEntryCache text_ps_cache_;
   bool using_ldg_;
+
+  // key of the shared server session pool, it is the fingerprint of session state
+  // which need sync to server session, and only recalculated when var version changed
+  int64_t shared_pool_key_version_;
+  char shared_pool_key_buf_[SHARED_POOL_KEY_BUF_LEN];
+  common::ObString shared_pool_key_;
+  // the full session state which shared_pool_key_ is hashed from
+  common::ObSqlString shared_pool_identity_;
+  // tables written by current transaction, see ObResultCacheDirtyTables
+  ObResultCacheDirtyTables result_cache_dirty_tables_;
 private:
   DISALLOW_COPY_AND_ASSIGN(ObMysqlClientSession);
 };
@@ -15,6 +15,8 @@
 #include "proxy/api/ob_plugin.h"
 #include "proxy/mysql/ob_mysql_sm.h"
 #include "proxy/mysql/ob_mysql_session_accept.h"
+#include "proxy/mysql/ob_mysql_sm_time_histogram.h"
+#include "proxy/mysql/ob_sqlaudit_ring.h"
 #include "proxy/route/ob_table_cache.h"
 #include "proxy/route/ob_partition_cache.h"
 #include "proxy/route/ob_routine_cache.h"
@@ -59,6 +61,8 @@ int ObMysqlProxyServerMain::make_net_accept_options(
 
     net_opt.accept_threads_ = config_params.net_accept_threads_;
     net_opt.frequent_accept_ = config_params.frequent_accept_;
+    net_opt.reuse_port_ = config_params.enable_reuse_port_accept_;
+    net_opt.reuse_port_cpu_steering_ = config_params.enable_reuse_port_cpu_steering_;
     net_opt.ip_family_ = port.family_;
     net_opt.local_port_ = port.port_;
     net_opt.stacksize_ = config_params.stack_size_;
@@ -169,6 +173,7 @@ int ObMysqlProxyServerMain::start_processor_threads(const ObMysqlConfigParams &c
   int64_t blocking_threads = config_params.block_thread_num_; //thread for blocking task
   int64_t grpc_threads = config_params.grpc_thread_num_;
   int64_t grpc_watch_threads = 1;
+  int64_t ssl_handshake_threads = config_params.ssl_handshake_thread_num_;
   if (OB_UNLIKELY(stack_size <= 0) || OB_UNLIKELY(event_threads <= 0)
       || OB_UNLIKELY(task_threads <= 0)) {
     ret = OB_INVALID_CONFIG;
@@ -188,8 +193,12 @@ int ObMysqlProxyServerMain::start_processor_threads(const ObMysqlConfigParams &c
     LOG_ERROR("fail to start grpc task processor", K(stack_size), K(ret));
   } else if (OB_FAIL(g_shard_watch_task_processor.start(grpc_watch_threads, stack_size))) {
     LOG_ERROR("fail to start grpc parent task processor", K(stack_size), K(ret));
+  } else if (OB_FAIL(g_ssl_processor.start_handshake_threads(ssl_handshake_threads, stack_size))) {
+    LOG_ERROR("fail to start ssl handshake threads", K(ssl_handshake_threads), K(stack_size), K(ret));
   } else if (OB_FAIL(init_cs_map_for_thread())) {
     LOG_ERROR("fail to init cs_map for thread", K(ret));
+  } else if (OB_FAIL(init_shared_session_manager_for_thread())) {
+    LOG_ERROR("fail to init shared session manager for thread", K(ret));
   } else if (OB_FAIL(init_table_map_for_thread())) {
     LOG_ERROR("fail to init table_map for thread", K(ret));
   } else if (OB_FAIL(init_congestion_map_for_thread())) {
@@ -202,6 +211,10 @@ int ObMysqlProxyServerMain::start_processor_threads(const ObMysqlConfigParams &c
     LOG_ERROR("fail to init sql_table_map for thread", K(ret));
   } else if (OB_FAIL(init_random_seed_for_thread())) {
     LOG_ERROR("fail to init random seed for thread", K(ret));
+  } else if (OB_FAIL(init_cmd_time_histograms_for_thread())) {
+    LOG_ERROR("fail to init cmd time histograms for thread", K(ret));
+  } else if (OB_FAIL(init_sqlaudit_rings_for_thread())) {
+    LOG_ERROR("fail to init sqlaudit rings for thread", K(ret));
   } else {}
   return ret;
 }
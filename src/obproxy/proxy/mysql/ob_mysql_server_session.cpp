@@ -53,6 +53,7 @@ void ObMysqlServerSession::destroy()
   buf_reader_ = NULL;
   mutex_.release();
   schema_key_.reset();
+  shared_pool_identity_.reset();
   op_reclaim_free(this);
 }
 
@@ -157,6 +158,15 @@ void ObMysqlServerSession::do_io_close(const int alerrno)
     server_vc_ = NULL;
   }
 
+  if (0 != shared_conn_hash_) {
+    if (OB_LIKELY(NULL != this_ethread()->shared_ss_counter_)) {
+      // a waiter of the same hash may open a new one now
+      this_ethread()->shared_ss_counter_->dec(shared_conn_hash_);
+      this_ethread()->shared_ss_counter_->wake_up_waiter(shared_conn_hash_);
+    }
+    shared_conn_hash_ = 0;
+  }
+
   MYSQL_SUM_GLOBAL_DYN_STAT(CURRENT_SERVER_CONNECTIONS, -1); // Make sure to work on the global stat
   MYSQL_SUM_DYN_STAT(TRANSACTIONS_PER_SERVER_CON, transact_count_);
 
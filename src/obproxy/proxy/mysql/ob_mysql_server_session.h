@@ -87,7 +87,7 @@ public:
       : event::ObVConnection(NULL), server_sessid_(0), ss_id_(0), transact_count_(0),
         state_(MSS_INIT), server_trans_stat_(0),
         read_buffer_(NULL), is_pool_session_(false), has_global_session_lock_(false),
-        create_time_(0), last_active_time_(0),
+        create_time_(0), last_active_time_(0), shared_lii_hash_(0), shared_conn_hash_(0),
         is_inited_(false), magic_(MYSQL_SS_MAGIC_DEAD), server_vc_(NULL),
         buf_reader_(NULL), client_session_(NULL)
   {
@@ -218,6 +218,12 @@ public:
   ObProxySchemaKey schema_key_;
   int64_t create_time_;
   int64_t last_active_time_;
+  // hash of last_insert_id value when lent to the shared server session pool
+  uint64_t shared_lii_hash_;
+  // hash in the shared server session counter of this thread, 0 if not counted
+  uint64_t shared_conn_hash_;
+  // session state of the client session which lent it to the shared server session pool
+  common::ObSqlString shared_pool_identity_;
 
 private:
   static int64_t get_next_ss_id();
@@ -12,6 +12,7 @@
 
 #define USING_LOG_PREFIX PROXY
 #include "proxy/mysql/ob_mysql_session_manager.h"
+#include "proxy/mysql/ob_mysql_sm.h"
 
 using namespace oceanbase::common;
 using namespace oceanbase::common::hash;
@@ -361,6 +362,121 @@ void ObMysqlSessionManagerNew::purge_keepalives()
   }
 }
 
+ObSharedServerSessionCounter::ObCounterItem *ObSharedServerSessionCounter::find(const uint64_t hash) const
+{
+  ObCounterItem *ret_item = NULL;
+  const ObCounterItem *item = NULL;
+  for (int64_t i = 0; NULL == ret_item && i < MAX_ITEM_COUNT; ++i) {
+    item = &items_[(hash + i) % MAX_ITEM_COUNT];
+    if (hash == item->hash_) {
+      ret_item = const_cast<ObCounterItem *>(item);
+    } else if (0 == item->hash_) {
+      break;
+    }
+  }
+  return ret_item;
+}
+
+bool ObSharedServerSessionCounter::inc(const uint64_t hash)
+{
+  ObCounterItem *ret_item = find(hash);
+  if (NULL == ret_item) {
+    ObCounterItem *item = NULL;
+    for (int64_t i = 0; NULL == ret_item && i < MAX_ITEM_COUNT; ++i) {
+      item = &items_[(hash + i) % MAX_ITEM_COUNT];
+      if (0 == item->hash_ || 0 == item->count_) {
+        item->hash_ = hash;
+        item->count_ = 0;
+        ret_item = item;
+      }
+    }
+  }
+  if (NULL != ret_item) {
+    ++ret_item->count_;
+  }
+  return NULL != ret_item;
+}
+
+void ObSharedServerSessionCounter::dec(const uint64_t hash)
+{
+  ObCounterItem *item = find(hash);
+  if (NULL != item && item->count_ > 0) {
+    --item->count_;
+  }
+}
+
+int64_t ObSharedServerSessionCounter::get(const uint64_t hash) const
+{
+  const ObCounterItem *item = find(hash);
+  return NULL == item ? 0 : item->count_;
+}
+
+void ObSharedServerSessionCounter::add_waiter(ObSharedServerSessionWaiter &waiter, const uint64_t hash)
+{
+  if (0 == waiter.hash_) {
+    waiter.hash_ = hash;
+    waiters_.enqueue(&waiter);
+  }
+}
+
+void ObSharedServerSessionCounter::remove_waiter(ObSharedServerSessionWaiter &waiter)
+{
+  if (0 != waiter.hash_) {
+    waiters_.remove(&waiter);
+    waiter.hash_ = 0;
+  }
+}
+
+ObSharedServerSessionWaiter *ObSharedServerSessionCounter::pop_waiter(const uint64_t hash)
+{
+  ObSharedServerSessionWaiter *waiter = waiters_.head_;
+  while (NULL != waiter && hash != waiter->hash_) {
+    waiter = waiter->link_.next_;
+  }
+  if (NULL != waiter) {
+    remove_waiter(*waiter);
+  }
+  return waiter;
+}
+
+void ObSharedServerSessionCounter::wake_up_waiter(const uint64_t hash)
+{
+  ObSharedServerSessionWaiter *waiter = NULL;
+  if (!waiters_.empty() && NULL != (waiter = pop_waiter(hash)) && NULL != waiter->sm_) {
+    waiter->sm_->wake_up_shared_server_session_waiter();
+  }
+}
+
+uint64_t ObSharedServerSessionCounter::get_hash(const ObString &pool_key, const sockaddr &addr)
+{
+  uint64_t hash = murmurhash(pool_key.ptr(), pool_key.length(), 0);
+  hash = murmurhash(&addr, sizeof(addr), hash);
+  // 0 marks an empty item
+  return 0 == hash ? 1 : hash;
+}
+
+int init_shared_session_manager_for_thread()
+{
+  int ret = OB_SUCCESS;
+  const int64_t event_thread_count = g_event_processor.thread_count_for_type_[ET_CALL];
+  ObEThread *ethread = NULL;
+  for (int64_t i = 0; i < event_thread_count && OB_SUCC(ret); ++i) {
+    if (OB_ISNULL(ethread = g_event_processor.event_thread_[ET_CALL][i])) {
+      ret = OB_ERR_UNEXPECTED;
+      LOG_WARN("ethread is null", K(i), K(ret));
+    } else if (OB_ISNULL(ethread->shared_ss_manager_ = new (std::nothrow) ObMysqlSessionManagerNew())) {
+      ret = OB_ALLOCATE_MEMORY_FAILED;
+      LOG_WARN("fail to new ObMysqlSessionManagerNew", K(i), K(ret));
+    } else if (OB_ISNULL(ethread->shared_ss_counter_ = new (std::nothrow) ObSharedServerSessionCounter())) {
+      ret = OB_ALLOCATE_MEMORY_FAILED;
+      LOG_WARN("fail to new ObSharedServerSessionCounter", K(i), K(ret));
+    } else {
+      ethread->shared_ss_manager_->set_mutex(ethread->mutex_);
+    }
+  }
+  return ret;
+}
+
 } // end of namespace proxy
 } // end of namespace obproxy
 } // end of namespace oceanbase
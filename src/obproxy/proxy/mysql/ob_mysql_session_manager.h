@@ -186,6 +186,71 @@ private:
   DISALLOW_COPY_AND_ASSIGN(ObMysqlSessionManagerNew);
 };
 
+class ObMysqlSM;
+
+// a request waiting for a busy shared server session, embedded in ObMysqlSM
+struct ObSharedServerSessionWaiter
+{
+  ObSharedServerSessionWaiter() : hash_(0), sm_(NULL) {}
+  explicit ObSharedServerSessionWaiter(ObMysqlSM *sm) : hash_(0), sm_(sm) {}
+
+  uint64_t hash_;
+  ObMysqlSM *sm_;
+  LINK(ObSharedServerSessionWaiter, link_);
+};
+
+// Live server sessions which take part in the shared pool of one net thread,
+// lent or in use, counted by the hash of pool key and server addr.
+//
+// When the count reaches shared_server_session_max_per_server, autocommit select
+// requests are queued here to wait for one of them instead of opening a new server
+// session. When one is lent back or closed, the first waiter of the same hash is
+// woken up. It is a linear probing table only accessed by its owner thread, the
+// items whose count drops to zero are reused by new hashes.
+class ObSharedServerSessionCounter
+{
+public:
+  static const int64_t MAX_ITEM_COUNT = 1024;
+
+  ObSharedServerSessionCounter() { MEMSET(items_, 0, sizeof(items_)); }
+  ~ObSharedServerSessionCounter() { }
+
+  // returns false if the table is full, the session is not counted then
+  bool inc(const uint64_t hash);
+  void dec(const uint64_t hash);
+  int64_t get(const uint64_t hash) const;
+
+  void add_waiter(ObSharedServerSessionWaiter &waiter, const uint64_t hash);
+  void remove_waiter(ObSharedServerSessionWaiter &waiter);
+  // the first waiter of hash, it is removed from the queue
+  ObSharedServerSessionWaiter *pop_waiter(const uint64_t hash);
+  // a session of hash is lent back or closed, wake up the first waiter of it
+  void wake_up_waiter(const uint64_t hash);
+  int64_t get_waiter_count() const { return waiters_.size_; }
+
+  static uint64_t get_hash(const common::ObString &pool_key, const sockaddr &addr);
+
+private:
+  struct ObCounterItem
+  {
+    uint64_t hash_;
+    int64_t count_;
+  };
+  ObCounterItem *find(const uint64_t hash) const;
+
+private:
+  ObCounterItem items_[MAX_ITEM_COUNT];
+  common::CountQueue<ObSharedServerSessionWaiter> waiters_;
+  DISALLOW_COPY_AND_ASSIGN(ObSharedServerSessionCounter);
+};
+
+// every net thread owns one shared session manager, idle server sessions of
+// non-pool clients are lent to it after transaction complete and can be
+// acquired by other client sessions of the same thread. it is only accessed
+// by its owner thread, so the thread mutex is used and no extra lock is needed.
+// the shared server session counter of the thread is created together.
+int init_shared_session_manager_for_thread();
+
 } // end of namespace proxy
 } // end of namespace obproxy
 } // end of namespace oceanbase
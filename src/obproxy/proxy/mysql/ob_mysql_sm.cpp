@@ -38,12 +38,16 @@
 #include "obutils/ob_resource_pool_processor.h"
 #include "proxy/client/ob_client_vc.h"
 #include "proxy/route/ob_mysql_route.h"
+#include "proxy/route/ob_server_latency_stats.h"
 #include "proxy/mysqllib/ob_proxy_session_info_handler.h"
 #include "proxy/mysqllib/ob_mysql_request_builder.h"
 #include "proxy/mysqllib/ob_mysql_response_builder.h"
 #include "proxy/api/ob_plugin_vc.h"
 #include "proxy/mysql/ob_mysql_debug_names.h"
 #include "proxy/mysql/ob_prepare_statement_struct.h"
+#include "proxy/mysql/ob_mysql_sm_time_histogram.h"
+#include "proxy/mysql/ob_sqlaudit_ring.h"
+#include "proxy/mysql/ob_result_cache.h"
 #include "cmd/ob_show_sqlaudit_handler.h"
 #include "cmd/ob_show_databases_handler.h"
 #include "cmd/ob_show_tables_handler.h"
@@ -176,7 +180,9 @@ ObMysqlSM::ObMysqlSM()
       default_handler_(NULL), pending_action_(NULL), reentrancy_count_(0),
       terminate_sm_(false), kill_this_async_done_(false), handling_ssl_request_(false),
       need_renew_cluster_resource_(false), is_in_trans_(true),
-      retry_acquire_server_session_count_(0), start_acquire_server_session_time_(0)
+      retry_acquire_server_session_count_(0), start_acquire_server_session_time_(0),
+      shared_ss_wait_hash_(0), shared_ss_wait_time_(0), shared_ss_waiter_(this),
+      inflight_server_addr_()
 {
   static bool scatter_inited = false;
 
@@ -197,6 +203,7 @@ inline void ObMysqlSM::cleanup()
   //request_analyzer_.reset(); // no need
   api_.destroy();
   trans_state_.destroy();
+  result_cache_capture_.reset();
   mutex_.release();
   tunnel_.mutex_.release();
   magic_ = MYSQL_SM_MAGIC_DEAD;
@@ -503,6 +510,9 @@ int ObMysqlSM::state_client_request_read(int event, void *data)
       case VC_EVENT_READ_READY:
       case VC_EVENT_READ_COMPLETE:
         // More data to parse
+        if (NULL != client_session_) {
+          client_session_->check_read_buffer_block_size();
+        }
         break;
 
       case VC_EVENT_EOS: {
@@ -1547,6 +1557,8 @@ inline int ObMysqlSM::init_request_content(ObRequestAnalyzeCtx &ctx)
     ctx.request_buffer_length_ = trans_state_.mysql_config_params_->request_buffer_length_;
 
     ctx.using_ldg_ = client_session_->using_ldg();
+    ctx.enable_sql_parse_cache_ = trans_state_.mysql_config_params_->enable_sql_parse_cache_;
+    ctx.sql_parse_cache_entry_count_ = trans_state_.mysql_config_params_->sql_parse_cache_entry_count_;
   }
   return ret;
 }
@@ -1918,11 +1930,32 @@ int ObMysqlSM::do_analyze_ps_prepare_request(const ObString &ps_sql)
   ObClientSessionInfo &session_info = client_session_->get_session_info();
   ObProxyMysqlRequest &client_request = trans_state_.trans_info_.client_request_;
 
-  ObPsEntry *ps_entry = client_session_->get_ps_entry(ps_sql);
+  ObPsEntry *ps_entry = NULL;
   ObPsIdEntry *ps_id_entry = NULL;
-  bool is_new_ps_entry = false;
+  bool need_dec_ref = false;
+
+  if (get_global_proxy_config().enable_global_ps_cache) {
+    ObString cluster_name;
+    ObString tenant_name;
+    ObString database_name;
+    // names not set are left empty, they are only used to scope the entry
+    (void)session_info.get_cluster_name(cluster_name);
+    (void)session_info.get_tenant_name(tenant_name);
+    (void)session_info.get_database_name(database_name);
+    const uint64_t scope_hash = ObGlobalPsEntryCache::get_scope_hash(
+        cluster_name, tenant_name, database_name, session_info.is_oracle_mode());
+    if (OB_FAIL(get_global_ps_entry_cache().acquire_ps_entry(
+                scope_hash, ps_sql, client_request.get_parse_result(),
+                get_global_proxy_config().global_ps_cache_entry_count, ps_entry))) {
+      LOG_DEBUG("fail to acquire global ps entry, use session ps cache", K(ret));
+      ps_entry = NULL;
+      ret = OB_SUCCESS;
+    } else {
+      need_dec_ref = true;
+    }
+  }
 
-  if (NULL == ps_entry) {
+  if (NULL == ps_entry && NULL == (ps_entry = client_session_->get_ps_entry(ps_sql))) {
     if (OB_FAIL(ObPsEntry::alloc_and_init_ps_entry(ps_sql, client_request.get_parse_result(), ps_entry))) {
       LOG_WARN("fail to alloc and init ps entry", K(ret));
     } else if (OB_FAIL(client_session_->add_ps_entry(ps_entry))) {
@@ -1933,7 +1966,7 @@ int ObMysqlSM::do_analyze_ps_prepare_request(const ObString &ps_sql)
       }
     } else {
       ps_entry->inc_ref();
-      is_new_ps_entry = true;
+      need_dec_ref = true;
     }
   }
 
@@ -1954,7 +1987,7 @@ int ObMysqlSM::do_analyze_ps_prepare_request(const ObString &ps_sql)
     }
   }
 
-  if (is_new_ps_entry) {
+  if (need_dec_ref) {
     ps_entry->dec_ref();
     ps_entry = NULL;
   }
@@ -2592,6 +2625,7 @@ int ObMysqlSM::state_server_response_read(int event, void *data)
     milestones_.server_.server_read_begin_ = get_based_hrtime();
     cmd_time_stats_.server_process_request_time_ =
         milestone_diff(milestones_.server_.server_write_end_, milestones_.server_.server_read_begin_);
+    finish_server_inflight(true);
   }
 
   if (OB_SUCC(ret)) {
@@ -4176,6 +4210,9 @@ int ObMysqlSM::tunnel_handler_client(int event, ObMysqlTunnelConsumer &c)
         c.write_success_ = true;
         trans_state_.client_info_.abort_ = ObMysqlTransact::DIDNOT_ABORT;
         close_connection = false;
+        if (result_cache_capture_.is_completed()) {
+          fill_result_cache();
+        }
 
         ObRespAnalyzeResult &result = trans_state_.trans_info_.server_response_.get_analyze_result();
         if (result.is_error_resp()) {
@@ -4792,6 +4829,8 @@ inline int ObMysqlSM::do_internal_observer_open_event(int event, void* data)
 
   pending_action_ = NULL;
   MYSQL_SM_SET_DEFAULT_HANDLER(&ObMysqlSM::state_observer_open);
+  // woken up or timeout
+  remove_shared_server_session_waiter();
 
   if (OB_SUCC(do_internal_observer_open())) {
     retry_acquire_server_session_count_ = 0;
@@ -4825,10 +4864,19 @@ inline int ObMysqlSM::handle_retry_acquire_svr_session() {
     }
     int64_t blocking_timeout_ms = ObMysqlSessionUtils::get_session_blocking_timeout_ms(client_session_->schema_key_);
     int64_t diff_time = now_time - start_acquire_server_session_time_;
+    const uint64_t shared_ss_wait_hash = shared_ss_wait_hash_;
+    shared_ss_wait_hash_ = 0;
     if (diff_time < blocking_timeout_ms) {
+      if (0 != shared_ss_wait_hash && NULL != this_ethread()->shared_ss_counter_) {
+        // woken up once a shared server session of the hash is lent back or closed,
+        // the event only fires if none is in the wait time
+        this_ethread()->shared_ss_counter_->add_waiter(shared_ss_waiter_, shared_ss_wait_hash);
+        interval = shared_ss_wait_time_;
+      }
       MYSQL_SM_SET_DEFAULT_HANDLER(&ObMysqlSM::do_internal_observer_open_event);
       if (OB_ISNULL(pending_action_ = self_ethread().schedule_in(this, interval, CLIENT_SESSION_ACQUIRE_SERVER_SESSION_EVENT))) {
         LOG_WARN("fail to handle_retry_acquire_svr_session ", K(this), K(interval));
+        remove_shared_server_session_waiter();
         ret = OB_ERR_UNEXPECTED;
       } else {
         LOG_DEBUG("succ to retry acquire svr session", K(diff_time), K(interval));
@@ -4925,6 +4973,13 @@ inline int ObMysqlSM::do_oceanbase_internal_observer_open(ObMysqlServerSession *
     } else {
       const bool need_close_last_ss = need_close_last_used_ss();
       ret = client_session_->acquire_svr_session(trans_state_.server_info_.addr_.sa_, need_close_last_ss, selected_session);
+      if (OB_SESSION_NOT_FOUND == ret && NULL == selected_session && need_wait_shared_server_session()) {
+        // queued by handle_retry_acquire_svr_session() until a shared server session is available
+        ret = OB_SESSION_POOL_FULL_ERROR;
+        LOG_DEBUG("wait for busy server session of shared pool", K_(sm_id),
+                  "server_ip", trans_state_.server_info_.addr_, K_(shared_ss_wait_time),
+                  K_(retry_acquire_server_session_count));
+      }
       if ((OB_SUCCESS == ret && NULL != selected_session)
           || (OB_SESSION_NOT_FOUND == ret && NULL == selected_session)) {
         ret = OB_SUCCESS;
@@ -4932,8 +4987,10 @@ inline int ObMysqlSM::do_oceanbase_internal_observer_open(ObMysqlServerSession *
         // now last is release
         client_session_->attach_server_session(NULL);
         server_entry_ = NULL;
-        LOG_WARN("server session pool is full", K_(sm_id), K(selected_session),
-                 "server_ip", trans_state_.server_info_.addr_, K(ret));
+        if (client_session_->is_session_pool_client()) {
+          LOG_WARN("server session pool is full", K_(sm_id), K(selected_session),
+                   "server_ip", trans_state_.server_info_.addr_, K(ret));
+        }
       } else {
         ret = OB_ERR_UNEXPECTED;
         LOG_WARN("failed to acquire server session", K_(sm_id), K(selected_session),
@@ -4945,6 +5002,63 @@ inline int ObMysqlSM::do_oceanbase_internal_observer_open(ObMysqlServerSession *
   return ret;
 }
 
+inline bool ObMysqlSM::need_wait_shared_server_session()
+{
+  bool bret = false;
+  const int64_t max_count = get_global_proxy_config().shared_server_session_max_per_server;
+  if (max_count > 0
+      && OB_MYSQL_COM_QUERY == trans_state_.trans_info_.sql_cmd_
+      && !trans_state_.is_hold_start_trans_
+      && !ObMysqlTransact::is_in_trans(trans_state_)
+      && client_session_->can_use_shared_session_pool()) {
+    ObClientSessionInfo &client_info = client_session_->get_session_info();
+    ObSqlParseResult &parse_result = trans_state_.trans_info_.client_request_.get_parse_result();
+    if (parse_result.is_select_stmt()
+        && !client_info.is_trans_specified()
+        && 1 == client_info.get_cached_variables().get_autocommit()) {
+      // never wait longer than the session pool retry does
+      int64_t timeout = HRTIME_USECONDS(get_global_proxy_config().shared_server_session_wait_timeout);
+      const int64_t blocking_timeout = ObMysqlSessionUtils::get_session_blocking_timeout_ms(client_session_->schema_key_);
+      timeout = std::min(timeout, blocking_timeout);
+      const int64_t wait_time = (0 == start_acquire_server_session_time_)
+                                ? 0 : event::get_hrtime() - start_acquire_server_session_time_;
+      const uint64_t conn_hash = client_session_->get_shared_server_session_hash(trans_state_.server_info_.addr_.sa_);
+      if (wait_time < timeout && 0 != conn_hash
+          && this_ethread()->shared_ss_counter_->get(conn_hash) >= max_count) {
+        shared_ss_wait_hash_ = conn_hash;
+        shared_ss_wait_time_ = timeout - wait_time;
+        bret = true;
+      }
+    }
+  }
+  return bret;
+}
+
+inline void ObMysqlSM::remove_shared_server_session_waiter()
+{
+  if (0 != shared_ss_waiter_.hash_ && NULL != this_ethread()->shared_ss_counter_) {
+    this_ethread()->shared_ss_counter_->remove_waiter(shared_ss_waiter_);
+  }
+}
+
+void ObMysqlSM::wake_up_shared_server_session_waiter()
+{
+  int ret = OB_SUCCESS;
+  ObAction *action = NULL;
+  if (NULL != pending_action_) {
+    // the wait timeout event is replaced by an immediate one
+    if (OB_ISNULL(action = self_ethread().schedule_imm(this, CLIENT_SESSION_ACQUIRE_SERVER_SESSION_EVENT))) {
+      LOG_WARN("fail to wake up shared server session waiter, wait for timeout", K_(sm_id));
+    } else if (OB_FAIL(pending_action_->cancel())) {
+      LOG_WARN("fail to cancel shared server session wait timeout", K_(sm_id), K(ret));
+      (void)action->cancel();
+    } else {
+      pending_action_ = action;
+      LOG_DEBUG("wake up shared server session waiter", K_(sm_id));
+    }
+  }
+}
+
 inline int ObMysqlSM::do_normal_internal_observer_open(ObMysqlServerSession *&selected_session)
 {
   int ret = OB_SUCCESS;
@@ -5130,7 +5244,9 @@ void ObMysqlSM::do_internal_request()
 {
   int ret = OB_SUCCESS;
   LOG_DEBUG("[ObMysqlSM::do_internal_request] Doing internal request", K_(sm_id));
-  MYSQL_INCREMENT_TRANS_STAT(CLIENT_INTERNAL_REQUESTS);
+  if (!trans_state_.is_result_cache_hit_) {
+    MYSQL_INCREMENT_TRANS_STAT(CLIENT_INTERNAL_REQUESTS);
+  }
   ObMIOBuffer *buf = NULL;
   bool send_response_direct = true;
 
@@ -5149,6 +5265,10 @@ void ObMysqlSM::do_internal_request()
   } else if (OB_FAIL(trans_state_.alloc_internal_buffer(MYSQL_BUFFER_SIZE))) {
     LOG_ERROR("[ObMysqlSM::do_internal_request] fail to allocate internal buffer,",
               K_(sm_id), K(ret));
+  } else if (trans_state_.is_result_cache_hit_) {
+    // the response has been copied into internal buffer from result cache
+    LOG_DEBUG("[ObMysqlSM::do_internal_request] send response from result cache", K_(sm_id),
+              "data_len", trans_state_.internal_reader_->read_avail());
   } else {
     buf = trans_state_.internal_buffer_;
     switch (trans_state_.trans_info_.sql_cmd_) {
@@ -5599,6 +5719,176 @@ void ObMysqlSM::do_internal_request()
   }
 }
 
+int ObMysqlSM::get_result_cache_scope_hash(uint64_t &scope_hash)
+{
+  int ret = OB_SUCCESS;
+  ObClientSessionInfo &session_info = client_session_->get_session_info();
+  ObString session_key;
+  if (OB_FAIL(client_session_->get_shared_pool_key(session_key))) {
+    LOG_WARN("fail to get session key", K_(sm_id), K(ret));
+  } else {
+    ObString cluster_name;
+    ObString tenant_name;
+    ObString user_name;
+    ObString database_name;
+    // names not set are left empty, they are only used to scope the entry
+    (void)session_info.get_cluster_name(cluster_name);
+    (void)session_info.get_tenant_name(tenant_name);
+    (void)session_info.get_user_name(user_name);
+    (void)session_info.get_database_name(database_name);
+    scope_hash = session_info.is_oracle_mode() ? 1 : 0;
+    scope_hash = cluster_name.hash(scope_hash);
+    scope_hash = tenant_name.hash(scope_hash);
+    scope_hash = user_name.hash(scope_hash);
+    scope_hash = database_name.hash(scope_hash);
+    // session key covers capability, database and all session variables
+    scope_hash = session_key.hash(scope_hash);
+  }
+  return ret;
+}
+
+int64_t ObMysqlSM::get_result_cache_table_slot()
+{
+  ObClientSessionInfo &session_info = client_session_->get_session_info();
+  ObSqlParseResult &parse_result = trans_state_.trans_info_.client_request_.get_parse_result();
+  ObString cluster_name;
+  ObString tenant_name;
+  ObString database_name = parse_result.get_database_name();
+  (void)session_info.get_cluster_name(cluster_name);
+  (void)session_info.get_tenant_name(tenant_name);
+  if (database_name.empty()) {
+    (void)session_info.get_database_name(database_name);
+  }
+  const uint64_t tenant_hash = tenant_name.hash(cluster_name.hash(session_info.is_oracle_mode() ? 1 : 0));
+  return ObResultCache::get_table_slot(tenant_hash, database_name, parse_result.get_table_name());
+}
+
+bool ObMysqlSM::handle_result_cache_request()
+{
+  int ret = OB_SUCCESS;
+  bool is_hit = false;
+  ObProxyMysqlRequest &client_request = trans_state_.trans_info_.client_request_;
+  ObSqlParseResult &parse_result = client_request.get_parse_result();
+  ObClientSessionInfo &session_info = client_session_->get_session_info();
+  const ObMySQLCmd sql_cmd = trans_state_.trans_info_.sql_cmd_;
+  ObResultCache &result_cache = get_global_result_cache();
+
+  result_cache_capture_.reset();
+
+  // writes are tracked even if result cache is disabled, so that it is
+  // never stale when enabled
+  if (OB_MYSQL_COM_QUERY == sql_cmd
+      || OB_MYSQL_COM_STMT_EXECUTE == sql_cmd
+      || OB_MYSQL_COM_STMT_PREPARE_EXECUTE == sql_cmd) {
+    ObResultCacheDirtyTables &dirty_tables = client_session_->get_result_cache_dirty_tables();
+    ObString sql;
+    if (OB_MYSQL_COM_STMT_EXECUTE != sql_cmd) {
+      sql = client_request.get_sql();
+    } else if (OB_SUCCESS != session_info.get_ps_sql(sql)) {
+      sql.reset();
+    }
+    if (parse_result.is_ddl_stmt()
+        || parse_result.is_multi_stmt()
+        || parse_result.is_call_stmt()
+        || parse_result.is_text_ps_execute_stmt()
+        || parse_result.has_anonymous_block()
+        || OBPROXY_T_OTHERS == parse_result.get_stmt_type()
+        || (OB_MYSQL_COM_QUERY == sql_cmd && parse_result.is_invalid_stmt())
+        || (parse_result.is_write_stmt()
+            && (parse_result.get_table_name().empty()
+                || sql.empty()
+                || ObResultCache::is_multi_table_write(sql)))) {
+      result_cache.invalidate_all();
+      dirty_tables.add_all();
+      if (parse_result.is_ddl_stmt() && ObResultCache::is_temporary_table_ddl(sql)) {
+        session_info.set_temporary_table_used_flag();
+      }
+    } else if (parse_result.is_write_stmt()) {
+      const int64_t table_slot = get_result_cache_table_slot();
+      result_cache.invalidate_table(table_slot);
+      dirty_tables.add(table_slot);
+    }
+  }
+
+  if (get_global_proxy_config().enable_result_cache
+      && OB_MYSQL_COM_QUERY == sql_cmd
+      && parse_result.is_select_stmt()
+      && !parse_result.has_dependent_func()
+      && !parse_result.has_last_insert_id()
+      && 0 == client_request.get_packet_meta().pkt_seq_
+      && !client_request.is_large_request()
+      // the whole sql is saved, it is the key
+      && client_request.get_req_pkt().length() == MYSQL_NET_HEADER_LENGTH + client_request.get_packet_meta().pkt_len_
+      && !client_session_->is_proxy_mysql_client_
+      && !session_info.is_sharding_user()
+      && !trans_state_.is_hold_start_trans_
+      && !ObMysqlTransact::is_in_trans(trans_state_)
+      && !session_info.is_trans_specified()
+      && !session_info.is_temporary_table_used()
+      && 1 == session_info.get_cached_variables().get_autocommit()
+      && ObResultCache::is_cacheable_sql(client_request.get_sql())) {
+    ObResultCacheSnapshot snapshot;
+    if (OB_FAIL(get_result_cache_scope_hash(snapshot.scope_hash_))) {
+      LOG_WARN("fail to get result cache scope hash", K_(sm_id), K(ret));
+    } else if (OB_FAIL(trans_state_.alloc_internal_buffer(MYSQL_BUFFER_SIZE))) {
+      LOG_WARN("fail to allocate internal buffer", K_(sm_id), K(ret));
+    } else {
+      // sample versions before lookup, so that writes from now on make the
+      // response of this request stale
+      result_cache.take_snapshot(get_result_cache_table_slot(), snapshot);
+      const ObResultCacheKey key(snapshot.scope_hash_, client_request.get_sql());
+      if (OB_FAIL(result_cache.get(key, ObTimeUtility::current_time(),
+                                   *trans_state_.internal_buffer_, is_hit))) {
+        LOG_WARN("fail to get result cache", K_(sm_id), K(key), K(ret));
+        trans_state_.reset_internal_buffer();
+        is_hit = false;
+      } else if (is_hit) {
+        MYSQL_INCREMENT_TRANS_STAT(CLIENT_RESULT_CACHE_HIT_REQUESTS);
+        trans_state_.is_result_cache_hit_ = true;
+        LOG_DEBUG("result cache hit", K_(sm_id), K(key));
+      } else {
+        MYSQL_INCREMENT_TRANS_STAT(CLIENT_RESULT_CACHE_MISS_REQUESTS);
+        result_cache_capture_.start(snapshot, get_global_proxy_config().result_cache_max_entry_size);
+      }
+    }
+  }
+  return is_hit;
+}
+
+void ObMysqlSM::fill_result_cache()
+{
+  int ret = OB_SUCCESS;
+  ObRespAnalyzeResult &result = trans_state_.trans_info_.server_response_.get_analyze_result();
+  const ObResultCacheSnapshot &snapshot = result_cache_capture_.get_snapshot();
+  uint64_t scope_hash = 0;
+  if ((ObMysqlTransact::SOURCE_OBSERVER == trans_state_.source_
+       || (ObMysqlTransact::SOURCE_TRANSFORM == trans_state_.source_
+           && ObMysqlTransact::SOURCE_OBSERVER == trans_state_.pre_transform_source_))
+      && result.is_resultset_resp()
+      && result.is_resp_completed()
+      && result.is_trans_completed()
+      && !result.is_error_resp()
+      && !result.is_last_insert_id_changed()
+      && !result.has_new_sys_var()
+      && !result.is_server_db_reset()
+      && result_cache_capture_.get_data_len() > 0) {
+    // session may be changed by the response, then it does not belong to the key any more
+    if (OB_FAIL(get_result_cache_scope_hash(scope_hash))) {
+      LOG_WARN("fail to get result cache scope hash", K_(sm_id), K(ret));
+    } else if (scope_hash == snapshot.scope_hash_) {
+      const ObResultCacheKey key(scope_hash, trans_state_.trans_info_.client_request_.get_sql());
+      const int64_t expire_time_us = ObTimeUtility::current_time() + get_global_proxy_config().result_cache_ttl;
+      if (OB_FAIL(get_global_result_cache().put(key, snapshot, expire_time_us,
+                                                result_cache_capture_.get_data(),
+                                                result_cache_capture_.get_data_len(),
+                                                get_global_proxy_config().result_cache_mem_limited))) {
+        LOG_DEBUG("fail to put result cache", K_(sm_id), K(key), K(ret));
+      }
+    }
+  }
+  result_cache_capture_.reset();
+}
+
 inline void ObMysqlSM::set_client_abort(const ObMysqlTransact::ObAbortStateType client_abort, int event)
 {
   trans_state_.client_info_.abort_ = client_abort;
@@ -6315,6 +6605,7 @@ int ObMysqlSM::setup_server_request_send()
       milestones_.server_.reset();
       cmd_size_stats_.server_request_bytes_ = request_len;
       milestones_.server_.server_write_begin_ = get_based_hrtime();
+      start_server_inflight();
 
       if (0 == milestones_.server_first_write_begin_
           && (trans_state_.is_auth_request_
@@ -6636,6 +6927,9 @@ int ObMysqlSM::setup_server_transfer()
 
     client_entry_->in_tunnel_ = true;
     server_entry_->in_tunnel_ = true;
+    if (result_cache_capture_.is_started()) {
+      c->capture_ = &result_cache_capture_;
+    }
 
     ObMysqlResp &server_response = trans_state_.trans_info_.server_response_;
     ObIMysqlRespAnalyzer *analyzer = NULL;
@@ -6702,8 +6996,15 @@ int ObMysqlSM::setup_cmd_complete()
       set_client_connect_timeout();
     }
 
+    result_cache_capture_.reset();
+
     // stat reset
     if (ObMysqlTransact::TRANSACTION_COMPLETE == trans_state_.current_.state_) {
+      // other sessions may cache old rows of these tables until the transaction commits
+      ObResultCacheDirtyTables &dirty_tables = client_session_->get_result_cache_dirty_tables();
+      if (!dirty_tables.empty()) {
+        dirty_tables.invalidate();
+      }
       update_stats();
       client_session_->get_session_info().set_need_sync_session_vars(true);
       trans_stats_.reset();
@@ -6726,6 +7027,17 @@ int ObMysqlSM::setup_cmd_complete()
           }
         }
       }
+      // lend idle server session to the shared pool of this thread,
+      // other client sessions with the same session vars can reuse it
+      if (need_release && !trans_state_.is_hold_start_trans_
+          && !ObMysqlTransact::is_in_trans(trans_state_)
+          && !client_session_->get_session_info().is_trans_specified()
+          && NULL != client_session_->get_server_session()
+          && client_session_->can_use_shared_session_pool()) {
+        if (OB_SUCCESS != client_session_->release_svr_session_to_shared_pool()) {
+          LOG_DEBUG("server session is not lent to shared pool", K_(sm_id));
+        }
+      }
       is_updated_stat_ = false;
       history_pos_ = 0;
       is_in_trans_ = false;
@@ -6889,7 +7201,9 @@ void ObMysqlSM::kill_this()
              K_(sm_id), K_(pending_action), K_(api_.callout_state));
 
     update_stats();
+    finish_server_inflight(false);
 
+    remove_shared_server_session_waiter();
     if (MYSQL_API_NO_CALLOUT == api_.callout_state_ && NULL != pending_action_) {
       LOG_DEBUG("deallocating sm", K_(sm_id), K_(pending_action));
       if (OB_FAIL(pending_action_->cancel())) {
@@ -7044,6 +7358,29 @@ inline void ObMysqlSM::update_congestion_entry(const int event)
   }
 }
 
+inline void ObMysqlSM::start_server_inflight()
+{
+  finish_server_inflight(false);
+  if (trans_state_.mysql_config_params_->enable_latency_aware_routing_) {
+    inflight_server_addr_.set_ipv4_addr(trans_state_.server_info_.addr_.get_ip4_host_order(),
+        static_cast<int32_t>(trans_state_.server_info_.addr_.get_port_host_order()));
+    get_global_server_latency_stats().inc_inflight(inflight_server_addr_);
+  }
+}
+
+inline void ObMysqlSM::finish_server_inflight(const bool is_responded)
+{
+  if (inflight_server_addr_.is_valid()) {
+    ObServerLatencyStats &latency_stats = get_global_server_latency_stats();
+    latency_stats.dec_inflight(inflight_server_addr_);
+    if (is_responded && cmd_time_stats_.server_process_request_time_ > 0) {
+      latency_stats.update_latency(inflight_server_addr_,
+                                   hrtime_to_usec(cmd_time_stats_.server_process_request_time_));
+    }
+    inflight_server_addr_.reset();
+  }
+}
+
 inline void ObMysqlSM::get_server_session_ids(uint32_t &server_sessid, int64_t &ss_id)
 {
   ObMysqlServerSession *tmp_ss = NULL;
@@ -7119,6 +7456,39 @@ inline void ObMysqlSM::update_monitor_stats(const ObString &logic_tenant_name,
   get_global_tenant_stat_mgr().revert_item(item);
 }
 
+inline void ObMysqlSM::update_sqlaudit_ring(ObSqlauditRing &sqlaudit_ring)
+{
+  const ObMysqlConfigParams &params = *trans_state_.mysql_config_params_;
+  const int64_t slow_time_threshold = params.sqlaudit_ring_slow_query_time_threshold_;
+  const bool is_slow = slow_time_threshold > 0 && slow_time_threshold < cmd_time_stats_.request_total_time_;
+  int32_t error_code = 0;
+  ObString error_msg;
+  bool is_error_resp = false;
+  get_monitor_error_info(error_code, error_msg, is_error_resp);
+
+  if (sqlaudit_ring.need_record(is_slow, is_error_resp, params.sqlaudit_ring_sample_ratio_,
+                                params.sqlaudit_ring_error_sample_ratio_)) {
+    ObSqlauditRingRecord record;
+    MEMSET(&record, 0, sizeof(record));
+    record.flags_ = static_cast<int16_t>((is_slow ? SQLAUDIT_RING_FLAG_SLOW : 0)
+                                         | (is_error_resp ? SQLAUDIT_RING_FLAG_ERROR : 0));
+    record.sql_cmd_ = static_cast<int32_t>(trans_state_.trans_info_.sql_cmd_);
+    record.error_code_ = error_code;
+    record.sm_id_ = static_cast<int64_t>(sm_id_);
+    record.gmt_create_us_ = hrtime_to_usec(milestones_.client_.client_begin_);
+    record.request_total_time_us_ = hrtime_to_usec(cmd_time_stats_.request_total_time_);
+    record.server_process_time_us_ = hrtime_to_usec(cmd_time_stats_.server_process_request_time_);
+    record.proxy_process_time_us_ = hrtime_to_usec(cmd_time_stats_.prepare_send_request_to_server_time_);
+    trans_state_.server_info_.addr_.to_string(record.server_addr_, ObSqlauditRingRecord::SERVER_ADDR_LENGTH);
+    // print sql is cut to PRINT_SQL_LEN, the ring keeps up to sqlaudit_ring_sql_max_len
+    const obmysql::ObMySQLCmd sql_cmd = trans_state_.trans_info_.sql_cmd_;
+    const ObString sql = (obmysql::OB_MYSQL_COM_HANDSHAKE == sql_cmd || obmysql::OB_MYSQL_COM_LOGIN == sql_cmd)
+                         ? trans_state_.trans_info_.get_print_sql()
+                         : trans_state_.trans_info_.client_request_.get_sql();
+    sqlaudit_ring.record(record, sql, params.sqlaudit_ring_sql_max_len_);
+  }
+}
+
 inline void ObMysqlSM::get_monitor_error_info(int32_t &error_code, ObString &error_msg, bool &is_error_resp)
 {
   const char *msg = NULL;
@@ -7473,6 +7843,13 @@ inline void ObMysqlSM::update_cmd_stats()
   trans_stats_.send_start_trans_time_ += cmd_time_stats_.server_send_start_trans_time_;
   trans_stats_.build_server_request_time_ += cmd_time_stats_.build_server_request_time_;
 
+  if (trans_state_.mysql_config_params_->enable_cmd_time_histogram_) {
+    ObCmdTimeHistograms *histograms = this_ethread()->cmd_time_histograms_;
+    if (OB_LIKELY(NULL != histograms)) {
+      histograms->record(cmd_time_stats_);
+    }
+  }
+
   int64_t slow_time_threshold = trans_state_.mysql_config_params_->slow_query_time_threshold_;
   int64_t proxy_process_time_threshold = trans_state_.mysql_config_params_->slow_proxy_process_time_threshold_;
   const char *SLOW_QUERY = "Slow Query: ";
@@ -7585,6 +7962,11 @@ inline void ObMysqlSM::update_cmd_stats()
         trans_state_.trans_info_.get_print_sql(), trans_state_.trans_info_.sql_cmd_);
   }
 
+  ObSqlauditRing *sqlaudit_ring = this_ethread()->sqlaudit_ring_;
+  if (NULL != sqlaudit_ring) {
+    update_sqlaudit_ring(*sqlaudit_ring);
+  }
+
   ObMysqlTransact::client_result_stat(trans_state_);
 
   if (trans_state_.mysql_config_params_->enable_trans_detail_stats_) {
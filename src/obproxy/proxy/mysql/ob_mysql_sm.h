@@ -63,6 +63,7 @@ static int64_t const MYSQL_BUFFER_SIZE     = BUFFER_SIZE_FOR_INDEX(BUFFER_SIZE_I
 static const int64_t MYSQL_SM_LIST_BUCKETS = 64;
 
 class ObMysqlServerSession;
+class ObSqlauditRing;
 
 enum ObMysqlSMMagic
 {
@@ -210,6 +211,9 @@ public:
   void clear_client_entry();
   void clear_server_entry();
   bool can_server_session_release();
+  // track writes for result cache, and look up the response of current request,
+  // return true if it is copied into internal buffer
+  bool handle_result_cache_request();
   void release_server_session_to_pool();
   void release_server_session();
   bool need_close_last_used_ss();
@@ -226,6 +230,8 @@ public:
 
   int trim_ok_packet(event::ObIOBufferReader &reader);
   int use_set_pool_addr();
+  // a shared server session this request waits for is lent back or closed
+  void wake_up_shared_server_session_waiter();
 
   bool is_cloud_user() const;
   bool need_reject_user_login(const common::ObString &user,
@@ -318,6 +324,8 @@ private:
   void do_server_addr_lookup();
   int do_observer_open();
   int do_oceanbase_internal_observer_open(ObMysqlServerSession *&selected_session);
+  bool need_wait_shared_server_session();
+  void remove_shared_server_session_waiter();
   int do_normal_internal_observer_open(ObMysqlServerSession *&selected_session);
   int do_internal_observer_open();
   void do_internal_request();
@@ -335,6 +343,9 @@ private:
   int setup_server_request_send();
   int setup_server_transfer();
   int setup_internal_transfer(MysqlSMHandler handler);
+  int get_result_cache_scope_hash(uint64_t &scope_hash);
+  int64_t get_result_cache_table_slot();
+  void fill_result_cache();
   void setup_error_transfer();
   int setup_cmd_complete();
 
@@ -369,6 +380,8 @@ private:
   void update_safe_read_snapshot();
 
   void update_congestion_entry(const int event);
+  void start_server_inflight();
+  void finish_server_inflight(const bool is_responded);
   bool is_cached_dummy_entry_expired();
   void update_cached_dummy_entry(ObMysqlRouteResult &result);
 
@@ -381,6 +394,7 @@ private:
   void update_stats();
   void update_cmd_stats();
   void update_monitor_log();
+  void update_sqlaudit_ring(ObSqlauditRing &sqlaudit_ring);
   void get_monitor_error_info(int32_t &error_code,
                               ObString &error_msg,
                               bool &is_error_resp);
@@ -433,6 +447,15 @@ private:
   bool is_in_trans_;
   int32_t retry_acquire_server_session_count_;
   int64_t start_acquire_server_session_time_;
+  // the hash of busy shared server sessions to wait for, and the most time to wait
+  uint64_t shared_ss_wait_hash_;
+  ObHRTime shared_ss_wait_time_;
+  ObSharedServerSessionWaiter shared_ss_waiter_;
+  // valid while a request sent to this server is waiting for response
+  common::ObAddr inflight_server_addr_;
+  // response of current request written to client, saved into result cache
+  // once it is completed
+  ObResultCacheCapture result_cache_capture_;
 };
 
 inline ObMysqlSM *ObMysqlSM::allocate()
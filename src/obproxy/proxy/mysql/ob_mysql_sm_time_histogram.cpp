@@ -0,0 +1,172 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+
+#include "proxy/mysql/ob_mysql_sm_time_histogram.h"
+#include "proxy/mysql/ob_mysql_sm_time_stat.h"
+#include "iocore/eventsystem/ob_event_processor.h"
+
+using namespace oceanbase::common;
+using namespace oceanbase::obproxy::event;
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace proxy
+{
+
+void ObLatencyHistogram::merge(const ObLatencyHistogram &other)
+{
+  int64_t count = 0;
+  int64_t bucket_count = 0;
+  for (int64_t i = 0; i < BUCKET_COUNT; ++i) {
+    if (0 != (bucket_count = ATOMIC_LOAD(&other.counts_[i]))) {
+      counts_[i] += bucket_count;
+      count += bucket_count;
+    }
+  }
+  // count_ is the sum of the buckets read, so that percentiles stay consistent
+  count_ += count;
+  sum_ += ATOMIC_LOAD(&other.sum_);
+  const int64_t max = ATOMIC_LOAD(&other.max_);
+  if (max > max_) {
+    max_ = max;
+  }
+}
+
+int64_t ObLatencyHistogram::get_value_at_percentile(const double percentile) const
+{
+  int64_t value = 0;
+  if (count_ > 0) {
+    int64_t target = static_cast<int64_t>(static_cast<double>(count_) * percentile / 100.0 + 0.5);
+    target = (target < 1) ? 1 : ((target > count_) ? count_ : target);
+    int64_t total = 0;
+    for (int64_t i = 0; i < BUCKET_COUNT; ++i) {
+      total += counts_[i];
+      if (total >= target) {
+        value = get_bucket_upper_bound(i);
+        break;
+      }
+    }
+    value = (value > max_) ? max_ : value;
+  }
+  return value;
+}
+
+const char *get_cmd_time_histogram_name(const ObCmdTimeHistogramType type)
+{
+  static const char *names[CMD_TIME_HISTOGRAM_MAX_TYPE + 1] = {
+    "client_transaction_idle",
+    "client_request_read",
+    "client_request_analyze",
+    "cluster_resource_create",
+    "pl_lookup",
+    "pl_process",
+    "congestion_control",
+    "congestion_process",
+    "do_observer_open",
+    "server_connect",
+    "server_sync_session_variable",
+    "build_server_request",
+    "plugin_compress_request",
+    "prepare_send_request_to_server",
+    "server_request_write",
+    "server_process_request",
+    "server_response_read",
+    "plugin_decompress_response",
+    "server_response_analyze",
+    "ok_packet_trim",
+    "client_response_write",
+    "request_total",
+    "unknown"
+  };
+  return (type >= 0 && type < CMD_TIME_HISTOGRAM_MAX_TYPE) ? names[type] : names[CMD_TIME_HISTOGRAM_MAX_TYPE];
+}
+
+void ObCmdTimeHistograms::reset()
+{
+  for (int64_t i = 0; i < CMD_TIME_HISTOGRAM_MAX_TYPE; ++i) {
+    histograms_[i].reset();
+  }
+}
+
+inline void ObCmdTimeHistograms::record(const ObCmdTimeHistogramType type, const ObHRTime cost)
+{
+  if (cost > 0) {
+    histograms_[type].record(hrtime_to_usec(cost));
+  }
+}
+
+void ObCmdTimeHistograms::record(const ObCmdTimeStat &cmd_time_stats)
+{
+  record(CMD_TIME_CLIENT_TRANSACTION_IDLE, cmd_time_stats.client_transaction_idle_time_);
+  record(CMD_TIME_CLIENT_REQUEST_READ, cmd_time_stats.client_request_read_time_);
+  record(CMD_TIME_CLIENT_REQUEST_ANALYZE, cmd_time_stats.client_request_analyze_time_);
+  record(CMD_TIME_CLUSTER_RESOURCE_CREATE, cmd_time_stats.cluster_resource_create_time_);
+  record(CMD_TIME_PL_LOOKUP, cmd_time_stats.pl_lookup_time_);
+  record(CMD_TIME_PL_PROCESS, cmd_time_stats.pl_process_time_);
+  record(CMD_TIME_CONGESTION_CONTROL, cmd_time_stats.congestion_control_time_);
+  record(CMD_TIME_CONGESTION_PROCESS, cmd_time_stats.congestion_process_time_);
+  record(CMD_TIME_DO_OBSERVER_OPEN, cmd_time_stats.do_observer_open_time_);
+  record(CMD_TIME_SERVER_CONNECT, cmd_time_stats.server_connect_time_);
+  record(CMD_TIME_SERVER_SYNC_SESSION_VARIABLE, cmd_time_stats.server_sync_session_variable_time_);
+  record(CMD_TIME_BUILD_SERVER_REQUEST, cmd_time_stats.build_server_request_time_);
+  record(CMD_TIME_PLUGIN_COMPRESS_REQUEST, cmd_time_stats.plugin_compress_request_time_);
+  record(CMD_TIME_PREPARE_SEND_REQUEST_TO_SERVER, cmd_time_stats.prepare_send_request_to_server_time_);
+  record(CMD_TIME_SERVER_REQUEST_WRITE, cmd_time_stats.server_request_write_time_);
+  record(CMD_TIME_SERVER_PROCESS_REQUEST, cmd_time_stats.server_process_request_time_);
+  record(CMD_TIME_SERVER_RESPONSE_READ, cmd_time_stats.server_response_read_time_);
+  record(CMD_TIME_PLUGIN_DECOMPRESS_RESPONSE, cmd_time_stats.plugin_decompress_response_time_);
+  record(CMD_TIME_SERVER_RESPONSE_ANALYZE, cmd_time_stats.server_response_analyze_time_);
+  record(CMD_TIME_OK_PACKET_TRIM, cmd_time_stats.ok_packet_trim_time_);
+  record(CMD_TIME_CLIENT_RESPONSE_WRITE, cmd_time_stats.client_response_write_time_);
+  record(CMD_TIME_REQUEST_TOTAL, cmd_time_stats.request_total_time_);
+}
+
+void ObCmdTimeHistograms::merge(const ObCmdTimeHistograms &other)
+{
+  for (int64_t i = 0; i < CMD_TIME_HISTOGRAM_MAX_TYPE; ++i) {
+    histograms_[i].merge(other.histograms_[i]);
+  }
+}
+
+int init_cmd_time_histograms_for_thread()
+{
+  int ret = OB_SUCCESS;
+  const int64_t event_thread_count = g_event_processor.thread_count_for_type_[ET_CALL];
+  for (int64_t i = 0; i < event_thread_count && OB_SUCC(ret); ++i) {
+    if (OB_ISNULL(g_event_processor.event_thread_[ET_CALL][i]->cmd_time_histograms_
+                  = new (std::nothrow) ObCmdTimeHistograms())) {
+      ret = OB_ALLOCATE_MEMORY_FAILED;
+      LOG_WARN("fail to new ObCmdTimeHistograms", K(i), K(ret));
+    }
+  }
+  return ret;
+}
+
+void get_merged_cmd_time_histograms(ObCmdTimeHistograms &merged)
+{
+  merged.reset();
+  const int64_t event_thread_count = g_event_processor.thread_count_for_type_[ET_CALL];
+  ObCmdTimeHistograms *histograms = NULL;
+  for (int64_t i = 0; i < event_thread_count; ++i) {
+    if (NULL != (histograms = g_event_processor.event_thread_[ET_CALL][i]->cmd_time_histograms_)) {
+      merged.merge(*histograms);
+    }
+  }
+}
+
+} // end of namespace proxy
+} // end of namespace obproxy
+} // end of namespace oceanbase
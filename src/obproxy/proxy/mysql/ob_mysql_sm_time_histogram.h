@@ -0,0 +1,159 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#ifndef OBPROXY_MYSQL_SM_TIME_HISTOGRAM_H
+#define OBPROXY_MYSQL_SM_TIME_HISTOGRAM_H
+#include "lib/ob_define.h"
+#include "lib/time/ob_hrtime.h"
+#include "lib/atomic/ob_atomic.h"
+#include "lib/utility/ob_print_utils.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace proxy
+{
+struct ObCmdTimeStat;
+
+// Log linear latency histogram in us, every power of two is split into
+// SUB_BUCKET_COUNT linear buckets, so the relative error is below 1/16.
+//
+// Only the owner thread records, with plain stores. Other threads read the
+// counters without lock, a snapshot may miss the values being recorded.
+class ObLatencyHistogram
+{
+public:
+  static const int64_t SUB_BUCKET_BITS = 4;
+  static const int64_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+  static const int64_t MAX_VALUE_BITS = 40;                     // about 12 days
+  static const int64_t MAX_VALUE = (1LL << MAX_VALUE_BITS) - 1;
+  static const int64_t BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+  ObLatencyHistogram() { reset(); }
+  ~ObLatencyHistogram() {}
+
+  void reset() { MEMSET(this, 0, sizeof(ObLatencyHistogram)); }
+
+  void record(const int64_t value_us)
+  {
+    const int64_t value = (value_us < 0) ? 0 : ((value_us > MAX_VALUE) ? MAX_VALUE : value_us);
+    ++counts_[get_bucket_index(value)];
+    ++count_;
+    sum_ += value;
+    if (value > max_) {
+      max_ = value;
+    }
+  }
+
+  // add a snapshot of other to this, other may be recorded concurrently
+  void merge(const ObLatencyHistogram &other);
+
+  int64_t get_count() const { return count_; }
+  int64_t get_sum() const { return sum_; }
+  int64_t get_max() const { return max_; }
+  int64_t get_bucket_count(const int64_t index) const { return counts_[index]; }
+  // percentile is in [0, 100], returns the upper bound of the bucket it falls in
+  int64_t get_value_at_percentile(const double percentile) const;
+
+  static int64_t get_bucket_index(const int64_t value)
+  {
+    int64_t index = value;
+    if (value >= SUB_BUCKET_COUNT) {
+      const int64_t shift = (63 - __builtin_clzll(static_cast<uint64_t>(value))) - SUB_BUCKET_BITS;
+      index = (shift + 1) * SUB_BUCKET_COUNT + ((value >> shift) - SUB_BUCKET_COUNT);
+    }
+    return index;
+  }
+  // the max value which falls in the bucket
+  static int64_t get_bucket_upper_bound(const int64_t index)
+  {
+    int64_t upper_bound = index;
+    if (index >= SUB_BUCKET_COUNT) {
+      const int64_t shift = index / SUB_BUCKET_COUNT - 1;
+      upper_bound = (((index % SUB_BUCKET_COUNT) + SUB_BUCKET_COUNT + 1) << shift) - 1;
+    }
+    return upper_bound;
+  }
+
+  TO_STRING_KV(K_(count), K_(sum), K_(max));
+
+private:
+  int64_t count_;
+  int64_t sum_;
+  int64_t max_;
+  int64_t counts_[BUCKET_COUNT];
+};
+
+enum ObCmdTimeHistogramType
+{
+  CMD_TIME_CLIENT_TRANSACTION_IDLE = 0,
+  CMD_TIME_CLIENT_REQUEST_READ,
+  CMD_TIME_CLIENT_REQUEST_ANALYZE,
+  CMD_TIME_CLUSTER_RESOURCE_CREATE,
+  CMD_TIME_PL_LOOKUP,
+  CMD_TIME_PL_PROCESS,
+  CMD_TIME_CONGESTION_CONTROL,
+  CMD_TIME_CONGESTION_PROCESS,
+  CMD_TIME_DO_OBSERVER_OPEN,
+  CMD_TIME_SERVER_CONNECT,
+  CMD_TIME_SERVER_SYNC_SESSION_VARIABLE,
+  CMD_TIME_BUILD_SERVER_REQUEST,
+  CMD_TIME_PLUGIN_COMPRESS_REQUEST,
+  CMD_TIME_PREPARE_SEND_REQUEST_TO_SERVER,
+  CMD_TIME_SERVER_REQUEST_WRITE,
+  CMD_TIME_SERVER_PROCESS_REQUEST,
+  CMD_TIME_SERVER_RESPONSE_READ,
+  CMD_TIME_PLUGIN_DECOMPRESS_RESPONSE,
+  CMD_TIME_SERVER_RESPONSE_ANALYZE,
+  CMD_TIME_OK_PACKET_TRIM,
+  CMD_TIME_CLIENT_RESPONSE_WRITE,
+  CMD_TIME_REQUEST_TOTAL,
+  CMD_TIME_HISTOGRAM_MAX_TYPE
+};
+
+const char *get_cmd_time_histogram_name(const ObCmdTimeHistogramType type);
+
+// One histogram for each phase of ObCmdTimeStat, owned by one event thread.
+class ObCmdTimeHistograms
+{
+public:
+  ObCmdTimeHistograms() {}
+  ~ObCmdTimeHistograms() {}
+
+  void reset();
+  // record the phases the cmd went through, the ones which cost nothing are skipped
+  void record(const ObCmdTimeStat &cmd_time_stats);
+  void merge(const ObCmdTimeHistograms &other);
+
+  const ObLatencyHistogram &get_histogram(const ObCmdTimeHistogramType type) const
+  {
+    return histograms_[type];
+  }
+
+private:
+  void record(const ObCmdTimeHistogramType type, const ObHRTime cost);
+
+private:
+  ObLatencyHistogram histograms_[CMD_TIME_HISTOGRAM_MAX_TYPE];
+  DISALLOW_COPY_AND_ASSIGN(ObCmdTimeHistograms);
+};
+
+int init_cmd_time_histograms_for_thread();
+// merge the histograms of all event threads into merged
+void get_merged_cmd_time_histograms(ObCmdTimeHistograms &merged);
+
+} // end of namespace proxy
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+#endif /* OBPROXY_MYSQL_SM_TIME_HISTOGRAM_H */
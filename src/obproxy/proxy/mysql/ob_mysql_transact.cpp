@@ -991,6 +991,9 @@ void ObMysqlTransact::handle_request(ObTransState &s)
       TRANSACT_RETURN(SM_ACTION_INTERNAL_NOOP, NULL);
     } else if (!s.sm_->client_session_->get_session_info().is_oceanbase_server()) {
       handle_mysql_request(s);
+    } else if (s.sm_->handle_result_cache_request()) {
+      // response is ready in internal buffer
+      TRANSACT_RETURN(SM_ACTION_INTERNAL_REQUEST, handle_internal_request);
     } else {
       handle_oceanbase_request(s);
     }// end of NULL != s.sm_->client_session_
@@ -483,6 +483,7 @@ public:
           is_proxysys_tenant_(false),
           is_hold_start_trans_(false),
           send_reqeust_direct_(false),
+          is_result_cache_hit_(false),
           source_(SOURCE_NONE),
           pre_transform_source_(SOURCE_NONE),
           next_action_(SM_ACTION_UNDEFINED),
@@ -681,6 +682,7 @@ public:
       reset_internal_buffer();
       trans_info_.request_content_length_ = MYSQL_UNDEFINED_CL; // disable tunnel client request
       send_reqeust_direct_ = false;
+      is_result_cache_hit_ = false;
       is_rerouted_ = false;
       reroute_info_.reset();
 
@@ -776,6 +778,7 @@ public:
     bool is_proxysys_tenant_;
     bool is_hold_start_trans_; // indicate whether hold begin(start transaction)
     bool send_reqeust_direct_; // when send sync all session variables, we can send user request directly
+    bool is_result_cache_hit_; // internal_buffer_ holds the response copied from result cache
 
     ObSourceType source_;
     ObSourceType pre_transform_source_;
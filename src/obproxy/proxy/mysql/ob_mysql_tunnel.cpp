@@ -30,6 +30,7 @@
 
 #define USING_LOG_PREFIX PROXY_TUNNEL
 #include "proxy/mysql/ob_mysql_tunnel.h"
+#include "proxy/mysql/ob_result_cache.h"
 #include "proxy/mysql/ob_mysql_sm.h"
 #include "proxy/mysql/ob_mysql_debug_names.h"
 
@@ -223,7 +224,8 @@ ObMysqlTunnelConsumer::ObMysqlTunnelConsumer()
     : link_(), producer_(NULL), self_producer_(NULL),
       vc_type_(MT_MYSQL_CLIENT), vc_(NULL), buffer_reader_(NULL),
       vc_handler_(NULL), write_vio_(NULL), skip_bytes_(0),
-      bytes_written_(0), handler_state_(0), alive_(false),
+      bytes_written_(0), handler_state_(0), capture_(NULL),
+      capture_reader_(NULL), alive_(false),
       write_success_(false),  cost_time_(0), name_(NULL)
 {
 }
@@ -489,6 +491,15 @@ int ObMysqlTunnel::producer_run(ObMysqlTunnelProducer &p)
       }
     }
 
+    if (OB_SUCC(ret) && NULL != c->capture_ && NULL == c->capture_reader_) {
+      // capture failure never fails the tunnel
+      if (OB_ISNULL(c->capture_reader_ = c->buffer_reader_->clone())) {
+        LOG_WARN("failed to clone capture reader, abandon capture", K_(sm_->sm_id));
+        c->capture_->abandon();
+        c->capture_ = NULL;
+      }
+    }
+
     if (OB_SUCC(ret)) {
       if (OB_UNLIKELY(c_write < 0)) {
         ret = OB_ERR_SYS;
@@ -583,7 +594,10 @@ inline int ObMysqlTunnel::producer_handler_packet(int event, ObMysqlTunnelProduc
       // If we couldn't understand the encoding, return an error
       ObHRTime packet_analyze_begin = get_based_hrtime();
       uint8_t &request_pkt_seq = sm_->trans_state_.trans_info_.client_request_.get_packet_meta().pkt_seq_;
-      if (OB_UNLIKELY(OB_SUCCESS != p.packet_analyzer_.process_content(cmd_complete, trans_complete, request_pkt_seq))) {
+      if (OB_UNLIKELY(OB_SUCCESS != skip_spliced_bytes(p))) {
+        ret = VC_EVENT_ERROR;
+        break;
+      } else if (OB_UNLIKELY(OB_SUCCESS != p.packet_analyzer_.process_content(cmd_complete, trans_complete, request_pkt_seq))) {
         LOG_WARN("process response content analyze response error",
                  K_(sm_->sm_id), K_(p.name), K(cmd_complete), K(trans_complete));
         // FIX ME: we return EOS here since it will cause the
@@ -628,6 +642,7 @@ inline int ObMysqlTunnel::producer_handler_packet(int event, ObMysqlTunnelProduc
           ret = MYSQL_TUNNEL_EVENT_CMD_COMPLETE;
         }
       }
+      update_splice_target(p, VC_EVENT_READ_READY == ret);
       break;
     }
 
@@ -638,6 +653,56 @@ inline int ObMysqlTunnel::producer_handler_packet(int event, ObMysqlTunnelProduc
   return ret;
 }
 
+inline int ObMysqlTunnel::skip_spliced_bytes(ObMysqlTunnelProducer &p)
+{
+  int ret = OB_SUCCESS;
+  if (MT_MYSQL_SERVER == p.vc_type_ && NULL != p.vc_) {
+    ObUnixNetVConnection *server_vc = static_cast<ObUnixNetVConnection *>(
+        static_cast<ObMysqlServerSession *>(p.vc_)->get_netvc());
+    int64_t spliced_len = 0;
+    if (NULL != server_vc && (spliced_len = server_vc->consume_spliced_bytes()) > 0) {
+      // spliced bytes never enter the read buffer, tell analyzer to skip them
+      if (OB_ISNULL(p.packet_analyzer_.resp_analyzer_)) {
+        ret = OB_ERR_UNEXPECTED;
+        LOG_WARN("resp analyzer is null while bytes spliced", K_(sm_->sm_id), K(spliced_len), K(ret));
+      } else if (OB_FAIL(p.packet_analyzer_.resp_analyzer_->skip_body(spliced_len))) {
+        LOG_WARN("fail to skip spliced bytes", K_(sm_->sm_id), K(spliced_len), K(ret));
+      } else {
+        LOG_DEBUG("skip spliced bytes", K_(sm_->sm_id), K(spliced_len));
+      }
+    }
+  }
+  return ret;
+}
+
+// Only a resultset which goes to one client is spliced, and only when the rest
+// of current row packet body is large enough to pay for the two extra syscalls.
+inline void ObMysqlTunnel::update_splice_target(ObMysqlTunnelProducer &p, const bool is_reading)
+{
+  if (MT_MYSQL_SERVER == p.vc_type_ && NULL != p.vc_) {
+    ObUnixNetVConnection *server_vc = static_cast<ObUnixNetVConnection *>(
+        static_cast<ObMysqlServerSession *>(p.vc_)->get_netvc());
+    ObUnixNetVConnection *client_vc = NULL;
+    int64_t splice_len = 0;
+    ObMysqlTunnelConsumer *c = p.consumer_list_.head_;
+    if (is_reading && NULL != server_vc && p.alive_ && !p.is_throttled()
+        && sm_->trans_state_.mysql_config_params_->enable_splice_tunnel_
+        && NULL != c && NULL == c->link_.next_ && c->alive_ && NULL == c->capture_reader_
+        && MT_MYSQL_CLIENT == c->vc_type_ && NULL != c->vc_
+        && !static_cast<ObMysqlClientSession *>(c->vc_)->is_proxy_mysql_client_
+        && NULL != p.packet_analyzer_.resp_analyzer_) {
+      splice_len = p.packet_analyzer_.resp_analyzer_->get_skippable_body_len();
+      if (splice_len >= sm_->trans_state_.mysql_config_params_->splice_tunnel_min_size_) {
+        client_vc = static_cast<ObUnixNetVConnection *>(
+            static_cast<ObMysqlClientSession *>(c->vc_)->get_netvc());
+      }
+    }
+    if (NULL != server_vc) {
+      server_vc->set_splice_target(client_vc, splice_len);
+    }
+  }
+}
+
 // Handles events from producers.
 //
 // If the event is interesting only to the tunnel, this
@@ -757,6 +822,7 @@ bool ObMysqlTunnel::producer_handler(int event, ObMysqlTunnelProducer &p)
     case MYSQL_TUNNEL_EVENT_CONSUMER_DETACH:
       p.alive_ = false;
       p.bytes_read_ = p.read_vio_->ndone_;
+      update_splice_target(p, false);
       // Interesting tunnel event, call SM
       jump_point = p.vc_handler_;
       p.cost_time_ += (get_based_hrtime() - last_handler_event_time_);
@@ -897,6 +963,9 @@ bool ObMysqlTunnel::consumer_handler(int event, ObMysqlTunnelConsumer &c)
 
   switch (event) {
     case VC_EVENT_WRITE_READY:
+      if (NULL != c.capture_reader_) {
+        capture_written_bytes(c);
+      }
       consumer_reenable(c);
       break;
 
@@ -907,6 +976,11 @@ bool ObMysqlTunnel::consumer_handler(int event, ObMysqlTunnelConsumer &c)
     case VC_EVENT_INACTIVITY_TIMEOUT: {
       c.alive_ = false;
       c.bytes_written_ = c.write_vio_ ? c.write_vio_->ndone_ : 0;
+      update_splice_target(*p, false);
+      if (NULL != c.capture_reader_) {
+        // before calling back sm, so that it sees the whole response
+        finish_capture(c, VC_EVENT_WRITE_COMPLETE == event);
+      }
 
       // Interesting tunnel event, call SM
       jump_point = c.vc_handler_;
@@ -990,13 +1064,53 @@ bool ObMysqlTunnel::consumer_handler(int event, ObMysqlTunnelConsumer &c)
   return sm_callback;
 }
 
+void ObMysqlTunnel::capture_written_bytes(ObMysqlTunnelConsumer &c)
+{
+  int ret = OB_SUCCESS;
+  if (NULL != c.capture_ && NULL != c.capture_reader_ && !c.capture_->is_abandoned()) {
+    const int64_t written = (NULL != c.write_vio_ ? c.write_vio_->ndone_ : 0) - c.capture_->get_data_len();
+    if (written > 0 && OB_FAIL(c.capture_->append(*c.capture_reader_, written))) {
+      LOG_DEBUG("fail to capture written bytes, abandon capture", K_(sm_->sm_id), K(written), K(ret));
+    }
+  }
+  if (NULL != c.capture_ && c.capture_->is_abandoned()) {
+    // the lagging reader must not hold buffer blocks any more
+    finish_capture(c, false);
+  }
+}
+
+void ObMysqlTunnel::finish_capture(ObMysqlTunnelConsumer &c, const bool is_completed)
+{
+  if (NULL != c.capture_) {
+    if (is_completed) {
+      capture_written_bytes(c);
+    }
+    if (NULL == c.capture_) {
+      // abandoned while capturing
+    } else if (is_completed) {
+      c.capture_->complete();
+    } else {
+      c.capture_->abandon();
+    }
+    c.capture_ = NULL;
+  }
+  if (NULL != c.capture_reader_) {
+    c.capture_reader_->dealloc();
+    c.capture_reader_ = NULL;
+  }
+}
+
 // Abort the producer and everyone still alive
 // downstream of the producer
 void ObMysqlTunnel::chain_abort_all(ObMysqlTunnelProducer &p)
 {
   ObMysqlTunnelProducer *selfp = NULL;
 
+  update_splice_target(p, false);
   for (ObMysqlTunnelConsumer *c = p.consumer_list_.head_; NULL != c; c = c->link_.next_) {
+    if (NULL != c->capture_reader_) {
+      finish_capture(*c, false);
+    }
     if (c->alive_) {
       c->alive_ = false;
       c->write_vio_ = NULL;
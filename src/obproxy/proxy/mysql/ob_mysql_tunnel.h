@@ -32,6 +32,7 @@ namespace proxy
 
 struct ObMysqlTunnelProducer;
 class ObMysqlSM;
+class ObResultCacheCapture;
 typedef int (ObMysqlSM::*MysqlSMHandler)(int event, void *data);
 
 struct ObMysqlTunnelConsumer;
@@ -101,6 +102,11 @@ struct ObMysqlTunnelConsumer
   int64_t bytes_written_;            // total bytes written to the vc
   int handler_state_;                // state used the handlers
 
+  // if set, bytes written to the vc are copied to capture_ through
+  // capture_reader_, which is cloned from buffer_reader_ and lags behind it
+  ObResultCacheCapture *capture_;
+  event::ObIOBufferReader *capture_reader_;
+
   bool alive_;
   bool write_success_;
 
@@ -250,6 +256,15 @@ private:
   int finish_all_internal(ObMysqlTunnelProducer &p, const bool chain);
   int producer_run(ObMysqlTunnelProducer &p);
 
+  // Row bodies of a large resultset can be spliced from server socket to client
+  // socket directly, see ObUnixNetVConnection::set_splice_target().
+  int skip_spliced_bytes(ObMysqlTunnelProducer &p);
+  void update_splice_target(ObMysqlTunnelProducer &p, const bool is_reading);
+
+  // copy what the consumer has written since last call to its capture
+  void capture_written_bytes(ObMysqlTunnelConsumer &c);
+  void finish_capture(ObMysqlTunnelConsumer &c, const bool is_completed);
+
   ObMysqlTunnelProducer *get_producer(event::ObVIO *vio);
   ObMysqlTunnelConsumer *get_consumer(event::ObVIO *vio);
 
@@ -501,6 +516,12 @@ inline void ObMysqlTunnel::init(ObMysqlSM &sm_arg, event::ObProxyMutex &mutex)
 
 inline void ObMysqlTunnel::deallocate_buffers()
 {
+  // capture readers are cloned from producer buffers, free them first
+  for (int64_t i = 0; i < MAX_CONSUMERS; ++i) {
+    if (NULL != consumers_[i].capture_reader_) {
+      finish_capture(consumers_[i], false);
+    }
+  }
   for (int64_t i = 0; i < MAX_PRODUCERS; ++i) {
     if (NULL != producers_[i].read_buffer_) {
       if (OB_ISNULL(producers_[i].vc_)) {
@@ -389,6 +389,146 @@ void ObTextPsNameEntry::destroy()
   op_fixed_mem_free(this, total_len);
 }
 
+uint64_t ObGlobalPsEntryCache::get_scope_hash(const ObString &cluster_name,
+                                              const ObString &tenant_name,
+                                              const ObString &database_name,
+                                              const bool is_oracle_mode)
+{
+  uint64_t hash = is_oracle_mode ? 1 : 0;
+  hash = cluster_name.hash(hash);
+  hash = tenant_name.hash(hash);
+  hash = database_name.hash(hash);
+  return hash;
+}
+
+int ObGlobalPsEntryCache::get_ps_entry(const ObGlobalPsEntryKey &key, ObPsEntry *&ps_entry)
+{
+  int ret = OB_SUCCESS;
+  ObGlobalPsEntryNode *node = NULL;
+  DRWLock::RDLockGuard guard(rwlock_);
+  if (OB_FAIL(ps_entry_map_.get_refactored(key, node))) {
+    // do nothing
+  } else {
+    ps_entry = node->ps_entry_;
+    ps_entry->inc_ref();
+  }
+  return ret;
+}
+
+int ObGlobalPsEntryCache::acquire_ps_entry(const uint64_t scope_hash, const ObString &sql,
+                                           const ObSqlParseResult &parse_result,
+                                           const int64_t max_count, ObPsEntry *&ps_entry)
+{
+  int ret = OB_SUCCESS;
+  ObGlobalPsEntryKey key(scope_hash, sql);
+  ObPsEntry *new_entry = NULL;
+  ObGlobalPsEntryNode *node = NULL;
+  ps_entry = NULL;
+
+  if (OB_SUCC(get_ps_entry(key, ps_entry))) {
+    // hit
+  } else if (OB_UNLIKELY(OB_HASH_NOT_EXIST != ret)) {
+    LOG_WARN("fail to get global ps entry", K(key), K(ret));
+  } else if (count() >= max_count) {
+    ret = OB_SIZE_OVERFLOW;
+    LOG_DEBUG("global ps entry cache is full", K(max_count), K(ret));
+  } else if (OB_FAIL(ObPsEntry::alloc_and_init_ps_entry(sql, parse_result, new_entry))) {
+    LOG_WARN("fail to alloc and init ps entry", K(ret));
+  } else if (OB_ISNULL(node = static_cast<ObGlobalPsEntryNode *>(op_fixed_mem_alloc(sizeof(ObGlobalPsEntryNode))))) {
+    ret = OB_ALLOCATE_MEMORY_FAILED;
+    LOG_WARN("fail to alloc mem for global ps entry node", K(ret));
+  } else {
+    node = new (node) ObGlobalPsEntryNode();
+    new_entry->set_global(scope_hash);
+    node->ps_entry_ = new_entry;
+    node->key_.scope_hash_ = scope_hash;
+    node->key_.sql_ = new_entry->get_base_ps_sql();
+
+    DRWLock::WRLockGuard guard(rwlock_);
+    ObGlobalPsEntryNode *exist_node = NULL;
+    if (OB_SUCC(ps_entry_map_.get_refactored(key, exist_node))) {
+      // added by others, use it
+      ps_entry = exist_node->ps_entry_;
+      ps_entry->inc_ref();
+    } else if (OB_FAIL(ps_entry_map_.unique_set(node))) {
+      LOG_WARN("fail to add global ps entry", K(key), K(ret));
+    } else {
+      // one for registry and one for caller
+      new_entry->inc_ref();
+      new_entry->inc_ref();
+      ps_entry = new_entry;
+      new_entry = NULL;
+      node = NULL;
+    }
+  }
+
+  if (NULL != node) {
+    op_fixed_mem_free(node, sizeof(ObGlobalPsEntryNode));
+    node = NULL;
+  }
+  if (NULL != new_entry) {
+    new_entry->destroy();
+    new_entry = NULL;
+  }
+  return ret;
+}
+
+int ObGlobalPsEntryCache::refresh_ps_entry(ObPsEntry *ps_entry, ObPsEntry *&new_entry)
+{
+  int ret = OB_SUCCESS;
+  ObGlobalPsEntryNode *node = NULL;
+  new_entry = NULL;
+
+  if (OB_ISNULL(ps_entry) || OB_UNLIKELY(!ps_entry->is_global())) {
+    ret = OB_INVALID_ARGUMENT;
+    LOG_WARN("invalid global ps entry", KPC(ps_entry), K(ret));
+  } else {
+    ObGlobalPsEntryKey key(ps_entry->get_scope_hash(), ps_entry->get_base_ps_sql());
+    {
+      DRWLock::WRLockGuard guard(rwlock_);
+      // it may be refreshed and replaced by others
+      if (OB_SUCCESS == ps_entry_map_.get_refactored(key, node) && node->ps_entry_ == ps_entry) {
+        ps_entry_map_.remove(node);
+      } else {
+        node = NULL;
+      }
+    }
+    if (OB_FAIL(ObPsEntry::alloc_and_init_ps_entry(ps_entry->get_base_ps_sql(),
+                                                   ps_entry->get_base_ps_parse_result(), new_entry))) {
+      LOG_WARN("fail to alloc and init ps entry", K(ret));
+    } else {
+      new_entry->inc_ref();
+    }
+    if (NULL != node) {
+      // the key refers to sql of ps_entry, free node before it
+      op_fixed_mem_free(node, sizeof(ObGlobalPsEntryNode));
+      node = NULL;
+      ps_entry->dec_ref();
+    }
+  }
+  return ret;
+}
+
+void ObGlobalPsEntryCache::destroy()
+{
+  DRWLock::WRLockGuard guard(rwlock_);
+  ObGlobalPsEntryMap::iterator last = ps_entry_map_.end();
+  ObGlobalPsEntryMap::iterator tmp_iter;
+  for (ObGlobalPsEntryMap::iterator iter = ps_entry_map_.begin(); iter != last;) {
+    tmp_iter = iter;
+    ++iter;
+    tmp_iter->ps_entry_->dec_ref();
+    op_fixed_mem_free(&(*tmp_iter), sizeof(ObGlobalPsEntryNode));
+  }
+  ps_entry_map_.reset();
+}
+
+ObGlobalPsEntryCache &get_global_ps_entry_cache()
+{
+  static ObGlobalPsEntryCache global_ps_entry_cache;
+  return global_ps_entry_cache;
+}
+
 } // end of namespace proxy
 } // end of namespace obproxy
 } // end of namespace oceanbase
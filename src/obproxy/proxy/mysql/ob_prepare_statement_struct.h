@@ -21,6 +21,7 @@
 #include "obutils/ob_proxy_sql_parser.h"
 #include "iocore/net/ob_inet.h"
 #include "lib/allocator/ob_mod_define.h"
+#include "lib/lock/ob_drw_lock.h"
 
 #define PARAM_TYPE_BLOCK_SIZE  1 << 9 // 512
 
@@ -173,7 +174,15 @@ inline void ObPsSqlMeta::reset()
 class ObPsEntry : public ObBasePsEntry
 {
 public:
-  ObPsEntry() : ObBasePsEntry(), ps_id_(0), ps_meta_() {}
+  enum ObPsSqlMetaState
+  {
+    PS_SQL_META_EMPTY = 0,
+    PS_SQL_META_FILLING,
+    PS_SQL_META_READY,
+  };
+
+  ObPsEntry() : ObBasePsEntry(), ps_id_(0), ps_meta_(), ps_meta_state_(PS_SQL_META_EMPTY),
+                scope_hash_(0), is_global_(false) {}
   ~ObPsEntry() {}
 
   static int alloc_and_init_ps_entry(const common::ObString &ps_sql,
@@ -187,12 +196,43 @@ public:
   int64_t get_param_count() const { return ps_meta_.get_param_count(); }
   uint32_t get_ps_id() { return ps_id_; }
   int64_t to_string(char *buf, const int64_t buf_len) const;
-  
+
+  // ps meta is filled by the first prepare response and read only after that,
+  // as the entry may be shared by sessions of different threads. READY is
+  // published with release and checked with acquire, so that a reader which
+  // sees it also sees the filled meta.
+  bool try_lock_ps_sql_meta()
+  {
+    return ATOMIC_BCAS(&ps_meta_state_, PS_SQL_META_EMPTY, PS_SQL_META_FILLING);
+  }
+  void unlock_ps_sql_meta(const bool is_ready)
+  {
+    __atomic_store_n(&ps_meta_state_, is_ready ? PS_SQL_META_READY : PS_SQL_META_EMPTY, __ATOMIC_RELEASE);
+  }
+  bool is_ps_sql_meta_ready() const
+  {
+    return PS_SQL_META_READY == __atomic_load_n(&ps_meta_state_, __ATOMIC_ACQUIRE);
+  }
+  // the meta is out of date after schema changed, only for entries not shared,
+  // the next prepare response fills it again
+  void reset_ps_sql_meta()
+  {
+    __atomic_store_n(&ps_meta_state_, PS_SQL_META_EMPTY, __ATOMIC_RELEASE);
+  }
+
+  // entries in ObGlobalPsEntryCache are shared by sessions, set before it is added
+  void set_global(const uint64_t scope_hash) { scope_hash_ = scope_hash; is_global_ = true; }
+  bool is_global() const { return is_global_; }
+  uint64_t get_scope_hash() const { return scope_hash_; }
+
 private:
   const static int64_t PARSE_EXTRA_CHAR_NUM = 2;
 
   uint32_t ps_id_;
   ObPsSqlMeta ps_meta_;
+  ObPsSqlMetaState ps_meta_state_;
+  uint64_t scope_hash_;
+  bool is_global_;
 public:
   DISALLOW_COPY_AND_ASSIGN(ObPsEntry);
 };
@@ -387,6 +427,89 @@ private:
   DISALLOW_COPY_AND_ASSIGN(ObBasePsEntryCache);
 };
 
+// Proxy wide registry of ObPsEntry, so that client sessions preparing the same
+// sql share one entry instead of parsing and storing it again.
+//
+// The key is the sql text and the scope (cluster, tenant, database and mode) the
+// entry is prepared in, as ps meta returned by server depends on the schema.
+// Entries are kept until proxy exits or their meta is found out of date, new
+// ones are not added once the registry is full and the caller falls back to
+// the cache of client session.
+// Lookups only take the read lock of a DRWLock, which is per cpu.
+class ObGlobalPsEntryCache
+{
+public:
+  static const int64_t HASH_BUCKET_SIZE = 1024;
+
+  struct ObGlobalPsEntryKey
+  {
+    ObGlobalPsEntryKey() : scope_hash_(0), sql_() {}
+    ObGlobalPsEntryKey(const uint64_t scope_hash, const common::ObString &sql)
+        : scope_hash_(scope_hash), sql_(sql) {}
+    TO_STRING_KV(K_(scope_hash), K_(sql));
+
+    uint64_t scope_hash_;
+    common::ObString sql_;
+  };
+
+  struct ObGlobalPsEntryNode
+  {
+    ObGlobalPsEntryNode() : key_(), ps_entry_(NULL) {}
+
+    ObGlobalPsEntryKey key_;
+    ObPsEntry *ps_entry_;
+    LINK(ObGlobalPsEntryNode, global_ps_entry_link_);
+  };
+
+  struct ObGlobalPsEntryHashing
+  {
+    typedef const ObGlobalPsEntryKey &Key;
+    typedef ObGlobalPsEntryNode Value;
+    typedef ObDLList(ObGlobalPsEntryNode, global_ps_entry_link_) ListHead;
+
+    static uint64_t hash(Key key) { return key.sql_.hash(key.scope_hash_); }
+    static Key key(Value const *value) { return value->key_; }
+    static bool equal(Key lhs, Key rhs)
+    {
+      return lhs.scope_hash_ == rhs.scope_hash_ && lhs.sql_ == rhs.sql_;
+    }
+  };
+
+  typedef common::hash::ObBuildInHashMap<ObGlobalPsEntryHashing, HASH_BUCKET_SIZE> ObGlobalPsEntryMap;
+
+public:
+  ObGlobalPsEntryCache() : rwlock_(), ps_entry_map_() {}
+  ~ObGlobalPsEntryCache() {}
+  void destroy();
+
+  // get the entry of sql in scope, create it if not exist, the entry is ref'ed for caller.
+  // returns OB_SIZE_OVERFLOW if it does not exist and max_count entries are cached
+  int acquire_ps_entry(const uint64_t scope_hash, const common::ObString &sql,
+                       const obutils::ObSqlParseResult &parse_result,
+                       const int64_t max_count, ObPsEntry *&ps_entry);
+  // the meta of ps_entry does not match the prepare response, e.g. columns are
+  // added to the table of select *. It is still read by sessions using it, so it
+  // is removed from registry instead of filled again, later prepares create a new
+  // one. new_entry is a copy with empty meta, ref'ed for caller.
+  int refresh_ps_entry(ObPsEntry *ps_entry, ObPsEntry *&new_entry);
+  int64_t count() const { return ps_entry_map_.count(); }
+
+  static uint64_t get_scope_hash(const common::ObString &cluster_name,
+                                 const common::ObString &tenant_name,
+                                 const common::ObString &database_name,
+                                 const bool is_oracle_mode);
+
+private:
+  int get_ps_entry(const ObGlobalPsEntryKey &key, ObPsEntry *&ps_entry);
+
+private:
+  common::DRWLock rwlock_;
+  ObGlobalPsEntryMap ps_entry_map_;
+  DISALLOW_COPY_AND_ASSIGN(ObGlobalPsEntryCache);
+};
+
+ObGlobalPsEntryCache &get_global_ps_entry_cache();
+
 } // end of namespace proxy
 } // end of namespace obproxy
 } // end of namespace oceanbase
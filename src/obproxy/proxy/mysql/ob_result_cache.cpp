@@ -0,0 +1,468 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+
+#include "proxy/mysql/ob_result_cache.h"
+#include "iocore/eventsystem/ob_io_buffer.h"
+#include "iocore/eventsystem/ob_buf_allocator.h"
+#include "lib/hash_func/murmur_hash.h"
+#include "lib/time/ob_time_utility.h"
+
+using namespace oceanbase::common;
+using namespace oceanbase::obproxy::event;
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace proxy
+{
+
+static const int64_t CAPTURE_INIT_BUF_LEN = 4 * 1024;
+static const int64_t MAX_WORD_LEN = 32;
+
+//--------------------------ObResultCacheCapture------------------------------
+void ObResultCacheCapture::start(const ObResultCacheSnapshot &snapshot, const int64_t limit)
+{
+  reset();
+  snapshot_ = snapshot;
+  limit_ = limit;
+  is_started_ = true;
+}
+
+void ObResultCacheCapture::reset()
+{
+  abandon();
+  snapshot_.reset();
+  limit_ = 0;
+  is_started_ = false;
+  is_abandoned_ = false;
+}
+
+void ObResultCacheCapture::abandon()
+{
+  if (NULL != buf_) {
+    op_fixed_mem_free(buf_, buf_len_);
+    buf_ = NULL;
+  }
+  data_len_ = 0;
+  buf_len_ = 0;
+  is_abandoned_ = true;
+  is_completed_ = false;
+}
+
+int ObResultCacheCapture::append(ObIOBufferReader &reader, const int64_t len)
+{
+  int ret = OB_SUCCESS;
+  if (OB_UNLIKELY(!is_started_) || OB_UNLIKELY(is_abandoned_)) {
+    ret = OB_STATE_NOT_MATCH;
+  } else if (len <= 0) {
+    // nothing to copy
+  } else if (OB_UNLIKELY(data_len_ + len > limit_) || OB_UNLIKELY(reader.read_avail() < len)) {
+    ret = OB_SIZE_OVERFLOW;
+  } else {
+    if (data_len_ + len > buf_len_) {
+      int64_t new_buf_len = (0 == buf_len_) ? CAPTURE_INIT_BUF_LEN : buf_len_;
+      while (new_buf_len < data_len_ + len) {
+        new_buf_len *= 2;
+      }
+      new_buf_len = std::min(new_buf_len, limit_);
+      char *new_buf = NULL;
+      if (OB_ISNULL(new_buf = static_cast<char *>(op_fixed_mem_alloc(new_buf_len)))) {
+        ret = OB_ALLOCATE_MEMORY_FAILED;
+        LOG_WARN("fail to alloc mem for result cache capture", K(new_buf_len), K(ret));
+      } else {
+        if (NULL != buf_) {
+          MEMCPY(new_buf, buf_, data_len_);
+          op_fixed_mem_free(buf_, buf_len_);
+        }
+        buf_ = new_buf;
+        buf_len_ = new_buf_len;
+      }
+    }
+    if (OB_SUCC(ret)) {
+      reader.copy(buf_ + data_len_, len);
+      if (OB_FAIL(reader.consume(len))) {
+        LOG_WARN("fail to consume captured bytes", K(len), K(ret));
+      } else {
+        data_len_ += len;
+      }
+    }
+  }
+  if (OB_FAIL(ret)) {
+    abandon();
+  }
+  return ret;
+}
+
+//--------------------------ObResultCacheDirtyTables------------------------------
+void ObResultCacheDirtyTables::invalidate()
+{
+  ObResultCache &result_cache = get_global_result_cache();
+  if (is_overflow_) {
+    result_cache.invalidate_all();
+  } else {
+    for (int64_t i = 0; i < count_; ++i) {
+      result_cache.invalidate_table(table_slots_[i]);
+    }
+  }
+  reset();
+}
+
+//--------------------------ObResultCache------------------------------
+ObResultCache::ObResultCache() : rwlock_(), entry_map_(), mem_size_(0), epoch_(0)
+{
+  MEMSET(const_cast<int64_t *>(table_versions_), 0, sizeof(table_versions_));
+}
+
+void ObResultCache::take_snapshot(const int64_t table_slot, ObResultCacheSnapshot &snapshot) const
+{
+  snapshot.table_slot_ = table_slot;
+  snapshot.table_version_ = ATOMIC_LOAD(&table_versions_[table_slot % TABLE_SLOT_COUNT]);
+  snapshot.epoch_ = ATOMIC_LOAD(&epoch_);
+}
+
+inline bool ObResultCache::is_stale(const ObResultCacheEntry &entry, const int64_t now_us) const
+{
+  const ObResultCacheSnapshot &snapshot = entry.snapshot_;
+  return entry.expire_time_us_ <= now_us
+         || snapshot.epoch_ != ATOMIC_LOAD(&epoch_)
+         || snapshot.table_version_ != ATOMIC_LOAD(&table_versions_[snapshot.table_slot_ % TABLE_SLOT_COUNT]);
+}
+
+int ObResultCache::get(const ObResultCacheKey &key, const int64_t now_us,
+                       ObMIOBuffer &buf, bool &is_hit)
+{
+  int ret = OB_SUCCESS;
+  ObResultCacheEntry *entry = NULL;
+  is_hit = false;
+  DRWLock::RDLockGuard guard(rwlock_);
+  if (OB_SUCCESS != entry_map_.get_refactored(key, entry) || is_stale(*entry, now_us)) {
+    // miss, stale entries are freed when cache is full
+  } else {
+    int64_t written_len = 0;
+    if (OB_FAIL(buf.write(entry->data_, entry->data_len_, written_len))) {
+      LOG_WARN("fail to write cached response", KPC(entry), K(ret));
+    } else if (OB_UNLIKELY(written_len != entry->data_len_)) {
+      ret = OB_ERR_UNEXPECTED;
+      LOG_WARN("fail to write whole cached response", K(written_len), KPC(entry), K(ret));
+    } else {
+      is_hit = true;
+    }
+  }
+  return ret;
+}
+
+int ObResultCache::put(const ObResultCacheKey &key, const ObResultCacheSnapshot &snapshot,
+                       const int64_t expire_time_us, const char *data, const int64_t data_len,
+                       const int64_t mem_limit)
+{
+  int ret = OB_SUCCESS;
+  const int64_t alloc_size = static_cast<int64_t>(sizeof(ObResultCacheEntry)) + key.sql_.length() + data_len;
+  char *buf = NULL;
+  ObResultCacheEntry *entry = NULL;
+
+  if (OB_ISNULL(data) || OB_UNLIKELY(data_len <= 0) || OB_UNLIKELY(key.sql_.empty())) {
+    ret = OB_INVALID_ARGUMENT;
+    LOG_WARN("invalid argument", K(key), K(data_len), K(ret));
+  } else if (OB_UNLIKELY(alloc_size > mem_limit)) {
+    ret = OB_SIZE_OVERFLOW;
+  } else if (OB_ISNULL(buf = static_cast<char *>(op_fixed_mem_alloc(alloc_size)))) {
+    ret = OB_ALLOCATE_MEMORY_FAILED;
+    LOG_WARN("fail to alloc mem for result cache entry", K(alloc_size), K(ret));
+  } else {
+    entry = new (buf) ObResultCacheEntry();
+    char *sql_buf = buf + sizeof(ObResultCacheEntry);
+    MEMCPY(sql_buf, key.sql_.ptr(), key.sql_.length());
+    entry->key_.scope_hash_ = key.scope_hash_;
+    entry->key_.sql_.assign_ptr(sql_buf, key.sql_.length());
+    entry->snapshot_ = snapshot;
+    entry->expire_time_us_ = expire_time_us;
+    entry->data_ = sql_buf + key.sql_.length();
+    entry->data_len_ = data_len;
+    entry->alloc_size_ = alloc_size;
+    MEMCPY(entry->data_, data, data_len);
+
+    const int64_t now_us = ObTimeUtility::current_time();
+    DRWLock::WRLockGuard guard(rwlock_);
+    free_entry(entry_map_.remove(key));
+    if (ATOMIC_LOAD(&mem_size_) + alloc_size > mem_limit) {
+      evict_entries(now_us, alloc_size, mem_limit);
+    }
+    if (OB_FAIL(entry_map_.unique_set(entry))) {
+      LOG_WARN("fail to add result cache entry", KPC(entry), K(ret));
+    } else {
+      (void)ATOMIC_AAF(&mem_size_, alloc_size);
+      LOG_DEBUG("succ to add result cache entry", KPC(entry));
+      entry = NULL;
+    }
+  }
+
+  if (NULL != entry) {
+    entry->~ObResultCacheEntry();
+    op_fixed_mem_free(entry, alloc_size);
+    entry = NULL;
+  }
+  return ret;
+}
+
+void ObResultCache::free_entry(ObResultCacheEntry *entry)
+{
+  if (NULL != entry) {
+    const int64_t alloc_size = entry->alloc_size_;
+    (void)ATOMIC_SAF(&mem_size_, alloc_size);
+    entry->~ObResultCacheEntry();
+    op_fixed_mem_free(entry, alloc_size);
+  }
+}
+
+void ObResultCache::evict_entries(const int64_t now_us, const int64_t need_size, const int64_t mem_limit)
+{
+  ObResultCacheEntry *entry = NULL;
+  ObResultCacheMap::iterator last = entry_map_.end();
+  ObResultCacheMap::iterator iter;
+  // first pass frees stale entries only, the second one frees whatever is left
+  for (int64_t pass = 0; pass < 2 && ATOMIC_LOAD(&mem_size_) + need_size > mem_limit; ++pass) {
+    for (iter = entry_map_.begin(); iter != last && ATOMIC_LOAD(&mem_size_) + need_size > mem_limit;) {
+      entry = &(*iter);
+      ++iter;
+      if (1 == pass || is_stale(*entry, now_us)) {
+        entry_map_.remove(entry);
+        free_entry(entry);
+      }
+    }
+  }
+}
+
+void ObResultCache::destroy()
+{
+  DRWLock::WRLockGuard guard(rwlock_);
+  ObResultCacheMap::iterator last = entry_map_.end();
+  ObResultCacheMap::iterator tmp_iter;
+  for (ObResultCacheMap::iterator iter = entry_map_.begin(); iter != last;) {
+    tmp_iter = iter;
+    ++iter;
+    free_entry(&(*tmp_iter));
+  }
+  entry_map_.reset();
+}
+
+int64_t ObResultCache::get_table_slot(const uint64_t scope_hash, const ObString &database_name,
+                                      const ObString &table_name)
+{
+  // names are compared case insensitively, a false match only invalidates more
+  uint64_t hash = scope_hash;
+  for (int64_t i = 0; i < database_name.length(); ++i) {
+    hash = hash * 31 + static_cast<uint64_t>(tolower(database_name[i]));
+  }
+  hash = hash * 31 + '.';
+  for (int64_t i = 0; i < table_name.length(); ++i) {
+    hash = hash * 31 + static_cast<uint64_t>(tolower(table_name[i]));
+  }
+  hash = murmurhash(&hash, sizeof(hash), 0);
+  return static_cast<int64_t>(hash % TABLE_SLOT_COUNT);
+}
+
+static inline bool is_word_char(const char c)
+{
+  return isalnum(static_cast<unsigned char>(c)) || '_' == c || '$' == c;
+}
+
+// get the next word of sql from pos in lower case, other chars are returned one by one
+static inline void next_word(const char *&pos, const char *end, char *word, int64_t &word_len)
+{
+  word_len = 0;
+  if (is_word_char(*pos)) {
+    for (; pos < end && is_word_char(*pos); ++pos) {
+      if (word_len < MAX_WORD_LEN) {
+        word[word_len++] = static_cast<char>(tolower(*pos));
+      }
+    }
+  } else {
+    word[word_len++] = *pos++;
+  }
+  word[word_len] = '\0';
+}
+
+static inline bool is_word_in(const char *word, const char *const *words, const int64_t count)
+{
+  bool bret = false;
+  for (int64_t i = 0; i < count && !bret; ++i) {
+    bret = (0 == STRCMP(word, words[i]));
+  }
+  return bret;
+}
+
+static inline bool is_next_char(const char *pos, const char *end, const char c)
+{
+  for (; pos < end && isspace(static_cast<unsigned char>(*pos)); ++pos) {
+  }
+  return pos < end && c == *pos;
+}
+
+bool ObResultCache::is_cacheable_sql(const ObString &sql)
+{
+  // builtin functions whose result only depends on their arguments and the
+  // session variables, any other function call is not cacheable
+  static const char *const DETERMINISTIC_FUNCS[] = {
+    "count", "sum", "min", "max", "avg", "group_concat", "bit_and", "bit_or", "bit_xor",
+    "abs", "ceil", "ceiling", "floor", "round", "truncate", "trunc", "mod", "sign", "sqrt",
+    "power", "pow", "exp", "ln", "log", "log2", "log10", "greatest", "least",
+    "concat", "concat_ws", "substr", "substring", "substring_index", "length", "lengthb",
+    "char_length", "character_length", "upper", "lower", "ucase", "lcase", "trim", "ltrim",
+    "rtrim", "lpad", "rpad", "replace", "left", "right", "reverse", "repeat", "instr",
+    "locate", "hex", "unhex", "md5", "sha1", "sha2", "crc32", "ascii",
+    "coalesce", "ifnull", "nvl", "nvl2", "nullif", "if", "decode", "cast", "convert",
+    "to_char", "to_number", "date_format", "date", "year", "month", "day", "hour",
+    "minute", "second", "datediff", "str_to_date"
+  };
+  // keywords which may be followed by a parenthesis
+  static const char *const PAREN_WORDS[] = {
+    "select", "from", "where", "in", "and", "or", "not", "xor", "on", "as", "by",
+    "having", "case", "when", "then", "else", "between", "like", "is", "distinct",
+    "partition", "values", "limit", "offset", "asc", "desc"
+  };
+  // functions and pseudo columns which are nondeterministic without a parenthesis,
+  // clauses which lock or write, and schemas of system views
+  static const char *const UNSAFE_WORDS[] = {
+    "current_date", "current_time", "current_timestamp", "current_user", "localtime",
+    "localtimestamp", "utc_date", "utc_time", "utc_timestamp", "sysdate", "systimestamp",
+    "sessiontimezone", "dbtimezone", "user", "uid", "nextval", "currval",
+    "for", "lock", "into", "join", "straight_join", "union", "intersect", "except", "minus",
+    "information_schema", "performance_schema", "oceanbase", "mysql", "sys"
+  };
+  static const char *const FROM_END_WORDS[] = {
+    "where", "group", "having", "order", "limit", "window", "partition"
+  };
+  static const int64_t DETERMINISTIC_FUNC_COUNT = sizeof(DETERMINISTIC_FUNCS) / sizeof(DETERMINISTIC_FUNCS[0]);
+  static const int64_t PAREN_WORD_COUNT = sizeof(PAREN_WORDS) / sizeof(PAREN_WORDS[0]);
+  static const int64_t UNSAFE_WORD_COUNT = sizeof(UNSAFE_WORDS) / sizeof(UNSAFE_WORDS[0]);
+  static const int64_t FROM_END_WORD_COUNT = sizeof(FROM_END_WORDS) / sizeof(FROM_END_WORDS[0]);
+
+  bool bret = !sql.empty();
+  int64_t select_count = 0;
+  bool in_from = false;
+  bool is_qualified = false;
+  char word[MAX_WORD_LEN + 1];
+  int64_t word_len = 0;
+  const char *pos = sql.ptr();
+  const char *end = sql.ptr() + sql.length();
+  while (bret && pos < end) {
+    next_word(pos, end, word, word_len);
+    if (1 == word_len && !is_word_char(word[0])) {
+      // user variables, placeholders, multi statements and tables joined by comma
+      bret = ('@' != word[0] && '?' != word[0] && ';' != word[0] && !(',' == word[0] && in_from));
+      is_qualified = ('.' == word[0]);
+      continue;
+    } else if (is_next_char(pos, end, '(')
+               && (is_qualified
+                   || !(is_word_in(word, DETERMINISTIC_FUNCS, DETERMINISTIC_FUNC_COUNT)
+                        || is_word_in(word, PAREN_WORDS, PAREN_WORD_COUNT)))) {
+      // user defined functions, package functions and other builtins
+      bret = false;
+    } else if (0 == STRCMP(word, "select")) {
+      bret = (++select_count <= 1);
+    } else if (0 == STRCMP(word, "from")) {
+      in_from = true;
+    } else if (is_word_in(word, FROM_END_WORDS, FROM_END_WORD_COUNT)) {
+      in_from = false;
+    } else if (is_word_in(word, UNSAFE_WORDS, UNSAFE_WORD_COUNT)
+               || 0 == STRNCMP(word, "__all", 5)
+               || 0 == STRNCMP(word, "v$", 2)
+               || 0 == STRNCMP(word, "gv$", 3)) {
+      bret = false;
+    }
+    is_qualified = false;
+  }
+  return bret && 1 == select_count;
+}
+
+bool ObResultCache::is_temporary_table_ddl(const ObString &sql)
+{
+  bool bret = false;
+  bool is_done = false;
+  int64_t word_count = 0;
+  char word[MAX_WORD_LEN + 1];
+  int64_t word_len = 0;
+  const char *pos = sql.ptr();
+  const char *end = sql.ptr() + sql.length();
+  // create [global] temporary table
+  while (!is_done && pos < end) {
+    next_word(pos, end, word, word_len);
+    if (isspace(static_cast<unsigned char>(word[0]))) {
+      continue;
+    } else if (0 == word_count) {
+      is_done = (0 != STRCMP(word, "create"));
+    } else if (1 == word_count && 0 == STRCMP(word, "global")) {
+      // oracle global temporary table
+    } else {
+      bret = (0 == STRCMP(word, "temporary"));
+      is_done = true;
+    }
+    ++word_count;
+  }
+  return bret;
+}
+
+bool ObResultCache::is_multi_table_write(const ObString &sql)
+{
+  static const char *const MULTI_TABLE_WORDS[] = { "join", "straight_join", "using" };
+  static const char *const TABLE_END_WORDS[] = { "set", "where", "order", "limit", "values", "select" };
+  static const int64_t MULTI_TABLE_WORD_COUNT = sizeof(MULTI_TABLE_WORDS) / sizeof(MULTI_TABLE_WORDS[0]);
+  static const int64_t TABLE_END_WORD_COUNT = sizeof(TABLE_END_WORDS) / sizeof(TABLE_END_WORDS[0]);
+
+  bool bret = false;
+  bool in_tables = true;
+  bool is_first_word = true;
+  bool is_insert = false;
+  int64_t depth = 0;
+  char word[MAX_WORD_LEN + 1];
+  int64_t word_len = 0;
+  const char *pos = sql.ptr();
+  const char *end = sql.ptr() + sql.length();
+  while (!bret && pos < end) {
+    next_word(pos, end, word, word_len);
+    if (isspace(static_cast<unsigned char>(word[0]))) {
+      continue;
+    } else if (1 == word_len && !is_word_char(word[0])) {
+      if ('(' == word[0]) {
+        ++depth;
+      } else if (')' == word[0]) {
+        --depth;
+      } else {
+        // update t1, t2 set ... or delete t1, t2 from ...
+        bret = (',' == word[0] && in_tables && 0 == depth) || ';' == word[0];
+      }
+    } else if (is_word_in(word, TABLE_END_WORDS, TABLE_END_WORD_COUNT)) {
+      in_tables = false;
+    } else if (is_word_in(word, MULTI_TABLE_WORDS, MULTI_TABLE_WORD_COUNT)) {
+      bret = true;
+    } else if (is_insert && (0 == STRCMP(word, "all") || 0 == STRCMP(word, "first"))) {
+      // oracle multi table insert
+      bret = true;
+    }
+    is_insert = is_first_word && 0 == STRCMP(word, "insert");
+    is_first_word = false;
+  }
+  return bret;
+}
+
+ObResultCache &get_global_result_cache()
+{
+  static ObResultCache global_result_cache;
+  return global_result_cache;
+}
+
+} // end of namespace proxy
+} // end of namespace obproxy
+} // end of namespace oceanbase
@@ -0,0 +1,241 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#ifndef OBPROXY_RESULT_CACHE_H
+#define OBPROXY_RESULT_CACHE_H
+
+#include "lib/ob_define.h"
+#include "lib/string/ob_string.h"
+#include "lib/hash/ob_build_in_hashmap.h"
+#include "lib/lock/ob_drw_lock.h"
+#include "lib/atomic/ob_atomic.h"
+#include "lib/utility/ob_print_utils.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace event
+{
+class ObMIOBuffer;
+class ObIOBufferReader;
+}
+namespace proxy
+{
+
+struct ObResultCacheKey
+{
+  ObResultCacheKey() : scope_hash_(0), sql_() {}
+  ObResultCacheKey(const uint64_t scope_hash, const common::ObString &sql)
+      : scope_hash_(scope_hash), sql_(sql) {}
+  TO_STRING_KV(K_(scope_hash), K_(sql));
+
+  // cluster, tenant, user, database and session variables of the client session
+  uint64_t scope_hash_;
+  common::ObString sql_;
+};
+
+// State of the cache sampled before the request is sent to observer, the response
+// is only cached if no table it reads from is invalidated meanwhile.
+struct ObResultCacheSnapshot
+{
+  ObResultCacheSnapshot() { reset(); }
+  void reset() { MEMSET(this, 0, sizeof(ObResultCacheSnapshot)); }
+  TO_STRING_KV(K_(scope_hash), K_(table_slot), K_(table_version), K_(epoch));
+
+  uint64_t scope_hash_;
+  int64_t table_slot_;
+  int64_t table_version_;
+  int64_t epoch_;
+};
+
+struct ObResultCacheEntry
+{
+  ObResultCacheEntry() : key_(), snapshot_(), expire_time_us_(0), data_len_(0),
+                         data_(NULL), alloc_size_(0), result_cache_link_() {}
+  TO_STRING_KV(K_(key), K_(snapshot), K_(expire_time_us), K_(data_len), K_(alloc_size));
+
+  ObResultCacheKey key_;
+  ObResultCacheSnapshot snapshot_;
+  int64_t expire_time_us_;
+  int64_t data_len_;
+  char *data_;
+  int64_t alloc_size_; // the entry, sql and data are in one block
+  LINK(ObResultCacheEntry, result_cache_link_);
+};
+
+// Response bytes written to the client, copied by the client consumer of
+// ObMysqlTunnel. Capture stops and the buffer is freed once the response
+// grows beyond limit.
+class ObResultCacheCapture
+{
+public:
+  ObResultCacheCapture() : snapshot_(), buf_(NULL), data_len_(0), buf_len_(0), limit_(0),
+                           is_started_(false), is_abandoned_(false), is_completed_(false) {}
+  ~ObResultCacheCapture() { reset(); }
+
+  void start(const ObResultCacheSnapshot &snapshot, const int64_t limit);
+  void reset();
+  void abandon();
+  void complete() { is_completed_ = !is_abandoned_; }
+  // copy len bytes from reader, the bytes are consumed
+  int append(event::ObIOBufferReader &reader, const int64_t len);
+
+  bool is_started() const { return is_started_; }
+  bool is_abandoned() const { return is_abandoned_; }
+  bool is_completed() const { return is_completed_; }
+  int64_t get_data_len() const { return data_len_; }
+  const char *get_data() const { return buf_; }
+  const ObResultCacheSnapshot &get_snapshot() const { return snapshot_; }
+
+  TO_STRING_KV(K_(snapshot), K_(data_len), K_(buf_len), K_(limit),
+               K_(is_started), K_(is_abandoned), K_(is_completed));
+
+private:
+  ObResultCacheSnapshot snapshot_;
+  char *buf_;
+  int64_t data_len_;
+  int64_t buf_len_;
+  int64_t limit_;
+  bool is_started_;
+  bool is_abandoned_;
+  bool is_completed_;
+
+  DISALLOW_COPY_AND_ASSIGN(ObResultCacheCapture);
+};
+
+// Tables written by the current transaction of one client session, they are
+// invalidated again when the transaction completes, so that responses read
+// before the commit do not stay cached.
+class ObResultCacheDirtyTables
+{
+public:
+  static const int64_t MAX_TABLE_COUNT = 8;
+
+  ObResultCacheDirtyTables() { reset(); }
+  void reset() { MEMSET(this, 0, sizeof(ObResultCacheDirtyTables)); }
+  bool empty() const { return 0 == count_ && !is_overflow_; }
+  void add(const int64_t table_slot);
+  void add_all() { is_overflow_ = true; }
+  void invalidate();
+
+private:
+  int64_t count_;
+  int64_t table_slots_[MAX_TABLE_COUNT];
+  bool is_overflow_;
+};
+
+// Responses of read only statements shared by all client sessions.
+//
+// The key is the sql text together with everything of the client session which
+// may change the response: cluster, tenant, user, database and the hash of all
+// session variables. The value is the raw mysql packets the client received.
+//
+// Entries expire after ttl. Besides, every write statement seen by obproxy bumps
+// the version of its table, and statements which may write unknown tables (ddl,
+// multi table dml, call, ...) bump the epoch of the whole cache. An entry records
+// the version of its table and the epoch sampled before the request was sent, and
+// is stale once either moves on. Table versions are kept in a fixed array indexed
+// by the hash of the table name, a collision only invalidates more than needed.
+//
+// Writes which do not go through this obproxy are not seen, they are only
+// covered by ttl.
+class ObResultCache
+{
+public:
+  static const int64_t HASH_BUCKET_SIZE = 1024;
+  static const int64_t TABLE_SLOT_COUNT = 4096;
+
+  struct ObResultCacheHashing
+  {
+    typedef const ObResultCacheKey &Key;
+    typedef ObResultCacheEntry Value;
+    typedef ObDLList(ObResultCacheEntry, result_cache_link_) ListHead;
+
+    static uint64_t hash(Key key) { return key.sql_.hash(key.scope_hash_); }
+    static Key key(Value const *value) { return value->key_; }
+    static bool equal(Key lhs, Key rhs)
+    {
+      return lhs.scope_hash_ == rhs.scope_hash_ && lhs.sql_ == rhs.sql_;
+    }
+  };
+
+  typedef common::hash::ObBuildInHashMap<ObResultCacheHashing, HASH_BUCKET_SIZE> ObResultCacheMap;
+
+public:
+  ObResultCache();
+  ~ObResultCache() {}
+  void destroy();
+
+  // copy the response of key into buf if it is neither expired nor stale
+  int get(const ObResultCacheKey &key, const int64_t now_us,
+          event::ObMIOBuffer &buf, bool &is_hit);
+  // replace the entry of key, entries are evicted if mem_limit is exceeded
+  int put(const ObResultCacheKey &key, const ObResultCacheSnapshot &snapshot,
+          const int64_t expire_time_us, const char *data, const int64_t data_len,
+          const int64_t mem_limit);
+
+  void take_snapshot(const int64_t table_slot, ObResultCacheSnapshot &snapshot) const;
+  void invalidate_table(const int64_t table_slot)
+  {
+    (void)ATOMIC_AAF(&table_versions_[table_slot % TABLE_SLOT_COUNT], 1);
+  }
+  void invalidate_all() { (void)ATOMIC_AAF(&epoch_, 1); }
+
+  int64_t count() const { return entry_map_.count(); }
+  int64_t get_mem_size() const { return ATOMIC_LOAD(&mem_size_); }
+
+  static int64_t get_table_slot(const uint64_t scope_hash, const common::ObString &database_name,
+                                const common::ObString &table_name);
+  // a select which only reads one table and whose result only depends on the
+  // session variables, it is checked on the sql text and errs on the side of false.
+  // only deterministic builtin functions may be called
+  static bool is_cacheable_sql(const common::ObString &sql);
+  // create temporary table, the table of the same name is different for the session
+  static bool is_temporary_table_ddl(const common::ObString &sql);
+  // whether a write statement may write more than the table found by parser
+  static bool is_multi_table_write(const common::ObString &sql);
+
+  TO_STRING_KV("count", count(), K_(mem_size), K_(epoch));
+
+private:
+  bool is_stale(const ObResultCacheEntry &entry, const int64_t now_us) const;
+  void free_entry(ObResultCacheEntry *entry);
+  // free expired or stale entries, and then any entries, until need_size fits in mem_limit
+  void evict_entries(const int64_t now_us, const int64_t need_size, const int64_t mem_limit);
+
+private:
+  common::DRWLock rwlock_;
+  ObResultCacheMap entry_map_;
+  volatile int64_t mem_size_;
+  volatile int64_t epoch_;
+  volatile int64_t table_versions_[TABLE_SLOT_COUNT];
+
+  DISALLOW_COPY_AND_ASSIGN(ObResultCache);
+};
+
+ObResultCache &get_global_result_cache();
+
+inline void ObResultCacheDirtyTables::add(const int64_t table_slot)
+{
+  if (count_ < MAX_TABLE_COUNT) {
+    table_slots_[count_++] = table_slot;
+  } else {
+    is_overflow_ = true;
+  }
+}
+
+} // end of namespace proxy
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+#endif // OBPROXY_RESULT_CACHE_H
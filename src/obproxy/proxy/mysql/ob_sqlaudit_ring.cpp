@@ -0,0 +1,341 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+
+#include "proxy/mysql/ob_sqlaudit_ring.h"
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <signal.h>
+#include "lib/time/ob_hrtime.h"
+#include "iocore/eventsystem/ob_event_processor.h"
+#include "obutils/ob_proxy_config.h"
+#include "utils/ob_layout.h"
+
+using namespace oceanbase::common;
+using namespace oceanbase::obproxy::event;
+using namespace oceanbase::obproxy::obutils;
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace proxy
+{
+
+ObSqlauditRing::ObSqlauditRing()
+  : is_inited_(false), thread_idx_(-1), capacity_(0), map_size_(0), fd_(-1),
+    random_state_(0), header_(NULL), data_(NULL)
+{
+}
+
+int ObSqlauditRing::init(const int64_t mem_size, const int64_t thread_idx, const char *export_path)
+{
+  int ret = OB_SUCCESS;
+  const int64_t map_size = (mem_size / ObSqlauditRingHeader::HEADER_SIZE) * ObSqlauditRingHeader::HEADER_SIZE;
+  void *addr = MAP_FAILED;
+  if (OB_UNLIKELY(is_inited_)) {
+    ret = OB_INIT_TWICE;
+    LOG_WARN("init twice", K(ret));
+  } else if (OB_UNLIKELY(map_size < MIN_CAPACITY + ObSqlauditRingHeader::HEADER_SIZE)) {
+    ret = OB_INVALID_ARGUMENT;
+    LOG_WARN("invalid sqlaudit ring mem size", K(mem_size), K(ret));
+  } else if (NULL == export_path) {
+    if (MAP_FAILED == (addr = ::mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+                                     MAP_PRIVATE | MAP_ANONYMOUS, -1, 0))) {
+      ret = OB_ALLOCATE_MEMORY_FAILED;
+      LOG_WARN("fail to mmap sqlaudit ring", K(map_size), KERRMSGS, K(ret));
+    }
+  } else if (OB_UNLIKELY((fd_ = ::open(export_path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600)) < 0)) {
+    ret = OB_IO_ERROR;
+    LOG_WARN("fail to open sqlaudit ring export file", K(export_path), KERRMSGS, K(ret));
+  } else if (OB_UNLIKELY(0 != ::fchmod(fd_, 0600))) {
+    // the file holds raw sql text, an existing file may have been created with other mode
+    ret = OB_IO_ERROR;
+    LOG_WARN("fail to chmod sqlaudit ring export file", K(export_path), KERRMSGS, K(ret));
+  } else if (OB_UNLIKELY(0 != ::ftruncate(fd_, map_size))) {
+    ret = OB_IO_ERROR;
+    LOG_WARN("fail to truncate sqlaudit ring export file", K(export_path), K(map_size), KERRMSGS, K(ret));
+  } else if (MAP_FAILED == (addr = ::mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0))) {
+    ret = OB_ALLOCATE_MEMORY_FAILED;
+    LOG_WARN("fail to mmap sqlaudit ring export file", K(export_path), K(map_size), KERRMSGS, K(ret));
+  }
+
+  if (OB_SUCC(ret)) {
+    // both the anonymous mapping and the truncated file are zero filled
+    map_size_ = map_size;
+    capacity_ = map_size - ObSqlauditRingHeader::HEADER_SIZE;
+    thread_idx_ = thread_idx;
+    header_ = static_cast<ObSqlauditRingHeader *>(addr);
+    data_ = static_cast<char *>(addr) + ObSqlauditRingHeader::HEADER_SIZE;
+    random_state_ = static_cast<uint64_t>(get_hrtime_internal()) ^ (static_cast<uint64_t>(thread_idx + 1) << 32);
+    if (0 == random_state_) {
+      random_state_ = 1;
+    }
+    header_->version_ = ObSqlauditRingHeader::VERSION;
+    header_->header_size_ = ObSqlauditRingHeader::HEADER_SIZE;
+    header_->capacity_ = capacity_;
+    header_->thread_idx_ = thread_idx;
+    header_->pid_ = static_cast<int64_t>(getpid());
+    // magic is set last, readers ignore the file until it is valid
+    ATOMIC_STORE(&header_->magic_, ObSqlauditRingHeader::RING_MAGIC);
+    is_inited_ = true;
+  } else if (fd_ >= 0) {
+    (void)::close(fd_);
+    fd_ = -1;
+  }
+  return ret;
+}
+
+void ObSqlauditRing::destroy()
+{
+  if (NULL != header_) {
+    (void)::munmap(header_, map_size_);
+    header_ = NULL;
+    data_ = NULL;
+  }
+  // the export file is kept, it is useful after the process exits,
+  // it is removed when the next process starts
+  if (fd_ >= 0) {
+    (void)::close(fd_);
+    fd_ = -1;
+  }
+  capacity_ = 0;
+  map_size_ = 0;
+  is_inited_ = false;
+}
+
+bool ObSqlauditRing::need_record(const bool is_slow, const bool is_error,
+                                 const int64_t sample_ratio, const int64_t error_sample_ratio)
+{
+  bool bret = false;
+  if (OB_LIKELY(is_inited_)) {
+    const int64_t ratio = is_error ? error_sample_ratio : sample_ratio;
+    if (is_slow || ratio >= 100) {
+      bret = true;
+    } else if (ratio > 0) {
+      // xorshift64, only used by the owner thread
+      random_state_ ^= random_state_ << 13;
+      random_state_ ^= random_state_ >> 7;
+      random_state_ ^= random_state_ << 17;
+      bret = static_cast<int64_t>(random_state_ % 100) < ratio;
+    }
+  }
+  return bret;
+}
+
+bool ObSqlauditRing::is_valid_record_len(const int64_t offset, const int64_t len, const int64_t head) const
+{
+  // a record never wraps, nor goes past head
+  return len >= RECORD_ALIGN && 0 == len % RECORD_ALIGN
+         && len <= head - offset && (offset % capacity_) + len <= capacity_;
+}
+
+void ObSqlauditRing::reserve(const int64_t head, const int64_t len)
+{
+  int64_t tail = header_->tail_;
+  if (head + len - tail > capacity_) {
+    while (head + len - tail > capacity_) {
+      const int64_t record_len = reinterpret_cast<ObSqlauditRingRecord *>(get_pos(tail))->len_;
+      if (OB_UNLIKELY(!is_valid_record_len(tail, record_len, head))) {
+        // the shared mapping may be written outside, drop all records instead of walking into garbage
+        LOG_WARN("invalid sqlaudit ring record, drop all records", K(tail), K(record_len), K(head),
+                 K_(capacity), K_(thread_idx));
+        tail = head;
+      } else {
+        tail += record_len;
+      }
+    }
+    // readers must see the new tail before the records below it are overwritten
+    ATOMIC_STORE(&header_->tail_, tail);
+  }
+}
+
+void ObSqlauditRing::record(ObSqlauditRingRecord &record, const ObString &sql, const int64_t sql_max_len)
+{
+  if (OB_LIKELY(is_inited_)) {
+    // one record never takes more than a quarter of the ring
+    const int64_t max_len = capacity_ / 4 - static_cast<int64_t>(sizeof(ObSqlauditRingRecord));
+    int64_t sql_len = sql.length();
+    if (sql_len > sql_max_len) {
+      sql_len = sql_max_len;
+    }
+    if (sql_len > max_len) {
+      sql_len = max_len;
+    }
+    if (sql_len < 0) {
+      sql_len = 0;
+    }
+    const int64_t len = get_record_len(sql_len);
+    int64_t head = header_->head_;
+    const int64_t pos = head % capacity_;
+    if (pos + len > capacity_) {
+      // records never wrap, the rest of the ring is filled with a padding record
+      const int64_t padding_len = capacity_ - pos;
+      reserve(head, padding_len);
+      ObSqlauditRingRecord *padding = reinterpret_cast<ObSqlauditRingRecord *>(get_pos(head));
+      padding->len_ = static_cast<int32_t>(padding_len);
+      padding->type_ = SQLAUDIT_RING_RECORD_PADDING;
+      head += padding_len;
+    }
+    reserve(head, len);
+
+    record.len_ = static_cast<int32_t>(len);
+    record.type_ = SQLAUDIT_RING_RECORD_SQL;
+    record.offset_ = head;
+    record.seq_ = header_->record_count_;
+    record.sql_len_ = static_cast<int32_t>(sql_len);
+    record.orig_sql_len_ = sql.length();
+    if (sql_len < sql.length()) {
+      record.flags_ = static_cast<int16_t>(record.flags_ | SQLAUDIT_RING_FLAG_SQL_TRUNCATED);
+    }
+    char *buf = get_pos(head);
+    MEMCPY(buf, &record, sizeof(ObSqlauditRingRecord));
+    if (sql_len > 0) {
+      MEMCPY(buf + sizeof(ObSqlauditRingRecord), sql.ptr(), sql_len);
+    }
+    ATOMIC_STORE(&header_->head_, head + len);
+    ATOMIC_STORE(&header_->record_count_, record.seq_ + 1);
+  }
+}
+
+int ObSqlauditRing::read(int64_t &offset, char *buf, const int64_t buf_len, int64_t &data_len) const
+{
+  int ret = OB_SUCCESS;
+  data_len = 0;
+  if (OB_UNLIKELY(!is_inited_)) {
+    ret = OB_NOT_INIT;
+    LOG_WARN("sqlaudit ring is not inited", K(ret));
+  } else if (OB_ISNULL(buf) || OB_UNLIKELY(buf_len <= 0)) {
+    ret = OB_INVALID_ARGUMENT;
+    LOG_WARN("invalid argument", KP(buf), K(buf_len), K(ret));
+  } else {
+    const int64_t head = ATOMIC_LOAD(&header_->head_);
+    int64_t tail = ATOMIC_LOAD(&header_->tail_);
+    int64_t cur = (offset < tail) ? tail : offset;
+    bool is_buf_full = false;
+    while (OB_SUCC(ret) && !is_buf_full && cur < head) {
+      const ObSqlauditRingRecord *record = reinterpret_cast<const ObSqlauditRingRecord *>(get_pos(cur));
+      const int64_t len = record->len_;
+      const int64_t type = record->type_;
+      const bool is_valid_len = is_valid_record_len(cur, len, head);
+      if (is_valid_len && SQLAUDIT_RING_RECORD_SQL == type && data_len + len > buf_len) {
+        is_buf_full = true;
+      } else {
+        if (is_valid_len && SQLAUDIT_RING_RECORD_SQL == type) {
+          MEMCPY(buf + data_len, record, len);
+        }
+        MEM_BARRIER();
+        tail = ATOMIC_LOAD(&header_->tail_);
+        if (tail > cur) {
+          // the record was overwritten while being copied
+          cur = tail;
+        } else if (OB_UNLIKELY(!is_valid_len)) {
+          ret = OB_ERR_UNEXPECTED;
+          LOG_WARN("invalid sqlaudit ring record", K(cur), K(len), K(head), K(tail), K(ret));
+        } else {
+          if (SQLAUDIT_RING_RECORD_SQL == type) {
+            data_len += len;
+          }
+          cur += len;
+        }
+      }
+    }
+    if (is_buf_full && 0 == data_len) {
+      ret = OB_BUF_NOT_ENOUGH;
+      LOG_WARN("buf is not enough for one sqlaudit ring record", K(buf_len), K(ret));
+    }
+    offset = cur;
+  }
+  return ret;
+}
+
+int remove_stale_sqlaudit_ring_files(const char *dir)
+{
+  int ret = OB_SUCCESS;
+  DIR *ring_dir = NULL;
+  struct dirent *ent = NULL;
+  char path[ObLayout::MAX_PATH_LENGTH];
+  const int cur_pid = getpid();
+  if (OB_ISNULL(dir)) {
+    ret = OB_INVALID_ARGUMENT;
+    LOG_WARN("invalid argument", K(ret));
+  } else if (OB_ISNULL(ring_dir = opendir(dir))) {
+    ret = OB_IO_ERROR;
+    LOG_WARN("fail to open dir", K(dir), KERRMSGS, K(ret));
+  }
+  while (OB_SUCC(ret) && NULL != (ent = readdir(ring_dir))) {
+    int pid = 0;
+    int64_t thread_idx = 0;
+    int name_len = 0;
+    // only sqlaudit_ring.<pid>.<thread_idx>
+    if (2 == sscanf(ent->d_name, "sqlaudit_ring.%d.%ld%n", &pid, &thread_idx, &name_len)
+        && '\0' == ent->d_name[name_len] && pid > 0 && pid != cur_pid
+        && 0 != kill(pid, 0) && ESRCH == errno) {
+      // the rings of a process still running, e.g. the old one during hot upgrade, are kept
+      const int64_t len = snprintf(path, sizeof(path), "%s/%s", dir, ent->d_name);
+      if (OB_UNLIKELY(len <= 0 || len >= static_cast<int64_t>(sizeof(path)))) {
+        LOG_WARN("fail to build stale sqlaudit ring path", K(dir), "name", ent->d_name);
+      } else if (OB_UNLIKELY(0 != ::unlink(path))) {
+        LOG_WARN("fail to remove stale sqlaudit ring file", K(path), KERRMSGS);
+      } else {
+        LOG_INFO("remove stale sqlaudit ring file", K(path));
+      }
+    }
+  }
+  if (OB_LIKELY(NULL != ring_dir) && OB_UNLIKELY(0 != closedir(ring_dir))) {
+    LOG_WARN("fail to close dir", K(dir), KERRMSGS);
+  }
+  return ret;
+}
+
+int init_sqlaudit_rings_for_thread()
+{
+  int ret = OB_SUCCESS;
+  const int64_t mem_size = get_global_proxy_config().sqlaudit_ring_mem_limited;
+  const bool enable_export = get_global_proxy_config().enable_sqlaudit_ring_export;
+  // nothing in process reads the ring, it is only kept for the tools reading the exported file
+  if (mem_size > 0 && enable_export) {
+    const int64_t event_thread_count = g_event_processor.thread_count_for_type_[ET_CALL];
+    char path[ObLayout::MAX_PATH_LENGTH];
+    ObSqlauditRing *ring = NULL;
+    // the files of exited processes are not removed by them, see ObSqlauditRing::destroy()
+    if (OB_FAIL(remove_stale_sqlaudit_ring_files(get_global_layout().get_log_dir()))) {
+      LOG_WARN("fail to remove stale sqlaudit ring files", K(ret));
+    }
+    for (int64_t i = 0; i < event_thread_count && OB_SUCC(ret); ++i) {
+      // the pid keeps the rings of the old and new process apart during hot upgrade
+      const int64_t len = snprintf(path, sizeof(path), "%s/sqlaudit_ring.%d.%ld",
+                                   get_global_layout().get_log_dir(), getpid(), i);
+      if (OB_UNLIKELY(len <= 0 || len >= static_cast<int64_t>(sizeof(path)))) {
+        ret = OB_SIZE_OVERFLOW;
+        LOG_WARN("fail to build sqlaudit ring export path", K(i), K(len), K(ret));
+      } else if (OB_ISNULL(ring = new (std::nothrow) ObSqlauditRing())) {
+        ret = OB_ALLOCATE_MEMORY_FAILED;
+        LOG_WARN("fail to new ObSqlauditRing", K(i), K(ret));
+      } else if (OB_FAIL(ring->init(mem_size, i, path))) {
+        LOG_WARN("fail to init sqlaudit ring", K(i), K(mem_size), K(ret));
+        delete ring;
+        ring = NULL;
+      } else {
+        g_event_processor.event_thread_[ET_CALL][i]->sqlaudit_ring_ = ring;
+      }
+    }
+  }
+  return ret;
+}
+
+} // end of namespace proxy
+} // end of namespace obproxy
+} // end of namespace oceanbase
@@ -0,0 +1,176 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#ifndef OBPROXY_SQLAUDIT_RING_H
+#define OBPROXY_SQLAUDIT_RING_H
+
+#include "lib/ob_define.h"
+#include "lib/string/ob_string.h"
+#include "lib/atomic/ob_atomic.h"
+#include "lib/utility/ob_print_utils.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace proxy
+{
+
+// The first page of the ring, the layout is stable so that tools outside
+// the process can read the exported file.
+struct ObSqlauditRingHeader
+{
+  static const uint64_t RING_MAGIC = 0x474E495241535142; // "BQSARING" in little endian
+  static const int64_t VERSION = 1;
+  static const int64_t HEADER_SIZE = 4096;
+
+  uint64_t magic_;
+  int64_t version_;
+  int64_t header_size_;
+  int64_t capacity_;               // bytes of the record area following the header
+  int64_t thread_idx_;
+  int64_t pid_;
+  // logical offsets, they only grow, the physical position is offset % capacity_.
+  // records in [tail_, head_) are valid
+  volatile int64_t head_;
+  volatile int64_t tail_;
+  volatile int64_t record_count_;
+  volatile int64_t drop_count_;
+};
+
+enum ObSqlauditRingRecordType
+{
+  SQLAUDIT_RING_RECORD_PADDING = 0,
+  SQLAUDIT_RING_RECORD_SQL = 1,
+};
+
+enum ObSqlauditRingRecordFlag
+{
+  SQLAUDIT_RING_FLAG_SLOW = 1 << 0,
+  SQLAUDIT_RING_FLAG_ERROR = 1 << 1,
+  SQLAUDIT_RING_FLAG_SQL_TRUNCATED = 1 << 2,
+};
+
+// Variable length record, followed by sql_len_ bytes of sql text, the total
+// length is aligned to 8. A padding record only has len_ and type_ valid.
+struct ObSqlauditRingRecord
+{
+  static const int64_t SERVER_ADDR_LENGTH = 64;
+
+  int32_t len_;
+  int16_t type_;
+  int16_t flags_;
+  int32_t sql_cmd_;
+  int32_t error_code_;
+  int64_t offset_;                 // logical offset of the record in the ring
+  int64_t seq_;
+  int64_t sm_id_;
+  int64_t gmt_create_us_;
+  int64_t request_total_time_us_;
+  int64_t server_process_time_us_;
+  int64_t proxy_process_time_us_;
+  int32_t sql_len_;
+  int32_t orig_sql_len_;
+  char server_addr_[SERVER_ADDR_LENGTH];
+
+  const char *get_sql() const { return reinterpret_cast<const char *>(this + 1); }
+  common::ObString get_sql_string() const { return common::ObString(sql_len_, get_sql()); }
+
+  TO_STRING_KV(K_(len), K_(type), K_(flags), K_(sql_cmd), K_(error_code), K_(offset), K_(seq), K_(sm_id),
+               K_(gmt_create_us), K_(request_total_time_us), K_(server_process_time_us),
+               K_(proxy_process_time_us), K_(sql_len), K_(orig_sql_len), K_(server_addr));
+};
+
+// Per thread sql audit ring with variable length records.
+//
+// Unlike ObSqlauditRecordQueue, records are not fixed size, so the sql text is
+// kept up to a configurable length and short statements take little memory.
+//
+// Only the owner thread writes. Before overwriting the oldest records the writer
+// moves tail_ past them, after the new record is written it publishes head_, so
+// tail_ and head_ are always record boundaries. Readers (in process, or outside
+// the process by mapping the exported file) copy one record, then load tail_
+// again: if it has moved past the record, the copy may be torn, it is dropped
+// and reading goes on from the new tail.
+//
+// The ring lives in a shared mapping of export_path, so that external tools can
+// tail it without going through show sqlaudit. Work threads only get rings when
+// the export is enabled, an anonymous mapping (NULL export_path) is only for
+// readers in process.
+class ObSqlauditRing
+{
+public:
+  static const int64_t MIN_CAPACITY = 64 * 1024;
+  static const int64_t RECORD_ALIGN = 8;
+
+  ObSqlauditRing();
+  ~ObSqlauditRing() { destroy(); }
+
+  int init(const int64_t mem_size, const int64_t thread_idx, const char *export_path);
+  void destroy();
+  bool is_inited() const { return is_inited_; }
+
+  // sampled by sample_ratio percent, requests which failed are sampled by
+  // error_sample_ratio percent instead, slow requests are always recorded
+  bool need_record(const bool is_slow, const bool is_error,
+                   const int64_t sample_ratio, const int64_t error_sample_ratio);
+  // record is filled except len_, type_, offset_, seq_ and the sql lengths,
+  // sql is truncated to sql_max_len
+  void record(ObSqlauditRingRecord &record, const common::ObString &sql, const int64_t sql_max_len);
+
+  // copy whole sql records from logical offset into buf, padding records are skipped.
+  // offset is moved to where the next read starts, if it is below the tail, the
+  // records in between were overwritten and are skipped
+  int read(int64_t &offset, char *buf, const int64_t buf_len, int64_t &data_len) const;
+
+  int64_t get_capacity() const { return capacity_; }
+  int64_t get_head() const { return ATOMIC_LOAD(&header_->head_); }
+  int64_t get_tail() const { return ATOMIC_LOAD(&header_->tail_); }
+  int64_t get_record_count() const { return ATOMIC_LOAD(&header_->record_count_); }
+  int64_t get_drop_count() const { return ATOMIC_LOAD(&header_->drop_count_); }
+
+  static int64_t get_record_len(const int64_t sql_len)
+  {
+    return (static_cast<int64_t>(sizeof(ObSqlauditRingRecord)) + sql_len + RECORD_ALIGN - 1)
+           & ~(RECORD_ALIGN - 1);
+  }
+
+  TO_STRING_KV(K_(is_inited), K_(thread_idx), K_(capacity), K_(map_size), K_(fd));
+
+private:
+  char *get_pos(const int64_t offset) const { return data_ + (offset % capacity_); }
+  bool is_valid_record_len(const int64_t offset, const int64_t len, const int64_t head) const;
+  // move tail until there are len free bytes after head
+  void reserve(const int64_t head, const int64_t len);
+
+private:
+  bool is_inited_;
+  int64_t thread_idx_;
+  int64_t capacity_;
+  int64_t map_size_;
+  int fd_;
+  uint64_t random_state_;
+  ObSqlauditRingHeader *header_;
+  char *data_;
+
+  DISALLOW_COPY_AND_ASSIGN(ObSqlauditRing);
+};
+
+// remove export files in dir of the processes which have exited
+int remove_stale_sqlaudit_ring_files(const char *dir);
+int init_sqlaudit_rings_for_thread();
+
+} // end of namespace proxy
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+#endif // OBPROXY_SQLAUDIT_RING_H
@@ -33,6 +33,10 @@ class ObIMysqlRespAnalyzer
 {
 public:
   virtual int analyze_response(event::ObIOBufferReader &reader, ObMysqlResp *resp = NULL) = 0;
+  // length of response which can be passed by without analyzing, see skip_body()
+  virtual int64_t get_skippable_body_len() { return 0; }
+  // the next len bytes of response will not be given to analyze_response()
+  virtual int skip_body(const int64_t len) { UNUSED(len); return common::OB_NOT_SUPPORTED; }
 };
 
 } // end of namespace proxy
@@ -45,6 +45,13 @@ ObMysqlConfigParams::ObMysqlConfigParams()
 
     default_buffer_water_mark_(0),
     tunnel_request_size_threshold_(0),
+    enable_splice_tunnel_(false),
+    splice_tunnel_min_size_(0),
+    enable_sql_parse_cache_(false),
+    sql_parse_cache_entry_count_(0),
+    enable_client_read_buffer_release_(false),
+    enable_latency_aware_routing_(false),
+    enable_cmd_time_histogram_(false),
     request_buffer_length_(4096),
 
     sock_recv_buffer_size_out_(0),
@@ -60,6 +67,8 @@ ObMysqlConfigParams::ObMysqlConfigParams()
 
     frequent_accept_(false),
     net_accept_threads_(0),
+    enable_reuse_port_accept_(false),
+    enable_reuse_port_cpu_steering_(false),
     default_inactivity_timeout_(0),
     observer_query_timeout_delta_(0),
     short_async_task_timeout_(0),
@@ -73,6 +82,7 @@ ObMysqlConfigParams::ObMysqlConfigParams()
     task_thread_num_(0),
     block_thread_num_(0),
     grpc_thread_num_(0),
+    ssl_handshake_thread_num_(0),
     automatic_match_work_thread_(true),
 
     enable_congestion_(false),
@@ -110,6 +120,10 @@ ObMysqlConfigParams::ObMysqlConfigParams()
     slow_proxy_process_time_threshold_(0),
     query_digest_time_threshold_(0),
     slow_query_time_threshold_(0),
+    sqlaudit_ring_sql_max_len_(0),
+    sqlaudit_ring_sample_ratio_(0),
+    sqlaudit_ring_error_sample_ratio_(0),
+    sqlaudit_ring_slow_query_time_threshold_(0),
     proxy_service_mode_(OB_MAX_SERVICE_MODE),
     server_routing_mode_(OB_MAX_ROUTING_MODE),
     proxy_id_(0),
@@ -133,6 +147,13 @@ int ObMysqlConfigParams::assign_config(const ObProxyConfig &proxy_config)
 
   CONFIG_ITEM_ASSIGN(default_buffer_water_mark);
   CONFIG_ITEM_ASSIGN(tunnel_request_size_threshold);
+  CONFIG_ITEM_ASSIGN(enable_splice_tunnel);
+  CONFIG_ITEM_ASSIGN(splice_tunnel_min_size);
+  CONFIG_ITEM_ASSIGN(enable_sql_parse_cache);
+  CONFIG_ITEM_ASSIGN(sql_parse_cache_entry_count);
+  CONFIG_ITEM_ASSIGN(enable_client_read_buffer_release);
+  CONFIG_ITEM_ASSIGN(enable_latency_aware_routing);
+  CONFIG_ITEM_ASSIGN(enable_cmd_time_histogram);
   CONFIG_ITEM_ASSIGN(request_buffer_length);
 
   CONFIG_ITEM_ASSIGN(sock_recv_buffer_size_out);
@@ -154,6 +175,8 @@ int ObMysqlConfigParams::assign_config(const ObProxyConfig &proxy_config)
 
   CONFIG_ITEM_ASSIGN(frequent_accept);
   CONFIG_ITEM_ASSIGN(net_accept_threads);
+  CONFIG_ITEM_ASSIGN(enable_reuse_port_accept);
+  CONFIG_ITEM_ASSIGN(enable_reuse_port_cpu_steering);
   CONFIG_TIME_ASSIGN(default_inactivity_timeout);
   CONFIG_TIME_ASSIGN(observer_query_timeout_delta);
   CONFIG_TIME_ASSIGN(short_async_task_timeout);
@@ -166,6 +189,7 @@ int ObMysqlConfigParams::assign_config(const ObProxyConfig &proxy_config)
   CONFIG_ITEM_ASSIGN(task_thread_num);
   CONFIG_ITEM_ASSIGN(block_thread_num);
   CONFIG_ITEM_ASSIGN(grpc_thread_num);
+  CONFIG_ITEM_ASSIGN(ssl_handshake_thread_num);
   CONFIG_ITEM_ASSIGN(automatic_match_work_thread);
 
   CONFIG_ITEM_ASSIGN(enable_congestion);
@@ -203,6 +227,10 @@ int ObMysqlConfigParams::assign_config(const ObProxyConfig &proxy_config)
   CONFIG_TIME_ASSIGN(slow_proxy_process_time_threshold);
   CONFIG_TIME_ASSIGN(query_digest_time_threshold);
   CONFIG_TIME_ASSIGN(slow_query_time_threshold);
+  CONFIG_ITEM_ASSIGN(sqlaudit_ring_sql_max_len);
+  CONFIG_ITEM_ASSIGN(sqlaudit_ring_sample_ratio);
+  CONFIG_ITEM_ASSIGN(sqlaudit_ring_error_sample_ratio);
+  CONFIG_TIME_ASSIGN(sqlaudit_ring_slow_query_time_threshold);
   CONFIG_ITEM_ASSIGN(proxy_id);
   CONFIG_ITEM_ASSIGN(client_max_memory_size);
 
@@ -294,16 +322,21 @@ DEF_TO_STRING(ObMysqlConfigParams)
        K_(stat_dump_interval), K_(enable_flow_control), K_(flow_high_water_mark),
        K_(flow_low_water_mark), K_(flow_consumer_reenable_threshold),
        K_(flow_event_queue_threshold), K_(default_buffer_water_mark),
-       K_(tunnel_request_size_threshold), K_(request_buffer_length),
+       K_(tunnel_request_size_threshold), K_(enable_splice_tunnel),
+       K_(splice_tunnel_min_size), K_(enable_sql_parse_cache),
+       K_(sql_parse_cache_entry_count), K_(enable_client_read_buffer_release),
+       K_(request_buffer_length),
        K_(sock_recv_buffer_size_out), K_(sock_send_buffer_size_out),
        K_(server_tcp_keepidle), K_(server_tcp_keepintvl),
        K_(server_tcp_keepcnt), K_(server_tcp_user_timeout),
        K_(sock_option_flag_out), K_(sock_packet_mark_out), K_(sock_packet_tos_out),
-       K_(server_tcp_init_cwnd), K_(frequent_accept), K_(net_accept_threads));
+       K_(server_tcp_init_cwnd), K_(frequent_accept), K_(net_accept_threads),
+       K_(enable_reuse_port_accept), K_(enable_reuse_port_cpu_steering));
   J_COMMA();
   J_KV(K_(short_async_task_timeout), K_(short_async_task_timeout), K_(min_congested_connect_timeout),
        K_(tenant_location_valid_time), K_(local_bound_ip), K_(listen_port), K_(stack_size), K_(work_thread_num),
-       K_(task_thread_num), K_(block_thread_num), K_(grpc_thread_num), K_(automatic_match_work_thread),
+       K_(task_thread_num), K_(block_thread_num), K_(grpc_thread_num), K_(ssl_handshake_thread_num),
+       K_(automatic_match_work_thread),
        K_(enable_congestion), K_(enable_bad_route_reject), K_(test_server_addr),
        K_(sqlaudit_mem_limited), K_(max_connections), K_(client_max_connections),
        K_(enable_client_connection_lru_disconnect), K_(connect_observer_max_retries),
@@ -319,7 +352,11 @@ DEF_TO_STRING(ObMysqlConfigParams)
        K_(default_inactivity_timeout), K_(enable_partition_table_route), K_(enable_pl_route),
        K_(enable_cluster_checkout), K_(enable_client_ip_checkout), K_(enable_proxy_scramble),
        K_(enable_compression_protocol), K_(enable_ob_protocol_v2), K_(enable_reroute), K_(enable_index_route),
-       K_(enable_causal_order_read));
+       K_(enable_causal_order_read), K_(enable_latency_aware_routing),
+       K_(enable_cmd_time_histogram));
+  J_COMMA();
+  J_KV(K_(sqlaudit_ring_sql_max_len), K_(sqlaudit_ring_sample_ratio),
+       K_(sqlaudit_ring_error_sample_ratio), K_(sqlaudit_ring_slow_query_time_threshold));
   J_OBJ_END();
   return pos;
 }
@@ -68,6 +68,13 @@ public:
 
   CfgInt default_buffer_water_mark_;
   CfgInt tunnel_request_size_threshold_;
+  CfgBool enable_splice_tunnel_;
+  CfgInt splice_tunnel_min_size_;
+  CfgBool enable_sql_parse_cache_;
+  CfgInt sql_parse_cache_entry_count_;
+  CfgBool enable_client_read_buffer_release_;
+  CfgBool enable_latency_aware_routing_;
+  CfgBool enable_cmd_time_histogram_;
   CfgInt request_buffer_length_;
 
   CfgInt sock_recv_buffer_size_out_;
@@ -89,6 +96,8 @@ public:
 
   CfgBool frequent_accept_;
   CfgInt net_accept_threads_;
+  CfgBool enable_reuse_port_accept_;
+  CfgBool enable_reuse_port_cpu_steering_;
   CfgTime default_inactivity_timeout_;
   CfgTime observer_query_timeout_delta_;
   CfgTime short_async_task_timeout_;
@@ -102,6 +111,7 @@ public:
   CfgInt task_thread_num_;
   CfgInt block_thread_num_;
   CfgInt grpc_thread_num_;
+  CfgInt ssl_handshake_thread_num_;
   CfgBool automatic_match_work_thread_;
   CfgBool enable_congestion_;
   CfgBool enable_bad_route_reject_;
@@ -139,6 +149,10 @@ public:
   CfgTime slow_proxy_process_time_threshold_;
   CfgTime query_digest_time_threshold_;
   CfgTime slow_query_time_threshold_;
+  CfgInt sqlaudit_ring_sql_max_len_;
+  CfgInt sqlaudit_ring_sample_ratio_;
+  CfgInt sqlaudit_ring_error_sample_ratio_;
+  CfgTime sqlaudit_ring_slow_query_time_threshold_;
   obutils::ObProxyServiceMode proxy_service_mode_;
   obutils::ObServerRoutingMode server_routing_mode_;
   CfgInt proxy_id_;
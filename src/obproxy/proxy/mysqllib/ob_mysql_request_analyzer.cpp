@@ -16,6 +16,7 @@
 #include "packet/ob_mysql_packet_util.h"
 #include "rpc/obmysql/ob_mysql_global.h"
 #include "obutils/ob_cached_variables.h"
+#include "obutils/ob_proxy_sql_parse_cache.h"
 #include "common/obsm_utils.h"
 #include "lib/timezone/ob_time_convert.h"
 #include "opsql/expr_parser/ob_expr_parser.h"
@@ -523,11 +524,38 @@ inline int ObMysqlRequestAnalyzer::do_analyze_request(
             }
             LOG_DEBUG("use_lower_case_name is ", K(use_lower_case_name), K(sql));
 
-            if (OB_FAIL(sql_parser.parse_sql(sql, ctx.parse_mode_, sql_parse_result,
-                                             use_lower_case_name,
-                                             ctx.drop_origin_db_table_name_,
-                                             client_request.is_sharding_user()))) {
+            // sharding request also need ob parser result, which is not cached
+            ObSqlParseResultCache *parse_cache = NULL;
+            bool is_cache_hit = false;
+            int tmp_ret = OB_SUCCESS;
+            if (ctx.enable_sql_parse_cache_ && !client_request.is_sharding_user()) {
+              const int64_t flags = ObSqlParseResultCache::make_flags(ctx.parse_mode_, use_lower_case_name,
+                                                                      ctx.drop_origin_db_table_name_);
+              if (OB_SUCCESS != (tmp_ret = ObSqlParseResultCache::get_thread_cache(
+                                 ctx.sql_parse_cache_entry_count_, parse_cache))) {
+                LOG_WARN("fail to get sql parse cache, parse it anyway", K(tmp_ret));
+                parse_cache = NULL;
+              } else if (OB_SUCCESS != (tmp_ret = parse_cache->get(client_request.get_sql(), flags,
+                                                                   sql_parse_result, is_cache_hit))) {
+                LOG_WARN("fail to get from sql parse cache, parse it anyway", K(tmp_ret));
+                parse_cache = NULL;
+                is_cache_hit = false;
+              }
+            }
+
+            if (is_cache_hit) {
+              LOG_DEBUG("sql parse cache hit", K(sql_parse_result));
+            } else if (OB_FAIL(sql_parser.parse_sql(sql, ctx.parse_mode_, sql_parse_result,
+                                                    use_lower_case_name,
+                                                    ctx.drop_origin_db_table_name_,
+                                                    client_request.is_sharding_user()))) {
               LOG_WARN("fail to parse sql", K(sql), K(ret));
+            } else if (NULL != parse_cache
+                       && OB_SUCCESS != (tmp_ret = parse_cache->put(sql_parse_result)))  {
+              LOG_WARN("fail to put sql parse result into cache, ignore it", K(tmp_ret));
+            }
+
+            if (OB_FAIL(ret)) {
             } else if (client_request.is_sharding_user() && OB_FAIL(parse_sql_fileds(client_request))){
               LOG_WARN("fail to extract_fileds");
             } else if (OB_FAIL(handle_internal_cmd(client_request))) {
@@ -64,6 +64,8 @@ struct ObRequestAnalyzeCtx
   int64_t large_request_threshold_len_;
   int64_t request_buffer_length_;
   bool using_ldg_;
+  bool enable_sql_parse_cache_;
+  int64_t sql_parse_cache_entry_count_;
 };
 
 class ObMysqlRequestAnalyzer
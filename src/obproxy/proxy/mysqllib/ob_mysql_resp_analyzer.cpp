@@ -924,6 +924,29 @@ int ObMysqlRespAnalyzer::analyze_mysql_resp(
   return ret;
 }
 
+int64_t ObMysqlRespAnalyzer::get_skippable_body_len(ObRespResult &result) const
+{
+  int64_t len = 0;
+  if (READ_BODY == state_ && next_read_len_ > 1 && !body_buf_.is_inited()
+      && !meta_analyzer_.is_need_reserve_packet(result)) {
+    len = next_read_len_ - 1;
+  }
+  return len;
+}
+
+int ObMysqlRespAnalyzer::skip_body(const int64_t len, ObRespResult &result)
+{
+  int ret = OB_SUCCESS;
+  if (OB_UNLIKELY(len <= 0) || OB_UNLIKELY(len > get_skippable_body_len(result))) {
+    ret = OB_INVALID_ARGUMENT;
+    LOG_WARN("invalid skip len", K(len), K_(state), K_(next_read_len), K(ret));
+  } else {
+    next_read_len_ -= len;
+    reserved_len_ = 0;
+  }
+  return ret;
+}
+
 inline int ObMysqlRespAnalyzer::build_packet_content(
     ObVariableLenBuffer<FIXED_MEMORY_BUFFER_SIZE> &content_buf)
 {
@@ -209,6 +209,12 @@ public:
   bool is_mysql_mode() const { return STANDARD_MYSQL_PROTOCOL_MODE == mysql_mode_; }
   bool need_wait_more_data() const { return (next_read_len_ > 0); }
 
+  // Body bytes of current packet that need not be seen, only for packets which are
+  // neither copied nor reserved (such as row packets). The last byte is always kept,
+  // so the packet is still finished by analyze_mysql_resp().
+  int64_t get_skippable_body_len(ObRespResult &result) const;
+  int skip_body(const int64_t len, ObRespResult &result);
+
 private:
   int analyze_prepare_ok_pkt(ObRespResult &result);
   int analyze_ok_pkt(bool &is_in_trans);
@@ -63,6 +63,8 @@ public:
   {
     return analyze_trans_response(reader, resp);
   }
+  virtual int64_t get_skippable_body_len() { return analyzer_.get_skippable_body_len(result_); }
+  virtual int skip_body(const int64_t len) { return analyzer_.skip_body(len, result_); }
 
   int analyze_response(event::ObIOBufferReader &reader,
                        ObMysqlAnalyzeResult &result,
@@ -159,7 +159,8 @@ int ObServerSessionInfo::add_text_ps_name(const uint32_t text_ps_name_id)
 }
 
 ObClientSessionInfo::ObClientSessionInfo()
-    : is_inited_(false), is_trans_specified_(false), is_global_vars_changed_(false),
+    : is_inited_(false), is_trans_specified_(false), is_temporary_table_used_(false),
+      is_global_vars_changed_(false),
       is_user_idc_name_set_(false), is_read_consistency_set_(false), is_oracle_mode_(false),
       enable_shard_authority_(false), enable_reset_db_(true), cap_(0), safe_read_snapshot_(0),
       syncing_safe_read_snapshot_(0), route_policy_(1), proxy_route_policy_(MAX_PROXY_ROUTE_POLICY),
@@ -1126,6 +1127,7 @@ void ObClientSessionInfo::destroy()
   destroy_ps_id_addrs_map();
   destroy_piece_info_map();
   is_trans_specified_ = false;
+  is_temporary_table_used_ = false;
   is_global_vars_changed_ = false;
   is_user_idc_name_set_ = false;
   is_read_consistency_set_ = false;
@@ -235,6 +235,12 @@ public:
   }
   void destroy_cursor_id_pair_map();
   int add_text_ps_name(const uint32_t text_ps_name_id);
+  // prepared statements and cursors are bound to this server session,
+  // such session can not be lent to other client sessions
+  bool has_ps_or_cursor() const
+  {
+    return ps_id_pair_map_.count() > 0 || cursor_id_pair_map_.count() > 0 || text_ps_name_set_.size() > 0;
+  }
 
   int get_database_name(ObString &database_name) const;
   int set_database_name(const common::ObString &database_name, const bool is_string_to_lower_case);
@@ -575,6 +581,10 @@ public:
   void clear_trans_specified_flag() { is_trans_specified_ = false; }
   bool is_trans_specified() const { return is_trans_specified_; }
 
+  // set once the session creates a temporary table, it is never cleared
+  void set_temporary_table_used_flag() { is_temporary_table_used_ = true; }
+  bool is_temporary_table_used() const { return is_temporary_table_used_; }
+
   void set_user_identity(const ObProxyLoginUserType identity) { user_identity_ = identity; }
   ObProxyLoginUserType get_user_identity() const { return user_identity_; }
   bool enable_analyze_internal_cmd() const;
@@ -705,6 +715,7 @@ public:
   void reset_client_ps_id() { ps_id_ = 0; }
   ObPsEntry *get_ps_entry() { return ps_entry_; }
   ObPsEntry *get_ps_entry(uint32_t ps_id);
+  int replace_ps_entry(uint32_t ps_id, ObPsEntry *ps_entry);
   void reset_ps_entry() { ps_entry_ = NULL; }
   int add_ps_id_entry(ObPsIdEntry *ps_id_entry) {
       set_ps_entry(ps_id_entry->ps_entry_);
@@ -825,6 +836,8 @@ private:
   bool is_inited_;
   // when exec set transaction xxx, it is true until the next transaction commit
   bool is_trans_specified_;
+  // the session has temporary tables, which may hide tables of the same name
+  bool is_temporary_table_used_;
   // the default value is false, we will check it when we receive the ok packet of saved login
   bool is_global_vars_changed_;
   //when user set proxy_idc_name, set it true;
@@ -964,6 +977,30 @@ inline ObPsEntry *ObClientSessionInfo::get_ps_entry(uint32_t ps_id)
   return ps_entry;
 }
 
+// let the statement of ps_id use ps_entry from now on
+inline int ObClientSessionInfo::replace_ps_entry(uint32_t ps_id, ObPsEntry *ps_entry)
+{
+  int ret = OB_SUCCESS;
+  ObPsIdEntry *ps_id_entry = NULL;
+  if (OB_ISNULL(ps_entry)) {
+    ret = OB_INVALID_ARGUMENT;
+    _PROXY_LOG(WARN, "ps_entry is null, ret=%d, client_ps_id=%d", ret, ps_id);
+  } else if (OB_FAIL(ps_id_entry_map_.get_refactored(ps_id, ps_id_entry))) {
+    _PROXY_LOG(WARN, "fail to get ps_id_entry with client ps id, ret=%d, client_ps_id=%d", ret, ps_id);
+  } else if (OB_ISNULL(ps_id_entry)) {
+    ret = OB_ERR_UNEXPECTED;
+    _PROXY_LOG(WARN, "ps_id_entry is null, ret=%d, client_ps_id=%d", ret, ps_id);
+  } else {
+    ps_entry->inc_ref();
+    if (ps_entry_ == ps_id_entry->ps_entry_) {
+      ps_entry_ = ps_entry;
+    }
+    ps_id_entry->ps_entry_->dec_ref();
+    ps_id_entry->ps_entry_ = ps_entry;
+  }
+  return ret;
+}
+
 inline void ObClientSessionInfo::set_idc_name(const ObString &name)
 {
   const int64_t len = min(name.length(), OB_PROXY_MAX_IDC_NAME_LENGTH);
@@ -564,6 +564,8 @@ inline ObProxySysVarType ObProxySessionInfoHandler::get_sys_var_type(
     type_ret = OBPROXY_VAR_GLOBAL_VARIABLES_VERSION;
   } else if (ObSessionFieldMgr::is_user_privilege_variable(var_name)) {
     type_ret = OBPROXY_VAR_USER_PRIVILEGE;
+  } else if (ObSessionFieldMgr::is_temporary_table_used_variable(var_name)) {
+    type_ret = OBPROXY_VAR_TEMPORARY_TABLE_USED;
   } else if (ObSessionFieldMgr::is_set_trx_executed_variable(var_name)) {
     type_ret = OBPROXY_VAR_SET_TRX_EXECUTED;
   } else if (ObSessionFieldMgr::is_partition_hit_variable(var_name)) {
@@ -771,6 +773,25 @@ inline int ObProxySessionInfoHandler::handle_set_trx_executed_var(
   return ret;
 }
 
+inline int ObProxySessionInfoHandler::handle_temporary_table_used_var(
+    ObClientSessionInfo &client_info,
+    const ObString &value,
+    const bool is_auth_request,
+    bool &need_save)
+{
+  int ret = OB_SUCCESS;
+
+  // the session is bound to its server session like set transaction
+  if (OB_FAIL(handle_set_trx_executed_var(client_info, value, is_auth_request, need_save))) {
+    LOG_WARN("fail to handle temporary table used var", K(value), K(ret));
+  } else if (!is_auth_request && value == ObString::make_string("1")) {
+    client_info.set_temporary_table_used_flag();
+    LOG_DEBUG("set temporary table used");
+  }
+
+  return ret;
+}
+
 inline int ObProxySessionInfoHandler::handle_partition_hit_var(
     const ObString &value,
     const bool is_auth_request,
@@ -907,6 +928,10 @@ inline int ObProxySessionInfoHandler::handle_sys_var(ObClientSessionInfo &client
       ret = handle_set_trx_executed_var(client_info, str_kv.value_,
                                         is_auth_request, need_save);
       break;
+    case OBPROXY_VAR_TEMPORARY_TABLE_USED:
+      ret = handle_temporary_table_used_var(client_info, str_kv.value_,
+                                            is_auth_request, need_save);
+      break;
     case OBPROXY_VAR_PARTITION_HIT:
       ret = handle_partition_hit_var(str_kv.value_, is_auth_request,
                                      resp_result, need_save);
@@ -50,6 +50,7 @@ enum ObProxySysVarType
   OBPROXY_VAR_GLOBAL_VARIABLES_VERSION = 0,
   OBPROXY_VAR_USER_PRIVILEGE,
   OBPROXY_VAR_SET_TRX_EXECUTED,
+  OBPROXY_VAR_TEMPORARY_TABLE_USED,
   OBPROXY_VAR_PARTITION_HIT,
   OBPROXY_VAR_LAST_INSERT_ID,
   OBPROXY_VAR_CAPABILITY_FLAG,
@@ -183,6 +184,11 @@ private:
                                          const bool is_auth_request,
                                          bool &need_save);
 
+  static int handle_temporary_table_used_var(ObClientSessionInfo &client_info,
+                                             const common::ObString &value,
+                                             const bool is_auth_request,
+                                             bool &need_save);
+
   static int handle_partition_hit_var(const common::ObString &value,
                                       const bool is_auth_request,
                                       ObRespAnalyzeResult &resp_result,
@@ -468,6 +468,37 @@ int ObSessionFieldMgr::calc_user_var_hash(uint64_t &hash_val)
   return calc_var_hash_common(user_first_block_, hash_val, NULL, ObString::make_string("user_var"));
 }
 
+int ObSessionFieldMgr::calc_last_insert_id_hash(uint64_t &hash_val) const
+{
+  int ret = OB_SUCCESS;
+  ObSessionSysField *field = NULL;
+  if (OB_UNLIKELY(!is_inited_)) {
+    ret = OB_NOT_INIT;
+    LOG_WARN("not inited", K(ret));
+  } else if (OB_FAIL(get_sys_variable(ObString::make_string(OB_SV_LAST_INSERT_ID), field))) {
+    LOG_WARN("get last_insert_id field error", K(ret));
+  } else if (OB_ISNULL(field)) {
+    ret = OB_ERR_NULL_VALUE;
+    LOG_WARN("unexpect null value in get_sys_variable", K(ret));
+  } else {
+    hash_val = field->value_.hash();
+  }
+  return ret;
+}
+
+int ObSessionFieldMgr::format_shared_pool_identity(ObSqlString &sql)
+{
+  int ret = OB_SUCCESS;
+  if (OB_FAIL(format_var_identity_common(common_sys_first_block_, true, sql))) {
+    LOG_WARN("fail to format common sys var identity", K(ret));
+  } else if (OB_FAIL(format_var_identity_common(sys_first_block_, true, sql))) {
+    LOG_WARN("fail to format sys var identity", K(ret));
+  } else if (OB_FAIL(format_var_identity_common(user_first_block_, false, sql))) {
+    LOG_WARN("fail to format user var identity", K(ret));
+  }
+  return ret;
+}
+
 int ObSessionFieldMgr::set_sys_var_set(ObDefaultSysVarSet *set)
 {
   int ret = common::OB_SUCCESS;
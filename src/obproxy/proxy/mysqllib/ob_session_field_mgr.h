@@ -382,6 +382,10 @@ public:
   int calc_hot_sys_var_hash(uint64_t &hash_val);
   int calc_cold_sys_var_hash(uint64_t &hash_val);
   int calc_user_var_hash(uint64_t &hash_val);
+  int calc_last_insert_id_hash(uint64_t &hash_val) const;
+  // format all used sys and user vars except last_insert_id in name order,
+  // it is the full session state compared by the shared server session pool
+  int format_shared_pool_identity(common::ObSqlString &sql);
   //set and get methord
   int set_cluster_name(const common::ObString &cluster_name);
   int set_tenant_name(const common::ObString &tenant_name);
@@ -506,6 +510,7 @@ public:
   static bool is_user_privilege_variable(const common::ObString &var_name) { return var_name == sql::OB_SV_PROXY_USER_PRIVILEGE; }
   static bool is_set_trx_executed_variable(const common::ObString &var_name) { return var_name == sql::OB_SV_PROXY_SET_TRX_EXECUTED
                                                                                    || var_name == sql::OB_SV_PROXY_SESSION_TEMPORARY_TABLE_USED; }
+  static bool is_temporary_table_used_variable(const common::ObString &var_name) { return var_name == sql::OB_SV_PROXY_SESSION_TEMPORARY_TABLE_USED; }
   static bool is_partition_hit_variable(const common::ObString &var_name) { return var_name == sql::OB_SV_PROXY_PARTITION_HIT; }
   static bool is_global_version_variable(const common::ObString &var_name) { return var_name == sql::OB_SV_PROXY_GLOBAL_VARIABLES_VERSION; }
   static bool is_capability_flag_variable(const common::ObString &var_name) { return var_name == sql::OB_SV_CAPABILITY_FLAG; }
@@ -597,6 +602,38 @@ private:
     return ret;
   }
 
+  template<typename T>
+  int format_var_identity_common(const T *block, const bool is_sys_field, common::ObSqlString &sql)
+  {
+    int ret = common::OB_SUCCESS;
+    if (OB_UNLIKELY(!is_inited_)) {
+      ret = common::OB_NOT_INIT;
+      PROXY_LOG(WARN, "not inited", K(ret));
+    } else {
+      // using map for sort
+      std::map<std::string, const ObSessionBaseField *> field_map;
+      const ObSessionBaseField *field = NULL;
+      for (; NULL != block; block = block->next_) {
+        for (int64_t i = 0; i < block->free_idx_; ++i) {
+          field = block->field_slots_ + i;
+          if (OB_FIELD_USED == field->stat_) {
+            std::string var_name(field->name_, field->name_len_);
+            if (!is_sys_field || 0 != var_name.compare(sql::OB_SV_LAST_INSERT_ID)) {
+              field_map.insert(std::pair<std::string, const ObSessionBaseField *>(var_name, field));
+            }
+          }
+        }
+      }
+      for (std::map<std::string, const ObSessionBaseField *>::iterator it = field_map.begin();
+           common::OB_SUCCESS == ret && it != field_map.end(); ++it) {
+        if (OB_FAIL(it->second->format_util(sql, is_sys_field))) {
+          PROXY_LOG(WARN, "fail to format var", "name", it->first.c_str(), K(ret));
+        }
+      }
+    }
+    return ret;
+  }
+
   template<typename T>
   int calc_var_hash_common(const T *block, uint64_t& hash_val, NeedFunc need_func, const common::ObString& session_name)
   {
@@ -31,7 +31,8 @@ ObMysqlResponsePrepareTransformPlugin *ObMysqlResponsePrepareTransformPlugin::al
 
 ObMysqlResponsePrepareTransformPlugin::ObMysqlResponsePrepareTransformPlugin(ObApiTransaction &transaction)
   : ObTransformationPlugin(transaction, ObTransformationPlugin::RESPONSE_TRANSFORMATION),
-    local_reader_(NULL), local_analyze_reader_(NULL), pkt_reader_(), prepare_state_(PREPARE_OK), num_columns_(0), num_params_(0), pkt_count_(0)
+    local_reader_(NULL), local_analyze_reader_(NULL), pkt_reader_(), prepare_state_(PREPARE_OK), num_columns_(0), num_params_(0), pkt_count_(0),
+    fill_ps_entry_(NULL)
 {
   PROXY_API_LOG(DEBUG, "ObMysqlResponsePrepareTransformPlugin born", K(this));
 }
@@ -39,6 +40,8 @@ ObMysqlResponsePrepareTransformPlugin::ObMysqlResponsePrepareTransformPlugin(ObA
 void ObMysqlResponsePrepareTransformPlugin::destroy()
 {
   PROXY_API_LOG(DEBUG, "ObMysqlResponsePrepareTransformPlugin destroy", K(this));
+  // response is not complete, let the next prepare fill it
+  finish_fill_ps_sql_meta(false);
   ObTransformationPlugin::destroy();
   pkt_reader_.reset();
   op_reclaim_free(this);
@@ -163,14 +166,15 @@ int ObMysqlResponsePrepareTransformPlugin::handle_prepare_param(event::ObIOBuffe
     }
 
     pkt_count_ = 0;
+    finish_fill_ps_sql_meta(true);
+  } else if (NULL == fill_ps_entry_) {
+    // ps meta is filled by others
   } else {
     pkt_reader_.reset();
     if (OB_FAIL(pkt_reader_.get_packet(*reader, field_packet))) {
       PROXY_API_LOG(ERROR, "fail to get filed packet from reader", K(ret));
-    } else {
-      ObClientSessionInfo &cs_info = sm_->get_client_session()->get_session_info();
-      ObIArray<obmysql::EMySQLFieldType> &param_types = cs_info.get_ps_entry()->get_ps_sql_meta().get_param_types();
-      param_types.push_back(field.type_);
+    } else if (OB_FAIL(fill_ps_entry_->get_ps_sql_meta().get_param_types().push_back(field.type_))) {
+      PROXY_API_LOG(WARN, "fail to push back param type", K(ret));
     }
   }
 
@@ -192,26 +196,39 @@ int ObMysqlResponsePrepareTransformPlugin::handle_prepare_ok(event::ObIOBufferRe
 
     reader->replace(reinterpret_cast<const char*>(&client_ps_id), sizeof(client_ps_id), MYSQL_NET_META_LENGTH);
     ObClientSessionInfo &cs_info = sm_->get_client_session()->get_session_info();
-    int64_t origin_num_params = cs_info.get_ps_entry()->get_ps_sql_meta().get_param_count();
-    int64_t origin_num_columns = cs_info.get_ps_entry()->get_ps_sql_meta().get_column_count();
+    ObPsEntry *ps_entry = cs_info.get_ps_entry();
+    // the meta being filled by other session is not checked
+    const bool is_meta_ready = ps_entry->is_ps_sql_meta_ready();
+    int64_t origin_num_params = is_meta_ready ? ps_entry->get_ps_sql_meta().get_param_count() : 0;
+    int64_t origin_num_columns = is_meta_ready ? ps_entry->get_ps_sql_meta().get_column_count() : 0;
 
     if ((origin_num_params > 0 && OB_UNLIKELY(origin_num_params != num_params_))
         || (origin_num_columns > 0 && OB_UNLIKELY(origin_num_columns != num_columns_))) {
-      ret = OB_ERR_UNEXPECTED;
-      PROXY_API_LOG(ERROR, "prepare response ok returns different param count or param count",
+      // schema changed after the meta is filled, fill it again
+      PROXY_API_LOG(WARN, "prepare response ok returns different param count or column count, refresh ps meta",
                     K_(num_columns), K(origin_num_columns),
-                    K_(num_params), K(origin_num_params), KPC(cs_info.get_ps_entry()), K(ret));
-    } else if (num_params_ > 0) {
-      cs_info.get_ps_entry()->get_ps_sql_meta().set_param_count(num_params_);
-      prepare_state_ = PREPARE_PARAM;
-      ObClientSessionInfo &cs_info = sm_->get_client_session()->get_session_info();
-      ObIArray<obmysql::EMySQLFieldType> &param_types = cs_info.get_ps_entry()->get_ps_sql_meta().get_param_types();
-      param_types.reset();
-    } else if (num_columns_ > 0) {
-      cs_info.get_ps_entry()->get_ps_sql_meta().set_column_count(num_columns_);
-      prepare_state_ = PREPARE_COLUMN;
-    } else {
-      prepare_state_ = PREPARE_END;
+                    K_(num_params), K(origin_num_params), KPC(ps_entry));
+      if (OB_FAIL(refresh_ps_entry(client_ps_id, ps_entry))) {
+        PROXY_API_LOG(WARN, "fail to refresh ps entry", K(client_ps_id), K(ret));
+      }
+    }
+
+    if (OB_SUCC(ret)) {
+      // only the first response fills ps meta, the entry may be shared and read by others
+      if (ps_entry->try_lock_ps_sql_meta()) {
+        fill_ps_entry_ = ps_entry;
+        fill_ps_entry_->inc_ref();
+        fill_ps_entry_->get_ps_sql_meta().set_param_count(num_params_);
+        fill_ps_entry_->get_ps_sql_meta().set_column_count(num_columns_);
+        fill_ps_entry_->get_ps_sql_meta().get_param_types().reset();
+      }
+
+      if (num_params_ > 0) {
+        prepare_state_ = PREPARE_PARAM;
+      } else {
+        finish_fill_ps_sql_meta(true);
+        prepare_state_ = num_columns_ > 0 ? PREPARE_COLUMN : PREPARE_END;
+      }
     }
 
     pkt_count_ = 0;
@@ -220,6 +237,40 @@ int ObMysqlResponsePrepareTransformPlugin::handle_prepare_ok(event::ObIOBufferRe
   return ret;
 }
 
+int ObMysqlResponsePrepareTransformPlugin::refresh_ps_entry(const uint32_t client_ps_id, ObPsEntry *&ps_entry)
+{
+  int ret = OB_SUCCESS;
+  if (!ps_entry->is_global()) {
+    // only used by this session
+    ps_entry->reset_ps_sql_meta();
+  } else {
+    // other sessions may be reading the meta, use a new entry
+    ObPsEntry *new_entry = NULL;
+    ObClientSessionInfo &cs_info = sm_->get_client_session()->get_session_info();
+    if (OB_FAIL(get_global_ps_entry_cache().refresh_ps_entry(ps_entry, new_entry))) {
+      PROXY_API_LOG(WARN, "fail to refresh global ps entry", KPC(ps_entry), K(ret));
+    } else if (OB_FAIL(cs_info.replace_ps_entry(client_ps_id, new_entry))) {
+      PROXY_API_LOG(WARN, "fail to replace ps entry", K(client_ps_id), K(ret));
+    } else {
+      ps_entry = new_entry;
+    }
+    if (NULL != new_entry) {
+      new_entry->dec_ref();
+      new_entry = NULL;
+    }
+  }
+  return ret;
+}
+
+void ObMysqlResponsePrepareTransformPlugin::finish_fill_ps_sql_meta(const bool is_ready)
+{
+  if (NULL != fill_ps_entry_) {
+    fill_ps_entry_->unlock_ps_sql_meta(is_ready);
+    fill_ps_entry_->dec_ref();
+    fill_ps_entry_ = NULL;
+  }
+}
+
 void ObMysqlResponsePrepareTransformPlugin::handle_input_complete()
 {
   PROXY_API_LOG(DEBUG, "ObMysqlResponsePrepareTransformPlugin::handle_input_complete happen");
@@ -51,6 +51,8 @@ private:
   int handle_prepare_ok(event::ObIOBufferReader *reader);
   int handle_prepare_param(event::ObIOBufferReader *reader);
   int handle_prepare_column();
+  int refresh_ps_entry(const uint32_t client_ps_id, ObPsEntry *&ps_entry);
+  void finish_fill_ps_sql_meta(const bool is_ready);
 
 private:
   event::ObIOBufferReader *local_reader_;
@@ -60,6 +62,8 @@ private:
   uint16_t num_columns_;
   uint16_t num_params_;
   uint16_t pkt_count_;
+  // the ps entry whose meta is filled by this response, NULL if filled by others
+  ObPsEntry *fill_ps_entry_;
 
   DISALLOW_COPY_AND_ASSIGN(ObMysqlResponsePrepareTransformPlugin);
 };
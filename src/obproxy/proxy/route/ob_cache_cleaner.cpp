@@ -566,6 +566,9 @@ int ObCacheCleaner::clean_one_part_table_cache(const int64_t part_idx)
         buf = NULL;
         buf_len = 0;
       }
+      // washed entries are freed once the lock is released
+      lock.release();
+      table_cache_->reclaim(part_idx);
     } else { // fail to try lock
       ret = OB_ERR_EXCLUSIVE_LOCK_CONFLICT;
     }
@@ -719,6 +722,9 @@ int ObCacheCleaner::clean_one_sub_bucket_partition_cache(const int64_t bucket_id
         buf = NULL;
         buf_len = 0;
       }
+      // washed entries are freed once the lock is released
+      lock.release();
+      partition_cache_->reclaim(bucket_idx);
     } else { // fail to try lock
       LOG_INFO("fail to try lock, wait next round", K(bucket_idx), K(clean_count));
     }
@@ -1033,6 +1039,8 @@ int ObCacheCleaner::do_expire_table_entry()
         MUTEX_TRY_LOCK(lock, bucket_mutex, this_ethread());
         if (lock.is_locked()) {
           table_cache_->gc(i);
+          lock.release();
+          table_cache_->reclaim(i);
         } else {
           all_locked = false;
         }
@@ -1062,6 +1070,8 @@ int ObCacheCleaner::do_expire_partition_entry()
         MUTEX_TRY_LOCK(lock, bucket_mutex, this_ethread());
         if (lock.is_locked()) {
           partition_cache_->gc(i);
+          lock.release();
+          partition_cache_->reclaim(i);
         } else {
           all_locked = false;
         }
@@ -1274,6 +1284,8 @@ int ObCacheCleaner::do_expire_routine_entry()
         MUTEX_TRY_LOCK(lock, bucket_mutex, this_ethread());
         if (lock.is_locked()) {
           routine_cache_->gc(i);
+          lock.release();
+          routine_cache_->reclaim(i);
         } else {
           all_locked = false;
         }
@@ -1436,6 +1448,9 @@ int ObCacheCleaner::clean_one_sub_bucket_routine_cache(const int64_t bucket_idx,
         buf = NULL;
         buf_len = 0;
       }
+      // washed entries are freed once the lock is released
+      lock.release();
+      routine_cache_->reclaim(bucket_idx);
     } else { // fail to try lock
       LOG_INFO("fail to try lock, wait next round", K(bucket_idx), K(clean_count));
     }
@@ -1452,8 +1467,11 @@ int ObCacheCleaner::do_expire_sql_table_entry()
       // every bucket
       for (int64_t i = sql_table_cache_range_.start_idx_; i <= sql_table_cache_range_.end_idx_; ++i) {
         DRWLock &rw_lock = sql_table_cache_->rw_lock_for_key(i);
-        DRWLock::WRLockGuard lock(rw_lock);
-        sql_table_cache_->gc(i);
+        {
+          DRWLock::WRLockGuard lock(rw_lock);
+          sql_table_cache_->gc(i);
+        }
+        sql_table_cache_->reclaim(i);
       }
     }
 
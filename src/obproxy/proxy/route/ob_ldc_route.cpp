@@ -13,6 +13,8 @@
 #define USING_LOG_PREFIX PROXY
 
 #include "ob_ldc_route.h"
+#include "proxy/route/ob_server_latency_stats.h"
+#include "obutils/ob_proxy_config.h"
 
 using namespace oceanbase::common;
 using namespace oceanbase::share;
@@ -485,6 +487,29 @@ int64_t ObLDCRoute::route_order_size_[] = {
     sizeof(route_order_cursor_of_unmerge_follower_first_optimized) / sizeof(ObRouteType),//19
 };
 
+// power of two choices: compare item with one random candidate behind it in the same
+// site, the better one is swapped into item, the other one is kept for the next try
+void ObLDCRoute::choose_better_item(const ObRouteType route_type, const int64_t site_end_index,
+                                    ObLDCItem &item)
+{
+  const int64_t candidate_count = site_end_index - next_index_in_site_;
+  if (candidate_count > 0 && OB_LIKELY(NULL != item.replica_)) {
+    ObLDCItem &other = location_.get_item_array()[ObRandom::rand(next_index_in_site_, site_end_index - 1)];
+    if (OB_LIKELY(NULL != other.replica_) && is_item_matched(route_type, other)) {
+      ObServerLatencyStats &stats = get_global_server_latency_stats();
+      const int64_t item_score = stats.get_score(item.replica_->server_);
+      const int64_t other_score = stats.get_score(other.replica_->server_);
+      if (other_score < item_score) {
+        LOG_DEBUG("choose the replica with lower latency score", K(other_score), K(item_score),
+                  "chosen", other, "skipped", item);
+        const ObLDCItem tmp_item = item;
+        item = other;
+        other = tmp_item;
+      }
+    }
+  }
+}
+
 const ObLDCItem *ObLDCRoute::get_next_item()
 {
   ObLDCItem *ret_item = NULL;
@@ -512,11 +537,10 @@ const ObLDCItem *ObLDCRoute::get_next_item()
       } else {
         ret_item = item_array + next_index_in_site_;
         ++next_index_in_site_;
-        if (!ret_item->is_used_
-            && is_same_role(route_type, *ret_item)
-            && is_same_partition_type(route_type, *ret_item)
-            && is_same_zone_type(route_type, *ret_item)
-            && (disable_merge_status_check_ || is_same_merge_type(route_type, *ret_item))) {
+        if (is_item_matched(route_type, *ret_item)) {
+          if (get_global_proxy_config().enable_latency_aware_routing) {
+            choose_better_item(route_type, site_start_index_array[idc_type + 1], *ret_item);
+          }
           ret_item->is_used_ = true;
           need_break = true;
           LOG_DEBUG("succ to get_next_replica", KPC(ret_item), K_(disable_merge_status_check),
@@ -57,6 +57,9 @@ public:
   int64_t next_index_in_site_;
 
 private:
+  bool is_item_matched(const ObRouteType route_type, const ObLDCItem &item) const;
+  void choose_better_item(const ObRouteType route_type, const int64_t site_end_index, ObLDCItem &item);
+
   DISALLOW_COPY_AND_ASSIGN(ObLDCRoute);
 };
 
@@ -81,6 +84,15 @@ inline bool ObLDCRoute::is_reach_end() const
   return ROUTE_TYPE_MAX == get_curr_route_type();
 }
 
+inline bool ObLDCRoute::is_item_matched(const ObRouteType route_type, const ObLDCItem &item) const
+{
+  return (!item.is_used_
+          && is_same_role(route_type, item)
+          && is_same_partition_type(route_type, item)
+          && is_same_zone_type(route_type, item)
+          && (disable_merge_status_check_ || is_same_merge_type(route_type, item)));
+}
+
 inline ObRouteType ObLDCRoute::get_curr_route_type() const
 {
   return get_route_type(curr_cursor_index_);
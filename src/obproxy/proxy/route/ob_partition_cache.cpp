@@ -167,6 +167,7 @@ int ObPartitionCacheCont::get_partition_entry_local(
       }
     }
     lock_bucket.release();
+    partition_cache.reclaim(partition_cache.part_num(hash));
   }
 
   return ret;
@@ -254,7 +255,8 @@ int ObPartitionCache::init(const int64_t bucket_size)
   } else if (OB_UNLIKELY(bucket_size <= 0 || sub_bucket_size <= 0)) {
     ret = OB_INVALID_ARGUMENT;
     LOG_WARN("invalid input value", K(bucket_size), K(sub_bucket_size), K(ret));
-  } else if (OB_FAIL(PartitionEntryHashMap::init(sub_bucket_size, PARTITION_ENTRY_MAP_LOCK, gc_partition_entry))) {
+  } else if (OB_FAIL(PartitionEntryHashMap::init(sub_bucket_size, PARTITION_ENTRY_MAP_LOCK,
+                                                 gc_partition_entry, NULL, true))) {
     LOG_WARN("fail to init hash partition of partition cache", K(sub_bucket_size), K(ret));
   } else {
     for (int64_t i = 0; i < MT_HASHTABLE_PARTITIONS; ++i) {
@@ -309,7 +311,9 @@ int ObPartitionCache::get_partition_entry(
 
     bool is_locked = false;
     ObPartitionEntry *tmp_entry = NULL;
-    if (OB_FAIL(ObPartitionCacheCont::get_partition_entry_local(*this, key, hash,
+    if (NULL != (*ppentry = get_partition_entry_lockless(hash, key))) {
+      LOG_DEBUG("get_partition_entry, entry found lockless succ", KPC(*ppentry));
+    } else if (OB_FAIL(ObPartitionCacheCont::get_partition_entry_local(*this, key, hash,
             is_add_building_entry, is_locked, tmp_entry))) {
       if (NULL != tmp_entry) {
         tmp_entry->dec_ref();
@@ -358,6 +362,24 @@ int ObPartitionCache::get_partition_entry(
   return ret;
 }
 
+ObPartitionEntry *ObPartitionCache::get_partition_entry_lockless(const uint64_t hash,
+                                                                const ObPartitionEntryKey &key)
+{
+  ObPartitionEntry *entry = NULL;
+  // pending todo ops must be applied first, go through the locked path then
+  if (todo_lists_[part_num(hash)].empty()
+      && NULL != (entry = lookup_entry_lockless(hash, key))) {
+    // expired entry need be set dirty or removed in the locked path
+    if (entry->is_deleted_state()
+        || is_partition_entry_expired_in_qa_mode(*entry)
+        || is_partition_entry_expired_in_time_mode(*entry)) {
+      entry->dec_ref();
+      entry = NULL;
+    }
+  }
+  return entry;
+}
+
 int ObPartitionCache::add_partition_entry(ObPartitionEntry &entry, bool direct_add)
 {
   int ret = OB_SUCCESS;
@@ -382,6 +404,8 @@ int ObPartitionCache::add_partition_entry(ObPartitionEntry &entry, bool direct_a
             tmp_entry = NULL;
           }
         }
+        lock.release();
+        reclaim(part_num(hash));
       } else {
         direct_add = true;
       }
@@ -432,6 +456,8 @@ int ObPartitionCache::remove_partition_entry(const ObPartitionEntryKey &key)
           entry = NULL;
         }
       }
+      lock.release();
+      reclaim(part_num(hash));
     } else {
       ObPartitionCacheParam *param = op_alloc(ObPartitionCacheParam);
       if (OB_ISNULL(param)) {
@@ -84,6 +84,7 @@ public:
 private:
   void destroy();
   int process(const int64_t buck_id, ObPartitionCacheParam *param);
+  ObPartitionEntry *get_partition_entry_lockless(const uint64_t hash, const ObPartitionEntryKey &key);
 
 private:
   bool is_inited_;
@@ -207,6 +207,7 @@ int ObRoutineCacheCont::get_routine_entry_local(
       }
     }
     lock_bucket.release();
+    routine_cache.reclaim(routine_cache.part_num(hash));
   }
 
   return ret;
@@ -288,7 +289,8 @@ int ObRoutineCache::init(const int64_t bucket_size)
   } else if (OB_UNLIKELY(bucket_size <= 0 || sub_bucket_size <= 0)) {
     ret = OB_INVALID_ARGUMENT;
     LOG_WARN("invalid input value", K(bucket_size), K(sub_bucket_size), K(ret));
-  } else if (OB_FAIL(RoutineEntryHashMap::init(sub_bucket_size, ROUTINE_ENTRY_MAP_LOCK, gc_routine_entry))) {
+  } else if (OB_FAIL(RoutineEntryHashMap::init(sub_bucket_size, ROUTINE_ENTRY_MAP_LOCK,
+                                               gc_routine_entry, NULL, true))) {
     LOG_WARN("fail to init hash routine of routine cache", K(sub_bucket_size), K(ret));
   } else {
     for (int64_t i = 0; i < MT_HASHTABLE_PARTITIONS; ++i) {
@@ -343,7 +345,9 @@ int ObRoutineCache::get_routine_entry(
 
     bool is_locked = false;
     ObRoutineEntry *tmp_entry = NULL;
-    if (OB_FAIL(ObRoutineCacheCont::get_routine_entry_local(*this, key, hash,
+    if (NULL != (*ppentry = get_routine_entry_lockless(hash, key))) {
+      LOG_DEBUG("get_routine_entry, entry found lockless succ", KPC(*ppentry));
+    } else if (OB_FAIL(ObRoutineCacheCont::get_routine_entry_local(*this, key, hash,
             is_add_building_entry, is_locked, tmp_entry))) {
       if (NULL != tmp_entry) {
         tmp_entry->dec_ref();
@@ -393,6 +397,22 @@ int ObRoutineCache::get_routine_entry(
   return ret;
 }
 
+ObRoutineEntry *ObRoutineCache::get_routine_entry_lockless(const uint64_t hash,
+                                                          const ObRoutineEntryKey &key)
+{
+  ObRoutineEntry *entry = NULL;
+  // pending todo ops must be applied first, go through the locked path then
+  if (todo_lists_[part_num(hash)].empty()
+      && NULL != (entry = lookup_entry_lockless(hash, key))) {
+    if (entry->is_deleted_state() || is_routine_entry_expired(*entry)) {
+      // expired entry is removed in the locked path
+      entry->dec_ref();
+      entry = NULL;
+    }
+  }
+  return entry;
+}
+
 int ObRoutineCache::add_routine_entry(ObRoutineEntry &entry, bool direct_add)
 {
   int ret = OB_SUCCESS;
@@ -418,6 +438,8 @@ int ObRoutineCache::add_routine_entry(ObRoutineEntry &entry, bool direct_add)
             tmp_entry = NULL;
           }
         }
+        lock.release();
+        reclaim(part_num(hash));
       } else {
         direct_add = true;
       }
@@ -468,6 +490,8 @@ int ObRoutineCache::remove_routine_entry(const ObRoutineEntryKey &key)
           entry = NULL;
         }
       }
+      lock.release();
+      reclaim(part_num(hash));
     } else {
       ObRoutineCacheParam *param = op_alloc(ObRoutineCacheParam);
       if (OB_ISNULL(param)) {
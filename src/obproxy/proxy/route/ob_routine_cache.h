@@ -81,6 +81,7 @@ public:
 private:
   void destroy();
   int process(const int64_t buck_id, ObRoutineCacheParam *param);
+  ObRoutineEntry *get_routine_entry_lockless(const uint64_t hash, const ObRoutineEntryKey &key);
 
 private:
   bool is_inited_;
@@ -0,0 +1,127 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+
+#include "proxy/route/ob_server_latency_stats.h"
+#include "iocore/eventsystem/ob_event_system.h"
+
+using namespace oceanbase::common;
+using namespace oceanbase::obproxy::event;
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace proxy
+{
+
+ObServerLatencyStats::ObServerLatencyItem *ObServerLatencyStats::get_item(
+    const ObAddr &addr, const bool need_create)
+{
+  ObServerLatencyItem *ret_item = NULL;
+  const uint64_t key = get_key(addr);
+  uint64_t cur_key = 0;
+  bool need_break = false;
+  for (int64_t i = 0; NULL == ret_item && !need_break && i < MAX_PROBE_COUNT; ++i) {
+    ObServerLatencyItem &item = items_[(key + i) % MAX_SERVER_COUNT];
+    cur_key = ATOMIC_LOAD(&item.key_);
+    if (0 == cur_key) {
+      if (!need_create) {
+        need_break = true;
+      } else if (ATOMIC_BCAS(&item.key_, 0, key)) {
+        item.addr_ = addr;
+        ATOMIC_STORE(&item.is_ready_, true);
+        ret_item = &item;
+      } else {
+        // claimed by another thread just now, check it again
+        cur_key = ATOMIC_LOAD(&item.key_);
+      }
+    }
+    if (NULL == ret_item && key == cur_key) {
+      // the claiming thread only copies the addr
+      while (!ATOMIC_LOAD(&item.is_ready_)) {
+        PAUSE();
+      }
+      if (item.addr_ == addr) {
+        ret_item = &item;
+      }
+    }
+  }
+  return ret_item;
+}
+
+const ObServerLatencyStats::ObServerLatencyItem *ObServerLatencyStats::get_item(
+    const ObAddr &addr) const
+{
+  return const_cast<ObServerLatencyStats *>(this)->get_item(addr, false);
+}
+
+void ObServerLatencyStats::inc_inflight(const ObAddr &addr)
+{
+  ObServerLatencyItem *item = get_item(addr, true);
+  if (NULL != item) {
+    (void)ATOMIC_AAF(&item->inflight_count_, 1);
+  }
+}
+
+void ObServerLatencyStats::dec_inflight(const ObAddr &addr)
+{
+  ObServerLatencyItem *item = get_item(addr, false);
+  if (NULL != item && ATOMIC_AAF(&item->inflight_count_, -1) < 0) {
+    // paired inc was lost when the table was full
+    ATOMIC_STORE(&item->inflight_count_, 0);
+  }
+}
+
+void ObServerLatencyStats::update_latency(const ObAddr &addr, const int64_t latency_us)
+{
+  ObServerLatencyItem *item = get_item(addr, true);
+  if (NULL != item && latency_us >= 0) {
+    const int64_t now_us = hrtime_to_usec(get_hrtime());
+    const int64_t old_ewma_us = ATOMIC_LOAD(&item->ewma_us_);
+    int64_t new_ewma_us = latency_us;
+    if (now_us - ATOMIC_LOAD(&item->last_update_time_us_) < STAT_EXPIRE_TIME_US) {
+      new_ewma_us = old_ewma_us + ((latency_us - old_ewma_us) >> EWMA_SHIFT);
+    }
+    ATOMIC_STORE(&item->ewma_us_, new_ewma_us);
+    ATOMIC_STORE(&item->last_update_time_us_, now_us);
+  }
+}
+
+int64_t ObServerLatencyStats::get_score(const ObAddr &addr) const
+{
+  int64_t score = 0;
+  const ObServerLatencyItem *item = get_item(addr);
+  if (NULL != item) {
+    const int64_t now_us = hrtime_to_usec(get_hrtime());
+    const int64_t inflight_count = ATOMIC_LOAD(&item->inflight_count_);
+    if (now_us - ATOMIC_LOAD(&item->last_update_time_us_) < STAT_EXPIRE_TIME_US) {
+      // queued requests wait for the ones in flight
+      score = (ATOMIC_LOAD(&item->ewma_us_) + 1) * (inflight_count + 1);
+    } else if (inflight_count > 0) {
+      // no response for a long time, but requests are pending
+      score = STAT_EXPIRE_TIME_US * inflight_count;
+    }
+  }
+  return score;
+}
+
+ObServerLatencyStats &get_global_server_latency_stats()
+{
+  static ObServerLatencyStats server_latency_stats;
+  return server_latency_stats;
+}
+
+} // end of namespace proxy
+} // end of namespace obproxy
+} // end of namespace oceanbase
@@ -0,0 +1,81 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#ifndef OBPROXY_SERVER_LATENCY_STATS_H
+#define OBPROXY_SERVER_LATENCY_STATS_H
+#include "lib/ob_define.h"
+#include "lib/net/ob_addr.h"
+#include "lib/atomic/ob_atomic.h"
+#include "lib/utility/ob_print_utils.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace proxy
+{
+// Per server EWMA of response time and in flight request count, fed by ObMysqlSM
+// and used by ObLDCRoute to pick the better of two random replicas in one site.
+//
+// Servers are kept in a fixed size open addressing table probed by ObAddr::hash(),
+// the slot keeps the ObAddr, so servers with the same hash get their own slots.
+// Slots are claimed with CAS and never freed. All updates are racy by design, a
+// lost update only makes the stat a little less accurate.
+class ObServerLatencyStats
+{
+public:
+  static const int64_t MAX_SERVER_COUNT = 4096;
+  static const int64_t MAX_PROBE_COUNT = 16;
+  static const int64_t EWMA_SHIFT = 3;                      // alpha = 1/8
+  static const int64_t STAT_EXPIRE_TIME_US = 5 * 1000 * 1000; // 5s
+
+  struct ObServerLatencyItem
+  {
+    uint64_t key_;
+    // addr_ is valid once is_ready_ is set by the thread claiming the slot
+    bool is_ready_;
+    common::ObAddr addr_;
+    int64_t ewma_us_;
+    int64_t inflight_count_;
+    int64_t last_update_time_us_;
+  } CACHE_ALIGNED;
+
+  ObServerLatencyStats() { MEMSET(items_, 0, sizeof(items_)); }
+  ~ObServerLatencyStats() {}
+
+  void inc_inflight(const common::ObAddr &addr);
+  void dec_inflight(const common::ObAddr &addr);
+  void update_latency(const common::ObAddr &addr, const int64_t latency_us);
+  // lower is better, a server without recent stat scores 0 so that it gets probed
+  int64_t get_score(const common::ObAddr &addr) const;
+
+private:
+  static uint64_t get_key(const common::ObAddr &addr)
+  {
+    const uint64_t key = static_cast<uint64_t>(addr.hash());
+    return (0 == key) ? 1 : key;
+  }
+  ObServerLatencyItem *get_item(const common::ObAddr &addr, const bool need_create);
+  const ObServerLatencyItem *get_item(const common::ObAddr &addr) const;
+
+private:
+  ObServerLatencyItem items_[MAX_SERVER_COUNT];
+  DISALLOW_COPY_AND_ASSIGN(ObServerLatencyStats);
+};
+
+ObServerLatencyStats &get_global_server_latency_stats();
+
+} // end of namespace proxy
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+#endif /* OBPROXY_SERVER_LATENCY_STATS_H */
@@ -44,7 +44,8 @@ int ObSqlTableCache::init(const int64_t bucket_size)
   } else if (OB_UNLIKELY(bucket_size <= 0 || sub_bucket_size <= 0)) {
     ret = OB_INVALID_ARGUMENT;
     LOG_WARN("invalid input value", K(bucket_size), K(sub_bucket_size), K(ret));
-  } else if (OB_FAIL(SqlTableEntryHashMap::init(sub_bucket_size, SQL_TABLE_ENTRY_MAP_LOCK, gc_sql_table_entry))) {
+  } else if (OB_FAIL(SqlTableEntryHashMap::init(sub_bucket_size, SQL_TABLE_ENTRY_MAP_LOCK,
+                                                gc_sql_table_entry, NULL, true))) {
     LOG_WARN("fail to init hash table of sql table cache", K(sub_bucket_size), K(ret));
   } else {
     is_inited_ = true;
@@ -83,20 +84,26 @@ int ObSqlTableCache::get_table_name(const ObSqlTableEntryKey &key, char *buf, co
     get_sql_table_entry_from_thread_cache(key, entry);
     if (NULL == entry) {
       uint64_t hash = key.hash();
-      DRWLock &rw_lock = rw_lock_for_key(hash);
-      DRWLock::RDLockGuard lock(rw_lock);
-      entry = lookup_entry(hash, key);
-      if (NULL != entry && entry->is_avail_state()) {
+      // lockless lookup first, a miss may race with writers, check it again in read lock
+      if (NULL == (entry = lookup_entry_lockless(hash, key))) {
+        DRWLock &rw_lock = rw_lock_for_key(hash);
+        DRWLock::RDLockGuard lock(rw_lock);
+        if (NULL != (entry = lookup_entry(hash, key))) {
+          entry->inc_ref();
+        }
+      }
+      if (NULL != entry && !entry->is_avail_state()) {
+        entry->dec_ref();
+        entry = NULL;
+      }
+      if (NULL != entry) {
         LOG_DEBUG("succ to get ObSqlTableEntry from global cache", KPC(entry));
-        entry->inc_ref();
         // add into thread cache, will add inc_ref
         ObSqlTableRefHashMap &sql_table_map = self_ethread().get_sql_table_map();
         if (OB_FAIL(sql_table_map.set(entry))) {
           LOG_WARN("fail to set thread sql table map", KPC(entry), K(ret));
           ret = OB_SUCCESS; // ignore ret
         }
-      } else {
-        entry = NULL;
       }
     }
     if (OB_ISNULL(entry)) {
@@ -174,6 +181,7 @@ int ObSqlTableCache::update_sql_table_entry(ObSqlTableEntry &entry)
       LOG_INFO("succ to update sql table entry", K(hash), KPC(tmp_entry), K(entry));
     }
   }
+  reclaim(part_num(hash));
   // no need write lock, direct update thread cache
   if (need_update_cache) {
     ObSqlTableRefHashMap &sql_table_map = self_ethread().get_sql_table_map();
@@ -242,14 +250,17 @@ int ObSqlTableCache::remove_sql_table_entry(const ObSqlTableEntryKey &key)
     uint64_t hash = key.hash();
     ObSqlTableEntry *entry = NULL;
     DRWLock &rw_lock = rw_lock_for_key(hash);
-    DRWLock::WRLockGuard lock(rw_lock);
-    entry = remove_entry(hash, key);
-    LOG_INFO("this entry will be removed from sql table cache", KPC(entry));
-    if (NULL != entry) {
-      entry->set_deleted_state();
-      entry->dec_ref();
-      entry = NULL;
+    {
+      DRWLock::WRLockGuard lock(rw_lock);
+      entry = remove_entry(hash, key);
+      LOG_INFO("this entry will be removed from sql table cache", KPC(entry));
+      if (NULL != entry) {
+        entry->set_deleted_state();
+        entry->dec_ref();
+        entry = NULL;
+      }
     }
+    reclaim(part_num(hash));
   }
   return ret;
 }
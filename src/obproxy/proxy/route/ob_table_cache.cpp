@@ -97,6 +97,7 @@ int ObTableCacheCont::get_table_entry(const int event, ObEvent *e)
           LOG_DEBUG("cont::get_table_entry, entry not found", K_(key));
         }
         lock_bucket.release();
+        table_cache_->reclaim(table_cache_->part_num(hash_));
         action_.continuation_->handle_event(TABLE_ENTRY_EVENT_LOOKUP_DONE, NULL);
         destroy();
       }
@@ -223,7 +224,8 @@ int ObTableCache::init(const int64_t bucket_size)
   } else if (OB_UNLIKELY(bucket_size <= 0 || sub_bucket_size <= 0)) {
     ret = OB_INVALID_ARGUMENT;
     LOG_WARN("invalid input value", K(bucket_size), K(sub_bucket_size), K(ret));
-  } else if (OB_FAIL(TableEntryHashMap::init(sub_bucket_size, TABLE_ENTRY_MAP_LOCK, gc_table_entry))) {
+  } else if (OB_FAIL(TableEntryHashMap::init(sub_bucket_size, TABLE_ENTRY_MAP_LOCK,
+                                             gc_table_entry, NULL, true))) {
     LOG_WARN("fail to init hash table of table cache", K(sub_bucket_size), K(ret));
   } else {
     for (int64_t i = 0; i < MT_HASHTABLE_PARTITIONS; ++i) {
@@ -274,62 +276,68 @@ int ObTableCache::get_table_entry(
     uint64_t hash = key.hash();
     LOG_DEBUG("begin to get table location entry", K(ppentry), K(key), K(cont), K(hash));
 
-    ObProxyMutex *bucket_mutex = lock_for_key(hash);
-    MUTEX_TRY_LOCK(lock_bucket, bucket_mutex, this_ethread());
-    if (lock_bucket.is_locked()) {
-      if (OB_FAIL(run_todo_list(part_num(hash)))) {
-        LOG_WARN("fail to run todo list", K(ret));
-      } else {
-        *ppentry = lookup_entry(hash, key);
-        if (NULL != *ppentry) {
-          if (is_table_entry_expired(**ppentry)) {
-            // expire time mismatch
-            LOG_DEBUG("the table entry is expired", "expire_time_us",
-                      get_cache_expire_time_us(), KPC(*ppentry));
-            *ppentry = NULL;
-            // remove the expired table entry in locked
-            if (OB_FAIL(remove_table_entry(key))) {
-              LOG_WARN("fail to remove table entry", K(key), K(ret));
+    if (NULL != (*ppentry = get_table_entry_lockless(hash, key))) {
+      LOG_DEBUG("get_table_entry, entry found lockless succ", KPC(*ppentry));
+    } else {
+      ObProxyMutex *bucket_mutex = lock_for_key(hash);
+      MUTEX_TRY_LOCK(lock_bucket, bucket_mutex, this_ethread());
+      if (lock_bucket.is_locked()) {
+        if (OB_FAIL(run_todo_list(part_num(hash)))) {
+          LOG_WARN("fail to run todo list", K(ret));
+        } else {
+          *ppentry = lookup_entry(hash, key);
+          if (NULL != *ppentry) {
+            if (is_table_entry_expired(**ppentry)) {
+              // expire time mismatch
+              LOG_DEBUG("the table entry is expired", "expire_time_us",
+                        get_cache_expire_time_us(), KPC(*ppentry));
+              *ppentry = NULL;
+              // remove the expired table entry in locked
+              if (OB_FAIL(remove_table_entry(key))) {
+                LOG_WARN("fail to remove table entry", K(key), K(ret));
+              }
+            } else {
+              (*ppentry)->inc_ref();
+              LOG_DEBUG("get_table_entry, entry found succ", KPC(*ppentry));
             }
           } else {
-            (*ppentry)->inc_ref();
-            LOG_DEBUG("get_table_entry, entry found succ", KPC(*ppentry));
+            // non-existent, return NULL
+            LOG_DEBUG("get_table_entry, entry not found", K(key));
           }
-        } else {
-          // non-existent, return NULL
-          LOG_DEBUG("get_table_entry, entry not found", K(key));
         }
-      }
-    } else {
-      LOG_DEBUG("get_table_entry, trylock failed, reschedule cont interval(ns)",
-                LITERAL_K(ObTableParam::SCHEDULE_TABLE_CACHE_CONT_INTERVAL));
-      ObTableCacheCont *table_cont = NULL;
-      if (OB_ISNULL(table_cont = op_alloc_args(ObTableCacheCont, *this))) {
-        ret = OB_ALLOCATE_MEMORY_FAILED;
-        LOG_ERROR("fail to allocate memory for table cache continuation", K(ret));
-      } else if (OB_FAIL(ObTableEntry::alloc_and_init_table_entry(*key.name_, key.cr_version_,
-          key.cr_id_, table_cont->buf_entry_))) { // use to save name buf
-        LOG_WARN("fail to alloc and init pl entry", K(key), K(ret));
+        lock_bucket.release();
+        reclaim(part_num(hash));
       } else {
-        table_cont->buf_entry_->get_key(table_cont->key_);
-        table_cont->action_.set_continuation(cont);
-        table_cont->mutex_ = cont->mutex_;
-        table_cont->hash_ = hash;
-        table_cont->ppentry_ = ppentry;
-
-        SET_CONTINUATION_HANDLER(table_cont, &ObTableCacheCont::get_table_entry);
-        if (OB_ISNULL(cont->mutex_->thread_holding_)
-            || OB_ISNULL(cont->mutex_->thread_holding_->schedule_in(table_cont,
-                ObTableParam::SCHEDULE_TABLE_CACHE_CONT_INTERVAL))) {
-          ret = OB_ERR_UNEXPECTED;
-          LOG_WARN("fail to schedule imm", K(table_cont), K(ret));
+        LOG_DEBUG("get_table_entry, trylock failed, reschedule cont interval(ns)",
+                  LITERAL_K(ObTableParam::SCHEDULE_TABLE_CACHE_CONT_INTERVAL));
+        ObTableCacheCont *table_cont = NULL;
+        if (OB_ISNULL(table_cont = op_alloc_args(ObTableCacheCont, *this))) {
+          ret = OB_ALLOCATE_MEMORY_FAILED;
+          LOG_ERROR("fail to allocate memory for table cache continuation", K(ret));
+        } else if (OB_FAIL(ObTableEntry::alloc_and_init_table_entry(*key.name_, key.cr_version_,
+            key.cr_id_, table_cont->buf_entry_))) { // use to save name buf
+          LOG_WARN("fail to alloc and init pl entry", K(key), K(ret));
         } else {
-          action = &table_cont->action_;
+          table_cont->buf_entry_->get_key(table_cont->key_);
+          table_cont->action_.set_continuation(cont);
+          table_cont->mutex_ = cont->mutex_;
+          table_cont->hash_ = hash;
+          table_cont->ppentry_ = ppentry;
+
+          SET_CONTINUATION_HANDLER(table_cont, &ObTableCacheCont::get_table_entry);
+          if (OB_ISNULL(cont->mutex_->thread_holding_)
+              || OB_ISNULL(cont->mutex_->thread_holding_->schedule_in(table_cont,
+                  ObTableParam::SCHEDULE_TABLE_CACHE_CONT_INTERVAL))) {
+            ret = OB_ERR_UNEXPECTED;
+            LOG_WARN("fail to schedule imm", K(table_cont), K(ret));
+          } else {
+            action = &table_cont->action_;
+          }
+        }
+        if (OB_FAIL(ret) && OB_LIKELY(NULL != table_cont)) {
+          table_cont->destroy();
+          table_cont = NULL;
         }
-      }
-      if (OB_FAIL(ret) && OB_LIKELY(NULL != table_cont)) {
-        table_cont->destroy();
-        table_cont = NULL;
       }
     }
     if (OB_FAIL(ret)) {
@@ -357,6 +365,21 @@ int ObTableCache::update_entry(ObTableEntry &entry, const ObTableEntryKey &key,
   return ret;
 }
 
+ObTableEntry *ObTableCache::get_table_entry_lockless(const uint64_t hash, const ObTableEntryKey &key)
+{
+  ObTableEntry *entry = NULL;
+  // pending todo ops must be applied first, go through the locked path then
+  if (todo_lists_[part_num(hash)].empty()
+      && NULL != (entry = lookup_entry_lockless(hash, key))) {
+    if (entry->is_deleted_state() || is_table_entry_expired(*entry)) {
+      // expired entry is removed in the locked path
+      entry->dec_ref();
+      entry = NULL;
+    }
+  }
+  return entry;
+}
+
 int ObTableCache::add_table_entry(ObTableEntry &entry, bool direct_add)
 {
   int ret = OB_SUCCESS;
@@ -378,6 +401,8 @@ int ObTableCache::add_table_entry(ObTableEntry &entry, bool direct_add)
         } else if (OB_FAIL(update_entry(entry, key, hash))) {
           LOG_WARN("fail to update_entry", K(entry), K(ret));
         }
+        lock.release();
+        reclaim(part_num(hash));
       } else {
         direct_add = true;
       }
@@ -428,6 +453,8 @@ int ObTableCache::remove_table_entry(const ObTableEntryKey &key)
           entry = NULL;
         }
       }
+      lock.release();
+      reclaim(part_num(hash));
     } else {
       ObTableParam *param = op_alloc(ObTableParam);
       if (OB_ISNULL(param)) {
@@ -492,6 +519,9 @@ int ObTableCache::remove_all_table_entry()
             }
           }
         }
+        // wait for readers once for the whole part
+        lock.release();
+        reclaim(part);
       } else {
         ObTableParam *param = op_alloc(ObTableParam);
         if (NULL != param) {
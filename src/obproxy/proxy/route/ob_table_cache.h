@@ -88,6 +88,7 @@ public:
 
 private:
   int process(const int64_t buck_id, ObTableParam *param);
+  ObTableEntry *get_table_entry_lockless(const uint64_t hash, const ObTableEntryKey &key);
 
 private:
   bool is_inited_;
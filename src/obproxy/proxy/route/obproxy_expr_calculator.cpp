@@ -16,8 +16,10 @@
 #include "opsql/expr_resolver/ob_expr_resolver.h"
 #include "opsql/expr_parser/ob_expr_parser_utils.h"
 #include "obutils/ob_proxy_sql_parser.h"
+#include "obutils/ob_proxy_config.h"
 #include "proxy/mysqllib/ob_proxy_session_info.h"
 #include "proxy/route/obproxy_part_info.h"
+#include "proxy/route/obproxy_expr_template_cache.h"
 #include "proxy/mysql/ob_prepare_statement_struct.h"
 #include "lib/rowid/ob_urowid.h"
 
@@ -80,8 +82,21 @@ int ObProxyExprCalculator::calculate_partition_id(common::ObArenaAllocator &allo
       if (OB_MYSQL_COM_STMT_PREPARE != client_request.get_packet_meta().cmd_) {
         LOG_INFO("fail to do expr resolve", K(print_sql), K(resolve_result), K(part_info));
       }
-    } else {
-    // do nothing here
+    } else if (expr_parse_result.multi_param_values_ > 1
+               && (parse_result.is_insert_stmt() || parse_result.is_replace_stmt()
+                   || parse_result.is_text_ps_insert_stmt() || parse_result.is_text_ps_replace_stmt())
+               && get_global_proxy_config().enable_batch_insert_majority_route) {
+      // route batch insert by all rows instead of the first one, keep the first one if fail
+      int64_t majority_partition_id = partition_id;
+      if (OB_FAIL(calc_batch_insert_partition_id(req_sql, parse_result, expr_parse_result,
+                                                 client_request, client_info, ps_entry,
+                                                 text_ps_entry, part_info, allocator,
+                                                 majority_partition_id))) {
+        LOG_DEBUG("fail to calc partition id of batch insert, use the first row", K(print_sql), K(ret));
+        ret = OB_SUCCESS;
+      } else {
+        partition_id = majority_partition_id;
+      }
     }
   }
 
@@ -160,8 +175,39 @@ int ObProxyExprCalculator::do_expr_parse(const common::ObString &req_sql,
   } else {
     // do nothing
   }
-  if (OB_FAIL(expr_parser.parse_reqsql(req_sql,  parse_result.get_parsed_length(), expr_result, parse_result.get_stmt_type()))) {
+
+  // statements differ only in literals share the part key relations, take the
+  // values from literal spans directly instead of running expr parser again
+  ObExprTemplateCache *template_cache = NULL;
+  bool is_hit = false;
+  if (get_global_proxy_config().enable_sql_parse_cache
+      && INVLIAD_PARSE_MODE != parse_mode
+      && 0 != expr_result.target_mask_) {
+    const uint64_t part_key_signature = ObExprTemplateCache::get_part_key_signature(
+        expr_result.part_key_info_, expr_result.target_mask_);
+    if (OB_FAIL(ObExprTemplateCache::get_thread_cache(
+                get_global_proxy_config().sql_parse_cache_entry_count, template_cache))) {
+      LOG_WARN("fail to get expr template cache, ignore", K(ret));
+      template_cache = NULL;
+      ret = OB_SUCCESS;
+    } else if (OB_FAIL(template_cache->get(req_sql, parse_mode, parse_result.get_stmt_type(),
+                                           part_key_signature, parse_result.get_parsed_length(),
+                                           allocator, expr_result, is_hit))) {
+      LOG_WARN("fail to get expr template, ignore", K(ret));
+      is_hit = false;
+      ret = OB_SUCCESS;
+    }
+  }
+
+  if (is_hit) {
+    expr_result.parse_mode_ = parse_mode;
+    LOG_DEBUG("succ to get expr parse result from template", K(req_sql),
+              "expr_result", ObExprParseResultPrintWrapper(expr_result));
+  } else if (OB_FAIL(expr_parser.parse_reqsql(req_sql,  parse_result.get_parsed_length(), expr_result, parse_result.get_stmt_type()))) {
     LOG_DEBUG("fail to do expr parse_reqsql", K(req_sql), K(ret));
+  } else if (NULL != template_cache && OB_FAIL(template_cache->put(expr_result))) {
+    LOG_WARN("fail to put expr template, ignore", K(ret));
+    ret = OB_SUCCESS;
   }
   return ret;
 }
@@ -331,3 +377,351 @@ int ObProxyExprCalculator::calc_partition_id_using_rowid(const ObExprParseResult
 
   return ret;
 }
+
+// skip spaces and comments
+int64_t ObProxyExprCalculator::skip_blanks(const char *str, const int64_t len, int64_t i)
+{
+  bool is_blank = true;
+  while (is_blank && i < len) {
+    if (isspace(str[i])) {
+      ++i;
+    } else if ('/' == str[i] && i + 1 < len && '*' == str[i + 1]) {
+      i += 2;
+      while (i + 1 < len && !('*' == str[i] && '/' == str[i + 1])) {
+        ++i;
+      }
+      i += 2;
+    } else if ('#' == str[i] || ('-' == str[i] && i + 2 < len && '-' == str[i + 1] && isspace(str[i + 2]))) {
+      while (i < len && '\n' != str[i]) {
+        ++i;
+      }
+    } else {
+      is_blank = false;
+    }
+  }
+  return std::min(i, len);
+}
+
+// the pos after the quoted string which starts at i
+int64_t ObProxyExprCalculator::skip_quoted(const char *str, const int64_t len, int64_t i)
+{
+  const char quote = str[i++];
+  while (i < len) {
+    if ('\\' == str[i] && '`' != quote) {
+      i += 2;
+    } else if (quote == str[i]) {
+      if (i + 1 < len && quote == str[i + 1]) {
+        i += 2;
+      } else {
+        ++i;
+        break;
+      }
+    } else {
+      ++i;
+    }
+  }
+  return std::min(i, len);
+}
+
+static inline bool is_word_char(const char c)
+{
+  return isalnum(c) || '_' == c || '$' == c || (c & 0x80);
+}
+
+// the pos after VALUES keyword, or len if not found
+int64_t ObProxyExprCalculator::skip_to_values(const char *str, const int64_t len)
+{
+  int64_t i = 0;
+  bool found = false;
+  while (!found && (i = skip_blanks(str, len, i)) < len) {
+    if ('\'' == str[i] || '"' == str[i] || '`' == str[i]) {
+      i = skip_quoted(str, len, i);
+    } else if (is_word_char(str[i])) {
+      const int64_t start = i;
+      while (i < len && is_word_char(str[i])) {
+        ++i;
+      }
+      found = (6 == i - start && 0 == strncasecmp(str + start, "VALUES", 6));
+    } else {
+      ++i;
+    }
+  }
+  return found ? i : len;
+}
+
+/*
+ * scan one row "(v1, v2, ...)" of VALUES from pos, and the ',' after it if there is one.
+ * Values are split by the commas out of brackets and quotes. For each r < value_pos_count,
+ * the value at value_pos[r] is put in values[r]. pos is left after the row.
+ */
+int ObProxyExprCalculator::scan_values_row(const char *str, const int64_t len,
+                                           const int64_t *value_pos, const int64_t value_pos_count,
+                                           int64_t &pos, int64_t &placeholder_count,
+                                           ObBatchInsertValue *values, bool &has_next_row)
+{
+  int ret = OB_SUCCESS;
+  int64_t i = pos;
+  int64_t value_idx = 0;
+  bool is_row_end = false;
+  has_next_row = false;
+  if ((i = skip_blanks(str, len, i)) >= len || '(' != str[i]) {
+    ret = OB_ERR_UNEXPECTED;
+  } else {
+    ++i;
+  }
+  while (OB_SUCC(ret) && !is_row_end) {
+    const int64_t start = (i = skip_blanks(str, len, i));
+    const int64_t placeholder_idx = placeholder_count;
+    int64_t end = start;
+    int64_t depth = 0;
+    bool is_value_end = false;
+    while (!is_value_end && i < len) {
+      const char c = str[i];
+      if ('\'' == c || '"' == c || '`' == c) {
+        end = i = skip_quoted(str, len, i);
+      } else if (skip_blanks(str, len, i) > i) {
+        i = skip_blanks(str, len, i);
+      } else if (0 == depth && (',' == c || ')' == c)) {
+        is_value_end = true;
+      } else {
+        if ('(' == c) {
+          ++depth;
+        } else if (')' == c) {
+          --depth;
+        } else if ('?' == c) {
+          ++placeholder_count;
+        }
+        end = ++i;
+      }
+    }
+    if (!is_value_end) {
+      ret = OB_ERR_UNEXPECTED;
+    } else {
+      is_row_end = (')' == str[i]);
+      ++i;
+      for (int64_t r = 0; r < value_pos_count; ++r) {
+        if (value_idx == value_pos[r]) {
+          values[r].start_ = start;
+          values[r].end_ = end;
+          values[r].placeholder_idx_ = placeholder_idx;
+        }
+      }
+      ++value_idx;
+    }
+  }
+  for (int64_t r = 0; OB_SUCC(ret) && r < value_pos_count; ++r) {
+    if (value_idx <= value_pos[r]) {
+      ret = OB_ERR_UNEXPECTED;
+    }
+  }
+  if (OB_SUCC(ret)) {
+    i = skip_blanks(str, len, i);
+    has_next_row = (i < len && ',' == str[i]);
+    if (has_next_row) {
+      ++i;
+    }
+    pos = i;
+  }
+  return ret;
+}
+
+// token of one value in VALUES, as expr parser produces for a single token value
+bool ObProxyExprCalculator::get_value_token(char *str, const int64_t len, const int64_t placeholder_idx,
+                                            ObProxyTokenNode &token)
+{
+  bool bret = false;
+  if (1 == len && '?' == str[0]) {
+    MEMSET(&token, 0, sizeof(token));
+    token.type_ = TOKEN_PLACE_HOLDER;
+    token.placeholder_idx_ = placeholder_idx;
+    bret = true;
+  } else {
+    bret = ObExprTemplateCache::get_literal_token(str, len, token);
+  }
+  return bret;
+}
+
+bool ObProxyExprCalculator::is_same_value_token(const ObProxyTokenNode &left, const ObProxyTokenNode &right)
+{
+  bool bret = (left.type_ == right.type_);
+  if (!bret) {
+  } else if (TOKEN_INT_VAL == left.type_) {
+    bret = (left.int_value_ == right.int_value_);
+  } else if (TOKEN_PLACE_HOLDER == left.type_) {
+    bret = (left.placeholder_idx_ == right.placeholder_idx_);
+  } else if (TOKEN_STR_VAL == left.type_) {
+    bret = (left.str_value_.str_ == right.str_value_.str_
+            && left.str_value_.str_len_ == right.str_value_.str_len_);
+  } else {
+    bret = false;
+  }
+  return bret;
+}
+
+struct ObBatchInsertPartRowCount
+{
+  int64_t partition_id_;
+  int64_t row_count_;
+  TO_STRING_KV(K_(partition_id), K_(row_count));
+};
+
+static int add_batch_insert_row(ObIArray<ObBatchInsertPartRowCount> &part_row_counts,
+                                const int64_t partition_id)
+{
+  int ret = OB_SUCCESS;
+  bool found = false;
+  for (int64_t i = 0; !found && i < part_row_counts.count(); ++i) {
+    if (partition_id == part_row_counts.at(i).partition_id_) {
+      ++part_row_counts.at(i).row_count_;
+      found = true;
+    }
+  }
+  if (!found) {
+    ObBatchInsertPartRowCount part_row_count;
+    part_row_count.partition_id_ = partition_id;
+    part_row_count.row_count_ = 1;
+    if (OB_FAIL(part_row_counts.push_back(part_row_count))) {
+      LOG_WARN("fail to push back part row count", K(part_row_count), K(ret));
+    }
+  }
+  return ret;
+}
+
+/*
+ * expr parser only takes the part keys of the first row in VALUES, so a batch
+ * insert is routed by its first row. Here the value lists are scanned, the
+ * part key values of the sampled rows are put in place of the ones in the
+ * relations of the first row and resolved the same way, and the partition
+ * which gets the most sampled rows is chosen, the first row wins on ties.
+ * Resolving is much more expensive than scanning, so the rows are counted
+ * first and at most BATCH_INSERT_ROUTE_SAMPLE_COUNT rows evenly spread over
+ * the batch are resolved.
+ * Only single token values (literal or ?) of part keys are supported, and the
+ * first row scanned must be the same as the one expr parser got, otherwise
+ * give up and the caller keeps the partition of the first row.
+ */
+int ObProxyExprCalculator::calc_batch_insert_partition_id(const ObString &req_sql,
+                                                          const ObSqlParseResult &parse_result,
+                                                          const ObExprParseResult &expr_result,
+                                                          ObProxyMysqlRequest &client_request,
+                                                          ObClientSessionInfo &client_info,
+                                                          ObPsEntry *ps_entry,
+                                                          ObTextPsEntry *text_ps_entry,
+                                                          ObProxyPartInfo &part_info,
+                                                          ObArenaAllocator &allocator,
+                                                          int64_t &partition_id)
+{
+  int ret = OB_SUCCESS;
+  const ObString expr_sql = ObProxyMysqlRequest::get_expr_sql(req_sql, parse_result.get_parsed_length());
+  char *str = const_cast<char *>(expr_sql.ptr());
+  const int64_t len = expr_sql.length();
+  const ObProxyRelationInfo &relation_info = expr_result.relation_info_;
+  const int64_t relation_num = relation_info.relation_num_;
+  ObExprParseResult row_result = expr_result;
+  ObProxyRelationExpr row_relations[OBPROXY_MAX_RELATION_NUM];
+  ObProxyTokenList row_lists[OBPROXY_MAX_RELATION_NUM];
+  ObProxyTokenNode row_tokens[OBPROXY_MAX_RELATION_NUM];
+  int64_t value_pos[OBPROXY_MAX_RELATION_NUM];
+  ObBatchInsertValue values[OBPROXY_MAX_RELATION_NUM];
+  ObSEArray<ObBatchInsertPartRowCount, 8> part_row_counts;
+  int64_t values_start = 0;
+  int64_t row_count = 0;
+  int64_t sample_step = 1;
+  int64_t sample_count = 0;
+  int64_t placeholder_count = 0;
+  int64_t pos = 0;
+  bool has_next_row = true;
+
+  if (OB_ISNULL(str) || OB_UNLIKELY(len <= 0)
+      || OB_UNLIKELY(relation_num <= 0 || relation_num > OBPROXY_MAX_RELATION_NUM)
+      || OB_UNLIKELY(expr_result.has_rowid_)) {
+    ret = OB_INVALID_ARGUMENT;
+    LOG_DEBUG("invalid argument", K(len), K(relation_num), K(ret));
+  }
+  // the value position of each relation, relations of insert refer to part key idx
+  for (int64_t r = 0; OB_SUCC(ret) && r < relation_num; ++r) {
+    const ObProxyRelationExpr *relation = relation_info.relations_[r];
+    if (OB_ISNULL(relation) || OB_ISNULL(relation->right_value_)
+        || OB_ISNULL(relation->right_value_->head_)
+        || OB_UNLIKELY(NULL != relation->right_value_->head_->next_)
+        || OB_UNLIKELY(F_COMP_EQ != relation->type_)
+        || OB_UNLIKELY(relation->column_idx_ < 0
+                       || relation->column_idx_ >= expr_result.part_key_info_.key_num_)) {
+      ret = OB_NOT_SUPPORTED;
+    } else {
+      value_pos[r] = expr_result.part_key_info_.part_keys_[relation->column_idx_].idx_;
+      row_relations[r] = *relation;
+      row_lists[r] = *relation->right_value_;
+      row_lists[r].head_ = &row_tokens[r];
+      row_lists[r].tail_ = &row_tokens[r];
+      row_relations[r].right_value_ = &row_lists[r];
+      row_result.relation_info_.relations_[r] = &row_relations[r];
+    }
+  }
+  if (OB_SUCC(ret) && (values_start = skip_to_values(str, len)) >= len) {
+    ret = OB_ENTRY_NOT_EXIST;
+  }
+
+  // 1. count the rows, only the structure is scanned
+  pos = values_start;
+  while (OB_SUCC(ret) && has_next_row && row_count < MAX_BATCH_INSERT_ROUTE_ROW_COUNT) {
+    if (OB_SUCC(scan_values_row(str, len, value_pos, relation_num, pos,
+                                placeholder_count, values, has_next_row))) {
+      ++row_count;
+    }
+  }
+  if (OB_SUCC(ret)) {
+    sample_step = (row_count + BATCH_INSERT_ROUTE_SAMPLE_COUNT - 1) / BATCH_INSERT_ROUTE_SAMPLE_COUNT;
+    pos = values_start;
+    placeholder_count = 0;
+  }
+
+  // 2. resolve every sample_step rows, the first row has been calculated by caller
+  for (int64_t row = 0; OB_SUCC(ret) && row < row_count; ++row) {
+    if (OB_FAIL(scan_values_row(str, len, value_pos, relation_num, pos,
+                                placeholder_count, values, has_next_row))) {
+      LOG_DEBUG("fail to scan batch insert row", K(row), K(ret));
+    } else if (0 == row % sample_step) {
+      int64_t row_partition_id = partition_id;
+      for (int64_t r = 0; OB_SUCC(ret) && r < relation_num; ++r) {
+        if (!get_value_token(str + values[r].start_, values[r].end_ - values[r].start_,
+                             values[r].placeholder_idx_, row_tokens[r])) {
+          ret = OB_NOT_SUPPORTED;
+        } else if (0 == row
+                   && !is_same_value_token(row_tokens[r], *relation_info.relations_[r]->right_value_->head_)) {
+          ret = OB_NOT_SUPPORTED;
+        }
+      }
+      if (OB_SUCC(ret) && row > 0) {
+        ObExprResolverResult resolve_result;
+        row_partition_id = OB_INVALID_INDEX;
+        if (OB_FAIL(do_expr_resolve(row_result, client_request, &client_info, ps_entry,
+                                    text_ps_entry, part_info, allocator, resolve_result))) {
+          LOG_DEBUG("fail to do expr resolve for batch insert row", K(row), K(ret));
+        } else if (OB_FAIL(do_partition_id_calc(resolve_result, part_info, allocator, row_partition_id))) {
+          LOG_DEBUG("fail to calc partition id for batch insert row", K(row), K(ret));
+        }
+      }
+      if (OB_SUCC(ret)) {
+        if (OB_FAIL(add_batch_insert_row(part_row_counts, row_partition_id))) {
+          LOG_WARN("fail to add batch insert row", K(row_partition_id), K(ret));
+        } else {
+          ++sample_count;
+        }
+      }
+    }
+  }
+
+  if (OB_SUCC(ret)) {
+    int64_t max_row_count = 0;
+    for (int64_t j = 0; j < part_row_counts.count(); ++j) {
+      if (part_row_counts.at(j).row_count_ > max_row_count) {
+        max_row_count = part_row_counts.at(j).row_count_;
+        partition_id = part_row_counts.at(j).partition_id_;
+      }
+    }
+    LOG_DEBUG("succ to calc partition id of batch insert", K(partition_id), K(row_count),
+              K(sample_count), K(part_row_counts));
+  }
+  return ret;
+}
@@ -39,9 +39,22 @@ class ObClientSessionInfo;
 class ObPsEntry;
 class ObTextPsEntry;
 
+// a value in VALUES of insert, [start_, end_) of the sql without blanks around
+struct ObBatchInsertValue
+{
+  int64_t start_;
+  int64_t end_;
+  int64_t placeholder_idx_; // count of ? before the value
+};
+
 class ObProxyExprCalculator
 {
 public:
+  // rows scanned at most to route a batch insert
+  static const int64_t MAX_BATCH_INSERT_ROUTE_ROW_COUNT = 1024;
+  // rows resolved at most to route a batch insert, evenly spread over the scanned rows
+  static const int64_t BATCH_INSERT_ROUTE_SAMPLE_COUNT = 32;
+
   ObProxyExprCalculator() {}
   ~ObProxyExprCalculator() {}
   int calculate_partition_id(common::ObArenaAllocator &allocator,
@@ -81,6 +94,29 @@ private:
                                     ObProxyPartInfo &part_info,
                                     opsql::ObExprResolverResult &resolve_result,
                                     common::ObIAllocator &allocator);
+  // partition which owns most rows of a multi-row insert, partition_id is the one of
+  // the first row as input
+  int calc_batch_insert_partition_id(const common::ObString &req_sql,
+                                     const obutils::ObSqlParseResult &parse_result,
+                                     const ObExprParseResult &expr_result,
+                                     ObProxyMysqlRequest &client_request,
+                                     ObClientSessionInfo &client_info,
+                                     ObPsEntry *ps_entry,
+                                     ObTextPsEntry *text_ps_entry,
+                                     ObProxyPartInfo &part_info,
+                                     common::ObArenaAllocator &allocator,
+                                     int64_t &partition_id);
+  // scanner of VALUES for batch insert routing
+  static int64_t skip_blanks(const char *str, const int64_t len, int64_t i);
+  static int64_t skip_quoted(const char *str, const int64_t len, int64_t i);
+  static int64_t skip_to_values(const char *str, const int64_t len);
+  static int scan_values_row(const char *str, const int64_t len,
+                             const int64_t *value_pos, const int64_t value_pos_count,
+                             int64_t &pos, int64_t &placeholder_count,
+                             ObBatchInsertValue *values, bool &has_next_row);
+  static bool get_value_token(char *str, const int64_t len, const int64_t placeholder_idx,
+                              ObProxyTokenNode &token);
+  static bool is_same_value_token(const ObProxyTokenNode &left, const ObProxyTokenNode &right);
 };
 } // end of namespace proxy
 } // end of namespace obproxy
@@ -0,0 +1,544 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+#include "proxy/route/obproxy_expr_template_cache.h"
+#include "lib/hash_func/murmur_hash.h"
+#include "lib/allocator/ob_malloc.h"
+
+using namespace oceanbase::common;
+using namespace oceanbase::obproxy::obutils;
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace proxy
+{
+
+static inline bool is_digit_char(const char c)
+{
+  return '0' <= c && c <= '9';
+}
+
+static int64_t skip_digits(const char *str, const int64_t len, int64_t i)
+{
+  while (i < len && is_digit_char(str[i])) {
+    ++i;
+  }
+  return i;
+}
+
+// same as {number} of expr lexer
+static bool is_number_literal(const char *str, const int64_t len)
+{
+  int64_t i = skip_digits(str, len, 0);
+  int64_t digit_count = i;
+  bool has_dot = false;
+  bool has_exp = false;
+  bool is_valid = true;
+  if (i < len && '.' == str[i]) {
+    has_dot = true;
+    const int64_t start = i + 1;
+    i = skip_digits(str, len, start);
+    digit_count += (i - start);
+  }
+  if (i < len && ('e' == str[i] || 'E' == str[i])) {
+    has_exp = true;
+    ++i;
+    if (i < len && ('+' == str[i] || '-' == str[i])) {
+      ++i;
+    }
+    const int64_t start = i;
+    i = skip_digits(str, len, start);
+    is_valid = (i > start);
+  }
+  return is_valid && digit_count > 0 && (has_dot || has_exp) && i == len;
+}
+
+static bool contains_case_insensitive(const char *str, const int64_t len, const char *word)
+{
+  bool found = false;
+  const int64_t word_len = static_cast<int64_t>(STRLEN(word));
+  for (int64_t i = 0; !found && i + word_len <= len; ++i) {
+    found = (0 == strncasecmp(str + i, word, word_len));
+  }
+  return found;
+}
+
+// :N and :+N are positional placeholders for expr lexer, N is masked in key
+static bool has_pos_placeholder(const char *key, const int64_t key_len)
+{
+  bool found = false;
+  for (int64_t i = 0; !found && i + 1 < key_len; ++i) {
+    if (':' == key[i]) {
+      const int64_t j = ('+' == key[i + 1] || '-' == key[i + 1]) ? i + 2 : i + 1;
+      found = (j < key_len && '\0' == key[j]);
+    }
+  }
+  return found;
+}
+
+// digits next to non ascii chars are not masked, but may be lexed as int
+static bool has_non_ascii(const char *key, const int64_t key_len)
+{
+  bool found = false;
+  for (int64_t i = 0; !found && i < key_len; ++i) {
+    found = (0 != (key[i] & 0x80));
+  }
+  return found;
+}
+
+ObExprTemplateCache::ObExprTemplateCache()
+    : is_inited_(false), entry_count_(0), entries_(NULL),
+      is_key_valid_(false), key_hash_(0), key_flags_(0), key_part_key_signature_(0),
+      key_parsed_length_(0), key_len_(0), first_literal_pos_(ObSqlParseResultCache::NO_LITERAL_POS),
+      sql_(), literal_count_(0), hit_count_(0), miss_count_(0)
+{
+}
+
+int ObExprTemplateCache::init(const int64_t entry_count)
+{
+  int ret = OB_SUCCESS;
+  int64_t count = 1;
+  if (OB_UNLIKELY(is_inited_)) {
+    ret = OB_INIT_TWICE;
+    LOG_WARN("init twice", K(ret));
+  } else if (OB_UNLIKELY(entry_count <= 0)) {
+    ret = OB_INVALID_ARGUMENT;
+    LOG_WARN("invalid argument", K(entry_count), K(ret));
+  } else {
+    // round up to power of 2, so the slot can be got by mask
+    while (count < entry_count) {
+      count <<= 1;
+    }
+    const int64_t size = count * static_cast<int64_t>(sizeof(ObExprTemplateEntry *));
+    if (OB_ISNULL(entries_ = static_cast<ObExprTemplateEntry **>(ob_malloc(size, ObModIds::OB_PROXY_SQL_PARSE)))) {
+      ret = OB_ALLOCATE_MEMORY_FAILED;
+      LOG_WARN("fail to alloc mem for expr template cache", K(size), K(ret));
+    } else {
+      MEMSET(entries_, 0, size);
+      entry_count_ = count;
+      is_inited_ = true;
+    }
+  }
+  return ret;
+}
+
+void ObExprTemplateCache::destroy()
+{
+  if (NULL != entries_) {
+    for (int64_t i = 0; i < entry_count_; ++i) {
+      ObExprTemplateEntry *entry = entries_[i];
+      if (NULL != entry) {
+        if (NULL != entry->key_) {
+          ob_free(entry->key_);
+          entry->key_ = NULL;
+        }
+        entry->~ObExprTemplateEntry();
+        ob_free(entry);
+        entries_[i] = NULL;
+      }
+    }
+    ob_free(entries_);
+    entries_ = NULL;
+  }
+  entry_count_ = 0;
+  is_key_valid_ = false;
+  is_inited_ = false;
+}
+
+int64_t ObExprTemplateCache::make_flags(const ObExprParseMode parse_mode,
+                                        const ObProxyBasicStmtType stmt_type,
+                                        const bool is_oracle_mode)
+{
+  return (static_cast<int64_t>(stmt_type) << 8)
+         | (static_cast<int64_t>(parse_mode) << 1)
+         | (is_oracle_mode ? 0x1 : 0);
+}
+
+uint64_t ObExprTemplateCache::get_part_key_signature(const ObProxyPartKeyInfo &part_key_info,
+                                                     const int64_t target_mask)
+{
+  uint64_t signature = murmurhash(&target_mask, sizeof(target_mask), 0);
+  signature = murmurhash(&part_key_info.key_num_, sizeof(part_key_info.key_num_), signature);
+  for (int64_t i = 0; i < part_key_info.key_num_ && i < OBPROXY_MAX_PART_KEY_NUM; ++i) {
+    const ObProxyPartKey &part_key = part_key_info.part_keys_[i];
+    const int64_t level = static_cast<int64_t>(part_key.level_);
+    const int64_t is_generated = part_key.is_generated_ ? 1 : 0;
+    if (NULL != part_key.name_.str_ && part_key.name_.str_len_ > 0) {
+      signature = murmurhash(part_key.name_.str_, part_key.name_.str_len_, signature);
+    }
+    signature = murmurhash(&level, sizeof(level), signature);
+    signature = murmurhash(&is_generated, sizeof(is_generated), signature);
+  }
+  return signature;
+}
+
+bool ObExprTemplateCache::get_literal_token(char *str, const int64_t len, ObProxyTokenNode &token)
+{
+  bool bret = false;
+  MEMSET(&token, 0, sizeof(token));
+  if (len <= 0) {
+    // empty
+  } else if ('\'' == str[0]) {
+    // '' and 'a' 'b' are not kept as they are by expr lexer
+    if (len >= 2 && '\'' == str[len - 1] && NULL == memchr(str + 1, '\'', len - 2)) {
+      token.type_ = TOKEN_STR_VAL;
+      token.str_value_.str_ = str + 1;
+      token.str_value_.str_len_ = static_cast<int32_t>(len - 2);
+      token.str_value_.end_ptr_ = str + len;
+      bret = true;
+    }
+  } else if (skip_digits(str, len, 0) == len) {
+    // same as strtoll in expr lexer, 0 if overflow
+    int64_t value = 0;
+    bool is_overflow = false;
+    for (int64_t i = 0; !is_overflow && i < len; ++i) {
+      const int64_t digit = str[i] - '0';
+      if (value > (INT64_MAX - digit) / 10) {
+        is_overflow = true;
+        value = 0;
+      } else {
+        value = value * 10 + digit;
+      }
+    }
+    token.type_ = TOKEN_INT_VAL;
+    token.int_value_ = value;
+    bret = true;
+  } else if (is_number_literal(str, len)) {
+    token.type_ = TOKEN_STR_VAL;
+    token.str_value_.str_ = str;
+    token.str_value_.str_len_ = static_cast<int32_t>(len);
+    token.str_value_.end_ptr_ = str + len;
+    bret = true;
+  }
+  return bret;
+}
+
+bool ObExprTemplateCache::find_literal(const ObProxyTokenNode &token, int64_t &literal_idx) const
+{
+  int64_t match_count = 0;
+  ObProxyTokenNode literal_token;
+  literal_idx = -1;
+  for (int64_t i = 0; match_count <= 1 && i < literal_count_; ++i) {
+    if (!get_literal_token(i, literal_token) || literal_token.type_ != token.type_) {
+      // not match
+    } else if (TOKEN_STR_VAL == token.type_) {
+      // str value points to sql, match by position
+      if (literal_token.str_value_.str_ == token.str_value_.str_
+          && literal_token.str_value_.str_len_ == token.str_value_.str_len_) {
+        literal_idx = i;
+        ++match_count;
+      }
+    } else if (literal_token.int_value_ == token.int_value_) {
+      // int value has no position, it must be the only one literal of the value
+      literal_idx = i;
+      ++match_count;
+    }
+  }
+  return 1 == match_count;
+}
+
+bool ObExprTemplateCache::has_keyword_in_literals(const ObExprParseMode parse_mode,
+                                                  const ObProxyBasicStmtType stmt_type) const
+{
+  bool bret = false;
+  const char *keywords[2] = {NULL, NULL};
+  if (SELECT_STMT_PARSE_MODE == parse_mode) {
+    keywords[0] = "JOIN";
+    keywords[1] = "WHERE";
+  } else if (OBPROXY_T_UPDATE == stmt_type) {
+    keywords[0] = "SET";
+  } else if (OBPROXY_T_MERGE == stmt_type) {
+    keywords[0] = "ON";
+  }
+  for (int64_t i = 0; !bret && NULL != keywords[0] && i < literal_count_; ++i) {
+    const char *str = sql_.ptr() + literals_[i].start_;
+    if ('\'' == str[0]) {
+      for (int64_t j = 0; !bret && j < 2 && NULL != keywords[j]; ++j) {
+        bret = contains_case_insensitive(str, literals_[i].len_, keywords[j]);
+      }
+    }
+  }
+  return bret;
+}
+
+bool ObExprTemplateCache::mark_literals_in_key()
+{
+  bool bret = (NULL == memchr(key_buf_, '\0', key_len_));
+  // key pos of the literal = its pos in sql - (len - 1) of each literal before it
+  int64_t shrink_len = 0;
+  for (int64_t i = 0; bret && i < literal_count_; ++i) {
+    const int64_t key_pos = literals_[i].start_ - shrink_len;
+    if (OB_UNLIKELY(key_pos < 0 || key_pos >= key_len_ || '?' != key_buf_[key_pos])) {
+      bret = false;
+    } else {
+      key_buf_[key_pos] = '\0';
+      shrink_len += (literals_[i].len_ - 1);
+    }
+  }
+  return bret;
+}
+
+int ObExprTemplateCache::build_result(const ObExprTemplateEntry &entry, ObIAllocator &allocator,
+                                      ObExprParseResult &expr_result) const
+{
+  int ret = OB_SUCCESS;
+  const int64_t relation_num = entry.relation_num_;
+  ObProxyRelationExpr *relations = NULL;
+  ObProxyTokenList *lists = NULL;
+  ObProxyTokenNode *nodes = NULL;
+  ObProxyTokenNode rowid_token;
+  if (relation_num > 0
+      && (OB_ISNULL(relations = static_cast<ObProxyRelationExpr *>(allocator.alloc(sizeof(ObProxyRelationExpr) * relation_num)))
+          || OB_ISNULL(lists = static_cast<ObProxyTokenList *>(allocator.alloc(sizeof(ObProxyTokenList) * relation_num)))
+          || OB_ISNULL(nodes = static_cast<ObProxyTokenNode *>(allocator.alloc(sizeof(ObProxyTokenNode) * relation_num))))) {
+    ret = OB_ALLOCATE_MEMORY_FAILED;
+    LOG_WARN("fail to alloc mem for expr template relations", K(relation_num), K(ret));
+  }
+  for (int64_t i = 0; OB_SUCC(ret) && i < relation_num; ++i) {
+    const ObExprRelationTemplate &relation_template = entry.relations_[i];
+    ObProxyTokenNode &node = nodes[i];
+    if (relation_template.is_placeholder_) {
+      MEMSET(&node, 0, sizeof(node));
+      node.type_ = TOKEN_PLACE_HOLDER;
+      node.placeholder_idx_ = relation_template.value_idx_;
+    } else if (!get_literal_token(relation_template.value_idx_, node)) {
+      // lexer would not produce the same token, do expr parse as usual
+      ret = OB_ENTRY_NOT_EXIST;
+    }
+    if (OB_SUCC(ret)) {
+      lists[i].column_node_ = NULL;
+      lists[i].head_ = &node;
+      lists[i].tail_ = &node;
+      relations[i].column_idx_ = relation_template.column_idx_;
+      relations[i].left_value_ = NULL;
+      relations[i].right_value_ = &lists[i];
+      relations[i].type_ = relation_template.type_;
+      relations[i].level_ = relation_template.level_;
+      expr_result.relation_info_.relations_[i] = &relations[i];
+    }
+  }
+  if (OB_SUCC(ret) && entry.rowid_literal_idx_ >= 0) {
+    // rowid must be STR_VAL in grammar
+    if (!get_literal_token(entry.rowid_literal_idx_, rowid_token) || TOKEN_STR_VAL != rowid_token.type_) {
+      ret = OB_ENTRY_NOT_EXIST;
+    }
+  }
+  if (OB_SUCC(ret)) {
+    expr_result.relation_info_.relation_num_ = relation_num;
+    expr_result.relation_info_.right_value_num_ = 0;
+    expr_result.all_relation_info_.relation_num_ = 0;
+    expr_result.all_relation_info_.right_value_num_ = 0;
+    expr_result.multi_param_values_ = entry.multi_param_values_;
+    expr_result.has_rowid_ = (entry.rowid_literal_idx_ >= 0);
+    if (expr_result.has_rowid_) {
+      expr_result.rowid_str_ = rowid_token.str_value_;
+    }
+  } else {
+    expr_result.relation_info_.relation_num_ = 0;
+  }
+  return ret;
+}
+
+int ObExprTemplateCache::get(const ObString &sql, const ObExprParseMode parse_mode,
+                             const ObProxyBasicStmtType stmt_type, const uint64_t part_key_signature,
+                             const int64_t parsed_length, ObIAllocator &allocator,
+                             ObExprParseResult &expr_result, bool &is_hit)
+{
+  int ret = OB_SUCCESS;
+  is_hit = false;
+  is_key_valid_ = false;
+  if (OB_UNLIKELY(!is_inited_)) {
+    ret = OB_NOT_INIT;
+    LOG_WARN("not inited", K(ret));
+  } else if (sql.empty() || sql.length() > ObSqlParseResultCache::MAX_CACHED_SQL_LENGTH) {
+    // do not cache
+  } else if (OB_FAIL(ObSqlParseResultCache::mask_literals(sql, key_buf_, ObSqlParseResultCache::MAX_CACHED_SQL_LENGTH,
+                                                          key_len_, first_literal_pos_,
+                                                          literals_, MAX_LITERAL_NUM, literal_count_))) {
+    if (OB_SIZE_OVERFLOW == ret) {
+      ret = OB_SUCCESS;
+    } else {
+      LOG_WARN("fail to mask literals", K(sql), K(ret));
+    }
+  } else {
+    sql_ = sql;
+    if (first_literal_pos_ < parsed_length
+        || !mark_literals_in_key()
+        || has_keyword_in_literals(parse_mode, stmt_type)) {
+      // expr parser may start from another pos for the same key
+    } else {
+      key_flags_ = make_flags(parse_mode, stmt_type, expr_result.is_oracle_mode_);
+      key_part_key_signature_ = part_key_signature;
+      key_parsed_length_ = parsed_length;
+      key_hash_ = murmurhash(key_buf_, static_cast<int32_t>(key_len_), static_cast<uint64_t>(key_flags_));
+      is_key_valid_ = true;
+
+      ObExprTemplateEntry *entry = entries_[key_hash_ & (entry_count_ - 1)];
+      if (NULL != entry
+          && entry->hash_ == key_hash_
+          && entry->flags_ == key_flags_
+          && entry->part_key_signature_ == key_part_key_signature_
+          && entry->parsed_length_ == key_parsed_length_
+          && entry->key_len_ == key_len_
+          && 0 == MEMCMP(entry->key_, key_buf_, key_len_)) {
+        if (OB_FAIL(build_result(*entry, allocator, expr_result))) {
+          if (OB_ENTRY_NOT_EXIST == ret) {
+            ret = OB_SUCCESS;
+          } else {
+            LOG_WARN("fail to build expr result from template", K(ret));
+          }
+          ++miss_count_;
+        } else {
+          is_hit = true;
+          is_key_valid_ = false;
+          ++hit_count_;
+        }
+      } else {
+        ++miss_count_;
+      }
+    }
+  }
+  return ret;
+}
+
+int ObExprTemplateCache::put(const ObExprParseResult &expr_result)
+{
+  int ret = OB_SUCCESS;
+  ObExprTemplateEntry tmp_entry;
+  bool can_cache = false;
+  if (OB_UNLIKELY(!is_inited_)) {
+    ret = OB_NOT_INIT;
+    LOG_WARN("not inited", K(ret));
+  } else if (!is_key_valid_) {
+    // no key or already hit
+  } else if (expr_result.relation_info_.relation_num_ > ObExprTemplateEntry::MAX_RELATION_NUM) {
+    // too many relations
+  } else {
+    can_cache = true;
+    tmp_entry.relation_num_ = expr_result.relation_info_.relation_num_;
+    tmp_entry.rowid_literal_idx_ = -1;
+    for (int64_t i = 0; can_cache && i < tmp_entry.relation_num_; ++i) {
+      const ObProxyRelationExpr *relation = expr_result.relation_info_.relations_[i];
+      const ObProxyTokenNode *token = NULL;
+      ObExprRelationTemplate &relation_template = tmp_entry.relations_[i];
+      if (NULL == relation || NULL == relation->right_value_ || NULL == (token = relation->right_value_->head_)) {
+        can_cache = false;
+      } else {
+        relation_template.column_idx_ = relation->column_idx_;
+        relation_template.type_ = relation->type_;
+        relation_template.level_ = relation->level_;
+        if (TOKEN_PLACE_HOLDER == token->type_) {
+          // the key can not tell :1 from :2
+          relation_template.is_placeholder_ = true;
+          relation_template.value_idx_ = token->placeholder_idx_;
+          can_cache = !has_pos_placeholder(key_buf_, key_len_);
+        } else if (TOKEN_STR_VAL == token->type_) {
+          relation_template.is_placeholder_ = false;
+          can_cache = find_literal(*token, relation_template.value_idx_);
+        } else if (TOKEN_INT_VAL == token->type_) {
+          relation_template.is_placeholder_ = false;
+          can_cache = !has_non_ascii(key_buf_, key_len_)
+                      && find_literal(*token, relation_template.value_idx_);
+        } else {
+          // value is an expr, leave it to resolver
+          can_cache = false;
+        }
+      }
+    }
+    if (can_cache && expr_result.has_rowid_) {
+      ObProxyTokenNode rowid_token;
+      MEMSET(&rowid_token, 0, sizeof(rowid_token));
+      rowid_token.type_ = TOKEN_STR_VAL;
+      rowid_token.str_value_ = expr_result.rowid_str_;
+      can_cache = find_literal(rowid_token, tmp_entry.rowid_literal_idx_);
+    }
+    if (!can_cache) {
+      is_key_valid_ = false;
+    }
+  }
+
+  if (OB_SUCC(ret) && can_cache) {
+    const int64_t idx = key_hash_ & (entry_count_ - 1);
+    ObExprTemplateEntry *entry = entries_[idx];
+    void *buf = NULL;
+    if (NULL == entry) {
+      if (OB_ISNULL(buf = ob_malloc(sizeof(ObExprTemplateEntry), ObModIds::OB_PROXY_SQL_PARSE))) {
+        ret = OB_ALLOCATE_MEMORY_FAILED;
+        LOG_WARN("fail to alloc mem for expr template entry", K(ret));
+      } else {
+        entry = new (buf) ObExprTemplateEntry();
+        entries_[idx] = entry;
+      }
+    }
+
+    if (OB_SUCC(ret) && entry->key_buf_len_ < key_len_) {
+      if (NULL != entry->key_) {
+        ob_free(entry->key_);
+        entry->key_ = NULL;
+        entry->key_buf_len_ = 0;
+      }
+      if (OB_ISNULL(entry->key_ = static_cast<char *>(ob_malloc(key_len_, ObModIds::OB_PROXY_SQL_PARSE)))) {
+        ret = OB_ALLOCATE_MEMORY_FAILED;
+        LOG_WARN("fail to alloc mem for expr template key", K_(key_len), K(ret));
+      } else {
+        entry->key_buf_len_ = key_len_;
+      }
+    }
+
+    if (OB_SUCC(ret)) {
+      MEMCPY(entry->key_, key_buf_, key_len_);
+      entry->key_len_ = key_len_;
+      entry->hash_ = key_hash_;
+      entry->flags_ = key_flags_;
+      entry->part_key_signature_ = key_part_key_signature_;
+      entry->parsed_length_ = key_parsed_length_;
+      entry->relation_num_ = tmp_entry.relation_num_;
+      MEMCPY(entry->relations_, tmp_entry.relations_, sizeof(ObExprRelationTemplate) * tmp_entry.relation_num_);
+      entry->rowid_literal_idx_ = tmp_entry.rowid_literal_idx_;
+      entry->multi_param_values_ = expr_result.multi_param_values_;
+    } else if (NULL != entry) {
+      // the slot is invalid now
+      entry->key_len_ = 0;
+      entry->hash_ = 0;
+    }
+    is_key_valid_ = false;
+  }
+  return ret;
+}
+
+int ObExprTemplateCache::get_thread_cache(const int64_t entry_count, ObExprTemplateCache *&cache)
+{
+  int ret = OB_SUCCESS;
+  static __thread ObExprTemplateCache *thread_cache = NULL;
+  if (NULL == thread_cache) {
+    ObExprTemplateCache *tmp_cache = NULL;
+    if (OB_ISNULL(tmp_cache = new (std::nothrow) ObExprTemplateCache())) {
+      ret = OB_ALLOCATE_MEMORY_FAILED;
+      LOG_WARN("fail to alloc expr template cache", K(ret));
+    } else if (OB_FAIL(tmp_cache->init(entry_count))) {
+      LOG_WARN("fail to init expr template cache", K(entry_count), K(ret));
+      delete tmp_cache;
+      tmp_cache = NULL;
+    } else {
+      thread_cache = tmp_cache;
+    }
+  }
+  cache = thread_cache;
+  return ret;
+}
+
+} // end of namespace proxy
+} // end of namespace obproxy
+} // end of namespace oceanbase
@@ -0,0 +1,150 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#ifndef OBPROXY_EXPR_TEMPLATE_CACHE_H
+#define OBPROXY_EXPR_TEMPLATE_CACHE_H
+
+#include "lib/ob_define.h"
+#include "lib/string/ob_string.h"
+#include "lib/allocator/ob_allocator.h"
+#include "obutils/ob_proxy_sql_parse_cache.h"
+#include "opsql/expr_parser/ob_expr_parse_result.h"
+#include "opsql/parser/ob_proxy_parse_result.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace proxy
+{
+
+// where the value of one part key relation comes from
+struct ObExprRelationTemplate
+{
+  int64_t column_idx_;
+  ObProxyFunctionType type_;
+  ObProxyPartKeyLevel level_;
+  bool is_placeholder_;
+  int64_t value_idx_; // placeholder idx, or the literal idx in sql
+};
+
+struct ObExprTemplateEntry
+{
+  static const int64_t MAX_RELATION_NUM = 16;
+
+  ObExprTemplateEntry() { MEMSET(this, 0, sizeof(ObExprTemplateEntry)); }
+  ~ObExprTemplateEntry() {}
+
+  uint64_t hash_;
+  int64_t flags_;
+  uint64_t part_key_signature_;
+  int64_t parsed_length_;
+  int64_t key_len_;
+  int64_t key_buf_len_;
+  char *key_;
+  int64_t relation_num_;
+  ObExprRelationTemplate relations_[MAX_RELATION_NUM];
+  int64_t rowid_literal_idx_; // -1 if there is no rowid
+  int64_t multi_param_values_;
+};
+
+// Per thread cache of the part key relations extracted by expr parser.
+//
+// Statements which only differ in literals have the same relations, only the values
+// of them differ. The key is the sql text with every literal masked, like
+// ObSqlParseResultCache, and the template records which literal (or which placeholder)
+// each part key relation takes its value from. On hit, the relations are built from
+// the literal spans found while building the key, and expr parser is skipped.
+//
+// A template is only built when every relation value can be mapped back to exactly one
+// literal, and a literal is only used on hit if the expr lexer would produce the same
+// kind of token for it, otherwise the sql is parsed as usual.
+//
+// Usage:
+//   get() to look up the sql, on miss do expr parse and put() the result,
+//   put() uses the key and literal spans built by the last get().
+//
+// It is a direct mapped table and only accessed by its owner thread, no lock is needed.
+class ObExprTemplateCache
+{
+public:
+  static const int64_t MAX_LITERAL_NUM = 256;
+
+  ObExprTemplateCache();
+  ~ObExprTemplateCache() { destroy(); }
+
+  int init(const int64_t entry_count);
+  void destroy();
+
+  // expr_result should be inited as for expr parse, relations and rowid are set on hit
+  int get(const common::ObString &sql, const ObExprParseMode parse_mode,
+          const ObProxyBasicStmtType stmt_type, const uint64_t part_key_signature,
+          const int64_t parsed_length, common::ObIAllocator &allocator,
+          ObExprParseResult &expr_result, bool &is_hit);
+  int put(const ObExprParseResult &expr_result);
+
+  static int get_thread_cache(const int64_t entry_count, ObExprTemplateCache *&cache);
+  static uint64_t get_part_key_signature(const ObProxyPartKeyInfo &part_key_info,
+                                         const int64_t target_mask);
+  // the token expr lexer produces for the literal text, false if it is not a single
+  // int, number or simple quoted string
+  static bool get_literal_token(char *str, const int64_t len, ObProxyTokenNode &token);
+
+  TO_STRING_KV(K_(is_inited), K_(entry_count), K_(hit_count), K_(miss_count));
+
+private:
+  static int64_t make_flags(const ObExprParseMode parse_mode, const ObProxyBasicStmtType stmt_type,
+                            const bool is_oracle_mode);
+  bool get_literal_token(const int64_t literal_idx, ObProxyTokenNode &token) const
+  {
+    return get_literal_token(const_cast<char *>(sql_.ptr()) + literals_[literal_idx].start_,
+                             literals_[literal_idx].len_, token);
+  }
+  bool find_literal(const ObProxyTokenNode &token, int64_t &literal_idx) const;
+  // expr parser starts from the first keyword found in sql, the key can not tell
+  // it if the keyword is in a literal
+  bool has_keyword_in_literals(const ObExprParseMode parse_mode,
+                               const ObProxyBasicStmtType stmt_type) const;
+  // literals are masked to '\0' in key, so that they differ from placeholders
+  bool mark_literals_in_key();
+  int build_result(const ObExprTemplateEntry &entry, common::ObIAllocator &allocator,
+                   ObExprParseResult &expr_result) const;
+
+private:
+  bool is_inited_;
+  int64_t entry_count_;
+  ObExprTemplateEntry **entries_;
+
+  // key built by last get()
+  bool is_key_valid_;
+  uint64_t key_hash_;
+  int64_t key_flags_;
+  uint64_t key_part_key_signature_;
+  int64_t key_parsed_length_;
+  int64_t key_len_;
+  int64_t first_literal_pos_;
+  common::ObString sql_;
+  int64_t literal_count_;
+  obutils::ObSqlLiteralSpan literals_[MAX_LITERAL_NUM];
+  char key_buf_[obutils::ObSqlParseResultCache::MAX_CACHED_SQL_LENGTH];
+
+  int64_t hit_count_;
+  int64_t miss_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(ObExprTemplateCache);
+};
+
+} // end of namespace proxy
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+#endif // OBPROXY_EXPR_TEMPLATE_CACHE_H
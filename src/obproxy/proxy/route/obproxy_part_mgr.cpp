@@ -686,6 +686,8 @@ int ObProxyPartMgr::build_list_part(const ObPartitionLevel part_level,
   if (OB_SUCC(ret)) {
     if (OB_FAIL(desc_list->set_part_array(part_array, part_num))) {
       LOG_WARN("failed to set_part_array, unexpected ", K(ret));
+    } else if (OB_FAIL(desc_list->build_value_index(allocator_))) {
+      LOG_WARN("failed to build list value index", K(ret));
     }
   }
 
@@ -779,6 +781,8 @@ int ObProxyPartMgr::build_sub_list_part_with_non_template(const ObPartitionFuncT
       desc_list->set_part_func_type(part_func_type);
       if (OB_FAIL(desc_list->set_part_array(part_array, sub_part_num_[i]))) {
         LOG_WARN("failed to set_part_array, unexpected ", K(ret));
+      } else if (OB_FAIL(desc_list->build_value_index(allocator_))) {
+        LOG_WARN("failed to build list value index", K(ret));
       }
     }
   } // end of for
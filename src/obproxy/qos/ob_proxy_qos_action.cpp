@@ -14,6 +14,7 @@
 
 #include "qos/ob_proxy_qos_action.h"
 #include "lib/utility/ob_print_utils.h"
+#include "lib/thread_local/ob_tsi_utils.h"
 #include "qos/ob_proxy_qos_stat_processor.h"
 
 namespace oceanbase
@@ -40,131 +41,104 @@ int ObProxyQosActionBreaker::calc(bool &is_pass)
   return ret;
 }
 
-int ObProxyQosActionLimit::do_calc(bool &is_pass)
+bool ObProxyQosActionLimit::consume_token(int64_t &token, const int64_t count)
 {
-  int ret = OB_SUCCESS;
-  int debug_value = 0;
-
-  // 1. first, check whethere exceed next_free_token_micros
-  // 2. if exceeded, check over how much
-  //   2.1 if current time is between next_free_token_micros and next_free_token_micros + 1, consume the new token
-  //   2.2 if current time greater than next_free_token_micros + 1, consume the new token and save the other token
-  // 3. if not exceeded, consume one token
-  int64_t current_time_micros = hrtime_to_usec(get_hrtime_internal());
-  int64_t next_free_token_micros = next_free_token_micros_;
-  int64_t interval_per_request_micros = sec_to_usec(1) * LIMIT_ACTION_RATIO / limit_qps_;
-
-  int64_t max_token = limit_qps_ / LIMIT_ACTION_RATIO;
-  max_token = max_token < 1 ? 1 : max_token;
-
-  if (current_time_micros > next_free_token_micros) {
-    // case 2
-    if (current_time_micros < next_free_token_micros + interval_per_request_micros) {
-      // case 2.1
-      if (!ATOMIC_BCAS(&next_free_token_micros_, next_free_token_micros, next_free_token_micros + interval_per_request_micros)) {
-        // if update failed, maybe other update next_free_token_micros, re-call this func
-        ret = OB_EAGAIN;
-        debug_value = 1;
-      } else {
-        is_pass = true;
-        debug_value = 2;
-      }
-    } else {
-      // case 2.2
-      if (OB_SUCC(lock_.try_wrlock())) {
-        // record the token num before update time
-        int64_t first_last_token = token_;
-
-        int64_t next_free_token_micros = next_free_token_micros_;
-        if (current_time_micros >= next_free_token_micros + interval_per_request_micros) {
-          int64_t current_token_total = current_time_micros / interval_per_request_micros;
-          int64_t new_next_free_token_micros = (current_token_total + 1 ) * interval_per_request_micros;
-          if (!ATOMIC_BCAS(&next_free_token_micros_, next_free_token_micros, new_next_free_token_micros)) {
-            // if update failed, maybe case 2.1 is happening, re-call this func
-            ret = OB_EAGAIN;
-            debug_value = 3;
-          } else {
-            // because cross next_free_token_micros, so need add 1
-            int64_t add_token = current_token_total - next_free_token_micros / interval_per_request_micros + 1;
-
-            int64_t target_token = first_last_token + add_token;
-            target_token = target_token > max_token ? max_token : target_token;
-            // becaure consume one token, so sub 1
-            target_token -= 1;
-
-            int64_t new_token = 0;
-            int64_t last_token = 0;
-
-            do {
-              last_token = token_;
-              new_token = target_token - (first_last_token - last_token);
-
-              // just defence
-              if (OB_UNLIKELY(new_token < 0)) {
-                new_token = 0;
-              }
-            } while (!ATOMIC_BCAS(&token_, last_token, new_token));
-
-            is_pass = true;
-            debug_value = 4;
-            LOG_DEBUG("ObProxyQosActionLimit update token", K(new_token), K(first_last_token), K(last_token), K(ret));
-          }
-        } else {
-          debug_value = 5;
-          ret = OB_EAGAIN;
-        }
-
-        // release lock
-        lock_.wrunlock();
-      } else {
-        debug_value = 6;
-        ret = OB_EAGAIN;
-      }
-    }
-  } else {
-    // case 3
-    int64_t last_token = token_;
-    while (last_token > 0 && !ATOMIC_BCAS(&token_, last_token, last_token - 1)) {
-      PAUSE();
-      last_token = token_;
-    }
+  int64_t last_token = ATOMIC_LOAD(&token);
+  while (last_token >= count && !ATOMIC_BCAS(&token, last_token, last_token - count)) {
+    PAUSE();
+    last_token = ATOMIC_LOAD(&token);
+  }
+  return last_token >= count;
+}
 
-    if (last_token <= 0) {
-      if (OB_SUCC(lock_.try_rdlock())) {
-        last_token = token_;
-        if (last_token > 0) {
-          debug_value = 7;
-          ret = OB_EAGAIN;
-        } else {
-          debug_value = 8;
-          is_pass = false;
-        }
-        lock_.rdunlock();
-      } else {
-        debug_value = 9;
-        ret = OB_EAGAIN;
-      }
-    } else {
-      debug_value = 10;
-      is_pass = true;
+int64_t ObProxyQosActionLimit::take_token(int64_t &token, const int64_t count)
+{
+  int64_t taken = 0;
+  int64_t last_token = ATOMIC_LOAD(&token);
+  while (last_token > 0) {
+    taken = last_token < count ? last_token : count;
+    if (ATOMIC_BCAS(&token, last_token, last_token - taken)) {
+      break;
     }
+    taken = 0;
+    PAUSE();
+    last_token = ATOMIC_LOAD(&token);
+  }
+  return taken;
+}
+
+void ObProxyQosActionLimit::refill(const int64_t limit_qps, const int64_t current_time_micros)
+{
+  const int64_t max_token = limit_qps < LIMIT_ACTION_RATIO ? LIMIT_ACTION_RATIO : limit_qps;
+  const int64_t last_refill_micros = ATOMIC_LOAD(&last_refill_micros_);
+  const int64_t elapsed_micros = current_time_micros - last_refill_micros;
+  int64_t add_token = 0;
+  int64_t new_refill_micros = current_time_micros;
+
+  if (elapsed_micros >= sec_to_usec(1)) {
+    add_token = max_token;
+  } else if (elapsed_micros > 0) {
+    add_token = elapsed_micros * limit_qps / sec_to_usec(1);
+    // only the time turned into tokens is consumed, the rest is left for next refill
+    new_refill_micros = last_refill_micros + add_token * sec_to_usec(1) / limit_qps;
   }
 
-  LOG_DEBUG("ObProxyQosActionLimit do calc end", K(debug_value), K(ret));
+  if (add_token > 0 && ATOMIC_BCAS(&last_refill_micros_, last_refill_micros, new_refill_micros)) {
+    int64_t last_token = 0;
+    int64_t new_token = 0;
+    do {
+      last_token = ATOMIC_LOAD(&token_);
+      new_token = last_token + add_token;
+      new_token = new_token > max_token ? max_token : new_token;
+    } while (!ATOMIC_BCAS(&token_, last_token, new_token));
+    LOG_DEBUG("ObProxyQosActionLimit refill token", K(add_token), K(last_token), K(new_token));
+  }
+}
 
-  return ret;
+void ObProxyQosActionLimit::rebalance()
+{
+  int64_t token = 0;
+  int64_t total_token = 0;
+  for (int64_t i = 0; i < QOS_LIMIT_SHARD_COUNT; ++i) {
+    if (0 != (token = take_token(shards_[i].token_, INT64_MAX))) {
+      total_token += token;
+    }
+  }
+  if (total_token > 0) {
+    (void)ATOMIC_AAF(&token_, total_token);
+  }
+  LOG_DEBUG("ObProxyQosActionLimit rebalance token", K(total_token));
 }
 
 int ObProxyQosActionLimit::calc(bool &is_pass)
 {
   int ret = OB_SUCCESS;
+  const int64_t limit_qps = ATOMIC_LOAD(&limit_qps_);
   is_pass = true;
 
-  if (limit_qps_ <= 0) {
+  if (limit_qps <= 0) {
     is_pass = false;
   } else {
-    while (OB_EAGAIN == (ret = do_calc(is_pass))) {
-      PAUSE();
+    ObTokenShard &shard = shards_[get_itid() % QOS_LIMIT_SHARD_COUNT];
+    if (!consume_token(shard.token_, LIMIT_ACTION_RATIO)) {
+      // shard is empty, borrow a batch from the global bucket
+      const int64_t current_time_micros = hrtime_to_usec(get_hrtime_internal());
+      const int64_t last_rebalance_micros = ATOMIC_LOAD(&last_rebalance_micros_);
+      int64_t batch = limit_qps / QOS_LIMIT_BATCH_DIVISOR;
+      batch = batch < LIMIT_ACTION_RATIO ? LIMIT_ACTION_RATIO : batch;
+
+      refill(limit_qps, current_time_micros);
+      if (current_time_micros - last_rebalance_micros >= QOS_LIMIT_REBALANCE_INTERVAL_US
+          && ATOMIC_BCAS(&last_rebalance_micros_, last_rebalance_micros, current_time_micros)) {
+        rebalance();
+      }
+
+      const int64_t token = take_token(token_, batch);
+      if (token > 0) {
+        (void)ATOMIC_AAF(&shard.token_, token);
+      }
+      is_pass = consume_token(shard.token_, LIMIT_ACTION_RATIO);
+      LOG_DEBUG("ObProxyQosActionLimit borrow token", K(batch), K(token), K(is_pass));
     }
   }
 
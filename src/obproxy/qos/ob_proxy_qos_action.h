@@ -14,7 +14,7 @@
 #define OB_PROXY_QOS_ACTION_H
 
 #include "lib/string/ob_string.h"
-#include "lib/lock/ob_drw_lock.h"
+#include "lib/utility/ob_macro_utils.h"
 #include "lib/time/ob_hrtime.h"
 
 namespace oceanbase
@@ -94,24 +94,53 @@ private:
   bool is_circuit_;
 };
 
+// Token bucket in milli tokens, limit_qps_ milli tokens are added every second
+// and at most one second of them are kept.
+//
+// Requests take tokens from the shard of their thread, a shard borrows a batch
+// from the global bucket when it is empty, so the global bucket is only touched
+// once per batch. Tokens left in the shards of idle threads are moved back to
+// the global bucket every QOS_LIMIT_REBALANCE_INTERVAL_US, so that a busy
+// thread can use them. Everything is updated by CAS, no lock is needed.
 class ObProxyQosActionLimit : public ObProxyQosAction
 {
 public:
+  static const int64_t QOS_LIMIT_SHARD_COUNT = 64;
+  // a shard borrows 1/QOS_LIMIT_BATCH_DIVISOR of one second tokens at a time, one token at least
+  static const int64_t QOS_LIMIT_BATCH_DIVISOR = 100;
+  static const int64_t QOS_LIMIT_REBALANCE_INTERVAL_US = 100 * 1000;
+
   ObProxyQosActionLimit() : ObProxyQosAction(OB_PROXY_QOS_ACTION_TYPE_LIMIT),
-                            limit_qps_(-1), token_(0), next_free_token_micros_(0) {}
+                            limit_qps_(-1), token_(0), last_refill_micros_(0),
+                            last_rebalance_micros_(0)
+  {
+    MEMSET(shards_, 0, sizeof(shards_));
+  }
   void set_limit_qps(int64_t limit_qps) { limit_qps_ = limit_qps * LIMIT_ACTION_RATIO; }
   int64_t get_limit_qps() const { return limit_qps_; }
 
   virtual int calc(bool &is_pass);
 
 private:
-  int do_calc(bool &is_pass);
+  struct ObTokenShard
+  {
+    int64_t token_;
+  } CACHE_ALIGNED;
+
+  // add the tokens generated since last refill to the global bucket
+  void refill(const int64_t limit_qps, const int64_t current_time_micros);
+  // move the tokens of all shards back to the global bucket
+  void rebalance();
+  static bool consume_token(int64_t &token, const int64_t count);
+  // take count tokens at most, returns the tokens taken
+  static int64_t take_token(int64_t &token, const int64_t count);
 
 private:
-  common::DRWLock lock_;
   int64_t limit_qps_; // limit threshold * 1000. so qps lower limit is 0.001/s
   int64_t token_;
-  int64_t next_free_token_micros_;
+  int64_t last_refill_micros_;
+  int64_t last_rebalance_micros_;
+  ObTokenShard shards_[QOS_LIMIT_SHARD_COUNT];
 };
 
 } // end qos
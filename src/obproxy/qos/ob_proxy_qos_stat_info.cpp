@@ -14,6 +14,7 @@
 
 #include "qos/ob_proxy_qos_stat_info.h"
 #include "lib/time/ob_hrtime.h"
+#include "lib/thread_local/ob_tsi_utils.h"
 
 namespace oceanbase
 {
@@ -27,7 +28,7 @@ int64_t ObProxyQosStatNode::to_string(char *buf, const int64_t buf_len) const
 {
   int64_t pos = 0;
   J_OBJ_START();
-  J_KV(K_(index_time_sec), K_(key), K_(idle_period_count), K_(node_type));
+  J_KV(K_(key), K_(idle_period_count), K_(node_type));
   J_OBJ_END();
   return pos;
 }
@@ -47,164 +48,152 @@ int ObProxyQosStatNode::init(const ObString &key)
   return ret;
 }
 
-int ObProxyQosStatNode::do_push_index(int64_t current_time_sec)
+int64_t ObProxyQosStatNode::diff_stat_sec(const int64_t time_sec, const int64_t word)
 {
-  int ret = OB_SUCCESS;
+  // compare in the high bits, so that the difference of wrapped seconds gets its sign
+  const uint64_t sec_bits = static_cast<uint64_t>(time_sec) << QOS_STAT_VALUE_BITS;
+  const uint64_t word_sec_bits = static_cast<uint64_t>(word) & ~static_cast<uint64_t>(QOS_STAT_VALUE_MASK);
+  return static_cast<int64_t>(sec_bits - word_sec_bits) >> QOS_STAT_VALUE_BITS;
+}
 
-  // if current_time_sec > index_time_sec_, need update index time
-  if (current_time_sec > index_time_sec_) {
-    // acquire write lock, avoid other use the index time
-    if (OB_SUCC(value_lock_.try_wrlock())) {
-      // if current_time_sec still greate than index_time_sec_, update index time and cleare values;
-      if (current_time_sec > index_time_sec_) {
-        if (current_time_sec - index_time_sec_ > QOS_STAT_VALUE_COUNT) {
-          MEMSET(values_, 0, sizeof(values_));
-        } else {
-          int64_t index = -1;
-          for (int64_t i = index_time_sec_ + 1; i <= current_time_sec; i++) {
-            index = i % QOS_STAT_VALUE_COUNT;
-            values_[QOS_STAT_TYPE_COUNT][index] = 0;
-            values_[QOS_STAT_TYPE_COST][index] = 0;
-            values_[QOS_STAT_TYPE_RT][index] = 0;
-          }
-        }
-        index_time_sec_ = current_time_sec;
+bool ObProxyQosStatNode::add_stat(int64_t &word, const int64_t time_sec, const int64_t value)
+{
+  bool is_added = false;
+  bool is_late = false;
+  int64_t old_word = ATOMIC_LOAD(&word);
+  while (!is_added && !is_late) {
+    const int64_t diff = diff_stat_sec(time_sec, old_word);
+    if (diff < 0) {
+      // a writer of a second which has passed is too late, just drop it
+      is_late = true;
+    } else {
+      // the word holds an old second, take it over and drop the old value
+      const int64_t old_value = (0 == diff) ? (old_word & QOS_STAT_VALUE_MASK) : 0;
+      const int64_t new_word = static_cast<int64_t>(static_cast<uint64_t>(time_sec) << QOS_STAT_VALUE_BITS)
+                               | ((old_value + value) & QOS_STAT_VALUE_MASK);
+      if (ATOMIC_BCAS(&word, old_word, new_word)) {
+        is_added = true;
       } else {
-        // if current_time_sec < index_time_sec_, other has updated the index_time_sec, re-enter this func
-        ret = OB_EAGAIN;
+        PAUSE();
+        old_word = ATOMIC_LOAD(&word);
       }
-      value_lock_.wrunlock();
-    } else {
-      // if acquire lock failed, other is updating the index_time_sec, re-enter this func
-      ret = OB_EAGAIN;
     }
   }
-
-  return ret;
+  return is_added;
 }
 
-int ObProxyQosStatNode::push_index()
+int ObProxyQosStatNode::store_stat(int64_t cost)
 {
   int ret = OB_SUCCESS;
-  int64_t current_time_sec = hrtime_to_sec(get_hrtime_internal());
-
-  while (OB_EAGAIN == (ret = do_push_index(current_time_sec))) {
-    PAUSE();
+  const int64_t current_time_sec = hrtime_to_sec(get_hrtime_internal());
+  ObProxyQosStatSlot &slot = shards_[get_itid() % QOS_STAT_SHARD_COUNT].slots_[current_time_sec % QOS_STAT_VALUE_COUNT];
+
+  if (add_stat(slot.count_, current_time_sec, 1)) {
+    (void)add_stat(slot.cost_, current_time_sec, cost);
+    reset_idle_period_count();
+    const int64_t value = ATOMIC_LOAD(&slot.count_) & QOS_STAT_VALUE_MASK;
+    PROXY_LOG(DEBUG, "qos store stat", K(current_time_sec), K(value));
   }
 
   return ret;
 }
 
-int ObProxyQosStatNode::store_stat(int64_t cost)
+void ObProxyQosStatNode::get_stat(const int64_t time_sec, int64_t &count, int64_t &cost) const
 {
-  int ret = OB_SUCCESS;
-
-  if (OB_FAIL(push_index())) {
-    PROXY_LOG(WARN, "fail to push index", K(ret));
-  } else {
-    // after updating, current time must less than index time
-    // acquire read lock, avoid other update index_time
-    if (OB_SUCC(value_lock_.rdlock())) {
-      int64_t index = index_time_sec_ % QOS_STAT_VALUE_COUNT;
-      int64_t new_value = ATOMIC_AAF(&values_[QOS_STAT_TYPE_COUNT][index], 1);
-      ATOMIC_AAF(&values_[QOS_STAT_TYPE_COST][index], cost);
-      value_lock_.rdunlock();
-      reset_idle_period_count();
-      PROXY_LOG(DEBUG, "qos store stat", K(index), "value", new_value);
+  const int64_t index = time_sec % QOS_STAT_VALUE_COUNT;
+  int64_t word = 0;
+  count = 0;
+  cost = 0;
+  for (int64_t i = 0; i < QOS_STAT_SHARD_COUNT; ++i) {
+    const ObProxyQosStatSlot &slot = shards_[i].slots_[index];
+    if (0 == diff_stat_sec(time_sec, word = ATOMIC_LOAD(&slot.count_))) {
+      count += word & QOS_STAT_VALUE_MASK;
+    }
+    if (0 == diff_stat_sec(time_sec, word = ATOMIC_LOAD(&slot.cost_))) {
+      cost += word & QOS_STAT_VALUE_MASK;
     }
   }
-
-  return ret;
 }
 
 int ObProxyQosStatNode::calc_qps(int64_t limit_qps, bool &is_reach)
 {
   int ret = OB_SUCCESS;
+  const int64_t MAX_BUF_LEN = 1024;
+  char debug_buf[MAX_BUF_LEN];
+  int64_t pos = 0;
 
-  if (OB_FAIL(push_index())) {
-    PROXY_LOG(WARN, "fail to push index", K(ret));
-  } else {
-    const int64_t MAX_BUF_LEN = 1024;
-    char debug_buf[MAX_BUF_LEN];
-    int64_t pos = 0;
-
-    int count = 0;
-    int64_t index = -1;
-    int64_t index_time_sec = index_time_sec_;
-
-    databuff_printf(debug_buf, MAX_BUF_LEN, pos, "type:%s, index_time_sec:%ld, limit_qps:%ld, ", "QOS_STAT_TYPE_QPS", index_time_sec, limit_qps);
-
-    // after updating, can use index_time without lock.
-    // algorithm: if there are more than 5 times, it is considered to be a problem. use 5s to anti-shake
-    for (int64_t i = index_time_sec - QOS_STAT_CALC_COUNT; i < index_time_sec; i++) {
-      index = i % QOS_STAT_VALUE_COUNT;
-      if (values_[QOS_STAT_TYPE_COUNT][index] > limit_qps) {
-        count++;
-      }
+  int count = 0;
+  int64_t value_count = 0;
+  int64_t value_cost = 0;
+  int64_t index_time_sec = hrtime_to_sec(get_hrtime_internal());
 
-      databuff_printf(debug_buf, MAX_BUF_LEN, pos, "values[COUNT][%ld]:%ld", index, values_[QOS_STAT_TYPE_COUNT][index]);
-      if (i < index_time_sec - 1) {
-        databuff_printf(debug_buf, MAX_BUF_LEN, pos, ",");
-      }
+  databuff_printf(debug_buf, MAX_BUF_LEN, pos, "type:%s, index_time_sec:%ld, limit_qps:%ld, ", "QOS_STAT_TYPE_QPS", index_time_sec, limit_qps);
+
+  // algorithm: if there are more than 5 times, it is considered to be a problem. use 5s to anti-shake
+  for (int64_t i = index_time_sec - QOS_STAT_CALC_COUNT; i < index_time_sec; i++) {
+    get_stat(i, value_count, value_cost);
+    if (value_count > limit_qps) {
+      count++;
     }
 
-    if (count >= QOS_STAT_MATCH_COUNT) {
-      is_reach = true;
+    databuff_printf(debug_buf, MAX_BUF_LEN, pos, "values[COUNT][%ld]:%ld", i % QOS_STAT_VALUE_COUNT, value_count);
+    if (i < index_time_sec - 1) {
+      databuff_printf(debug_buf, MAX_BUF_LEN, pos, ",");
     }
+  }
 
-    _PROXY_LOG(DEBUG, "%s", debug_buf);
+  if (count >= QOS_STAT_MATCH_COUNT) {
+    is_reach = true;
   }
 
+  _PROXY_LOG(DEBUG, "%s", debug_buf);
+
   return ret;
 }
 
 int ObProxyQosStatNode::calc_rt(int64_t limit_rt, bool &is_reach)
 {
   int ret = OB_SUCCESS;
+  const int64_t MAX_BUF_LEN = 2048;
+  char debug_buf[MAX_BUF_LEN];
+  int64_t pos = 0;
 
-  if (OB_FAIL(push_index())) {
-    PROXY_LOG(WARN, "fail to push index", K(ret));
-  } else {
-    const int64_t MAX_BUF_LEN = 2048;
-    char debug_buf[MAX_BUF_LEN];
-    int64_t pos = 0;
-
-    int count = 0;
-    int64_t index = -1;
-    int64_t index_time_sec = index_time_sec_;
-
-    databuff_printf(debug_buf, MAX_BUF_LEN, pos, "type:%s, index_time_sec:%ld, limit_rt:%ld, ", "QOS_STAT_TYPE_RT", index_time_sec, limit_rt);
-
-    // after updating, can use index_time without lock.
-    // algorithm: if there are more than 5 times, it is considered to be a problem. use 5s to anti-shake
-    for (int64_t i = index_time_sec - QOS_STAT_CALC_COUNT; i < index_time_sec; i++) {
-      index = i % QOS_STAT_VALUE_COUNT;
-      if (0 == values_[QOS_STAT_TYPE_RT][index] && 0 != values_[QOS_STAT_TYPE_COUNT][index]) {
-        values_[QOS_STAT_TYPE_RT][index] = values_[QOS_STAT_TYPE_COST][index] / values_[QOS_STAT_TYPE_COUNT][index];
-      }
+  int count = 0;
+  int64_t index = -1;
+  int64_t value_count = 0;
+  int64_t value_cost = 0;
+  int64_t value_rt = 0;
+  int64_t index_time_sec = hrtime_to_sec(get_hrtime_internal());
 
-      if (values_[QOS_STAT_TYPE_RT][index] > limit_rt) {
-        count++;
-      }
+  databuff_printf(debug_buf, MAX_BUF_LEN, pos, "type:%s, index_time_sec:%ld, limit_rt:%ld, ", "QOS_STAT_TYPE_RT", index_time_sec, limit_rt);
 
-      databuff_printf(debug_buf, MAX_BUF_LEN, pos, "values[COST][%ld]:%ld,"
-                                                   "values[COUNT][%ld]:%ld,"
-                                                   "values[RT][%ld]:%ld",
-                                                   index, values_[QOS_STAT_TYPE_COST][index],
-                                                   index, values_[QOS_STAT_TYPE_COUNT][index],
-                                                   index, values_[QOS_STAT_TYPE_RT][index]);
-      if (i < index_time_sec - 1) {
-        databuff_printf(debug_buf, MAX_BUF_LEN, pos, ",");
-      }
+  // algorithm: if there are more than 5 times, it is considered to be a problem. use 5s to anti-shake
+  for (int64_t i = index_time_sec - QOS_STAT_CALC_COUNT; i < index_time_sec; i++) {
+    index = i % QOS_STAT_VALUE_COUNT;
+    get_stat(i, value_count, value_cost);
+    value_rt = (0 == value_count) ? 0 : value_cost / value_count;
+
+    if (value_rt > limit_rt) {
+      count++;
     }
 
-    if (count >= QOS_STAT_MATCH_COUNT) {
-      is_reach = true;
+    databuff_printf(debug_buf, MAX_BUF_LEN, pos, "values[COST][%ld]:%ld,"
+                                                 "values[COUNT][%ld]:%ld,"
+                                                 "values[RT][%ld]:%ld",
+                                                 index, value_cost,
+                                                 index, value_count,
+                                                 index, value_rt);
+    if (i < index_time_sec - 1) {
+      databuff_printf(debug_buf, MAX_BUF_LEN, pos, ",");
     }
+  }
 
-    _PROXY_LOG(DEBUG, "%s", debug_buf);
+  if (count >= QOS_STAT_MATCH_COUNT) {
+    is_reach = true;
   }
 
+  _PROXY_LOG(DEBUG, "%s", debug_buf);
+
   return ret;
 }
 
@@ -215,15 +204,14 @@ int ObProxyQosStatNode::calc_cost(int64_t &cost, int64_t time_window)
   if (time_window < 1 || time_window > 10) {
     ret = OB_INVALID_ARGUMENT;
     PROXY_LOG(WARN, "time window is wrong number", K(ret), K(time_window));
-  } else if (OB_FAIL(push_index())) {
-    PROXY_LOG(WARN, "fail to push index", K(ret));
   } else {
-    int64_t index = -1;
-    int64_t index_time_sec = index_time_sec_;
+    int64_t value_count = 0;
+    int64_t value_cost = 0;
+    int64_t index_time_sec = hrtime_to_sec(get_hrtime_internal());
 
     for (int64_t i = index_time_sec - time_window; i < index_time_sec; i++) {
-      index = i % QOS_STAT_VALUE_COUNT;
-      cost += values_[QOS_STAT_TYPE_COST][index];
+      get_stat(i, value_count, value_cost);
+      cost += value_cost;
     }
   }
 
@@ -29,6 +29,10 @@ namespace qos
 #define QOS_STAT_CALC_COUNT 10
 #define QOS_STAT_MATCH_COUNT 5
 #define QOS_NODE_HASH_BUCKET_SIZE 8
+#define QOS_STAT_SHARD_COUNT 16
+#define QOS_STAT_SEC_BITS 24
+#define QOS_STAT_VALUE_BITS (64 - QOS_STAT_SEC_BITS)
+#define QOS_STAT_VALUE_MASK ((1LL << QOS_STAT_VALUE_BITS) - 1)
 
 enum ObQosStatTypeEnum {
   QOS_STAT_TYPE_COUNT = 0,
@@ -45,12 +49,34 @@ enum ObProxyQosNodeTypeEnum {
   QOS_NODE_TYPE_MAX
 };
 
+// Stat of one second. The second and the value are packed in one word, the high
+// QOS_STAT_SEC_BITS bits hold the second (wrapped) and the others hold the value,
+// so that taking an old slot over and adding to it is one CAS, a writer can never
+// add to a second it has not seen. Seconds wrap every 2^24s (194 days), far more
+// than the window of QOS_STAT_VALUE_COUNT seconds which is read.
+struct ObProxyQosStatSlot
+{
+  int64_t count_;
+  int64_t cost_; // unit us
+};
+
+// Stats are written to the shard of the writer thread and merged on read, so no
+// lock is needed and writers of different threads do not share cache lines.
+// Every node costs QOS_STAT_SHARD_COUNT * QOS_STAT_VALUE_COUNT * 16B = 3KB instead
+// of one 288B array. Nodes only exist for the cluster/tenant/database/user which
+// have qos rules, so there are tens of them usually, and the stat of every
+// statement was serialized on the lock of the shared array before.
+struct ObProxyQosStatShard
+{
+  ObProxyQosStatSlot slots_[QOS_STAT_VALUE_COUNT];
+} CACHE_ALIGNED;
+
 class ObProxyQosStatNode : public common::ObSharedRefCount
 {
 public:
   ObProxyQosStatNode(ObProxyQosNodeTypeEnum node_type)
-    : idle_period_count_(0), index_time_sec_(0), node_type_(node_type) {
-    MEMSET(values_, 0, sizeof(values_));
+    : idle_period_count_(0), node_type_(node_type) {
+    MEMSET(shards_, 0, sizeof(shards_));
     MEMSET(key_str_, 0, sizeof(key_str_));
   }
 
@@ -70,24 +96,31 @@ public:
   ObProxyQosNodeTypeEnum get_node_type() { return node_type_; }
   int64_t inc_and_fetch_idle_period_count() { return ATOMIC_AAF(&idle_period_count_, 1); }
   int64_t get_idle_period_count() { return ATOMIC_LOAD(&idle_period_count_); }
-  void reset_idle_period_count() { idle_period_count_ = 0; }
+  void reset_idle_period_count()
+  {
+    // avoid writing the shared line on every stat
+    if (0 != ATOMIC_LOAD(&idle_period_count_)) {
+      ATOMIC_STORE(&idle_period_count_, 0);
+    }
+  }
   virtual int64_t count() { return 1; }
 
 public:
   LINK(ObProxyQosStatNode, node_link_);
 
 private:
-  int push_index();
-  int do_push_index(int64_t current_time_sec);
+  // merge the stat of time_sec from all shards
+  void get_stat(const int64_t time_sec, int64_t &count, int64_t &cost) const;
+  // add value to the packed stat word of time_sec, false if the word holds a newer second
+  static bool add_stat(int64_t &word, const int64_t time_sec, const int64_t value);
+  // > 0 if time_sec is newer than the second of the word, < 0 if older
+  static int64_t diff_stat_sec(const int64_t time_sec, const int64_t word);
   virtual void free() { op_free(this); }
 
 private:
-  common::DRWLock value_lock_;
-
   int64_t idle_period_count_;
 
-  int64_t index_time_sec_;
-  int64_t values_[QOS_STAT_TYPE_MAX][QOS_STAT_VALUE_COUNT]; // RT unit us
+  ObProxyQosStatShard shards_[QOS_STAT_SHARD_COUNT];
 
   common::ObString key_;
   char key_str_[OB_PROXY_FULL_USER_NAME_MAX_LEN];
@@ -69,6 +69,9 @@ int init_mysql_stats()
     MYSQL_REGISTER_RAW_STAT(mysql_rsb, RECT_PROCESS, "dummy_entry_expired_count",
                             RECD_INT, DUMMY_ENTRY_EXPIRED_COUNT, SYNC_SUM, RECP_PERSISTENT);
 
+    MYSQL_REGISTER_RAW_STAT(mysql_rsb, RECT_PROCESS, "client_read_buffer_release_count",
+                            RECD_INT, CLIENT_READ_BUFFER_RELEASE_COUNT, SYNC_SUM, RECP_PERSISTENT);
+
     MYSQL_REGISTER_RAW_STAT(mysql_rsb, RECT_PROCESS, "total_client_connections",
                             RECD_INT, TOTAL_CLIENT_CONNECTIONS, SYNC_SUM, RECP_NULL);
 
@@ -114,6 +117,12 @@ int init_mysql_stats()
     MYSQL_REGISTER_RAW_STAT(mysql_rsb, RECT_PROCESS, "local_session_state_requests",
                             RECD_INT, CLIENT_USE_LOCAL_SESSION_STATE_REQUESTS, SYNC_SUM, RECP_PERSISTENT);
 
+    MYSQL_REGISTER_RAW_STAT(mysql_rsb, RECT_PROCESS, "result_cache_hit_requests",
+                            RECD_INT, CLIENT_RESULT_CACHE_HIT_REQUESTS, SYNC_SUM, RECP_NULL);
+
+    MYSQL_REGISTER_RAW_STAT(mysql_rsb, RECT_PROCESS, "result_cache_miss_requests",
+                            RECD_INT, CLIENT_RESULT_CACHE_MISS_REQUESTS, SYNC_SUM, RECP_NULL);
+
     MYSQL_REGISTER_RAW_STAT(mysql_rsb, RECT_PROCESS, "client_missing_pk_requests",
                             RECD_INT, CLIENT_MISSING_PK_REQUESTS, SYNC_SUM, RECP_NULL);
 
@@ -74,6 +74,9 @@ enum ObMysqlStats
   // the request proxy will use local session state and responce packet directly
   // e.g. select @@tx_read_only
   CLIENT_USE_LOCAL_SESSION_STATE_REQUESTS,
+  // select answered from or missed in result cache
+  CLIENT_RESULT_CACHE_HIT_REQUESTS,
+  CLIENT_RESULT_CACHE_MISS_REQUESTS,
   CLIENT_MISSING_PK_REQUESTS,
   CLIENT_COMPLETED_REQUESTS,
   CLIENT_CONNECTION_ABORT_COUNT,
@@ -147,6 +150,7 @@ enum ObMysqlStats
   CURRENT_SERVER_TRANSACTIONS,
 
   DUMMY_ENTRY_EXPIRED_COUNT,
+  CLIENT_READ_BUFFER_RELEASE_COUNT,
 
   // Mysql Total Connections Stats
   //
@@ -74,6 +74,9 @@ int init_net_stats()
     NET_REGISTER_RAW_STAT(net_rsb, RECT_PROCESS, "calls_to_write_nodata",
                           RECD_INT, NET_CALLS_TO_WRITE_NODATA, SYNC_SUM, RECP_NULL);
 
+    NET_REGISTER_RAW_STAT(net_rsb, RECT_PROCESS, "calls_to_io_uring_enter",
+                          RECD_INT, NET_CALLS_TO_IO_URING_ENTER, SYNC_SUM, RECP_NULL);
+
     NET_REGISTER_RAW_STAT(net_rsb, RECT_PROCESS, "inactivity_cop_lock_acquire_failure",
                           RECD_INT, INACTIVITY_COP_LOCK_ACQUIRE_FAILURE, SYNC_SUM, RECP_NULL);
 
@@ -85,6 +88,12 @@ int init_net_stats()
 
     NET_REGISTER_RAW_STAT(net_rsb, RECT_PROCESS, "default_inactivity_timeout",
                           RECD_INT, DEFAULT_INACTIVITY_TIMEOUT, SYNC_SUM, RECP_NULL);
+
+    NET_REGISTER_RAW_STAT(net_rsb, RECT_PROCESS, "ssl_full_handshakes",
+                          RECD_INT, SSL_FULL_HANDSHAKES, SYNC_SUM, RECP_NULL);
+
+    NET_REGISTER_RAW_STAT(net_rsb, RECT_PROCESS, "ssl_resumed_handshakes",
+                          RECD_INT, SSL_RESUMED_HANDSHAKES, SYNC_SUM, RECP_NULL);
   }
   return ret;
 }
@@ -37,10 +37,14 @@ enum ObNetStats
   NET_CALLS_TO_WRITETONET,
   NET_CALLS_TO_WRITE,
   NET_CALLS_TO_WRITE_NODATA,
+  NET_CALLS_TO_IO_URING_ENTER,
   INACTIVITY_COP_LOCK_ACQUIRE_FAILURE,
   KEEP_ALIVE_LRU_TIMEOUT_TOTAL,
   KEEP_ALIVE_LRU_TIMEOUT_COUNT,
   DEFAULT_INACTIVITY_TIMEOUT,
+  // ssl handshakes with clients
+  SSL_FULL_HANDSHAKES,
+  SSL_RESUMED_HANDSHAKES,
   NET_STAT_COUNT
 };
 
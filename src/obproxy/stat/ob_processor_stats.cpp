@@ -179,6 +179,19 @@ int init_processor_stats()
 
     PROCESSOR_REGISTER_RAW_STAT(processor_rsb, RECT_PROCESS, "get_congestion_from_global_cache_miss",
                       RECD_INT, GET_CONGESTION_FROM_GLOBAL_CACHE_MISS, SYNC_SUM, RECP_PERSISTENT);
+
+    // dbconfig related
+    PROCESSOR_REGISTER_RAW_STAT(processor_rsb, RECT_PROCESS, "dbconfig_reload_logic_db_count",
+                      RECD_INT, DBCONFIG_RELOAD_LOGIC_DB_COUNT, SYNC_SUM, RECP_NULL);
+
+    PROCESSOR_REGISTER_RAW_STAT(processor_rsb, RECT_PROCESS, "dbconfig_reload_logic_db_time",
+                      RECD_INT, DBCONFIG_RELOAD_LOGIC_DB_TIME, SYNC_SUM, RECP_NULL);
+
+    PROCESSOR_REGISTER_RAW_STAT(processor_rsb, RECT_PROCESS, "dbconfig_shard_rule_parsed",
+                      RECD_INT, DBCONFIG_SHARD_RULE_PARSED, SYNC_SUM, RECP_NULL);
+
+    PROCESSOR_REGISTER_RAW_STAT(processor_rsb, RECT_PROCESS, "dbconfig_shard_rule_reused",
+                      RECD_INT, DBCONFIG_SHARD_RULE_REUSED, SYNC_SUM, RECP_NULL);
   }
 
   return ret;
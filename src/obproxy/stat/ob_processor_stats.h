@@ -84,6 +84,12 @@ enum ObProcessorStats
   GET_CONGESTION_FROM_GLOBAL_CACHE_HIT,
   GET_CONGESTION_FROM_GLOBAL_CACHE_MISS,
 
+  // dbconfig related
+  DBCONFIG_RELOAD_LOGIC_DB_COUNT,
+  DBCONFIG_RELOAD_LOGIC_DB_TIME, // from building the new version to swapping it in
+  DBCONFIG_SHARD_RULE_PARSED,
+  DBCONFIG_SHARD_RULE_REUSED, // rule of an unchanged table copied from the current version
+
   PROCESSOR_STAT_COUNT
 };
 
@@ -21,6 +21,8 @@ namespace common
 ObPartDescList::ObPartDescList() : part_array_ (NULL)
                                    , part_array_size_(0)
                                    , default_part_array_idx_(OB_INVALID_INDEX)
+                                   , value_index_(NULL)
+                                   , value_index_size_(0)
 {
 }
 
@@ -72,23 +74,16 @@ int ObPartDescList::get_part(ObNewRange &range,
     if (OB_FAIL(cast_obj(src_obj, target_obj, allocator))) {
       COMMON_LOG(INFO, "fail to cast obj", K(src_obj), K(target_obj), K(ret));
     } else {
-      bool found = false;
-      for (int64_t i = 0; OB_SUCC(ret) && i < part_array_size_ && !found; ++i) {
-        if (i == default_part_array_idx_) {
-          continue;
-        }
-        for (int64_t j= 0; OB_SUCC(ret) && j < part_array_[i].rows_.count() && !found; ++j) {
-          if (part_array_[i].rows_[j].get_count() == 0) {
-            ret = OB_ERR_UNEXPECTED;
-            COMMON_LOG(WARN, "no cells in the row", K(part_array_[i].rows_[j]), K(ret));
-          } else if (src_obj == part_array_[i].rows_[j].get_cell(0)) {
-            found = true;
-            if (OB_FAIL(part_ids.push_back(part_array_[i].part_id_))) {
-              COMMON_LOG(WARN, "fail to push part id", K(ret));
-            }
-          } // end found
-        } // end for rows
-      } // end for part_array
+      int64_t part_array_idx = OB_INVALID_INDEX;
+      if (NULL != value_index_) {
+        part_array_idx = get_part_array_idx_by_index(src_obj);
+      } else if (OB_FAIL(get_part_array_idx_by_scan(src_obj, part_array_idx))) {
+        COMMON_LOG(WARN, "fail to get part by scan", K(src_obj), K(ret));
+      }
+      const bool found = (OB_INVALID_INDEX != part_array_idx);
+      if (found && OB_FAIL(part_ids.push_back(part_array_[part_array_idx].part_id_))) {
+        COMMON_LOG(WARN, "fail to push part id", K(ret));
+      }
       if (!found && OB_INVALID_INDEX != default_part_array_idx_) {
         // if no row cell matches, use default partition
         COMMON_LOG(DEBUG, "will use default partition id", K(src_obj), K(ret));
@@ -101,6 +96,120 @@ int ObPartDescList::get_part(ObNewRange &range,
   return ret;
 }
 
+int ObPartDescList::get_part_array_idx_by_scan(const ObObj &src_obj, int64_t &part_array_idx) const
+{
+  int ret = OB_SUCCESS;
+  bool found = false;
+  part_array_idx = OB_INVALID_INDEX;
+  for (int64_t i = 0; OB_SUCC(ret) && i < part_array_size_ && !found; ++i) {
+    if (i == default_part_array_idx_) {
+      continue;
+    }
+    for (int64_t j= 0; OB_SUCC(ret) && j < part_array_[i].rows_.count() && !found; ++j) {
+      if (part_array_[i].rows_[j].get_count() == 0) {
+        ret = OB_ERR_UNEXPECTED;
+        COMMON_LOG(WARN, "no cells in the row", K(part_array_[i].rows_[j]), K(ret));
+      } else if (src_obj == part_array_[i].rows_[j].get_cell(0)) {
+        found = true;
+        part_array_idx = i;
+      } // end found
+    } // end for rows
+  } // end for part_array
+  return ret;
+}
+
+int64_t ObPartDescList::get_part_array_idx_by_index(const ObObj &src_obj) const
+{
+  int64_t part_array_idx = OB_INVALID_INDEX;
+  const uint64_t hash = src_obj.hash();
+  const int64_t mask = value_index_size_ - 1;
+  for (int64_t i = 0; OB_INVALID_INDEX == part_array_idx && i < value_index_size_; ++i) {
+    const ListValueIndexItem &item = value_index_[(hash + i) & mask];
+    if (OB_INVALID_INDEX == item.part_array_idx_) {
+      break;
+    } else if (item.hash_ == hash && src_obj == *item.value_) {
+      part_array_idx = item.part_array_idx_;
+    }
+  }
+  return part_array_idx;
+}
+
+// equal values must have the same hash, so only index the types whose hash
+// agrees with compare, and all values must have the type src obj is cast to
+bool ObPartDescList::can_index_value(const ObObj &value, const ObObj &target_obj)
+{
+  const ObObjTypeClass tc = value.get_type_class();
+  return value.get_type() == target_obj.get_type()
+         && value.get_collation_type() == target_obj.get_collation_type()
+         && (ObIntTC == tc || ObUIntTC == tc || ObNumberTC == tc || ObStringTC == tc);
+}
+
+int ObPartDescList::build_value_index(ObIAllocator &allocator)
+{
+  int ret = OB_SUCCESS;
+  int64_t value_count = 0;
+  bool can_index = (NULL != part_array_ && part_array_size_ > 0
+                    && part_array_[0].rows_.count() > 0
+                    && part_array_[0].rows_[0].get_count() > 0);
+  value_index_ = NULL;
+  value_index_size_ = 0;
+  for (int64_t i = 0; can_index && i < part_array_size_; ++i) {
+    if (i != default_part_array_idx_) {
+      const ObObj &target_obj = part_array_[0].rows_[0].get_cell(0);
+      for (int64_t j = 0; can_index && j < part_array_[i].rows_.count(); ++j) {
+        can_index = (part_array_[i].rows_[j].get_count() > 0
+                     && can_index_value(part_array_[i].rows_[j].get_cell(0), target_obj));
+        ++value_count;
+      }
+    }
+  }
+
+  if (can_index && value_count > 0) {
+    // load factor is at most 1/2
+    int64_t size = 2;
+    while (size < value_count * 2) {
+      size <<= 1;
+    }
+    void *buf = NULL;
+    if (OB_ISNULL(buf = allocator.alloc(sizeof(ListValueIndexItem) * size))) {
+      ret = OB_ALLOCATE_MEMORY_FAILED;
+      COMMON_LOG(WARN, "fail to alloc mem for list value index", K(size), K(ret));
+    } else {
+      ListValueIndexItem *index = static_cast<ListValueIndexItem *>(buf);
+      for (int64_t i = 0; i < size; ++i) {
+        index[i].hash_ = 0;
+        index[i].part_array_idx_ = OB_INVALID_INDEX;
+        index[i].value_ = NULL;
+      }
+      const int64_t mask = size - 1;
+      for (int64_t i = 0; i < part_array_size_; ++i) {
+        if (i == default_part_array_idx_) {
+          continue;
+        }
+        for (int64_t j = 0; j < part_array_[i].rows_.count(); ++j) {
+          const ObObj &value = part_array_[i].rows_[j].get_cell(0);
+          const uint64_t hash = value.hash();
+          bool is_dup = false;
+          int64_t slot = static_cast<int64_t>(hash & mask);
+          // the first partition holding the value wins, same as scan
+          while (!is_dup && OB_INVALID_INDEX != index[slot].part_array_idx_) {
+            is_dup = (index[slot].hash_ == hash && value == *index[slot].value_);
+            slot = (slot + 1) & mask;
+          }
+          if (!is_dup) {
+            index[slot].hash_ = hash;
+            index[slot].part_array_idx_ = i;
+            index[slot].value_ = &value;
+          }
+        }
+      }
+      value_index_ = index;
+      value_index_size_ = size;
+    }
+  }
+  return ret;
+}
+
 inline int ObPartDescList::cast_obj(ObObj &src_obj,
                                     const ObObj &target_obj,
                                     ObIAllocator &allocator)
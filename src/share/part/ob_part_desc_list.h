@@ -49,16 +49,31 @@ public:
     part_array_size_ = size;
     return OB_SUCCESS;
   }
+  // build hash index of list values after part array is set, so that get_part
+  // need not scan all values. The memory is hold by allocator.
+  int build_value_index(ObIAllocator &allocator);
 
   DECLARE_VIRTUAL_TO_STRING;
 private:
+  struct ListValueIndexItem
+  {
+    uint64_t hash_;
+    int64_t part_array_idx_; // OB_INVALID_INDEX if the slot is empty
+    const ObObj *value_;
+  };
+
   int cast_obj(ObObj &src_obj,
                const ObObj &target_obj,
                ObIAllocator &allocator);
+  static bool can_index_value(const ObObj &value, const ObObj &target_obj);
+  int64_t get_part_array_idx_by_index(const ObObj &src_obj) const;
+  int get_part_array_idx_by_scan(const ObObj &src_obj, int64_t &part_array_idx) const;
 private:
   ListPartition *part_array_;
   int64_t part_array_size_;
   int64_t default_part_array_idx_;
+  ListValueIndexItem *value_index_;
+  int64_t value_index_size_; // power of 2, 0 if there is no index
 };
 
 } // end common
@@ -0,0 +1,197 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include <string>
+#include "lib/oblog/ob_log.h"
+#include "proxy/route/obproxy_expr_calculator.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace proxy
+{
+using namespace common;
+
+typedef ObProxyExprCalculator Calc;
+
+class TestBatchInsertValuesScanner : public ::testing::Test
+{
+public:
+  static int64_t len(const char *str) { return static_cast<int64_t>(strlen(str)); }
+
+  static std::string value_str(const char *str, const ObBatchInsertValue &value)
+  {
+    return std::string(str + value.start_, value.end_ - value.start_);
+  }
+};
+
+TEST_F(TestBatchInsertValuesScanner, skip_blanks)
+{
+  const char *str = "  /* c1 */ -- c2\n # c3\n\t a";
+  ASSERT_EQ(len(str) - 1, Calc::skip_blanks(str, len(str), 0));
+  // -- must be followed by a space to be a comment
+  const char *minus = "--1";
+  ASSERT_EQ(0, Calc::skip_blanks(minus, len(minus), 0));
+  const char *unterminated = " /* c1";
+  ASSERT_EQ(len(unterminated), Calc::skip_blanks(unterminated, len(unterminated), 0));
+  const char *line_comment = "# only comment";
+  ASSERT_EQ(len(line_comment), Calc::skip_blanks(line_comment, len(line_comment), 0));
+}
+
+TEST_F(TestBatchInsertValuesScanner, skip_quoted)
+{
+  const char *doubled = "'a''b' x";
+  ASSERT_EQ(6, Calc::skip_quoted(doubled, len(doubled), 0));
+  const char *escaped = "'a\\'b' x";
+  ASSERT_EQ(6, Calc::skip_quoted(escaped, len(escaped), 0));
+  const char *comma = "\"a,b\", x";
+  ASSERT_EQ(5, Calc::skip_quoted(comma, len(comma), 0));
+  // backslash does not escape in identifier
+  const char *ident = "`a\\` x";
+  ASSERT_EQ(4, Calc::skip_quoted(ident, len(ident), 0));
+  const char *unterminated = "'abc\\'";
+  ASSERT_EQ(len(unterminated), Calc::skip_quoted(unterminated, len(unterminated), 0));
+}
+
+TEST_F(TestBatchInsertValuesScanner, skip_to_values)
+{
+  const char *str = "insert /* values */ into t_values(`values`, \"values\") values (1, 2)";
+  ASSERT_EQ(strstr(str, " (1, 2)") - str, Calc::skip_to_values(str, len(str)));
+  const char *upper = "INSERT INTO t VALUES(1)";
+  ASSERT_EQ(strstr(upper, "(1)") - upper, Calc::skip_to_values(upper, len(upper)));
+  const char *select = "insert into t(a) select 1 -- values\n";
+  ASSERT_EQ(len(select), Calc::skip_to_values(select, len(select)));
+  const char *quoted = "insert into t(a) select 'values'";
+  ASSERT_EQ(len(quoted), Calc::skip_to_values(quoted, len(quoted)));
+}
+
+TEST_F(TestBatchInsertValuesScanner, scan_values_row)
+{
+  const char *str = "(1, 'a,b)', f(2, (3)), ?) ,\n( ? , \"x)\" /* c */, 4, 5)"
+                    " ON DUPLICATE KEY UPDATE c = VALUES(c)";
+  const int64_t value_pos[] = {0, 1, 2, 3};
+  ObBatchInsertValue values[4];
+  int64_t pos = 0;
+  int64_t placeholder_count = 0;
+  bool has_next_row = false;
+
+  ASSERT_EQ(OB_SUCCESS, Calc::scan_values_row(str, len(str), value_pos, 4, pos,
+                                              placeholder_count, values, has_next_row));
+  ASSERT_TRUE(has_next_row);
+  ASSERT_EQ("1", value_str(str, values[0]));
+  ASSERT_EQ("'a,b)'", value_str(str, values[1]));
+  ASSERT_EQ("f(2, (3))", value_str(str, values[2]));
+  ASSERT_EQ("?", value_str(str, values[3]));
+  ASSERT_EQ(0, values[3].placeholder_idx_);
+  ASSERT_EQ(1, placeholder_count);
+
+  ASSERT_EQ(OB_SUCCESS, Calc::scan_values_row(str, len(str), value_pos, 4, pos,
+                                              placeholder_count, values, has_next_row));
+  // ON DUPLICATE KEY UPDATE is not another row
+  ASSERT_FALSE(has_next_row);
+  ASSERT_EQ("?", value_str(str, values[0]));
+  ASSERT_EQ(1, values[0].placeholder_idx_);
+  ASSERT_EQ("\"x)\"", value_str(str, values[1]));
+  ASSERT_EQ("4", value_str(str, values[2]));
+  ASSERT_EQ("5", value_str(str, values[3]));
+  ASSERT_EQ(2, placeholder_count);
+  ASSERT_EQ(0, strncmp(str + pos, "ON DUPLICATE", 12));
+}
+
+TEST_F(TestBatchInsertValuesScanner, scan_values_row_error)
+{
+  int64_t pos = 0;
+  int64_t placeholder_count = 0;
+  bool has_next_row = false;
+  ObBatchInsertValue values[1];
+  const int64_t value_pos[] = {1};
+
+  // fewer values than the part key position
+  const char *short_row = "(1)";
+  ASSERT_EQ(OB_ERR_UNEXPECTED, Calc::scan_values_row(short_row, len(short_row), value_pos, 1, pos,
+                                                     placeholder_count, values, has_next_row));
+  pos = 0;
+  const char *unterminated = "(1, '2)";
+  ASSERT_EQ(OB_ERR_UNEXPECTED, Calc::scan_values_row(unterminated, len(unterminated), value_pos, 1, pos,
+                                                     placeholder_count, values, has_next_row));
+  pos = 0;
+  const char *no_bracket = "1, 2";
+  ASSERT_EQ(OB_ERR_UNEXPECTED, Calc::scan_values_row(no_bracket, len(no_bracket), value_pos, 1, pos,
+                                                     placeholder_count, values, has_next_row));
+}
+
+TEST_F(TestBatchInsertValuesScanner, get_value_token)
+{
+  char placeholder[] = "?";
+  char int_value[] = "123";
+  char str_value[] = "'abc'";
+  char negative[] = "-1";
+  char func[] = "f(1)";
+  ObProxyTokenNode token;
+
+  ASSERT_TRUE(Calc::get_value_token(placeholder, 1, 5, token));
+  ASSERT_EQ(TOKEN_PLACE_HOLDER, token.type_);
+  ASSERT_EQ(5, token.placeholder_idx_);
+  ASSERT_TRUE(Calc::get_value_token(int_value, 3, 0, token));
+  ASSERT_EQ(TOKEN_INT_VAL, token.type_);
+  ASSERT_EQ(123, token.int_value_);
+  ASSERT_TRUE(Calc::get_value_token(str_value, 5, 0, token));
+  ASSERT_EQ(TOKEN_STR_VAL, token.type_);
+  ASSERT_EQ(str_value + 1, token.str_value_.str_);
+  ASSERT_EQ(3, token.str_value_.str_len_);
+  ASSERT_FALSE(Calc::get_value_token(negative, 2, 0, token));
+  ASSERT_FALSE(Calc::get_value_token(func, 4, 0, token));
+}
+
+TEST_F(TestBatchInsertValuesScanner, is_same_value_token)
+{
+  char sql[] = "'abc', 'abc'";
+  ObProxyTokenNode left;
+  ObProxyTokenNode right;
+  ASSERT_TRUE(Calc::get_value_token(sql, 5, 0, left));
+  ASSERT_TRUE(Calc::get_value_token(sql, 5, 0, right));
+  ASSERT_TRUE(Calc::is_same_value_token(left, right));
+  // the same text at another position is not the value expr parser got
+  ASSERT_TRUE(Calc::get_value_token(sql + 7, 5, 0, right));
+  ASSERT_FALSE(Calc::is_same_value_token(left, right));
+
+  char one[] = "1";
+  char two[] = "2";
+  char placeholder[] = "?";
+  ASSERT_TRUE(Calc::get_value_token(one, 1, 0, left));
+  ASSERT_TRUE(Calc::get_value_token(one, 1, 0, right));
+  ASSERT_TRUE(Calc::is_same_value_token(left, right));
+  ASSERT_TRUE(Calc::get_value_token(two, 1, 0, right));
+  ASSERT_FALSE(Calc::is_same_value_token(left, right));
+  ASSERT_TRUE(Calc::get_value_token(placeholder, 1, 0, right));
+  ASSERT_FALSE(Calc::is_same_value_token(left, right));
+  ASSERT_TRUE(Calc::get_value_token(placeholder, 1, 0, left));
+  ASSERT_TRUE(Calc::is_same_value_token(left, right));
+  ASSERT_TRUE(Calc::get_value_token(placeholder, 1, 1, left));
+  ASSERT_FALSE(Calc::is_same_value_token(left, right));
+}
+
+} // end of namespace proxy
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  oceanbase::common::ObLogger::get_logger().set_log_level("ERROR");
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,167 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include "test_eventsystem_api.h"
+#include "lib/charset/ob_mysql_global.h"
+#include "proxy/mysql/ob_mysql_client_session.h"
+#include "proxy/mysql/ob_mysql_sm.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+using namespace common;
+using namespace event;
+using namespace proxy;
+
+static const int64_t TEST_WAIT_TIMEOUT_MS = 5000;
+static const int64_t TEST_SMALL_REQUEST_LEN = 100;
+static const int64_t TEST_MIN_BLOCK_SIZE = BUFFER_SIZE_FOR_INDEX(BUFFER_SIZE_INDEX_1K);
+
+// the client session counts stats of the thread holding its mutex, so the
+// requests are handled in event thread, the block sizes are checked later
+struct TestClientReadBufferDriver : public ObContinuation
+{
+  enum ObLargeRequestType
+  {
+    LARGE_PACKET_HEADER = 0,
+    BLOCK_FILLED,
+  };
+
+  TestClientReadBufferDriver(ObProxyMutex *mutex, const ObLargeRequestType type)
+    : ObContinuation(mutex), type_(type), small_block_size_(0), large_block_size_(0),
+      next_block_size_(0), large_block_count_(0), run_count_(0)
+  {
+    SET_HANDLER(&TestClientReadBufferDriver::handle_requests);
+    MEMSET(data_, 'a', sizeof(data_));
+  }
+
+  // what read_from_net() does for the request
+  void read_request(ObMysqlClientSession &cs, const int64_t payload_len, const int64_t read_len)
+  {
+    int64_t written_len = 0;
+    ob_int3store(data_, payload_len);
+    data_[3] = 0;
+    (void)cs.read_buffer_->write(data_, read_len, written_len);
+    cs.check_read_buffer_block_size();
+  }
+
+  void finish_request(ObMysqlClientSession &cs, const int64_t request_len)
+  {
+    (void)cs.buffer_reader_->consume_all();
+    cs.release_idle_read_buffer(request_len);
+  }
+
+  int handle_requests(int event, void *data)
+  {
+    UNUSED(event);
+    UNUSED(data);
+    ObMysqlClientSession *cs = new ObMysqlClientSession();
+    cs->mutex_ = mutex_;
+    cs->read_buffer_ = new_miobuffer(MYSQL_BUFFER_SIZE);
+    cs->buffer_reader_ = cs->read_buffer_->alloc_reader();
+
+    for (int64_t i = 0; i < 10; ++i) {
+      read_request(*cs, TEST_SMALL_REQUEST_LEN - MYSQL_NET_HEADER_LENGTH, TEST_SMALL_REQUEST_LEN);
+      finish_request(*cs, TEST_SMALL_REQUEST_LEN);
+    }
+    small_block_size_ = cs->read_buffer_->get_block_size();
+
+    if (LARGE_PACKET_HEADER == type_) {
+      // only the first bytes of a large packet arrive in the first read
+      read_request(*cs, 100 * 1024, 200);
+    } else {
+      // the packet fits in the small block exactly, but fills it up
+      read_request(*cs, small_block_size_ - MYSQL_NET_HEADER_LENGTH, small_block_size_);
+    }
+    large_block_size_ = cs->read_buffer_->get_block_size();
+    // the rest of the request goes into large blocks
+    int64_t written_len = 0;
+    (void)cs->read_buffer_->write(data_, sizeof(data_), written_len);
+    large_block_count_ = cs->buffer_reader_->get_block_count();
+    finish_request(*cs, 100 * 1024);
+    next_block_size_ = cs->read_buffer_->get_block_size();
+
+    free_miobuffer(cs->read_buffer_);
+    cs->read_buffer_ = NULL;
+    cs->buffer_reader_ = NULL;
+    cs->mutex_.release();
+    delete cs;
+    (void)ATOMIC_AAF(&run_count_, 1);
+    return EVENT_DONE;
+  }
+
+  ObLargeRequestType type_;
+  int64_t small_block_size_;
+  int64_t large_block_size_;
+  int64_t next_block_size_;
+  int64_t large_block_count_;
+  int64_t run_count_;
+  char data_[4 * MYSQL_BUFFER_SIZE];
+};
+
+class TestClientReadBuffer : public ::testing::Test
+{
+public:
+  void run(TestClientReadBufferDriver &driver)
+  {
+    ASSERT_TRUE(NULL != g_event_processor.schedule_imm(&driver, ET_CALL));
+    int64_t i = 0;
+    for (; i < TEST_WAIT_TIMEOUT_MS && 0 == ATOMIC_LOAD(&driver.run_count_); ++i) {
+      usleep(1000);
+    }
+    ASSERT_LT(i, TEST_WAIT_TIMEOUT_MS);
+  }
+};
+
+TEST_F(TestClientReadBuffer, large_packet_header)
+{
+  ObPtr<ObProxyMutex> mutex(new_proxy_mutex());
+  TestClientReadBufferDriver *driver =
+      new TestClientReadBufferDriver(mutex.ptr_, TestClientReadBufferDriver::LARGE_PACKET_HEADER);
+  run(*driver);
+  ASSERT_EQ(TEST_MIN_BLOCK_SIZE, driver->small_block_size_);
+  ASSERT_EQ(MYSQL_BUFFER_SIZE, driver->large_block_size_);
+  // one small block, then blocks of MYSQL_BUFFER_SIZE
+  ASSERT_EQ(1 + (TEST_MIN_BLOCK_SIZE + sizeof(driver->data_) - 1) / MYSQL_BUFFER_SIZE,
+            driver->large_block_count_);
+  // recent requests are large, the next one is read into a large block too
+  ASSERT_EQ(MYSQL_BUFFER_SIZE, driver->next_block_size_);
+  delete driver;
+}
+
+TEST_F(TestClientReadBuffer, block_filled)
+{
+  ObPtr<ObProxyMutex> mutex(new_proxy_mutex());
+  TestClientReadBufferDriver *driver =
+      new TestClientReadBufferDriver(mutex.ptr_, TestClientReadBufferDriver::BLOCK_FILLED);
+  run(*driver);
+  ASSERT_EQ(TEST_MIN_BLOCK_SIZE, driver->small_block_size_);
+  ASSERT_EQ(MYSQL_BUFFER_SIZE, driver->large_block_size_);
+  ASSERT_EQ(1 + static_cast<int64_t>(sizeof(driver->data_)) / MYSQL_BUFFER_SIZE, driver->large_block_count_);
+  delete driver;
+}
+
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  oceanbase::common::ObLogger::get_logger().set_log_level("ERROR");
+  oceanbase::obproxy::init_g_net_processor();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
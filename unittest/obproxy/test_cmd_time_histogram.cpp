@@ -0,0 +1,95 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include "proxy/mysql/ob_mysql_sm_time_histogram.h"
+#include "proxy/mysql/ob_mysql_sm_time_stat.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+using namespace common;
+using namespace proxy;
+
+class TestCmdTimeHistogram : public ::testing::Test
+{
+public:
+  virtual void SetUp() { }
+  virtual void TearDown() { }
+};
+
+TEST_F(TestCmdTimeHistogram, bucket_index)
+{
+  int64_t last_index = 0;
+  for (int64_t value = 0; value < 100000; ++value) {
+    const int64_t index = ObLatencyHistogram::get_bucket_index(value);
+    ASSERT_TRUE(index == last_index || index == last_index + 1);
+    ASSERT_LE(value, ObLatencyHistogram::get_bucket_upper_bound(index));
+    if (index > 0) {
+      ASSERT_GT(value, ObLatencyHistogram::get_bucket_upper_bound(index - 1));
+    }
+    last_index = index;
+  }
+  ASSERT_EQ(ObLatencyHistogram::BUCKET_COUNT - 1,
+            ObLatencyHistogram::get_bucket_index(ObLatencyHistogram::MAX_VALUE));
+}
+
+TEST_F(TestCmdTimeHistogram, percentile_and_merge)
+{
+  ObLatencyHistogram histogram;
+  ObLatencyHistogram other;
+  for (int64_t value = 1; value <= 1000; ++value) {
+    histogram.record(value);
+  }
+  ASSERT_EQ(1000, histogram.get_count());
+  ASSERT_EQ(500500, histogram.get_sum());
+  ASSERT_EQ(1000, histogram.get_max());
+  // relative error is below 1/16
+  ASSERT_LE(500, histogram.get_value_at_percentile(50));
+  ASSERT_GE(500 + 500 / 16, histogram.get_value_at_percentile(50));
+  ASSERT_LE(990, histogram.get_value_at_percentile(99));
+  ASSERT_EQ(1000, histogram.get_value_at_percentile(100));
+
+  other.record(-1);
+  other.record(ObLatencyHistogram::MAX_VALUE + 1);
+  histogram.merge(other);
+  ASSERT_EQ(1002, histogram.get_count());
+  ASSERT_EQ(ObLatencyHistogram::MAX_VALUE, histogram.get_max());
+  ASSERT_EQ(1, histogram.get_bucket_count(0));
+}
+
+TEST_F(TestCmdTimeHistogram, record_cmd_time_stat)
+{
+  ObCmdTimeHistograms histograms;
+  ObCmdTimeStat stats;
+  histograms.reset();
+  stats.server_process_request_time_ = HRTIME_MSECONDS(2);
+  stats.request_total_time_ = HRTIME_MSECONDS(3);
+  histograms.record(stats);
+  ASSERT_EQ(0, histograms.get_histogram(CMD_TIME_SERVER_CONNECT).get_count());
+  ASSERT_EQ(1, histograms.get_histogram(CMD_TIME_SERVER_PROCESS_REQUEST).get_count());
+  ASSERT_EQ(2000, histograms.get_histogram(CMD_TIME_SERVER_PROCESS_REQUEST).get_max());
+  ASSERT_EQ(3000, histograms.get_histogram(CMD_TIME_REQUEST_TOTAL).get_sum());
+  ASSERT_STREQ("request_total", get_cmd_time_histogram_name(CMD_TIME_REQUEST_TOTAL));
+}
+
+}
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -206,6 +206,7 @@ void *thread_g_net_processor_start(void *data)
   net_options.max_connections_ = 8192;
   net_options.default_inactivity_timeout_ = 180000;
   net_options.max_client_connections_ = 0;
+  net_options.enable_io_uring_ = false;
   if (OB_FAIL(init_event_system(EVENT_SYSTEM_MODULE_VERSION))) {
     ERROR_NET("failed to init event_system, ret=%d", ret);
   } else if (OB_FAIL(init_mysql_stats())) {
@@ -0,0 +1,256 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include "lib/oblog/ob_log.h"
+#include "proxy/mysql/ob_prepare_statement_struct.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace proxy
+{
+using namespace common;
+using namespace obutils;
+
+static const int64_t THREAD_COUNT = 8;
+static const int64_t PREPARE_COUNT_PER_THREAD = 1000;
+static const int64_t PARAM_COUNT = 3;
+static const uint64_t SCOPE_HASH = 1;
+
+struct TestPrepareArg
+{
+  ObGlobalPsEntryCache *cache_;
+  ObPsEntry *first_entry_;
+  int64_t fill_count_;
+  int64_t diff_entry_count_;
+  int64_t wrong_meta_count_;
+};
+
+// every prepare of the same sql gets the same entry, and the meta is filled
+// by the first response only, like ObMysqlResponsePrepareTransformPlugin
+void *prepare_thread(void *data)
+{
+  TestPrepareArg *arg = static_cast<TestPrepareArg *>(data);
+  ObSqlParseResult parse_result;
+  ObPsEntry *ps_entry = NULL;
+  for (int64_t i = 0; i < PREPARE_COUNT_PER_THREAD; ++i) {
+    if (OB_SUCCESS == arg->cache_->acquire_ps_entry(SCOPE_HASH, ObString::make_string("select ?, ?, ?"),
+                                                    parse_result, 1, ps_entry)) {
+      if (NULL == arg->first_entry_) {
+        arg->first_entry_ = ps_entry;
+      } else if (arg->first_entry_ != ps_entry) {
+        ++arg->diff_entry_count_;
+      }
+      if (ps_entry->try_lock_ps_sql_meta()) {
+        ps_entry->get_ps_sql_meta().set_param_count(PARAM_COUNT);
+        ps_entry->get_ps_sql_meta().set_column_count(PARAM_COUNT);
+        ps_entry->unlock_ps_sql_meta(true);
+        ++arg->fill_count_;
+      } else if (ps_entry->is_ps_sql_meta_ready()
+                 && PARAM_COUNT != ps_entry->get_param_count()) {
+        ++arg->wrong_meta_count_;
+      }
+      ps_entry->dec_ref();
+    }
+  }
+  return NULL;
+}
+
+class TestGlobalPsEntryCache : public ::testing::Test
+{
+public:
+  ObSqlParseResult parse_result_;
+};
+
+TEST_F(TestGlobalPsEntryCache, fill_once)
+{
+  ObPsEntry *ps_entry = NULL;
+  ASSERT_EQ(OB_SUCCESS, ObPsEntry::alloc_and_init_ps_entry(ObString::make_string("select ?"),
+                                                           parse_result_, ps_entry));
+  ps_entry->inc_ref();
+  ASSERT_FALSE(ps_entry->is_ps_sql_meta_ready());
+
+  // the first prepare response claims the meta
+  ASSERT_TRUE(ps_entry->try_lock_ps_sql_meta());
+  ASSERT_FALSE(ps_entry->try_lock_ps_sql_meta());
+  ASSERT_FALSE(ps_entry->is_ps_sql_meta_ready());
+
+  // a failed fill gives it back to the next response
+  ps_entry->unlock_ps_sql_meta(false);
+  ASSERT_FALSE(ps_entry->is_ps_sql_meta_ready());
+  ASSERT_TRUE(ps_entry->try_lock_ps_sql_meta());
+  ps_entry->get_ps_sql_meta().set_param_count(1);
+  ps_entry->unlock_ps_sql_meta(true);
+  ASSERT_TRUE(ps_entry->is_ps_sql_meta_ready());
+  ASSERT_EQ(1, ps_entry->get_param_count());
+
+  // filled only once
+  ASSERT_FALSE(ps_entry->try_lock_ps_sql_meta());
+  ps_entry->dec_ref();
+}
+
+TEST_F(TestGlobalPsEntryCache, overflow_fallback)
+{
+  ObGlobalPsEntryCache cache;
+  ObPsEntry *ps_entry = NULL;
+  ObPsEntry *other_entry = NULL;
+  const ObString sql = ObString::make_string("select ?");
+
+  ASSERT_EQ(OB_SUCCESS, cache.acquire_ps_entry(SCOPE_HASH, sql, parse_result_, 1, ps_entry));
+  ASSERT_TRUE(NULL != ps_entry);
+  ASSERT_EQ(1, cache.count());
+  // one for registry and one for caller
+  ASSERT_EQ(2, ps_entry->ref_count_);
+
+  // existing entries are still got when full
+  ASSERT_EQ(OB_SUCCESS, cache.acquire_ps_entry(SCOPE_HASH, sql, parse_result_, 1, other_entry));
+  ASSERT_EQ(ps_entry, other_entry);
+  ASSERT_EQ(3, ps_entry->ref_count_);
+  other_entry->dec_ref();
+
+  // new sql or the same sql in another scope falls back to session cache
+  ASSERT_EQ(OB_SIZE_OVERFLOW, cache.acquire_ps_entry(SCOPE_HASH, ObString::make_string("select 1"),
+                                                     parse_result_, 1, other_entry));
+  ASSERT_TRUE(NULL == other_entry);
+  ASSERT_EQ(OB_SIZE_OVERFLOW, cache.acquire_ps_entry(SCOPE_HASH + 1, sql, parse_result_, 1, other_entry));
+  ASSERT_TRUE(NULL == other_entry);
+  ASSERT_EQ(1, cache.count());
+
+  ASSERT_EQ(OB_SUCCESS, cache.acquire_ps_entry(SCOPE_HASH + 1, sql, parse_result_, 2, other_entry));
+  ASSERT_NE(ps_entry, other_entry);
+  ASSERT_EQ(2, cache.count());
+  other_entry->dec_ref();
+
+  // entries used by sessions survive destroy
+  cache.destroy();
+  ASSERT_EQ(0, cache.count());
+  ASSERT_EQ(1, ps_entry->ref_count_);
+  ps_entry->dec_ref();
+}
+
+// fill meta like the first prepare response
+void fill_ps_sql_meta(ObPsEntry &ps_entry, const int64_t column_count)
+{
+  ASSERT_TRUE(ps_entry.try_lock_ps_sql_meta());
+  ps_entry.get_ps_sql_meta().set_param_count(0);
+  ps_entry.get_ps_sql_meta().set_column_count(column_count);
+  ps_entry.unlock_ps_sql_meta(true);
+}
+
+TEST_F(TestGlobalPsEntryCache, refresh_after_schema_change)
+{
+  ObGlobalPsEntryCache cache;
+  ObPsEntry *ps_entry = NULL;
+  ObPsEntry *new_entry = NULL;
+  ObPsEntry *other_entry = NULL;
+  const ObString sql = ObString::make_string("select * from t1");
+
+  // prepare, the table has 2 columns
+  ASSERT_EQ(OB_SUCCESS, cache.acquire_ps_entry(SCOPE_HASH, sql, parse_result_, 1, ps_entry));
+  ASSERT_TRUE(ps_entry->is_global());
+  fill_ps_sql_meta(*ps_entry, 2);
+
+  // a column is added, the prepare response returns 3 columns
+  ASSERT_EQ(OB_SUCCESS, cache.refresh_ps_entry(ps_entry, new_entry));
+  ASSERT_NE(ps_entry, new_entry);
+  ASSERT_EQ(0, cache.count());
+  ASSERT_FALSE(new_entry->is_global());
+  ASSERT_TRUE(new_entry->get_base_ps_sql() == sql);
+  fill_ps_sql_meta(*new_entry, 3);
+  // the old one is still used by sessions having prepared it
+  ASSERT_EQ(1, ps_entry->ref_count_);
+  ASSERT_TRUE(ps_entry->is_ps_sql_meta_ready());
+  ASSERT_EQ(2, ps_entry->get_ps_sql_meta().get_column_count());
+
+  // another session holding the old one refreshes it too, the registry is not touched
+  ASSERT_EQ(OB_SUCCESS, cache.acquire_ps_entry(SCOPE_HASH, sql, parse_result_, 1, other_entry));
+  ASSERT_EQ(OB_SUCCESS, cache.refresh_ps_entry(ps_entry, new_entry));
+  ASSERT_EQ(1, cache.count());
+  new_entry->dec_ref();
+  ps_entry->dec_ref();
+
+  // prepare again, the meta of the new entry is filled by the response
+  ASSERT_NE(ps_entry, other_entry);
+  ASSERT_FALSE(other_entry->is_ps_sql_meta_ready());
+  fill_ps_sql_meta(*other_entry, 3);
+  ASSERT_EQ(3, other_entry->get_ps_sql_meta().get_column_count());
+  other_entry->dec_ref();
+  cache.destroy();
+}
+
+TEST_F(TestGlobalPsEntryCache, refresh_session_entry)
+{
+  ObGlobalPsEntryCache cache;
+  ObPsEntry *ps_entry = NULL;
+  ObPsEntry *new_entry = NULL;
+  ASSERT_EQ(OB_SUCCESS, ObPsEntry::alloc_and_init_ps_entry(ObString::make_string("select * from t1"),
+                                                           parse_result_, ps_entry));
+  ps_entry->inc_ref();
+  ASSERT_FALSE(ps_entry->is_global());
+  fill_ps_sql_meta(*ps_entry, 2);
+
+  // not in registry
+  ASSERT_EQ(OB_INVALID_ARGUMENT, cache.refresh_ps_entry(ps_entry, new_entry));
+  ASSERT_TRUE(NULL == new_entry);
+
+  // entry of session is filled again
+  ps_entry->reset_ps_sql_meta();
+  ASSERT_FALSE(ps_entry->is_ps_sql_meta_ready());
+  fill_ps_sql_meta(*ps_entry, 3);
+  ASSERT_EQ(3, ps_entry->get_ps_sql_meta().get_column_count());
+  ps_entry->dec_ref();
+}
+
+TEST_F(TestGlobalPsEntryCache, concurrent_prepare)
+{
+  ObGlobalPsEntryCache cache;
+  pthread_t threads[THREAD_COUNT];
+  TestPrepareArg args[THREAD_COUNT];
+  for (int64_t i = 0; i < THREAD_COUNT; ++i) {
+    MEMSET(&args[i], 0, sizeof(args[i]));
+    args[i].cache_ = &cache;
+    ASSERT_EQ(0, pthread_create(&threads[i], NULL, prepare_thread, &args[i]));
+  }
+  int64_t fill_count = 0;
+  for (int64_t i = 0; i < THREAD_COUNT; ++i) {
+    pthread_join(threads[i], NULL);
+    fill_count += args[i].fill_count_;
+    ASSERT_EQ(args[0].first_entry_, args[i].first_entry_);
+    ASSERT_EQ(0, args[i].diff_entry_count_);
+    ASSERT_EQ(0, args[i].wrong_meta_count_);
+  }
+  ASSERT_EQ(1, fill_count);
+  ASSERT_EQ(1, cache.count());
+  ObPsEntry *ps_entry = args[0].first_entry_;
+  ASSERT_TRUE(NULL != ps_entry);
+  ASSERT_EQ(1, ps_entry->ref_count_);
+  ASSERT_TRUE(ps_entry->is_ps_sql_meta_ready());
+  ASSERT_EQ(PARAM_COUNT, ps_entry->get_param_count());
+  cache.destroy();
+}
+
+} // end of namespace proxy
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  oceanbase::common::ObLogger::get_logger().set_log_level("ERROR");
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
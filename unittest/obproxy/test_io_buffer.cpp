@@ -591,6 +591,40 @@ TEST_F(TestIOBuffer, test_ObMIOBuffer_size_and_check_block_free)
   }
 }
 
+TEST_F(TestIOBuffer, test_ObMIOBuffer_release_empty_blocks)
+{
+  LOG_DEBUG("test_ObMIOBuffer_release_empty_blocks");
+  int64_t written_len = 0;
+  ObMIOBuffer *mio = new_miobuffer(BUFFER_SIZE_FOR_INDEX(BUFFER_SIZE_INDEX_8K));
+  ASSERT_TRUE(NULL != mio);
+  ObIOBufferReader *reader = mio->alloc_reader();
+  ASSERT_TRUE(NULL != reader);
+
+  // data not consumed, can not release
+  ASSERT_EQ(OB_SUCCESS, mio->write(g_input_buf, 100, written_len));
+  ASSERT_FALSE(mio->release_empty_blocks());
+  ASSERT_FALSE(mio->empty());
+  reader->reserved_size_ = 100;
+  ASSERT_FALSE(mio->release_empty_blocks());
+  reader->reserved_size_ = 0;
+
+  ASSERT_EQ(OB_SUCCESS, reader->consume_all());
+  ASSERT_TRUE(mio->release_empty_blocks());
+  ASSERT_TRUE(mio->empty());
+  ASSERT_TRUE(NULL == reader->get_current_block());
+  ASSERT_EQ(0, reader->read_avail());
+  ASSERT_FALSE(mio->release_empty_blocks());
+
+  // next block is allocated with new block size
+  mio->set_block_size(BUFFER_SIZE_FOR_INDEX(BUFFER_SIZE_INDEX_1K));
+  ASSERT_EQ(BUFFER_SIZE_FOR_INDEX(BUFFER_SIZE_INDEX_1K), mio->write_avail());
+  ASSERT_EQ(OB_SUCCESS, mio->write(g_input_buf, 100, written_len));
+  ASSERT_EQ(100, reader->read_avail());
+  ASSERT_EQ(0, memcmp(g_input_buf, reader->start(), 100));
+
+  free_miobuffer(mio);
+}
+
 TEST_F(TestIOBuffer, test_OBMIOBufferReader_replace_with_char)
 {
   LOG_DEBUG("test_ObMIOBufferReader_replace_with_char");
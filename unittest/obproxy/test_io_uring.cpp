@@ -0,0 +1,309 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY_NET
+
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include "test_eventsystem_api.h"
+#include "iocore/net/ob_io_uring.h"
+#include "iocore/net/ob_unix_net_vconnection.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+using namespace common;
+using namespace event;
+using namespace net;
+
+static const int64_t TEST_WAIT_TIMEOUT_MS = 5000;
+static const int64_t TEST_BLOCK_SIZE = 4096;
+static const int64_t TEST_BLOCK_COUNT = 32;
+// more than MAX_IOV blocks, one io_uring readv can not read all of them
+static const int64_t TEST_DATA_SIZE = 100 * 1024;
+
+// the continuation of read vio, records what net vc signals
+struct TestReadCont : public ObContinuation
+{
+  explicit TestReadCont(ObProxyMutex *mutex)
+    : ObContinuation(mutex), event_count_(0), last_event_(0), ndone_(0)
+  {
+    SET_HANDLER(&TestReadCont::handle_read);
+  }
+
+  int handle_read(int event, void *data)
+  {
+    ++event_count_;
+    last_event_ = event;
+    ndone_ = static_cast<ObVIO *>(data)->ndone_;
+    return EVENT_CONT;
+  }
+
+  int64_t event_count_;
+  int last_event_;
+  int64_t ndone_;
+};
+
+// prep_read_from_net() and finish_read_from_net() take the vio mutex and count
+// stats of the calling ethread, so one round of net handler batch is run in event
+// thread, the same as ObNetHandler::process_ready_list_by_io_uring()
+struct TestIOUringReadDriver : public ObContinuation
+{
+  TestIOUringReadDriver(ObProxyMutex *mutex, ObUnixNetVConnection *vc, ObIOUring *io_uring)
+    : ObContinuation(mutex), vc_(vc), io_uring_(io_uring), prep_result_(IO_URING_PREP_DONE),
+      niov_(0), attempted_(0), ret_(OB_SUCCESS), res_(0), vio_mutex_released_(false), run_count_(0)
+  {
+    SET_HANDLER(&TestIOUringReadDriver::handle_read);
+  }
+
+  int handle_read(int event, void *data)
+  {
+    UNUSED(event);
+    UNUSED(data);
+    ObEThread &thread = self_ethread();
+    ObNetIOUringRequest req;
+    uint64_t user_data = 0;
+    ObProxyMutex *vio_mutex = vc_->read_.vio_.mutex_.ptr_;
+    prep_result_ = vc_->prep_read_from_net(thread, req);
+    niov_ = req.niov_;
+    attempted_ = req.attempted_;
+    if (IO_URING_PREP_SUBMIT == prep_result_) {
+      if (OB_SUCCESS != (ret_ = io_uring_->prep_readv(vc_->con_.fd_, req.iov_, req.niov_, 0))) {
+      } else if (OB_SUCCESS != (ret_ = io_uring_->submit_and_wait(1))) {
+      } else if (!io_uring_->get_cqe(user_data, res_)) {
+        ret_ = OB_ERR_UNEXPECTED;
+      } else {
+        req.res_ = res_;
+      }
+      vc_->finish_read_from_net(thread, req);
+      mutex_unlock(vio_mutex, &thread);
+      req.reset();
+    }
+    vio_mutex_released_ = (NULL == vio_mutex->thread_holding_);
+    (void)ATOMIC_AAF(&run_count_, 1);
+    return EVENT_DONE;
+  }
+
+  void reset()
+  {
+    prep_result_ = IO_URING_PREP_DONE;
+    niov_ = 0;
+    attempted_ = 0;
+    ret_ = OB_SUCCESS;
+    res_ = 0;
+    vio_mutex_released_ = false;
+    run_count_ = 0;
+  }
+
+  ObUnixNetVConnection *vc_;
+  ObIOUring *io_uring_;
+  ObNetIOUringPrepResult prep_result_;
+  int32_t niov_;
+  int64_t attempted_;
+  int ret_;
+  int32_t res_;
+  bool vio_mutex_released_;
+  int64_t run_count_;
+};
+
+class TestIOUring : public ::testing::Test
+{
+public:
+  virtual void SetUp()
+  {
+    fds_[0] = -1;
+    fds_[1] = -1;
+    buffer_ = NULL;
+    reader_ = NULL;
+    vc_ = NULL;
+    read_cont_ = NULL;
+    driver_ = NULL;
+  }
+
+  virtual void TearDown()
+  {
+    delete driver_;
+    if (NULL != vc_) {
+      net_handler_.read_ready_list_.remove(vc_);
+      vc_->con_.fd_ = -1;
+      delete vc_;
+    }
+    delete read_cont_;
+    if (fds_[0] >= 0) {
+      close(fds_[0]);
+    }
+    if (fds_[1] >= 0) {
+      close(fds_[1]);
+    }
+    if (NULL != buffer_) {
+      free_miobuffer(buffer_);
+      buffer_ = NULL;
+    }
+    vio_mutex_.release();
+    driver_mutex_.release();
+  }
+
+  void prepare_socket_data()
+  {
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds_));
+    ASSERT_EQ(0, fcntl(fds_[0], F_SETFL, fcntl(fds_[0], F_GETFL) | O_NONBLOCK));
+    for (int64_t i = 0; i < TEST_DATA_SIZE; ++i) {
+      data_[i] = static_cast<char>('a' + i % 26);
+    }
+    int64_t written = 0;
+    while (written < TEST_DATA_SIZE) {
+      ssize_t n = write(fds_[1], data_ + written, TEST_DATA_SIZE - written);
+      ASSERT_GT(n, 0);
+      written += n;
+    }
+  }
+
+  void prepare_buffer()
+  {
+#ifdef TRACK_BUFFER_USER
+    buffer_ = new_miobuffer_internal(RES_PATH("memory/ObIOUring/"), TEST_BLOCK_SIZE);
+#else
+    buffer_ = new_miobuffer_internal(TEST_BLOCK_SIZE);
+#endif
+    ASSERT_TRUE(NULL != buffer_);
+    ASSERT_EQ(OB_SUCCESS, buffer_->add_block(TEST_BLOCK_COUNT - 1));
+    ASSERT_EQ(TEST_BLOCK_SIZE * TEST_BLOCK_COUNT, buffer_->write_avail());
+    reader_ = buffer_->alloc_reader();
+    ASSERT_TRUE(NULL != reader_);
+  }
+
+  // what do_io_read() and a read event of epoll do to the vc
+  void prepare_vc()
+  {
+    vio_mutex_ = new_proxy_mutex();
+    read_cont_ = new TestReadCont(vio_mutex_.ptr_);
+    vc_ = new ObUnixNetVConnection();
+    vc_->nh_ = &net_handler_;
+    vc_->con_.fd_ = fds_[0];
+    vc_->read_.vio_.op_ = ObVIO::READ;
+    vc_->read_.vio_.mutex_ = vio_mutex_;
+    vc_->read_.vio_.cont_ = read_cont_;
+    vc_->read_.vio_.nbytes_ = INT64_MAX;
+    vc_->read_.vio_.ndone_ = 0;
+    vc_->read_.vio_.vc_server_ = reinterpret_cast<ObVConnection *>(vc_);
+    vc_->read_.vio_.buffer_.writer_for(buffer_);
+    vc_->read_.enabled_ = true;
+    vc_->read_.triggered_ = true;
+
+    driver_mutex_ = new_proxy_mutex();
+    driver_ = new TestIOUringReadDriver(driver_mutex_.ptr_, vc_, &io_uring_);
+  }
+
+  void run_driver()
+  {
+    driver_->reset();
+    ASSERT_TRUE(NULL != g_event_processor.schedule_imm(driver_, ET_CALL));
+    int64_t i = 0;
+    for (; i < TEST_WAIT_TIMEOUT_MS && 0 == ATOMIC_LOAD(&driver_->run_count_); ++i) {
+      usleep(1000);
+    }
+    ASSERT_LT(i, TEST_WAIT_TIMEOUT_MS);
+  }
+
+public:
+  int fds_[2];
+  ObIOUring io_uring_;
+  ObMIOBuffer *buffer_;
+  ObIOBufferReader *reader_;
+  ObNetHandler net_handler_;
+  ObPtr<ObProxyMutex> vio_mutex_;
+  ObPtr<ObProxyMutex> driver_mutex_;
+  ObUnixNetVConnection *vc_;
+  TestReadCont *read_cont_;
+  TestIOUringReadDriver *driver_;
+  char data_[TEST_DATA_SIZE];
+};
+
+TEST_F(TestIOUring, init_fallback)
+{
+  ObIOUring io_uring;
+  ASSERT_EQ(OB_INVALID_ARGUMENT, io_uring.init(0));
+  ASSERT_FALSE(io_uring.is_inited());
+
+  // io_uring_setup fails with EINVAL beyond IORING_MAX_ENTRIES,
+  // the same error path as a kernel without io_uring
+  ASSERT_EQ(OB_NOT_SUPPORTED, io_uring.init(1 << 20));
+  ASSERT_FALSE(io_uring.is_inited());
+  ASSERT_EQ(-1, io_uring.ring_fd_);
+  ASSERT_EQ(0, io_uring.get_to_submit());
+  ASSERT_NE(OB_SUCCESS, io_uring.prep_readv(0, NULL, 0, 0));
+}
+
+TEST_F(TestIOUring, read_until_eagain)
+{
+  int ret = io_uring_.init(static_cast<uint32_t>(ObNetPoll::IO_URING_ENTRIES));
+  if (OB_NOT_SUPPORTED == ret) {
+    LOG_WARN("kernel does not support io_uring, skip it", K(ret));
+  } else {
+    ASSERT_EQ(OB_SUCCESS, ret);
+    prepare_socket_data();
+    prepare_buffer();
+    prepare_vc();
+
+    run_driver();
+    ASSERT_EQ(IO_URING_PREP_SUBMIT, driver_->prep_result_);
+    ASSERT_EQ(OB_SUCCESS, driver_->ret_);
+    ASSERT_EQ(ObNetIOUringRequest::MAX_IOV, driver_->niov_);
+    ASSERT_EQ(TEST_BLOCK_SIZE * ObNetIOUringRequest::MAX_IOV, driver_->attempted_);
+    ASSERT_EQ(driver_->attempted_, driver_->res_);
+    ASSERT_TRUE(driver_->vio_mutex_released_);
+
+    // a full completion goes on reading from the next block until EAGAIN
+    ASSERT_EQ(TEST_DATA_SIZE, vc_->read_.vio_.ndone_);
+    ASSERT_EQ(1, read_cont_->event_count_);
+    ASSERT_EQ(VC_EVENT_READ_READY, read_cont_->last_event_);
+    ASSERT_EQ(TEST_DATA_SIZE, read_cont_->ndone_);
+    ASSERT_EQ(TEST_DATA_SIZE, reader_->read_avail());
+    ASSERT_EQ(TEST_BLOCK_SIZE * TEST_BLOCK_COUNT - TEST_DATA_SIZE, buffer_->write_avail());
+    char *dst = new char[TEST_DATA_SIZE];
+    ASSERT_EQ(dst + TEST_DATA_SIZE, reader_->copy(dst, TEST_DATA_SIZE));
+    ASSERT_EQ(0, memcmp(dst, data_, TEST_DATA_SIZE));
+    delete []dst;
+    // still triggered, the buffer has space left
+    ASSERT_TRUE(vc_->read_.enabled_);
+    ASSERT_TRUE(vc_->read_.triggered_);
+    ASSERT_TRUE(net_handler_.read_ready_list_.in(vc_));
+
+    // nothing left, the next readv completes with -EAGAIN instead of blocking
+    run_driver();
+    ASSERT_EQ(IO_URING_PREP_SUBMIT, driver_->prep_result_);
+    ASSERT_EQ(OB_SUCCESS, driver_->ret_);
+    ASSERT_EQ(-EAGAIN, driver_->res_);
+    ASSERT_TRUE(driver_->vio_mutex_released_);
+    ASSERT_EQ(TEST_DATA_SIZE, vc_->read_.vio_.ndone_);
+    ASSERT_EQ(1, read_cont_->event_count_);
+    ASSERT_EQ(TEST_DATA_SIZE, reader_->read_avail());
+    ASSERT_TRUE(vc_->read_.enabled_);
+    ASSERT_FALSE(vc_->read_.triggered_);
+    ASSERT_FALSE(net_handler_.read_ready_list_.in(vc_));
+  }
+}
+
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  oceanbase::common::ObLogger::get_logger().set_log_level("WARN");
+  oceanbase::obproxy::init_g_net_processor();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -17,7 +17,9 @@
 #include "lib/oblog/ob_log.h"
 #include "lib/string/ob_string.h"
 #include "proxy/route/ob_ldc_route.h"
+#include "proxy/route/ob_server_latency_stats.h"
 #include "obutils/ob_state_info.h"
+#include "obutils/ob_proxy_config.h"
 #include "lib/container/ob_se_array.h"
 
 #define TEST2_GET_NEXT_ITEM(idc, merge, is_partition_server, addr, port, type1) \
@@ -4043,6 +4045,129 @@ TEST_F(TesLDCLocation, get_next_item13)
   EXPECT_TRUE(test_ldc_route.is_reach_end());
 }
 
+TEST_F(TesLDCLocation, server_latency_stats)
+{
+  ObServerLatencyStats *stats = new ObServerLatencyStats();
+  ObAddr fast_addr;
+  ObAddr slow_addr;
+  ObAddr unknown_addr;
+  fast_addr.set_ipv4_addr("1.1.1.1", 2881);
+  slow_addr.set_ipv4_addr("1.1.1.2", 2881);
+  unknown_addr.set_ipv4_addr("1.1.1.3", 2881);
+
+  EXPECT_EQ(0, stats->get_score(unknown_addr));
+  stats->update_latency(fast_addr, 100);
+  stats->update_latency(slow_addr, 10000);
+  EXPECT_LT(stats->get_score(fast_addr), stats->get_score(slow_addr));
+
+  // ewma moves toward the new latency
+  stats->update_latency(slow_addr, 100);
+  EXPECT_LT(stats->get_score(slow_addr), 10001);
+  EXPECT_GT(stats->get_score(slow_addr), stats->get_score(fast_addr));
+
+  // requests in flight make the fast one worse
+  const int64_t fast_score = stats->get_score(fast_addr);
+  stats->inc_inflight(fast_addr);
+  stats->inc_inflight(fast_addr);
+  EXPECT_EQ(fast_score * 3, stats->get_score(fast_addr));
+  stats->dec_inflight(fast_addr);
+  stats->dec_inflight(fast_addr);
+  stats->dec_inflight(fast_addr);
+  EXPECT_EQ(fast_score, stats->get_score(fast_addr));
+  delete stats;
+}
+
+TEST_F(TesLDCLocation, server_latency_stats_hash_collision)
+{
+  ObServerLatencyStats *stats = new ObServerLatencyStats();
+  ObAddr addr;
+  ObAddr other_addr;
+  addr.set_ipv4_addr("1.1.1.1", 2881);
+  other_addr.set_ipv4_addr("1.1.1.2", 2881);
+  // other_addr has taken the slot of addr, as if their hashes were the same
+  const uint64_t key = ObServerLatencyStats::get_key(addr);
+  ObServerLatencyStats::ObServerLatencyItem &slot = stats->items_[key % ObServerLatencyStats::MAX_SERVER_COUNT];
+  slot.key_ = key;
+  slot.addr_ = other_addr;
+  slot.is_ready_ = true;
+
+  EXPECT_EQ(0, stats->get_score(addr));
+  stats->update_latency(addr, 100);
+  EXPECT_EQ(0, slot.last_update_time_us_);
+  EXPECT_EQ(101, stats->get_score(addr));
+  ObServerLatencyStats::ObServerLatencyItem &next_slot =
+      stats->items_[(key + 1) % ObServerLatencyStats::MAX_SERVER_COUNT];
+  EXPECT_EQ(key, next_slot.key_);
+  EXPECT_TRUE(addr == next_slot.addr_);
+
+  slot.ewma_us_ = 10000;
+  slot.last_update_time_us_ = next_slot.last_update_time_us_;
+  EXPECT_EQ(10001, stats->get_score(other_addr));
+  EXPECT_EQ(101, stats->get_score(addr));
+  stats->inc_inflight(addr);
+  EXPECT_EQ(0, slot.inflight_count_);
+  EXPECT_EQ(202, stats->get_score(addr));
+  delete stats;
+}
+
+TEST_F(TesLDCLocation, latency_aware_get_next_item)
+{
+  ObServerLatencyStats &stats = get_global_server_latency_stats();
+  ObLDCItem items[2];
+  for (int64_t i = 0; i < 2; ++i) {
+    items[i].set(replicas_z1_.at(i), false, SAME_IDC, ZONE_TYPE_READWRITE, true, false);
+  }
+  const ObAddr &addr0 = replicas_z1_.at(0).server_;
+  const ObAddr &addr1 = replicas_z1_.at(1).server_;
+  ObLDCRoute test_ldc_route;
+  test_ldc_route.location_.item_array_ = items;
+  test_ldc_route.location_.item_count_ = 2;
+  test_ldc_route.location_.site_start_index_array_[SAME_IDC] = 0;
+  test_ldc_route.location_.site_start_index_array_[SAME_REGION] = 2;
+  test_ldc_route.location_.site_start_index_array_[OTHER_REGION] = 2;
+  test_ldc_route.location_.site_start_index_array_[MAX_IDC_TYPE] = 2;
+  test_ldc_route.policy_ = MERGE_IDC_ORDER;
+  ASSERT_TRUE(get_global_proxy_config().enable_latency_aware_routing.set_value("true"));
+
+  // the second one is faster, it is picked first against the one in order
+  stats.update_latency(addr0, 10000);
+  stats.update_latency(addr1, 100);
+  test_ldc_route.reset_cursor();
+  const ObLDCItem *item = test_ldc_route.get_next_item();
+  ASSERT_TRUE(NULL != item);
+  EXPECT_TRUE(addr1 == item->replica_->server_);
+  item = test_ldc_route.get_next_item();
+  ASSERT_TRUE(NULL != item);
+  EXPECT_TRUE(addr0 == item->replica_->server_);
+
+  // the first one is faster now, the order is kept
+  for (int64_t i = 0; i < 100; ++i) {
+    stats.update_latency(addr0, 10);
+    stats.update_latency(addr1, 100000);
+  }
+  test_ldc_route.reset_cursor();
+  item = test_ldc_route.get_next_item();
+  ASSERT_TRUE(NULL != item);
+  EXPECT_TRUE(addr0 == item->replica_->server_);
+  item = test_ldc_route.get_next_item();
+  ASSERT_TRUE(NULL != item);
+  EXPECT_TRUE(addr1 == item->replica_->server_);
+
+  // without latency aware routing, always in order
+  ASSERT_TRUE(get_global_proxy_config().enable_latency_aware_routing.set_value("false"));
+  for (int64_t i = 0; i < 2; ++i) {
+    items[i].reset();
+    items[i].set(replicas_z1_.at(1 - i), false, SAME_IDC, ZONE_TYPE_READWRITE, true, false);
+  }
+  test_ldc_route.reset_cursor();
+  item = test_ldc_route.get_next_item();
+  ASSERT_TRUE(NULL != item);
+  EXPECT_TRUE(addr1 == item->replica_->server_);
+
+  test_ldc_route.location_.item_array_ = NULL;
+  test_ldc_route.location_.item_count_ = 0;
+}
+
 }//end of namespace proxy
 }//end of namespace obproxy
 }//end of namespace oceanbase
@@ -0,0 +1,285 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <vector>
+#include "obutils/ob_mt_hashtable.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace obutils
+{
+using namespace common;
+
+static const int64_t ALIVE_MAGIC = 0x4c495645;
+static const int64_t DEAD_MAGIC = 0x44454144;
+static const int64_t KEY_COUNT = 4096;
+static const int64_t READER_COUNT = 4;
+static const int64_t WRITER_COUNT = 2;
+static const int64_t WRITE_COUNT = 100000;
+
+// freed values are only marked dead and kept until the end of the test,
+// so that a reader touching a released value fails the magic check
+struct TestValue
+{
+  TestValue(const int64_t key) : magic_(ALIVE_MAGIC), key_(key), ref_count_(1), expired_(false) {}
+
+  void inc_ref() { ATOMIC_INC(&ref_count_); }
+  void dec_ref()
+  {
+    if (0 == ATOMIC_SAF(&ref_count_, 1)) {
+      ATOMIC_STORE(&magic_, DEAD_MAGIC);
+    }
+  }
+  bool is_alive() const { return ALIVE_MAGIC == ATOMIC_LOAD(&magic_); }
+
+  int64_t magic_;
+  int64_t key_;
+  volatile int64_t ref_count_;
+  bool expired_;
+};
+
+typedef ObMTHashTable<int64_t, TestValue *> TestHashTable;
+
+static bool gc_test_value(TestValue *value)
+{
+  bool expired = false;
+  if (value->expired_) {
+    expired = true;
+    value->dec_ref();
+  }
+  return expired;
+}
+
+class TestMTHashTable : public ::testing::Test
+{
+public:
+  virtual void SetUp()
+  {
+    stop_ = false;
+    for (int64_t i = 0; i < MT_HASHTABLE_PARTITIONS; ++i) {
+      pthread_mutex_init(&part_locks_[i], NULL);
+    }
+    pthread_mutex_init(&values_lock_, NULL);
+  }
+
+  virtual void TearDown()
+  {
+    for (int64_t i = 0; i < static_cast<int64_t>(values_.size()); ++i) {
+      delete values_[i];
+    }
+    values_.clear();
+  }
+
+  TestValue *new_value(const int64_t key)
+  {
+    TestValue *value = new TestValue(key);
+    pthread_mutex_lock(&values_lock_);
+    values_.push_back(value);
+    pthread_mutex_unlock(&values_lock_);
+    return value;
+  }
+
+  // writers of a part are serialized like under lock_for_key(), reclaim after unlock
+  void insert(TestHashTable &table, const int64_t key, const bool expired)
+  {
+    TestValue *value = new_value(key);
+    value->expired_ = expired;
+    const int64_t part = table.part_num(key);
+    pthread_mutex_lock(&part_locks_[part]);
+    TestValue *old_value = table.insert_entry(key, key, value);
+    pthread_mutex_unlock(&part_locks_[part]);
+    if (NULL != old_value) {
+      old_value->dec_ref();
+    }
+    table.reclaim(part);
+  }
+
+  void remove(TestHashTable &table, const int64_t key)
+  {
+    const int64_t part = table.part_num(key);
+    pthread_mutex_lock(&part_locks_[part]);
+    TestValue *old_value = table.remove_entry(key, key);
+    pthread_mutex_unlock(&part_locks_[part]);
+    if (NULL != old_value) {
+      old_value->dec_ref();
+    }
+    table.reclaim(part);
+  }
+
+  void remove_all(TestHashTable &table)
+  {
+    TestHashTable::IteratorState it;
+    for (int64_t part = 0; part < MT_HASHTABLE_PARTITIONS; ++part) {
+      pthread_mutex_lock(&part_locks_[part]);
+      TestValue *value = table.first_entry(part, it);
+      while (NULL != value) {
+        ASSERT_EQ(value, table.remove_entry(part, it));
+        value->dec_ref();
+        value = table.cur_entry(part, it);
+      }
+      pthread_mutex_unlock(&part_locks_[part]);
+      table.reclaim(part);
+    }
+  }
+
+  static void *read_func(void *arg)
+  {
+    TestMTHashTable *test = static_cast<TestMTHashTable *>(arg);
+    int64_t key = 0;
+    TestValue *value = NULL;
+    while (!ATOMIC_LOAD(&test->stop_)) {
+      key = (key + 7) % KEY_COUNT;
+      if (NULL != (value = test->table_.lookup_entry_lockless(key, key))) {
+        if (!value->is_alive() || key != value->key_) {
+          ATOMIC_INC(&test->read_error_count_);
+        }
+        value->dec_ref();
+      }
+    }
+    return NULL;
+  }
+
+  static void *write_func(void *arg)
+  {
+    TestMTHashTable *test = static_cast<TestMTHashTable *>(arg);
+    unsigned int seed = static_cast<unsigned int>(reinterpret_cast<int64_t>(&seed));
+    int64_t key = 0;
+    for (int64_t i = 0; i < WRITE_COUNT; ++i) {
+      key = rand_r(&seed) % KEY_COUNT;
+      if (0 == rand_r(&seed) % 3) {
+        test->remove(test->table_, key);
+      } else {
+        // some are expired, so that gc unlinks them when a chain grows
+        test->insert(test->table_, key, 0 == rand_r(&seed) % 4);
+      }
+    }
+    return NULL;
+  }
+
+public:
+  volatile bool stop_;
+  int64_t read_error_count_;
+  TestHashTable table_;
+  pthread_mutex_t part_locks_[MT_HASHTABLE_PARTITIONS];
+  pthread_mutex_t values_lock_;
+  std::vector<TestValue *> values_;
+};
+
+TEST_F(TestMTHashTable, retire_until_reclaim)
+{
+  TestHashTable table;
+  ASSERT_EQ(OB_SUCCESS, table.init(4, event::COMMON_LOCK, gc_test_value, NULL, true));
+  const int64_t key = 1;
+  const int64_t part = table.part_num(key);
+  TestValue *value = new_value(key);
+  ASSERT_TRUE(NULL == table.insert_entry(key, key, value));
+
+  // replaced, the old node and value live until reclaim
+  TestValue *new_one = new_value(key);
+  ASSERT_EQ(value, table.insert_entry(key, key, new_one));
+  value->dec_ref();
+  ASSERT_TRUE(value->is_alive());
+  ASSERT_TRUE(table.hash_tables_[part]->has_retired());
+  table.reclaim(part);
+  ASSERT_FALSE(table.hash_tables_[part]->has_retired());
+  ASSERT_FALSE(value->is_alive());
+
+  // removed
+  ASSERT_EQ(new_one, table.remove_entry(key, key));
+  new_one->dec_ref();
+  ASSERT_TRUE(new_one->is_alive());
+  ASSERT_EQ(1, new_one->ref_count_);
+  table.reclaim(part);
+  ASSERT_FALSE(new_one->is_alive());
+  ASSERT_TRUE(NULL == table.lookup_entry_lockless(key, key));
+}
+
+TEST_F(TestMTHashTable, retire_buckets_on_resize)
+{
+  TestHashTable table;
+  ASSERT_EQ(OB_SUCCESS, table.init(1, event::COMMON_LOCK, gc_test_value, NULL, true));
+  const int64_t part = 3;
+  const int64_t count = (MT_HASHTABLE_MAX_CHAIN_AVG_LEN + 1) * 4;
+  for (int64_t i = 0; i < count; ++i) {
+    const int64_t key = i * MT_HASHTABLE_PARTITIONS + part;
+    ASSERT_TRUE(NULL == table.insert_entry(key, key, new_value(key)));
+  }
+  ASSERT_GT(table.hash_tables_[part]->get_bucket_num(), 1);
+  ASSERT_TRUE(NULL != table.hash_tables_[part]->retired_buckets_);
+  table.reclaim(part);
+  ASSERT_FALSE(table.hash_tables_[part]->has_retired());
+  for (int64_t i = 0; i < count; ++i) {
+    const int64_t key = i * MT_HASHTABLE_PARTITIONS + part;
+    TestValue *value = table.lookup_entry_lockless(key, key);
+    ASSERT_TRUE(NULL != value);
+    ASSERT_EQ(key, value->key_);
+    value->dec_ref();
+  }
+  remove_all(table);
+}
+
+TEST_F(TestMTHashTable, concurrent_read_write_remove)
+{
+  read_error_count_ = 0;
+  ASSERT_EQ(OB_SUCCESS, table_.init(4, event::COMMON_LOCK, gc_test_value, NULL, true));
+  pthread_t readers[READER_COUNT];
+  pthread_t writers[WRITER_COUNT];
+  for (int64_t i = 0; i < READER_COUNT; ++i) {
+    ASSERT_EQ(0, pthread_create(&readers[i], NULL, read_func, this));
+  }
+  for (int64_t i = 0; i < WRITER_COUNT; ++i) {
+    ASSERT_EQ(0, pthread_create(&writers[i], NULL, write_func, this));
+  }
+  for (int64_t i = 0; i < WRITER_COUNT; ++i) {
+    pthread_join(writers[i], NULL);
+  }
+  ATOMIC_STORE(&stop_, true);
+  for (int64_t i = 0; i < READER_COUNT; ++i) {
+    pthread_join(readers[i], NULL);
+  }
+  ASSERT_EQ(0, read_error_count_);
+
+  // every value still in the table is found and nothing retired is left behind
+  for (int64_t key = 0; key < KEY_COUNT; ++key) {
+    TestValue *value = table_.lookup_entry(key, key);
+    if (NULL != value) {
+      ASSERT_TRUE(value->is_alive());
+      ASSERT_EQ(1, value->ref_count_);
+    }
+  }
+  remove_all(table_);
+  for (int64_t i = 0; i < MT_HASHTABLE_PARTITIONS; ++i) {
+    ASSERT_FALSE(table_.hash_tables_[i]->has_retired());
+  }
+  for (int64_t i = 0; i < static_cast<int64_t>(values_.size()); ++i) {
+    ASSERT_EQ(0, values_[i]->ref_count_);
+    ASSERT_FALSE(values_[i]->is_alive());
+  }
+}
+
+} // end of namespace obutils
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  oceanbase::common::ObLogger::get_logger().set_log_level("ERROR");
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -718,6 +718,108 @@ TEST_F(TestMysqlTransactionAnalyzer, test_OB_MYSQL_COM_QUERY_select_great_than_1
   analyze_mysql_response(trans_analyzer, hex_commit, true);
 };
 
+// a row packet with 100 bytes body: 99 bytes string
+static int64_t make_row_packet(char *buf, const uint8_t seq)
+{
+  const int64_t body_len = 100;
+  buf[0] = static_cast<char>(body_len);
+  buf[1] = 0;
+  buf[2] = 0;
+  buf[3] = static_cast<char>(seq);
+  buf[4] = static_cast<char>(body_len - 1);
+  memset(buf + 5, 'a', body_len - 1);
+  return body_len + MYSQL_NET_HEADER_LENGTH;
+}
+
+static void analyze_data(ObMysqlTransactionAnalyzer &trans_analyzer, const char *buf, const int64_t len)
+{
+  ObString resp_str;
+  resp_str.assign_ptr(buf, static_cast<int32_t>(len));
+  ASSERT_EQ(OB_SUCCESS, trans_analyzer.analyze_trans_response(resp_str));
+}
+
+TEST_F(TestMysqlTransactionAnalyzer, test_skip_row_body)
+{
+  ObMysqlTransactionAnalyzer trans_analyzer;
+  trans_analyzer.set_server_cmd(OB_MYSQL_COM_QUERY, STANDARD_MYSQL_PROTOCOL_MODE, false, false);
+  ASSERT_EQ(0, trans_analyzer.get_skippable_body_len());
+  const char *hex = "0100000101"//column num
+                    "28000002036465660a6d795f746"//column field1
+                    "573745f64620274330274330270"
+                    "6b02706b0c3f000b000000030350000000"//column EOF
+                    "05000003fe00000200";
+  analyze_mysql_response(trans_analyzer, hex);
+  ASSERT_EQ(0, trans_analyzer.get_skippable_body_len());
+
+  char row[3][DEFAULT_PKT_LEN];
+  const int64_t row_len = make_row_packet(row[0], 4);
+  make_row_packet(row[1], 5);
+  make_row_packet(row[2], 6);
+
+  // 1. partial header, nothing can be skipped
+  analyze_data(trans_analyzer, row[0], 2);
+  ASSERT_EQ(0, trans_analyzer.get_skippable_body_len());
+  ASSERT_EQ(OB_INVALID_ARGUMENT, trans_analyzer.skip_body(1));
+  analyze_data(trans_analyzer, row[0] + 2, 2);
+  ASSERT_EQ(0, trans_analyzer.get_skippable_body_len());
+
+  // 2. the body is skipped except the last byte
+  analyze_data(trans_analyzer, row[0] + 4, 10);
+  ASSERT_EQ(row_len - 14 - 1, trans_analyzer.get_skippable_body_len());
+  ASSERT_EQ(OB_INVALID_ARGUMENT, trans_analyzer.skip_body(0));
+  ASSERT_EQ(OB_INVALID_ARGUMENT, trans_analyzer.skip_body(row_len - 14));
+  ASSERT_EQ(OB_SUCCESS, trans_analyzer.skip_body(50));
+  ASSERT_EQ(row_len - 14 - 1 - 50, trans_analyzer.get_skippable_body_len());
+  ASSERT_EQ(OB_SUCCESS, trans_analyzer.skip_body(row_len - 14 - 1 - 50));
+  ASSERT_EQ(0, trans_analyzer.get_skippable_body_len());
+  ASSERT_EQ(OB_INVALID_ARGUMENT, trans_analyzer.skip_body(1));
+  analyze_data(trans_analyzer, row[0] + row_len - 1, 1);
+  ASSERT_EQ(0, trans_analyzer.get_skippable_body_len());
+  ASSERT_FALSE(trans_analyzer.is_resp_completed());
+
+  // 3. one read crosses packet boundary, only the body of the last packet is skippable
+  char data[2 * DEFAULT_PKT_LEN];
+  MEMCPY(data, row[1], row_len);
+  MEMCPY(data + row_len, row[2], 20);
+  analyze_data(trans_analyzer, data, row_len + 20);
+  ASSERT_EQ(row_len - 20 - 1, trans_analyzer.get_skippable_body_len());
+  ASSERT_EQ(OB_SUCCESS, trans_analyzer.skip_body(row_len - 20 - 1));
+
+  // 4. eof packet is analyzed, never skipped
+  const char eof[] = {0x05, 0x00, 0x00, 0x07, static_cast<char>(0xfe), 0x00, 0x00, 0x02, 0x00};
+  MEMCPY(data, row[2] + row_len - 1, 1);
+  MEMCPY(data + 1, eof, 6);
+  analyze_data(trans_analyzer, data, 7);
+  ASSERT_EQ(0, trans_analyzer.get_skippable_body_len());
+  ASSERT_EQ(OB_INVALID_ARGUMENT, trans_analyzer.skip_body(1));
+  ASSERT_FALSE(trans_analyzer.is_resp_completed());
+  analyze_data(trans_analyzer, eof + 6, 3);
+  ASSERT_EQ(0, trans_analyzer.get_skippable_body_len());
+  ASSERT_TRUE(trans_analyzer.is_resp_completed());
+  ASSERT_TRUE(trans_analyzer.is_trans_completed());
+};
+
+TEST_F(TestMysqlTransactionAnalyzer, test_skip_ok_body)
+{
+  ObMysqlTransactionAnalyzer trans_analyzer;
+  trans_analyzer.set_server_cmd(OB_MYSQL_COM_QUERY, STANDARD_MYSQL_PROTOCOL_MODE, false, false);
+  // ok packet with a message, the status flags are analyzed
+  char ok[DEFAULT_PKT_LEN];
+  const char *hex = "2200000100010002000000"
+                    "526f7773206d6174636865643a203120204368616e6765643a2031";
+  ASSERT_EQ(OB_SUCCESS, covert_hex_to_string(hex, strlen(hex), ok));
+  const int64_t ok_len = strlen(hex) / 2;
+  ASSERT_EQ(static_cast<int64_t>(ok[0]) + MYSQL_NET_HEADER_LENGTH, ok_len);
+
+  analyze_data(trans_analyzer, ok, 6);
+  ASSERT_EQ(0, trans_analyzer.get_skippable_body_len());
+  ASSERT_EQ(OB_INVALID_ARGUMENT, trans_analyzer.skip_body(1));
+  analyze_data(trans_analyzer, ok + 6, ok_len - 6);
+  ASSERT_EQ(0, trans_analyzer.get_skippable_body_len());
+  ASSERT_TRUE(trans_analyzer.is_resp_completed());
+  ASSERT_TRUE(trans_analyzer.is_trans_completed());
+};
+
 }
 }
 }
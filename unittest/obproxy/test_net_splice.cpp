@@ -0,0 +1,322 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY_NET
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+#include <fcntl.h>
+#include "test_eventsystem_api.h"
+#include "iocore/net/ob_unix_net_vconnection.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+using namespace common;
+using namespace event;
+using namespace net;
+
+static const int64_t TEST_WAIT_TIMEOUT_MS = 5000;
+static const int64_t TEST_BLOCK_SIZE = 4096;
+static const int64_t TEST_BLOCK_COUNT = 32;
+static const int64_t TEST_DATA_SIZE = 64 * 1024;
+static const int64_t TEST_SPLICE_LEN = 40000;
+
+// splice_from_net() counts stats of the calling ethread, it is run in event thread
+struct TestSpliceDriver : public ObContinuation
+{
+  TestSpliceDriver(ObProxyMutex *mutex, ObUnixNetVConnection *vc, ObMIOBuffer *buffer)
+    : ObContinuation(mutex), vc_(vc), buffer_(buffer), ret_(OB_SUCCESS),
+      total_spliced_(0), total_read_(0), run_count_(0)
+  {
+    SET_HANDLER(&TestSpliceDriver::handle_splice);
+  }
+
+  int handle_splice(int event, void *data)
+  {
+    UNUSED(event);
+    UNUSED(data);
+    total_spliced_ = 0;
+    total_read_ = 0;
+    ret_ = vc_->splice_from_net(self_ethread(), *buffer_, buffer_->write_avail(),
+                                total_spliced_, total_read_);
+    (void)ATOMIC_AAF(&run_count_, 1);
+    return EVENT_DONE;
+  }
+
+  ObUnixNetVConnection *vc_;
+  ObMIOBuffer *buffer_;
+  int ret_;
+  int64_t total_spliced_;
+  int64_t total_read_;
+  int64_t run_count_;
+};
+
+class TestNetSplice : public ::testing::Test
+{
+public:
+  virtual void SetUp()
+  {
+    // src_fds_[0] is the socket of the vc spliced from, the peer sends data on src_fds_[1];
+    // dst_fds_[0] is the socket of splice target, the peer receives data on dst_fds_[1]
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, src_fds_));
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, dst_fds_));
+    for (int64_t i = 0; i < 2; ++i) {
+      ASSERT_EQ(0, fcntl(src_fds_[i], F_SETFL, fcntl(src_fds_[i], F_GETFL) | O_NONBLOCK));
+      ASSERT_EQ(0, fcntl(dst_fds_[i], F_SETFL, fcntl(dst_fds_[i], F_GETFL) | O_NONBLOCK));
+    }
+    for (int64_t i = 0; i < TEST_DATA_SIZE; ++i) {
+      data_[i] = static_cast<char>('a' + i % 26);
+    }
+
+#ifdef TRACK_BUFFER_USER
+    buffer_ = new_miobuffer_internal(RES_PATH("memory/ObNetSplice/"), TEST_BLOCK_SIZE);
+#else
+    buffer_ = new_miobuffer_internal(TEST_BLOCK_SIZE);
+#endif
+    ASSERT_TRUE(NULL != buffer_);
+    ASSERT_EQ(OB_SUCCESS, buffer_->add_block(TEST_BLOCK_COUNT - 1));
+    reader_ = buffer_->alloc_reader();
+    ASSERT_TRUE(NULL != reader_);
+#ifdef TRACK_BUFFER_USER
+    dst_buffer_ = new_empty_miobuffer_internal(RES_PATH("memory/ObNetSplice/"), TEST_BLOCK_SIZE);
+#else
+    dst_buffer_ = new_empty_miobuffer_internal(TEST_BLOCK_SIZE);
+#endif
+    ASSERT_TRUE(NULL != dst_buffer_);
+    dst_reader_ = dst_buffer_->alloc_reader();
+    ASSERT_TRUE(NULL != dst_reader_);
+
+    // what do_io_read() of src and do_io_write() of dst do with the same continuation mutex
+    vio_mutex_ = new_proxy_mutex();
+    vc_ = new ObUnixNetVConnection();
+    vc_->nh_ = &net_handler_;
+    vc_->con_.fd_ = src_fds_[0];
+    vc_->read_.vio_.op_ = ObVIO::READ;
+    vc_->read_.vio_.mutex_ = vio_mutex_;
+    vc_->read_.vio_.nbytes_ = INT64_MAX;
+    vc_->read_.vio_.ndone_ = 0;
+    vc_->read_.vio_.buffer_.writer_for(buffer_);
+    dst_vc_ = new ObUnixNetVConnection();
+    dst_vc_->nh_ = &net_handler_;
+    dst_vc_->con_.fd_ = dst_fds_[0];
+    dst_vc_->write_.vio_.op_ = ObVIO::WRITE;
+    dst_vc_->write_.vio_.mutex_ = vio_mutex_;
+    dst_vc_->write_.vio_.nbytes_ = INT64_MAX;
+    dst_vc_->write_.vio_.ndone_ = 0;
+    dst_vc_->write_.vio_.buffer_.reader_for(dst_reader_);
+    vc_->set_splice_target(dst_vc_, TEST_SPLICE_LEN);
+
+    driver_mutex_ = new_proxy_mutex();
+    driver_ = new TestSpliceDriver(driver_mutex_.ptr_, vc_, buffer_);
+  }
+
+  virtual void TearDown()
+  {
+    delete driver_;
+    vc_->con_.fd_ = -1;
+    dst_vc_->con_.fd_ = -1;
+    delete vc_;
+    delete dst_vc_;
+    net_handler_.close_splice_pipe();
+    free_miobuffer(buffer_);
+    free_miobuffer(dst_buffer_);
+    vio_mutex_.release();
+    driver_mutex_.release();
+    close(src_fds_[0]);
+    close(src_fds_[1]);
+    close(dst_fds_[0]);
+    close(dst_fds_[1]);
+  }
+
+  void send_data(const int64_t len)
+  {
+    int64_t written = 0;
+    while (written < len) {
+      ssize_t n = write(src_fds_[1], data_ + written, len - written);
+      ASSERT_GT(n, 0);
+      written += n;
+    }
+  }
+
+  // read until EAGAIN
+  int64_t recv_data(const int fd, char *buf, const int64_t len)
+  {
+    int64_t total = 0;
+    ssize_t n = 0;
+    while (total < len && (n = read(fd, buf + total, len - total)) > 0) {
+      total += n;
+    }
+    return total;
+  }
+
+  void run_driver()
+  {
+    ASSERT_TRUE(NULL != g_event_processor.schedule_imm(driver_, ET_CALL));
+    int64_t i = 0;
+    for (; i < TEST_WAIT_TIMEOUT_MS && 0 == ATOMIC_LOAD(&driver_->run_count_); ++i) {
+      usleep(1000);
+    }
+    ASSERT_LT(i, TEST_WAIT_TIMEOUT_MS);
+  }
+
+public:
+  int src_fds_[2];
+  int dst_fds_[2];
+  ObNetHandler net_handler_;
+  ObMIOBuffer *buffer_;
+  ObIOBufferReader *reader_;
+  ObMIOBuffer *dst_buffer_;
+  ObIOBufferReader *dst_reader_;
+  ObPtr<ObProxyMutex> vio_mutex_;
+  ObPtr<ObProxyMutex> driver_mutex_;
+  ObUnixNetVConnection *vc_;
+  ObUnixNetVConnection *dst_vc_;
+  TestSpliceDriver *driver_;
+  char data_[TEST_DATA_SIZE];
+  char recv_buf_[TEST_DATA_SIZE];
+};
+
+TEST_F(TestNetSplice, can_splice_to_net)
+{
+  ASSERT_TRUE(vc_->can_splice_to_net());
+
+  // data before the spliced bytes has not been written to dst
+  int64_t written_len = 0;
+  ASSERT_EQ(OB_SUCCESS, dst_buffer_->write(data_, 10, written_len));
+  ASSERT_FALSE(vc_->can_splice_to_net());
+  ASSERT_EQ(OB_SUCCESS, dst_reader_->consume_all());
+  ASSERT_TRUE(vc_->can_splice_to_net());
+
+  // dst is written in the callback of other continuation
+  ObPtr<ObProxyMutex> other_mutex(new_proxy_mutex());
+  dst_vc_->write_.vio_.mutex_ = other_mutex;
+  ASSERT_FALSE(vc_->can_splice_to_net());
+  dst_vc_->write_.vio_.mutex_ = vio_mutex_;
+
+  // dst does not expect so many bytes
+  dst_vc_->write_.vio_.nbytes_ = TEST_SPLICE_LEN;
+  ASSERT_FALSE(vc_->can_splice_to_net());
+  dst_vc_->write_.vio_.nbytes_ = INT64_MAX;
+
+  dst_vc_->f_.shutdown_ = NET_VC_SHUTDOWN_WRITE;
+  ASSERT_FALSE(vc_->can_splice_to_net());
+  dst_vc_->f_.shutdown_ = 0;
+
+  vc_->set_splice_target(dst_vc_, 0);
+  ASSERT_FALSE(vc_->can_splice_to_net());
+  ASSERT_TRUE(NULL == vc_->splice_dst_);
+}
+
+TEST_F(TestNetSplice, splice_to_dst)
+{
+  send_data(TEST_DATA_SIZE);
+  run_driver();
+  ASSERT_EQ(OB_SUCCESS, driver_->ret_);
+  ASSERT_EQ(TEST_SPLICE_LEN, driver_->total_spliced_);
+  ASSERT_EQ(0, driver_->total_read_);
+
+  // both vios count the spliced bytes, the tunnel gets them once
+  ASSERT_EQ(0, vc_->splice_todo_);
+  ASSERT_EQ(TEST_SPLICE_LEN, vc_->read_.vio_.ndone_);
+  ASSERT_EQ(TEST_SPLICE_LEN, dst_vc_->write_.vio_.ndone_);
+  ASSERT_EQ(TEST_SPLICE_LEN, vc_->consume_spliced_bytes());
+  ASSERT_EQ(0, vc_->consume_spliced_bytes());
+
+  // never more than splice todo, the rest is left in src socket
+  ASSERT_EQ(0, reader_->read_avail());
+  ASSERT_EQ(TEST_SPLICE_LEN, recv_data(dst_fds_[1], recv_buf_, TEST_DATA_SIZE));
+  ASSERT_EQ(0, memcmp(recv_buf_, data_, TEST_SPLICE_LEN));
+  ASSERT_EQ(TEST_DATA_SIZE - TEST_SPLICE_LEN, recv_data(src_fds_[0], recv_buf_, TEST_DATA_SIZE));
+  ASSERT_EQ(0, memcmp(recv_buf_, data_ + TEST_SPLICE_LEN, TEST_DATA_SIZE - TEST_SPLICE_LEN));
+}
+
+TEST_F(TestNetSplice, dst_full)
+{
+  // dst can only take part of the bytes, the rest in pipe goes to the read buffer
+  int sndbuf = 4096;
+  ASSERT_EQ(0, setsockopt(dst_fds_[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)));
+  vc_->set_splice_target(dst_vc_, TEST_DATA_SIZE);
+  send_data(TEST_DATA_SIZE);
+  run_driver();
+  ASSERT_EQ(OB_SUCCESS, driver_->ret_);
+  ASSERT_LT(0, driver_->total_read_);
+  ASSERT_GT(TEST_DATA_SIZE, driver_->total_spliced_);
+
+  const int64_t spliced = driver_->total_spliced_;
+  const int64_t read_len = driver_->total_read_;
+  ASSERT_EQ(TEST_DATA_SIZE - spliced - read_len, vc_->splice_todo_);
+  ASSERT_EQ(spliced, vc_->read_.vio_.ndone_);
+  ASSERT_EQ(spliced, dst_vc_->write_.vio_.ndone_);
+  ASSERT_EQ(spliced, vc_->consume_spliced_bytes());
+
+  // the pipe is empty, the bytes are in order between dst, the read buffer and src
+  ASSERT_EQ(OB_SUCCESS, buffer_->fill(read_len));
+  ASSERT_EQ(read_len, reader_->read_avail());
+  ASSERT_EQ(recv_buf_ + read_len, reader_->copy(recv_buf_, read_len));
+  ASSERT_EQ(0, memcmp(recv_buf_, data_ + spliced, read_len));
+  ASSERT_EQ(spliced, recv_data(dst_fds_[1], recv_buf_, TEST_DATA_SIZE));
+  ASSERT_EQ(0, memcmp(recv_buf_, data_, spliced));
+  ASSERT_EQ(TEST_DATA_SIZE - spliced - read_len, recv_data(src_fds_[0], recv_buf_, TEST_DATA_SIZE));
+  ASSERT_EQ(0, memcmp(recv_buf_, data_ + spliced + read_len, TEST_DATA_SIZE - spliced - read_len));
+}
+
+TEST_F(TestNetSplice, fallback_eagain)
+{
+  // nothing to read, read_from_net() goes on with normal read
+  run_driver();
+  ASSERT_EQ(OB_SUCCESS, driver_->ret_);
+  ASSERT_EQ(0, driver_->total_spliced_);
+  ASSERT_EQ(0, driver_->total_read_);
+  ASSERT_EQ(TEST_SPLICE_LEN, vc_->splice_todo_);
+  ASSERT_EQ(0, vc_->read_.vio_.ndone_);
+  ASSERT_EQ(0, dst_vc_->write_.vio_.ndone_);
+  ASSERT_EQ(0, vc_->consume_spliced_bytes());
+}
+
+TEST_F(TestNetSplice, fallback_einval)
+{
+  // eventfd can not be spliced, splice() fails with EINVAL
+  int efd = eventfd(0, EFD_NONBLOCK);
+  ASSERT_LE(0, efd);
+  uint64_t value = 1;
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(value)), write(efd, &value, sizeof(value)));
+  ASSERT_EQ(-1, splice(efd, NULL, dst_fds_[0], NULL, sizeof(value), SPLICE_F_NONBLOCK));
+  ASSERT_EQ(EINVAL, errno);
+
+  vc_->con_.fd_ = efd;
+  run_driver();
+  ASSERT_EQ(OB_SUCCESS, driver_->ret_);
+  ASSERT_EQ(0, driver_->total_spliced_);
+  ASSERT_EQ(0, driver_->total_read_);
+  ASSERT_EQ(TEST_SPLICE_LEN, vc_->splice_todo_);
+  ASSERT_EQ(0, vc_->read_.vio_.ndone_);
+  ASSERT_EQ(0, dst_vc_->write_.vio_.ndone_);
+  // the data is still there for normal read
+  ASSERT_EQ(static_cast<ssize_t>(sizeof(value)), read(efd, &value, sizeof(value)));
+  ASSERT_EQ(1UL, value);
+  close(efd);
+}
+
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  oceanbase::common::ObLogger::get_logger().set_log_level("ERROR");
+  oceanbase::obproxy::init_g_net_processor();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
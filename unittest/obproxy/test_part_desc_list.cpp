@@ -0,0 +1,243 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include "lib/allocator/page_arena.h"
+#include "share/part/ob_part_desc_list.h"
+
+namespace oceanbase
+{
+namespace common
+{
+
+class TestPartDescList : public ::testing::Test
+{
+public:
+  TestPartDescList() : allocator_(ObModIds::TEST), part_array_(NULL), part_count_(0) {}
+
+  void init_part_array(const int64_t part_count)
+  {
+    part_count_ = part_count;
+    part_array_ = static_cast<ListPartition *>(allocator_.alloc(sizeof(ListPartition) * part_count));
+    for (int64_t i = 0; i < part_count; ++i) {
+      new (part_array_ + i) ListPartition();
+      part_array_[i].part_id_ = i + 100;
+    }
+  }
+
+  void add_value(const int64_t part_idx, const ObObj &value)
+  {
+    ObObj *cell = new (allocator_.alloc(sizeof(ObObj))) ObObj(value);
+    ObNewRow row;
+    row.assign(cell, 1);
+    ASSERT_EQ(OB_SUCCESS, part_array_[part_idx].rows_.push_back(row));
+  }
+
+  void add_int(const int64_t part_idx, const int64_t value)
+  {
+    ObObj obj;
+    obj.set_int(value);
+    add_value(part_idx, obj);
+  }
+
+  void add_varchar(const int64_t part_idx, const char *value, const ObCollationType cs_type)
+  {
+    ObObj obj;
+    obj.set_varchar(value);
+    obj.set_collation_type(cs_type);
+    add_value(part_idx, obj);
+  }
+
+  void build(ObPartDescList &desc, const int64_t default_part_idx)
+  {
+    ASSERT_EQ(OB_SUCCESS, desc.set_part_array(part_array_, part_count_));
+    desc.set_default_part_array_idx(default_part_idx);
+    ASSERT_EQ(OB_SUCCESS, desc.build_value_index(allocator_));
+  }
+
+  // the index must find the same partition as the scan it replaces
+  void check_same_as_scan(const ObPartDescList &desc, const ObObj &value)
+  {
+    int64_t scan_idx = OB_INVALID_INDEX;
+    ASSERT_TRUE(NULL != desc.value_index_);
+    ASSERT_EQ(OB_SUCCESS, desc.get_part_array_idx_by_scan(value, scan_idx));
+    ASSERT_EQ(scan_idx, desc.get_part_array_idx_by_index(value)) << to_cstring(value);
+  }
+
+  void get_part(ObPartDescList &desc, const ObObj &value, const bool use_index, ObIArray<int64_t> &part_ids)
+  {
+    ObObj obj = value;
+    ObNewRange range;
+    range.start_key_.assign(&obj, 1);
+    range.end_key_.assign(&obj, 1);
+    ObPartDescList::ListValueIndexItem *value_index = desc.value_index_;
+    if (!use_index) {
+      desc.value_index_ = NULL;
+    }
+    ASSERT_EQ(OB_SUCCESS, desc.get_part(range, allocator_, part_ids));
+    desc.value_index_ = value_index;
+  }
+
+  void check_get_part(ObPartDescList &desc, const ObObj &value, const int64_t expected_part_id)
+  {
+    ObSEArray<int64_t, 1> index_part_ids;
+    ObSEArray<int64_t, 1> scan_part_ids;
+    get_part(desc, value, true, index_part_ids);
+    get_part(desc, value, false, scan_part_ids);
+    ASSERT_EQ(scan_part_ids.count(), index_part_ids.count());
+    if (OB_INVALID_INDEX == expected_part_id) {
+      ASSERT_EQ(0, index_part_ids.count());
+    } else {
+      ASSERT_EQ(1, index_part_ids.count());
+      ASSERT_EQ(expected_part_id, index_part_ids.at(0));
+      ASSERT_EQ(expected_part_id, scan_part_ids.at(0));
+    }
+  }
+
+public:
+  ObArenaAllocator allocator_;
+  ListPartition *part_array_;
+  int64_t part_count_;
+};
+
+TEST_F(TestPartDescList, int_values)
+{
+  // p0 (1, 2, 3), p1 DEFAULT, p2 (3, 4, -5), p3 (100..199)
+  init_part_array(4);
+  add_int(0, 1);
+  add_int(0, 2);
+  add_int(0, 3);
+  add_int(1, 0);
+  add_int(2, 3);
+  add_int(2, 4);
+  add_int(2, -5);
+  for (int64_t i = 100; i < 200; ++i) {
+    add_int(3, i);
+  }
+  ObPartDescList desc;
+  build(desc, 1);
+  ASSERT_TRUE(NULL != desc.value_index_);
+  ASSERT_GE(desc.value_index_size_, 2 * (3 + 3 + 100));
+
+  ObObj obj;
+  for (int64_t i = -10; i < 210; ++i) {
+    obj.set_int(i);
+    check_same_as_scan(desc, obj);
+  }
+  // duplicate value, the first partition wins
+  obj.set_int(3);
+  check_get_part(desc, obj, 100);
+  obj.set_int(-5);
+  check_get_part(desc, obj, 102);
+  obj.set_int(150);
+  check_get_part(desc, obj, 103);
+  // the value of the DEFAULT partition row is not indexed
+  obj.set_int(0);
+  check_get_part(desc, obj, 101);
+  obj.set_int(1000);
+  check_get_part(desc, obj, 101);
+}
+
+TEST_F(TestPartDescList, no_default_partition)
+{
+  init_part_array(2);
+  add_int(0, 1);
+  add_int(1, 2);
+  ObPartDescList desc;
+  build(desc, OB_INVALID_INDEX);
+  ObObj obj;
+  obj.set_int(2);
+  check_get_part(desc, obj, 101);
+  obj.set_int(3);
+  check_get_part(desc, obj, OB_INVALID_INDEX);
+}
+
+TEST_F(TestPartDescList, case_insensitive_collation)
+{
+  const ObCollationType cs_type = CS_TYPE_UTF8MB4_GENERAL_CI;
+  init_part_array(4);
+  add_varchar(0, "abc", cs_type);
+  add_varchar(0, "Hangzhou", cs_type);
+  add_varchar(1, "ABC", cs_type); // equal to 'abc' in this collation
+  add_varchar(1, "beijing", cs_type);
+  add_varchar(2, "Shanghai", cs_type);
+  add_varchar(3, "default", cs_type);
+  ObPartDescList desc;
+  build(desc, 3);
+
+  const char *probes[] = {"abc", "ABC", "aBc", "abc ", "hangzhou", "HANGZHOU", "Beijing",
+                          "shanghai", "shang hai", "", "default", "unknown"};
+  ObObj obj;
+  for (int64_t i = 0; i < static_cast<int64_t>(ARRAYSIZEOF(probes)); ++i) {
+    obj.set_varchar(probes[i]);
+    obj.set_collation_type(cs_type);
+    check_same_as_scan(desc, obj);
+  }
+  obj.set_varchar("ABC");
+  obj.set_collation_type(cs_type);
+  check_get_part(desc, obj, 100);
+  obj.set_varchar("BEIJING");
+  check_get_part(desc, obj, 101);
+  obj.set_varchar("SHANGHAI");
+  check_get_part(desc, obj, 102);
+  obj.set_varchar("guangzhou");
+  check_get_part(desc, obj, 103);
+}
+
+TEST_F(TestPartDescList, binary_collation)
+{
+  const ObCollationType cs_type = CS_TYPE_UTF8MB4_BIN;
+  init_part_array(2);
+  add_varchar(0, "abc", cs_type);
+  add_varchar(1, "ABC", cs_type);
+  ObPartDescList desc;
+  build(desc, OB_INVALID_INDEX);
+
+  ObObj obj;
+  obj.set_varchar("ABC");
+  obj.set_collation_type(cs_type);
+  check_same_as_scan(desc, obj);
+  check_get_part(desc, obj, 101);
+  obj.set_varchar("aBc");
+  check_get_part(desc, obj, OB_INVALID_INDEX);
+}
+
+TEST_F(TestPartDescList, not_indexed)
+{
+  // values of different types are left to the scan
+  init_part_array(2);
+  add_int(0, 1);
+  add_varchar(1, "1", CS_TYPE_UTF8MB4_GENERAL_CI);
+  ObPartDescList desc;
+  build(desc, OB_INVALID_INDEX);
+  ASSERT_TRUE(NULL == desc.value_index_);
+  ASSERT_EQ(0, desc.value_index_size_);
+  ObSEArray<int64_t, 1> part_ids;
+  ObObj obj;
+  obj.set_int(1);
+  get_part(desc, obj, true, part_ids);
+  ASSERT_EQ(1, part_ids.count());
+  ASSERT_EQ(100, part_ids.at(0));
+}
+
+} // end of namespace common
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  oceanbase::common::ObLogger::get_logger().set_log_level("ERROR");
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,211 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define private public
+#define protected public
+#define USING_LOG_PREFIX PROXY
+#include <gtest/gtest.h>
+#include "dbconfig/ob_proxy_pb_utils.h"
+#include "dbconfig/ob_proxy_db_config_info.h"
+#include "opsql/func_expr_resolver/proxy_expr/ob_proxy_expr.h"
+#include "opsql/func_expr_resolver/proxy_expr/ob_proxy_compiled_expr.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+using namespace common;
+using namespace obutils;
+using namespace dbconfig;
+using namespace opsql;
+
+// tb rules as they are configured in sharding json
+static const char *TEST_RULES[] = {
+  "[\"Integer.valueOf(#user_id#)\"]",
+  "[\"Integer.valueOf(String.valueOf(#user_id#).getAt(-2..-1))\"]",
+  "[\"hash(substr(#user_id#, 3, 2), 10)\"]",
+  "[\"toint(substr(#user_id#, -2))\"]",
+  "[\"hash(toint(substr(user_id, 1, 4)), 16)\"]",
+  "[\"div(toint(substr(user_id, 1, 8)), 100)\"]",
+  "[\"div(hash(user_id), 2)\"]",
+};
+
+static const char *TEST_VALUES[] = {
+  "12345678", "00000099", "1", "98", "abcdefgh", "12ab", "", "-12", "123456789012345678901234567890123",
+};
+
+class TestProxyCompiledExpr : public ::testing::Test
+{
+public:
+  virtual void SetUp() { }
+  virtual void TearDown() { }
+
+  void parse_rules(const char *json, ObProxyShardRuleList &rules)
+  {
+    rules.reset();
+    ASSERT_EQ(OB_SUCCESS, ObProxyPbUtils::parse_json_rules(std::string(json), rules, allocator_));
+    ASSERT_EQ(1, rules.count());
+    ASSERT_TRUE(NULL != rules.at(0).expr_);
+  }
+
+  void build_str_field(const char *column, const char *value, SqlFieldResult &sql_result)
+  {
+    const char *values[] = { value };
+    build_str_field(column, values, 1, sql_result);
+  }
+
+  void build_str_field(const char *column, const char **values, const int64_t count, SqlFieldResult &sql_result)
+  {
+    SqlField field;
+    field.column_name_.set(ObString::make_string(column));
+    for (int64_t i = 0; i < count; i++) {
+      SqlColumnValue column_value;
+      column_value.value_type_ = TOKEN_STR_VAL;
+      column_value.column_value_.set(ObString::make_string(values[i]));
+      field.column_values_.push_back(column_value);
+    }
+    sql_result.reset();
+    sql_result.fields_.push_back(field);
+    sql_result.field_num_ = 1;
+  }
+
+  void build_int_field(const char *column, const int64_t value, SqlFieldResult &sql_result)
+  {
+    SqlField field;
+    SqlColumnValue column_value;
+    field.column_name_.set(ObString::make_string(column));
+    column_value.value_type_ = TOKEN_INT_VAL;
+    column_value.column_int_value_ = value;
+    field.column_values_.push_back(column_value);
+    sql_result.reset();
+    sql_result.fields_.push_back(field);
+    sql_result.field_num_ = 1;
+  }
+
+  // the test load handling changes the column value, so every calc gets its own sql_result
+  void check_same_result(const ObProxyShardRuleInfo &rule, const SqlFieldResult &src_result,
+                         const ObTestLoadType type, const bool is_elastic_index)
+  {
+    ObArenaAllocator allocator;
+    ObProxyExprCtx ctx(64, type, is_elastic_index, &allocator);
+    SqlFieldResult expr_sql_result;
+    SqlFieldResult compiled_sql_result;
+    ObSEArray<ObObj, 4> expr_result;
+    ObSEArray<ObObj, 4> compiled_result;
+    expr_sql_result.fields_.assign(src_result.fields_);
+    expr_sql_result.field_num_ = src_result.field_num_;
+    compiled_sql_result.fields_.assign(src_result.fields_);
+    compiled_sql_result.field_num_ = src_result.field_num_;
+
+    ObProxyExprCalcItem calc_item(&expr_sql_result);
+    const int expr_ret = rule.expr_->calc(ctx, calc_item, expr_result);
+    const int compiled_ret = rule.compiled_expr_.calc(ctx, compiled_sql_result, compiled_result);
+    ASSERT_EQ(expr_ret, compiled_ret) << to_cstring(rule);
+    if (OB_SUCCESS == expr_ret) {
+      ASSERT_EQ(expr_result.count(), compiled_result.count());
+      for (int64_t i = 0; i < expr_result.count(); i++) {
+        ASSERT_TRUE(expr_result.at(i) == compiled_result.at(i))
+            << to_cstring(expr_result.at(i)) << " " << to_cstring(compiled_result.at(i));
+      }
+    }
+  }
+
+  void check_all_values(const ObProxyShardRuleInfo &rule)
+  {
+    const ObTestLoadType types[] = { TESTLOAD_NON, TESTLOAD_ALIPAY };
+    SqlFieldResult sql_result;
+    for (int64_t t = 0; t < 2; t++) {
+      for (int64_t e = 0; e < 2; e++) {
+        for (int64_t i = 0; i < static_cast<int64_t>(ARRAYSIZEOF(TEST_VALUES)); i++) {
+          build_str_field("user_id", TEST_VALUES[i], sql_result);
+          check_same_result(rule, sql_result, types[t], 1 == e);
+        }
+        build_str_field("USER_ID", TEST_VALUES, ARRAYSIZEOF(TEST_VALUES), sql_result);
+        check_same_result(rule, sql_result, types[t], 1 == e);
+        build_str_field("USER_ID", TEST_VALUES, 2, sql_result);
+        check_same_result(rule, sql_result, types[t], 1 == e);
+        build_int_field("user_id", 12345678, sql_result);
+        check_same_result(rule, sql_result, types[t], 1 == e);
+        build_int_field("user_id", -7, sql_result);
+        check_same_result(rule, sql_result, types[t], 1 == e);
+        build_str_field("order_id", "12345678", sql_result);
+        check_same_result(rule, sql_result, types[t], 1 == e);
+      }
+    }
+  }
+
+public:
+  ObArenaAllocator allocator_;
+};
+
+TEST_F(TestProxyCompiledExpr, compile)
+{
+  ObProxyShardRuleList rules;
+  for (int64_t i = 0; i < static_cast<int64_t>(ARRAYSIZEOF(TEST_RULES)); i++) {
+    parse_rules(TEST_RULES[i], rules);
+    ASSERT_TRUE(rules.at(0).compiled_expr_.is_valid()) << TEST_RULES[i];
+  }
+
+  parse_rules("[\"hash(substr(user_id, 1, 2), 10)\"]", rules);
+  ASSERT_EQ(2, rules.at(0).compiled_expr_.op_count_);
+  ASSERT_EQ(OB_PROXY_COMPILED_OP_SUBSTR, rules.at(0).compiled_expr_.ops_[0].type_);
+  ASSERT_EQ(1, rules.at(0).compiled_expr_.ops_[0].arg1_);
+  ASSERT_EQ(2, rules.at(0).compiled_expr_.ops_[0].arg2_);
+  ASSERT_EQ(OB_PROXY_COMPILED_OP_HASH, rules.at(0).compiled_expr_.ops_[1].type_);
+  ASSERT_EQ(10, rules.at(0).compiled_expr_.ops_[1].arg1_);
+
+  // calculated by proxy expr
+  parse_rules("[\"hash(concat(substr(user_id, 1, 2), '1'))\"]", rules);
+  ASSERT_FALSE(rules.at(0).compiled_expr_.is_valid());
+  parse_rules("[\"div(user_id, 100)\"]", rules);
+  ASSERT_FALSE(rules.at(0).compiled_expr_.is_valid());
+  parse_rules("[\"hash(user_id, 0)\"]", rules);
+  ASSERT_TRUE(rules.at(0).compiled_expr_.is_valid());
+  parse_rules("[\"div(toint(user_id), 0)\"]", rules);
+  ASSERT_FALSE(rules.at(0).compiled_expr_.is_valid());
+  parse_rules("[\"hash(substr(user_id, 1, 0))\"]", rules);
+  ASSERT_FALSE(rules.at(0).compiled_expr_.is_valid());
+}
+
+TEST_F(TestProxyCompiledExpr, same_as_proxy_expr)
+{
+  ObProxyShardRuleList rules;
+  ObProxyShardRuleList expr_rules;
+  SqlFieldResult sql_result;
+  build_str_field("user_id", "2088123456789012", sql_result);
+  for (int64_t i = 0; i < static_cast<int64_t>(ARRAYSIZEOF(TEST_RULES)); i++) {
+    parse_rules(TEST_RULES[i], rules);
+    check_all_values(rules.at(0));
+
+    // the whole get_physic_index path, with and without the compiled expr
+    ASSERT_EQ(OB_SUCCESS, expr_rules.assign(rules));
+    expr_rules.at(0).compiled_expr_.reset();
+    int64_t compiled_index = OBPROXY_MAX_DBMESH_ID;
+    int64_t expr_index = OBPROXY_MAX_DBMESH_ID;
+    const int compiled_ret = ObShardRule::get_physic_index(sql_result, rules, 1024, TESTLOAD_NON, compiled_index);
+    const int expr_ret = ObShardRule::get_physic_index(sql_result, expr_rules, 1024, TESTLOAD_NON, expr_index);
+    ASSERT_EQ(expr_ret, compiled_ret) << TEST_RULES[i];
+    ASSERT_EQ(expr_index, compiled_index) << TEST_RULES[i];
+  }
+  parse_rules("[\"hash(user_id, 0)\"]", rules);
+  check_all_values(rules.at(0));
+}
+
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  oceanbase::common::ObLogger::get_logger().set_log_level("ERROR");
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
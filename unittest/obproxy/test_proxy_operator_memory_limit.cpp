@@ -0,0 +1,222 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include <string>
+#include "lib/charset/ob_mysql_global.h"
+#include "engine/ob_proxy_operator_table_scan.h"
+#include "executor/ob_proxy_parallel_execute_cont.h"
+#include "proxy/client/ob_client_utils.h"
+#include "obutils/ob_proxy_config.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace engine
+{
+using namespace common;
+using namespace obutils;
+using namespace proxy;
+using namespace executor;
+
+static const int64_t TEST_MEMORY_LIMIT = 1 << 20;
+static const int64_t TEST_ROW_COUNT = 1000;
+static const int64_t TEST_VALUE_LEN = 200;
+static const int64_t TEST_MAX_RESP_COUNT = 100;
+
+class TestProxyOperatorMemoryLimit : public ::testing::Test
+{
+public:
+  TestProxyOperatorMemoryLimit() : allocator_(ObModIds::TEST) {}
+
+  virtual void SetUp()
+  {
+    ASSERT_TRUE(get_global_proxy_config().sharding_plan_memory_limit.set_value("1MB"));
+    ASSERT_EQ(TEST_MEMORY_LIMIT, get_global_proxy_config().sharding_plan_memory_limit.get());
+  }
+
+  virtual void TearDown()
+  {
+    ASSERT_TRUE(get_global_proxy_config().sharding_plan_memory_limit.set_value("0"));
+  }
+
+  // shard rows are allocated from the plan allocator as they arrive
+  void add_shard_rows(const int64_t size)
+  {
+    const int64_t row_size = 1024;
+    for (int64_t i = 0; i < size / row_size; i++) {
+      ASSERT_TRUE(NULL != allocator_.alloc(row_size));
+    }
+  }
+
+  static void write_packet(ObClientMysqlResp &resp, const char *body, const int64_t body_len,
+                           uint8_t &seq)
+  {
+    char header[MYSQL_NET_HEADER_LENGTH];
+    int64_t written_len = 0;
+    ob_int3store(header, body_len);
+    header[3] = static_cast<char>(seq++);
+    ASSERT_EQ(OB_SUCCESS, resp.get_resp_miobuf()->write(header, MYSQL_NET_HEADER_LENGTH, written_len));
+    ASSERT_EQ(OB_SUCCESS, resp.get_resp_miobuf()->write(body, body_len, written_len));
+  }
+
+  // resultset of one shard: one varchar column, TEST_ROW_COUNT rows
+  void build_shard_resp(ObProxyParallelResp *&pres)
+  {
+    uint8_t seq = 1;
+    const char column_count[] = {0x01};
+    const char column_def[] = {0x03, 'd', 'e', 'f', 0x04, 't', 'e', 's', 't', 0x02, 't', '1',
+                               0x02, 't', '1', 0x02, 'c', '1', 0x02, 'c', '1', 0x0c, 0x21, 0x00,
+                               static_cast<char>(0x80), 0x01, 0x00, 0x00, static_cast<char>(0xfd),
+                               0x00, 0x00, 0x00, 0x00, 0x00};
+    const char eof[] = {static_cast<char>(0xfe), 0x00, 0x00, 0x02, 0x00};
+    char row[TEST_VALUE_LEN + 1];
+    row[0] = static_cast<char>(TEST_VALUE_LEN);
+    MEMSET(row + 1, 'a', TEST_VALUE_LEN);
+
+    ObClientMysqlResp *resp = op_alloc(ObClientMysqlResp);
+    ASSERT_TRUE(NULL != resp);
+    ASSERT_EQ(OB_SUCCESS, resp->init());
+    write_packet(*resp, column_count, sizeof(column_count), seq);
+    write_packet(*resp, column_def, sizeof(column_def), seq);
+    write_packet(*resp, eof, sizeof(eof), seq);
+    for (int64_t i = 0; i < TEST_ROW_COUNT; i++) {
+      write_packet(*resp, row, sizeof(row), seq);
+    }
+    write_packet(*resp, eof, sizeof(eof), seq);
+    ASSERT_EQ(OB_SUCCESS, resp->analyze_resp(obmysql::OB_MYSQL_COM_QUERY));
+    ASSERT_TRUE(resp->is_resultset_resp());
+
+    pres = op_alloc_args(ObProxyParallelResp, 0);
+    ASSERT_TRUE(NULL != pres);
+    ASSERT_EQ(OB_SUCCESS, pres->init(resp, &allocator_));
+    ASSERT_EQ(1, pres->get_column_count());
+  }
+
+  // feed shard responses to table scan until it fails the query
+  void handle_shard_resps(ObProxyTableScanOp &op, int64_t &resp_count, ObProxyResultResp *&result)
+  {
+    resp_count = 0;
+    result = NULL;
+    for (; resp_count < TEST_MAX_RESP_COUNT && (NULL == result || !result->is_error_resp());
+         resp_count++) {
+      ObProxyParallelResp *pres = NULL;
+      build_shard_resp(pres);
+      result = NULL;
+      // pres is freed by table scan
+      ASSERT_EQ(OB_SUCCESS, op.handle_result(pres, false, result));
+      ASSERT_TRUE(NULL != result);
+    }
+  }
+
+public:
+  ObArenaAllocator allocator_;
+};
+
+TEST_F(TestProxyOperatorMemoryLimit, below_limit)
+{
+  ObProxyTableScanOp op(NULL, allocator_);
+  ObProxyResultResp *result = NULL;
+  add_shard_rows(TEST_MEMORY_LIMIT / 2);
+  ASSERT_FALSE(op.is_exceed_memory_limit());
+  ASSERT_EQ(OB_SUCCESS, op.check_memory_limit(result));
+  ASSERT_TRUE(NULL == result);
+}
+
+TEST_F(TestProxyOperatorMemoryLimit, exceed_limit)
+{
+  ObProxyTableScanOp op(NULL, allocator_);
+  ObProxyResultResp *result = NULL;
+  add_shard_rows(TEST_MEMORY_LIMIT / 2);
+  ASSERT_FALSE(op.is_exceed_memory_limit());
+  add_shard_rows(TEST_MEMORY_LIMIT);
+  ASSERT_GT(allocator_.total(), TEST_MEMORY_LIMIT);
+  ASSERT_TRUE(op.is_exceed_memory_limit());
+
+  // the query fails with an error packet instead of holding more rows
+  ASSERT_EQ(OB_SUCCESS, op.check_memory_limit(result));
+  ASSERT_TRUE(NULL != result);
+  ASSERT_TRUE(result->is_error_resp());
+  ASSERT_EQ(static_cast<uint16_t>(-OB_EXCEED_MEM_LIMIT), result->get_err_code());
+}
+
+TEST_F(TestProxyOperatorMemoryLimit, shard_rows_exceed_limit)
+{
+  ObProxyTableScanOp op(NULL, allocator_);
+  ObProxyResultResp *result = NULL;
+  ObProxyParallelResp *pres = NULL;
+
+  // one shard response fits, its rows go on to the upper operator
+  build_shard_resp(pres);
+  ASSERT_EQ(OB_SUCCESS, op.handle_result(pres, false, result));
+  ASSERT_TRUE(NULL != result);
+  ASSERT_FALSE(result->is_error_resp());
+  ASSERT_TRUE(result->is_resultset_resp());
+  ASSERT_LT(allocator_.total(), TEST_MEMORY_LIMIT);
+
+  // more shard responses push the plan memory over the limit
+  int64_t resp_count = 0;
+  handle_shard_resps(op, resp_count, result);
+  ASSERT_LT(resp_count, TEST_MAX_RESP_COUNT);
+  ASSERT_GT(resp_count, 1);
+  ASSERT_TRUE(NULL != result);
+  ASSERT_TRUE(result->is_error_resp());
+  ASSERT_GT(allocator_.total(), TEST_MEMORY_LIMIT);
+  ASSERT_EQ(static_cast<uint16_t>(-OB_EXCEED_MEM_LIMIT), result->get_err_code());
+  // the user is told which config stops the query
+  ObString err_msg = result->get_err_msg();
+  ASSERT_TRUE(NULL != strstr(std::string(err_msg.ptr(), err_msg.length()).c_str(),
+                             "sharding_plan_memory_limit(1048576)"));
+}
+
+TEST_F(TestProxyOperatorMemoryLimit, shard_rows_unlimited)
+{
+  ASSERT_TRUE(get_global_proxy_config().sharding_plan_memory_limit.set_value("0"));
+  ObProxyTableScanOp op(NULL, allocator_);
+  ObProxyResultResp *result = NULL;
+  for (int64_t i = 0; i < 10; i++) {
+    ObProxyParallelResp *pres = NULL;
+    build_shard_resp(pres);
+    ASSERT_EQ(OB_SUCCESS, op.handle_result(pres, false, result));
+    ASSERT_TRUE(NULL != result);
+    ASSERT_FALSE(result->is_error_resp());
+  }
+  ASSERT_GT(allocator_.total(), TEST_MEMORY_LIMIT);
+}
+
+TEST_F(TestProxyOperatorMemoryLimit, zero_is_unlimited)
+{
+  ObProxyTableScanOp op(NULL, allocator_);
+  ObProxyResultResp *result = NULL;
+  add_shard_rows(TEST_MEMORY_LIMIT * 2);
+  ASSERT_TRUE(op.is_exceed_memory_limit());
+
+  ASSERT_TRUE(get_global_proxy_config().sharding_plan_memory_limit.set_value("0"));
+  ASSERT_FALSE(op.is_exceed_memory_limit());
+  ASSERT_EQ(OB_SUCCESS, op.check_memory_limit(result));
+  ASSERT_TRUE(NULL == result);
+}
+
+} // end of namespace engine
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  oceanbase::common::ObLogger::get_logger().set_log_level("ERROR");
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,138 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include "lib/time/ob_time_utility.h"
+#include "engine/ob_proxy_operator_table_scan.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace engine
+{
+using namespace common;
+
+static const int64_t ROW_COUNT = 100000;
+static const int64_t COLUMN_COUNT = 4;
+
+class TestProxyOperatorRowBatch : public ::testing::Test
+{
+public:
+  // the same row building as ObProxyTableScanOp::handle_response_result()
+  static int fill_row(ObIAllocator &allocator, ResultRow &row)
+  {
+    int ret = OB_SUCCESS;
+    for (int64_t i = 0; OB_SUCC(ret) && i < COLUMN_COUNT; i++) {
+      ObObj *obj = new (allocator.alloc(sizeof(ObObj))) ObObj();
+      obj->set_int(i);
+      ret = row.push_back(obj);
+    }
+    return ret;
+  }
+
+  // one ResultRow allocation per row, as before init_row() took rows from a batch
+  static int build_rows_one_by_one(ObIAllocator &allocator, ResultRows &rows)
+  {
+    int ret = OB_SUCCESS;
+    for (int64_t i = 0; OB_SUCC(ret) && i < ROW_COUNT; i++) {
+      void *buf = allocator.alloc(sizeof(ResultRow));
+      if (OB_ISNULL(buf)) {
+        ret = OB_ALLOCATE_MEMORY_FAILED;
+      } else {
+        ResultRow *row = new (buf) ResultRow(array_new_alloc_size, allocator);
+        if (OB_SUCC(fill_row(allocator, *row))) {
+          ret = rows.push_back(row);
+        }
+      }
+    }
+    return ret;
+  }
+
+  static int build_rows_by_batch(ObProxyOperator &op, ResultRows &rows)
+  {
+    int ret = OB_SUCCESS;
+    for (int64_t i = 0; OB_SUCC(ret) && i < ROW_COUNT; i++) {
+      ResultRow *row = NULL;
+      if (OB_SUCC(op.init_row(row)) && OB_SUCC(fill_row(op.allocator_, *row))) {
+        ret = rows.push_back(row);
+      }
+    }
+    return ret;
+  }
+};
+
+TEST_F(TestProxyOperatorRowBatch, init_row)
+{
+  ObArenaAllocator allocator(ObModIds::TEST);
+  ObProxyTableScanOp op(NULL, allocator);
+  ResultRows rows(array_new_alloc_size, allocator);
+  const int64_t count = ObProxyOperator::ROW_BATCH_SIZE * 2 + 1;
+  for (int64_t i = 0; i < count; i++) {
+    ResultRow *row = NULL;
+    ASSERT_EQ(OB_SUCCESS, op.init_row(row));
+    ASSERT_TRUE(NULL != row);
+    ASSERT_EQ(0, row->count());
+    ASSERT_EQ(OB_SUCCESS, fill_row(allocator, *row));
+    ASSERT_EQ(OB_SUCCESS, rows.push_back(row));
+  }
+  // rows next to each other in one batch, a new batch every ROW_BATCH_SIZE rows
+  ASSERT_EQ(rows.at(0) + 1, rows.at(1));
+  ASSERT_EQ(rows.at(0) + ObProxyOperator::ROW_BATCH_SIZE - 1,
+            rows.at(ObProxyOperator::ROW_BATCH_SIZE - 1));
+  ASSERT_EQ(1, op.row_batch_pos_);
+  ASSERT_EQ(rows.at(count - 1), op.row_batch_);
+  for (int64_t i = 0; i < count; i++) {
+    ASSERT_EQ(COLUMN_COUNT, rows.at(i)->count());
+    for (int64_t j = 0; j < COLUMN_COUNT; j++) {
+      ASSERT_EQ(j, rows.at(i)->at(j)->get_int());
+    }
+  }
+}
+
+TEST_F(TestProxyOperatorRowBatch, performance)
+{
+  ObArenaAllocator one_allocator(ObModIds::TEST);
+  ObArenaAllocator batch_allocator(ObModIds::TEST);
+  ObProxyTableScanOp op(NULL, batch_allocator);
+  ResultRows one_rows(array_new_alloc_size, one_allocator);
+  ResultRows batch_rows(array_new_alloc_size, batch_allocator);
+
+  int64_t t0 = ObTimeUtility::current_time();
+  ASSERT_EQ(OB_SUCCESS, build_rows_one_by_one(one_allocator, one_rows));
+  int64_t t1 = ObTimeUtility::current_time();
+  ASSERT_EQ(OB_SUCCESS, build_rows_by_batch(op, batch_rows));
+  int64_t t2 = ObTimeUtility::current_time();
+  ASSERT_EQ(one_rows.count(), batch_rows.count());
+
+  // at most one unused batch more than one allocation per row
+  ASSERT_LE(batch_allocator.used(),
+            one_allocator.used() + static_cast<int64_t>(sizeof(ResultRow)) * ObProxyOperator::ROW_BATCH_SIZE);
+  printf("rows %ld, columns %ld\n", ROW_COUNT, COLUMN_COUNT);
+  printf("  one by one %lf (ns/row) used %ld, batch %lf (ns/row) used %ld\n",
+         (double)(t1 - t0) * 1000 / (double)ROW_COUNT, one_allocator.used(),
+         (double)(t2 - t1) * 1000 / (double)ROW_COUNT, batch_allocator.used());
+}
+
+} // end of namespace engine
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  oceanbase::common::ObLogger::get_logger().set_log_level("ERROR");
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
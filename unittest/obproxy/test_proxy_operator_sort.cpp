@@ -0,0 +1,177 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include "engine/ob_proxy_operator_sort.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace engine
+{
+using namespace common;
+
+static const int64_t SHARD_COUNT = 16;
+static const int64_t ROWS_PER_SHARD = 200;
+
+class TestProxyOperatorSort : public ::testing::Test
+{
+public:
+  TestProxyOperatorSort() : allocator_(ObModIds::TEST) {}
+
+  ResultRow *new_row(const int64_t value)
+  {
+    ResultRow *row = new (allocator_.alloc(sizeof(ResultRow))) ResultRow(array_new_alloc_size, allocator_);
+    ObObj *obj = new (allocator_.alloc(sizeof(ObObj))) ObObj();
+    obj->set_int(value);
+    EXPECT_EQ(OB_SUCCESS, row->push_back(obj));
+    return row;
+  }
+
+  // every shard returns its rows ordered by the pushed down ORDER BY,
+  // the last shard is unsorted like the output of hash agg
+  void build_shards(const bool is_asc, std::vector<std::vector<int64_t> > &shards)
+  {
+    srand(20211018);
+    shards.resize(SHARD_COUNT);
+    for (int64_t i = 0; i < SHARD_COUNT; i++) {
+      for (int64_t j = 0; j < ROWS_PER_SHARD; j++) {
+        // small value range, so that there are many duplicates across shards
+        shards[i].push_back(rand() % 1000);
+      }
+      if (i != SHARD_COUNT - 1) {
+        if (is_asc) {
+          std::sort(shards[i].begin(), shards[i].end());
+        } else {
+          std::sort(shards[i].begin(), shards[i].end(), std::greater<int64_t>());
+        }
+      }
+    }
+  }
+
+  void check_merge_sort(const bool is_asc, const int64_t topn)
+  {
+    std::vector<std::vector<int64_t> > shards;
+    std::vector<int64_t> expected;
+    build_shards(is_asc, shards);
+    for (int64_t i = 0; i < SHARD_COUNT; i++) {
+      expected.insert(expected.end(), shards[i].begin(), shards[i].end());
+    }
+    if (is_asc) {
+      std::sort(expected.begin(), expected.end());
+    } else {
+      std::sort(expected.begin(), expected.end(), std::greater<int64_t>());
+    }
+    if (topn > 0 && topn < static_cast<int64_t>(expected.size())) {
+      expected.resize(topn);
+    }
+
+    SortColumnArray sort_columns(array_new_alloc_size, allocator_);
+    ObSortColumn sort_column(0, CS_TYPE_BINARY, is_asc);
+    ASSERT_EQ(OB_SUCCESS, sort_columns.push_back(&sort_column));
+    ResultRows sort_rows(array_new_alloc_size, allocator_);
+    ObMergeSort sort(sort_columns, allocator_, sort_rows);
+    sort.set_topn_cnt(topn);
+
+    for (int64_t i = 0; i < SHARD_COUNT; i++) {
+      for (int64_t j = 0; j < ROWS_PER_SHARD; j++) {
+        ASSERT_EQ(OB_SUCCESS, sort.add_row(new_row(shards[i][j])));
+      }
+      ASSERT_EQ(OB_SUCCESS, sort.finish_run());
+      if (topn > 0) {
+        // merged as each shard arrives, the rows to merge do not grow with shards
+        ASSERT_LE(sort.sort_rows_.count(), std::max(topn, ROWS_PER_SHARD) + ROWS_PER_SHARD);
+      }
+    }
+    ASSERT_EQ(OB_SUCCESS, sort.sort_rows());
+
+    ResultRows result(array_new_alloc_size, allocator_);
+    ASSERT_EQ(OB_SUCCESS, sort.fetch_final_results(result));
+    ASSERT_EQ(static_cast<int64_t>(expected.size()), result.count());
+    for (int64_t i = 0; i < result.count(); i++) {
+      ASSERT_EQ(expected[i], result.at(i)->at(0)->get_int());
+    }
+  }
+
+public:
+  ObArenaAllocator allocator_;
+};
+
+TEST_F(TestProxyOperatorSort, merge_sort_full)
+{
+  check_merge_sort(true, 0);
+  check_merge_sort(false, 0);
+}
+
+TEST_F(TestProxyOperatorSort, merge_sort_topn)
+{
+  check_merge_sort(true, 1);
+  check_merge_sort(true, 10);
+  check_merge_sort(false, 10);
+  // more than one shard returns
+  check_merge_sort(true, ROWS_PER_SHARD * 3 + 7);
+  check_merge_sort(false, ROWS_PER_SHARD * 3 + 7);
+  // more than all rows
+  check_merge_sort(true, SHARD_COUNT * ROWS_PER_SHARD + 1);
+}
+
+TEST_F(TestProxyOperatorSort, merge_sort_equals_memory_sort)
+{
+  std::vector<std::vector<int64_t> > shards;
+  build_shards(true, shards);
+  SortColumnArray sort_columns(array_new_alloc_size, allocator_);
+  ObSortColumn sort_column(0, CS_TYPE_BINARY, true);
+  ASSERT_EQ(OB_SUCCESS, sort_columns.push_back(&sort_column));
+  ResultRows merge_rows(array_new_alloc_size, allocator_);
+  ResultRows memory_rows(array_new_alloc_size, allocator_);
+  ObMergeSort merge_sort(sort_columns, allocator_, merge_rows);
+  ObMemorySort memory_sort(sort_columns, allocator_, memory_rows);
+
+  for (int64_t i = 0; i < SHARD_COUNT; i++) {
+    for (int64_t j = 0; j < ROWS_PER_SHARD; j++) {
+      ResultRow *row = new_row(shards[i][j]);
+      ASSERT_EQ(OB_SUCCESS, merge_sort.add_row(row));
+      ASSERT_EQ(OB_SUCCESS, memory_sort.add_row(row));
+    }
+    ASSERT_EQ(OB_SUCCESS, merge_sort.finish_run());
+  }
+  ASSERT_EQ(SHARD_COUNT, merge_sort.get_run_count());
+  ASSERT_EQ(OB_SUCCESS, merge_sort.sort_rows());
+  ASSERT_EQ(OB_SUCCESS, memory_sort.sort_rows());
+
+  ResultRows merge_result(array_new_alloc_size, allocator_);
+  ResultRows memory_result(array_new_alloc_size, allocator_);
+  ASSERT_EQ(OB_SUCCESS, merge_sort.fetch_final_results(merge_result));
+  ASSERT_EQ(OB_SUCCESS, memory_sort.fetch_final_results(memory_result));
+  ASSERT_EQ(memory_result.count(), merge_result.count());
+  for (int64_t i = 0; i < merge_result.count(); i++) {
+    ASSERT_EQ(memory_result.at(i)->at(0)->get_int(), merge_result.at(i)->at(0)->get_int());
+  }
+}
+
+} // end of namespace engine
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  oceanbase::common::ObLogger::get_logger().set_log_level("ERROR");
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
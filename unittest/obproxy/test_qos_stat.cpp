@@ -0,0 +1,229 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include "lib/oblog/ob_log.h"
+#include "lib/time/ob_time_utility.h"
+#include "qos/ob_proxy_qos_stat_info.h"
+#include "qos/ob_proxy_qos_action.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace qos
+{
+using namespace common;
+
+static const int64_t THREAD_COUNT = 8;
+static const int64_t STAT_COUNT_PER_THREAD = 100000;
+static const int64_t STAT_COST = 3;
+
+struct TestStatArg
+{
+  ObProxyQosStatNode *node_;
+  int64_t *word_;
+  int64_t time_sec_;
+};
+
+struct TestLimitArg
+{
+  ObProxyQosActionLimit *limit_;
+  int64_t run_us_;
+  int64_t pass_count_;
+};
+
+void *store_stat_thread(void *data)
+{
+  TestStatArg *arg = static_cast<TestStatArg *>(data);
+  for (int64_t i = 0; i < STAT_COUNT_PER_THREAD; ++i) {
+    (void)arg->node_->store_stat(STAT_COST);
+  }
+  return NULL;
+}
+
+// the first half is written to time_sec, the second half to time_sec + 1
+void *add_stat_thread(void *data)
+{
+  TestStatArg *arg = static_cast<TestStatArg *>(data);
+  for (int64_t i = 0; i < STAT_COUNT_PER_THREAD; ++i) {
+    const int64_t time_sec = arg->time_sec_ + (i < STAT_COUNT_PER_THREAD / 2 ? 0 : 1);
+    (void)ObProxyQosStatNode::add_stat(*arg->word_, time_sec, 1);
+  }
+  return NULL;
+}
+
+void *limit_thread(void *data)
+{
+  TestLimitArg *arg = static_cast<TestLimitArg *>(data);
+  const int64_t end_us = ObTimeUtility::current_time() + arg->run_us_;
+  bool is_pass = false;
+  while (ObTimeUtility::current_time() < end_us) {
+    if (OB_SUCCESS == arg->limit_->calc(is_pass) && is_pass) {
+      ++arg->pass_count_;
+    }
+  }
+  return NULL;
+}
+
+class TestQosStat : public ::testing::Test
+{
+public:
+  // passed requests of all threads, and the time they ran
+  int64_t run_limit(ObProxyQosActionLimit &limit, const int64_t run_us, int64_t &elapsed_us)
+  {
+    pthread_t threads[THREAD_COUNT];
+    TestLimitArg args[THREAD_COUNT];
+    int64_t pass_count = 0;
+    const int64_t start_us = ObTimeUtility::current_time();
+    for (int64_t i = 0; i < THREAD_COUNT; ++i) {
+      args[i].limit_ = &limit;
+      args[i].run_us_ = run_us;
+      args[i].pass_count_ = 0;
+      EXPECT_EQ(0, pthread_create(&threads[i], NULL, limit_thread, &args[i]));
+    }
+    for (int64_t i = 0; i < THREAD_COUNT; ++i) {
+      pthread_join(threads[i], NULL);
+      pass_count += args[i].pass_count_;
+    }
+    elapsed_us = ObTimeUtility::current_time() - start_us;
+    return pass_count;
+  }
+};
+
+TEST_F(TestQosStat, add_stat)
+{
+  int64_t word = 0;
+  ASSERT_TRUE(ObProxyQosStatNode::add_stat(word, 100, 5));
+  ASSERT_TRUE(ObProxyQosStatNode::add_stat(word, 100, 3));
+  ASSERT_EQ(0, ObProxyQosStatNode::diff_stat_sec(100, word));
+  ASSERT_EQ(8, word & QOS_STAT_VALUE_MASK);
+
+  // a passed second is dropped
+  ASSERT_FALSE(ObProxyQosStatNode::add_stat(word, 99, 1));
+  ASSERT_EQ(8, word & QOS_STAT_VALUE_MASK);
+
+  // a new second takes the slot over
+  ASSERT_TRUE(ObProxyQosStatNode::add_stat(word, 100 + QOS_STAT_VALUE_COUNT, 1));
+  ASSERT_EQ(1, word & QOS_STAT_VALUE_MASK);
+  ASSERT_EQ(-QOS_STAT_VALUE_COUNT, ObProxyQosStatNode::diff_stat_sec(100, word));
+
+  // the second wraps around
+  const int64_t wrap_sec = 1LL << QOS_STAT_SEC_BITS;
+  word = 0;
+  ASSERT_TRUE(ObProxyQosStatNode::add_stat(word, wrap_sec - 1, 1));
+  ASSERT_EQ(2, ObProxyQosStatNode::diff_stat_sec(wrap_sec + 1, word));
+  ASSERT_TRUE(ObProxyQosStatNode::add_stat(word, wrap_sec + 1, 1));
+  ASSERT_FALSE(ObProxyQosStatNode::add_stat(word, wrap_sec - 1, 1));
+  ASSERT_EQ(1, word & QOS_STAT_VALUE_MASK);
+}
+
+TEST_F(TestQosStat, concurrent_take_over)
+{
+  // all threads write the same word across a second, none of the adds of the
+  // new second may be lost, none of the old second may leak into it
+  int64_t word = 0;
+  pthread_t threads[THREAD_COUNT];
+  TestStatArg args[THREAD_COUNT];
+  for (int64_t i = 0; i < THREAD_COUNT; ++i) {
+    args[i].node_ = NULL;
+    args[i].word_ = &word;
+    args[i].time_sec_ = 1000;
+    ASSERT_EQ(0, pthread_create(&threads[i], NULL, add_stat_thread, &args[i]));
+  }
+  for (int64_t i = 0; i < THREAD_COUNT; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+  ASSERT_EQ(0, ObProxyQosStatNode::diff_stat_sec(1001, word));
+  ASSERT_EQ(THREAD_COUNT * STAT_COUNT_PER_THREAD / 2, word & QOS_STAT_VALUE_MASK);
+}
+
+TEST_F(TestQosStat, concurrent_store_stat)
+{
+  ObProxyQosStatNode node(QOS_NODE_TYPE_LEAF);
+  pthread_t threads[THREAD_COUNT];
+  TestStatArg args[THREAD_COUNT];
+  const int64_t start_sec = hrtime_to_sec(get_hrtime_internal());
+  for (int64_t i = 0; i < THREAD_COUNT; ++i) {
+    args[i].node_ = &node;
+    args[i].word_ = NULL;
+    args[i].time_sec_ = 0;
+    ASSERT_EQ(0, pthread_create(&threads[i], NULL, store_stat_thread, &args[i]));
+  }
+  for (int64_t i = 0; i < THREAD_COUNT; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+  const int64_t end_sec = hrtime_to_sec(get_hrtime_internal());
+  ASSERT_LT(end_sec - start_sec, QOS_STAT_VALUE_COUNT);
+
+  int64_t total_count = 0;
+  int64_t total_cost = 0;
+  int64_t count = 0;
+  int64_t cost = 0;
+  for (int64_t sec = start_sec; sec <= end_sec; ++sec) {
+    node.get_stat(sec, count, cost);
+    total_count += count;
+    total_cost += cost;
+  }
+  ASSERT_EQ(THREAD_COUNT * STAT_COUNT_PER_THREAD, total_count);
+  ASSERT_EQ(THREAD_COUNT * STAT_COUNT_PER_THREAD * STAT_COST, total_cost);
+}
+
+TEST_F(TestQosStat, limit_zero)
+{
+  ObProxyQosActionLimit limit;
+  bool is_pass = true;
+  limit.set_limit_qps(0);
+  ASSERT_EQ(OB_SUCCESS, limit.calc(is_pass));
+  ASSERT_FALSE(is_pass);
+}
+
+TEST_F(TestQosStat, limit_overshoot)
+{
+  const int64_t limit_qps = 1000;
+  int64_t elapsed_us = 0;
+  ObProxyQosActionLimit limit;
+  limit.set_limit_qps(limit_qps);
+  const int64_t pass_count = run_limit(limit, 500 * 1000, elapsed_us);
+  // one second of tokens at start, and the tokens refilled while running,
+  // tokens borrowed by the shards of other threads are never passed twice
+  const int64_t max_pass_count = limit_qps + limit_qps * elapsed_us / 1000000 + 1;
+  printf("limit %ld qps, %ld threads, passed %ld in %ld us, max %ld\n",
+         limit_qps, THREAD_COUNT, pass_count, elapsed_us, max_pass_count);
+  ASSERT_LE(pass_count, max_pass_count);
+  ASSERT_GE(pass_count, limit_qps);
+}
+
+TEST_F(TestQosStat, limit_low_qps)
+{
+  int64_t elapsed_us = 0;
+  ObProxyQosActionLimit limit;
+  limit.set_limit_qps(1);
+  // the batch is one token, only one request passes in one second
+  const int64_t pass_count = run_limit(limit, 200 * 1000, elapsed_us);
+  ASSERT_EQ(1, pass_count);
+}
+
+} // end of namespace qos
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  oceanbase::common::ObLogger::get_logger().set_log_level("ERROR");
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,183 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include "proxy/mysql/ob_result_cache.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+using namespace common;
+using namespace proxy;
+
+class TestResultCache : public ::testing::Test
+{
+public:
+  virtual void SetUp() { }
+  virtual void TearDown() { }
+
+  bool is_cacheable(const char *sql) { return ObResultCache::is_cacheable_sql(ObString::make_string(sql)); }
+  bool is_multi_table(const char *sql) { return ObResultCache::is_multi_table_write(ObString::make_string(sql)); }
+};
+
+TEST_F(TestResultCache, cacheable_sql)
+{
+  ASSERT_TRUE(is_cacheable("select c1, c2 from t1 where c1 = 1"));
+  ASSERT_TRUE(is_cacheable("SELECT * FROM db.t1 WHERE c1 IN (1, 2) ORDER BY c2 LIMIT 10"));
+  ASSERT_TRUE(is_cacheable("select count(*) from t1 group by c1, c2"));
+
+  ASSERT_FALSE(is_cacheable("select * from t1, t2 where t1.c1 = t2.c1"));
+  ASSERT_FALSE(is_cacheable("select * from t1 join t2 on t1.c1 = t2.c1"));
+  ASSERT_FALSE(is_cacheable("select * from t1 where c1 in (select c1 from t2)"));
+  ASSERT_FALSE(is_cacheable("select * from t1 union select * from t2"));
+  ASSERT_FALSE(is_cacheable("select * from t1 for update"));
+  ASSERT_FALSE(is_cacheable("select now() from t1"));
+  ASSERT_FALSE(is_cacheable("select rand() from t1"));
+  ASSERT_FALSE(is_cacheable("select @a from t1"));
+  ASSERT_FALSE(is_cacheable("select 1; select 2"));
+  ASSERT_FALSE(is_cacheable("select * from information_schema.tables"));
+  ASSERT_FALSE(is_cacheable("select * from oceanbase.__all_server"));
+  ASSERT_FALSE(is_cacheable("select * from gv$sql_audit"));
+}
+
+TEST_F(TestResultCache, deterministic_functions)
+{
+  ASSERT_TRUE(is_cacheable("select upper(c1), ifnull(c2, 0), round(c3, 2) from t1 where c1 in (1, 2)"));
+  ASSERT_TRUE(is_cacheable("select count(distinct c1), max(c2) from t1 where (c1 = 1 or c2 = 2)"));
+  ASSERT_TRUE(is_cacheable("select date_format(c1, '%Y') from t1 where c2 between (1) and (2)"));
+  // names of volatile functions which are not called
+  ASSERT_TRUE(is_cacheable("select c1 from t1 where c2 = 'now'"));
+  ASSERT_TRUE(is_cacheable("select rand from t1"));
+
+  ASSERT_FALSE(is_cacheable("select uuid() from t1"));
+  ASSERT_FALSE(is_cacheable("select NOW ( ) from t1"));
+  ASSERT_FALSE(is_cacheable("select connection_id() from t1"));
+  ASSERT_FALSE(is_cacheable("select * from t1 where c1 = last_insert_id()"));
+  ASSERT_FALSE(is_cacheable("select sleep(1) from t1"));
+  ASSERT_FALSE(is_cacheable("select * from t1 where c1 > unix_timestamp()"));
+  ASSERT_FALSE(is_cacheable("select random_bytes(8) from t1"));
+  // user defined and package functions, even if named like a builtin
+  ASSERT_FALSE(is_cacheable("select my_func(c1) from t1"));
+  ASSERT_FALSE(is_cacheable("select db.abs(c1) from t1"));
+  ASSERT_FALSE(is_cacheable("select dbms_random.value(1, 10) from dual"));
+  // volatile without a parenthesis
+  ASSERT_FALSE(is_cacheable("select current_timestamp from t1"));
+  ASSERT_FALSE(is_cacheable("select sysdate from dual"));
+  ASSERT_FALSE(is_cacheable("select seq.nextval from dual"));
+  ASSERT_FALSE(is_cacheable("select user from dual"));
+}
+
+TEST_F(TestResultCache, temporary_table_ddl)
+{
+  ASSERT_TRUE(ObResultCache::is_temporary_table_ddl(ObString::make_string("create temporary table t1 (c1 int)")));
+  ASSERT_TRUE(ObResultCache::is_temporary_table_ddl(ObString::make_string(" CREATE  TEMPORARY TABLE t1 like t2")));
+  ASSERT_TRUE(ObResultCache::is_temporary_table_ddl(
+      ObString::make_string("create global temporary table t1 (c1 int) on commit preserve rows")));
+  ASSERT_FALSE(ObResultCache::is_temporary_table_ddl(ObString::make_string("create table temporary (c1 int)")));
+  ASSERT_FALSE(ObResultCache::is_temporary_table_ddl(ObString::make_string("drop temporary table t1")));
+  ASSERT_FALSE(ObResultCache::is_temporary_table_ddl(ObString::make_string("create table t1 (c1 int)")));
+  ASSERT_FALSE(ObResultCache::is_temporary_table_ddl(ObString()));
+}
+
+TEST_F(TestResultCache, multi_table_write)
+{
+  ASSERT_FALSE(is_multi_table("update t1 set c1 = 1, c2 = 2 where c3 = 3"));
+  ASSERT_FALSE(is_multi_table("delete from t1 where c1 = 1"));
+  ASSERT_FALSE(is_multi_table("insert into t1 (c1, c2) values (1, 2), (3, 4)"));
+  ASSERT_FALSE(is_multi_table("insert into t1 select c1, c2 from t2"));
+  ASSERT_FALSE(is_multi_table("replace into t1 (c1, c2) values (1, 2)"));
+
+  ASSERT_TRUE(is_multi_table("update t1, t2 set t1.c1 = t2.c1 where t1.c2 = t2.c2"));
+  ASSERT_TRUE(is_multi_table("update t1 join t2 on t1.c1 = t2.c1 set t1.c2 = 1"));
+  ASSERT_TRUE(is_multi_table("delete t1, t2 from t1 join t2 on t1.c1 = t2.c1"));
+  ASSERT_TRUE(is_multi_table("delete from t1 using t1, t2 where t1.c1 = t2.c1"));
+  ASSERT_TRUE(is_multi_table("insert all into t1 values (1) into t2 values (2) select 1 from dual"));
+  ASSERT_TRUE(is_multi_table("merge into t1 using t2 on (t1.c1 = t2.c1) when matched then update set t1.c2 = 1"));
+}
+
+TEST_F(TestResultCache, table_slot)
+{
+  const int64_t slot = ObResultCache::get_table_slot(1, ObString::make_string("db"), ObString::make_string("t1"));
+  ASSERT_EQ(slot, ObResultCache::get_table_slot(1, ObString::make_string("DB"), ObString::make_string("T1")));
+  ASSERT_LE(0, slot);
+  ASSERT_GT(ObResultCache::TABLE_SLOT_COUNT, slot);
+}
+
+TEST_F(TestResultCache, invalidate)
+{
+  ObResultCache cache;
+  const char *data = "response";
+  const int64_t data_len = static_cast<int64_t>(strlen(data));
+  const int64_t slot = ObResultCache::get_table_slot(1, ObString::make_string("db"), ObString::make_string("t1"));
+  const int64_t other_slot = (slot + 1) % ObResultCache::TABLE_SLOT_COUNT;
+  const ObResultCacheKey key(1, ObString::make_string("select * from t1"));
+  ObResultCacheSnapshot snapshot;
+  ObResultCacheEntry *entry = NULL;
+
+  cache.take_snapshot(slot, snapshot);
+  ASSERT_EQ(OB_SUCCESS, cache.put(key, snapshot, 1000, data, data_len, 1024 * 1024));
+  ASSERT_EQ(1, cache.count());
+  ASSERT_EQ(OB_SUCCESS, cache.entry_map_.get_refactored(key, entry));
+  ASSERT_EQ(data_len, entry->data_len_);
+  ASSERT_EQ(0, MEMCMP(data, entry->data_, data_len));
+  ASSERT_FALSE(cache.is_stale(*entry, 999));
+  ASSERT_TRUE(cache.is_stale(*entry, 1000));
+
+  cache.invalidate_table(other_slot);
+  ASSERT_FALSE(cache.is_stale(*entry, 0));
+  cache.invalidate_table(slot);
+  ASSERT_TRUE(cache.is_stale(*entry, 0));
+
+  // a response sampled before the write is stale once the write is seen
+  cache.take_snapshot(slot, snapshot);
+  ASSERT_EQ(OB_SUCCESS, cache.put(key, snapshot, 1000, data, data_len, 1024 * 1024));
+  ASSERT_EQ(1, cache.count());
+  ASSERT_EQ(OB_SUCCESS, cache.entry_map_.get_refactored(key, entry));
+  ASSERT_FALSE(cache.is_stale(*entry, 0));
+  cache.invalidate_all();
+  ASSERT_TRUE(cache.is_stale(*entry, 0));
+
+  // the entry does not fit in memory limit
+  ASSERT_EQ(OB_SIZE_OVERFLOW, cache.put(key, snapshot, 1000, data, data_len, data_len));
+  cache.destroy();
+  ASSERT_EQ(0, cache.count());
+  ASSERT_EQ(0, cache.get_mem_size());
+}
+
+TEST_F(TestResultCache, dirty_tables)
+{
+  ObResultCacheDirtyTables dirty_tables;
+  ASSERT_TRUE(dirty_tables.empty());
+  for (int64_t i = 0; i < ObResultCacheDirtyTables::MAX_TABLE_COUNT; ++i) {
+    dirty_tables.add(i);
+  }
+  ASSERT_FALSE(dirty_tables.is_overflow_);
+  dirty_tables.add(ObResultCacheDirtyTables::MAX_TABLE_COUNT);
+  ASSERT_TRUE(dirty_tables.is_overflow_);
+
+  const int64_t epoch = ATOMIC_LOAD(&get_global_result_cache().epoch_);
+  dirty_tables.invalidate();
+  ASSERT_EQ(epoch + 1, ATOMIC_LOAD(&get_global_result_cache().epoch_));
+  ASSERT_TRUE(dirty_tables.empty());
+}
+
+}
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
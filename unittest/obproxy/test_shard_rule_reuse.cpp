@@ -0,0 +1,105 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define private public
+#define protected public
+#define USING_LOG_PREFIX PROXY
+#include <gtest/gtest.h>
+#include "dbconfig/ob_proxy_pb_utils.h"
+#include "dbconfig/ob_proxy_db_config_info.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+using namespace common;
+using namespace dbconfig;
+
+static const char *TB_RULES = "[\"hash(substr(#user_id#, -2), 10)\", \"toint(substr(user_id, 1, 2))\"]";
+static const char *TB_PATTERN = "t_user_{00-99}";
+
+class TestShardRuleReuse : public ::testing::Test
+{
+public:
+  virtual void SetUp() { }
+  virtual void TearDown() { }
+
+  void build_rule(ObShardRule &rule)
+  {
+    ASSERT_EQ(OB_SUCCESS, rule.init("T_USER"));
+    ASSERT_EQ(OB_SUCCESS, ObProxyPbUtils::parse_shard_rule("tbNamePattern", TB_PATTERN, rule));
+    ASSERT_EQ(OB_SUCCESS, ObProxyPbUtils::parse_shard_rule("tbRules", TB_RULES, rule));
+    ASSERT_EQ(2, rule.tb_rules_.count());
+    ASSERT_TRUE(NULL != rule.arena_);
+  }
+};
+
+TEST_F(TestShardRuleReuse, assign)
+{
+  ObShardRule *rule = op_alloc(ObShardRule);
+  ObShardRule *copy = op_alloc(ObShardRule);
+  ASSERT_TRUE(NULL != rule && NULL != copy);
+  build_rule(*rule);
+  ASSERT_EQ(1, rule->arena_->ref_count_);
+
+  ASSERT_EQ(OB_SUCCESS, copy->assign(*rule));
+  ASSERT_EQ(rule->arena_, copy->arena_);
+  ASSERT_EQ(2, rule->arena_->ref_count_);
+  ASSERT_EQ(100, copy->tb_size_);
+  ASSERT_EQ(rule->tb_rules_.count(), copy->tb_rules_.count());
+  for (int64_t i = 0; i < rule->tb_rules_.count(); i++) {
+    ASSERT_EQ(rule->tb_rules_.at(i).expr_, copy->tb_rules_.at(i).expr_);
+    ASSERT_TRUE(copy->tb_rules_.at(i).compiled_expr_.is_valid());
+  }
+
+  // exprs stay valid after the rule they are parsed for is freed
+  rule->destroy();
+  ASSERT_EQ(1, copy->arena_->ref_count_);
+  ASSERT_EQ(OB_SUCCESS, ObProxyPbUtils::parse_shard_rule("dbRules", "[\"toint(user_id)\"]", *copy));
+  ASSERT_EQ(1, copy->db_rules_.count());
+  copy->destroy();
+}
+
+TEST_F(TestShardRuleReuse, same_shard_rule)
+{
+  ObShardRule *rule = op_alloc(ObShardRule);
+  ASSERT_TRUE(NULL != rule);
+  build_rule(*rule);
+
+  ASSERT_TRUE(ObProxyPbUtils::is_same_shard_rule("tbNamePattern", TB_PATTERN, *rule));
+  ASSERT_FALSE(ObProxyPbUtils::is_same_shard_rule("tbNamePattern", "t_user_{00-98}", *rule));
+  ASSERT_TRUE(ObProxyPbUtils::is_same_shard_rule("tbRules", TB_RULES, *rule));
+  ASSERT_TRUE(ObProxyPbUtils::is_same_shard_rule("dbRules", "", *rule));
+  ASSERT_TRUE(ObProxyPbUtils::is_same_shard_rule("dbRules", "null", *rule));
+  ASSERT_TRUE(ObProxyPbUtils::is_same_shard_rule("unknown", "[]", *rule));
+  ASSERT_FALSE(ObProxyPbUtils::is_same_shard_rule("dbRules", "[\"toint(user_id)\"]", *rule));
+
+  ASSERT_FALSE(ObProxyPbUtils::is_same_json_rules("[\"hash(substr(#user_id#, -2), 10)\"]", rule->tb_rules_));
+  ASSERT_FALSE(ObProxyPbUtils::is_same_json_rules(
+      "[\"hash(substr(#user_id#, -2), 10)\", \"toint(substr(user_id, 1, 3))\"]", rule->tb_rules_));
+  ASSERT_FALSE(ObProxyPbUtils::is_same_json_rules(
+      "[\"hash(substr(#user_id#, -2), 10)\", \"toint(substr(user_id, 1, 2))\", \"toint(user_id)\"]",
+      rule->tb_rules_));
+  ASSERT_FALSE(ObProxyPbUtils::is_same_json_rules("[\"hash(substr(#user_id#, -2), 10)\", 1]", rule->tb_rules_));
+  ASSERT_FALSE(ObProxyPbUtils::is_same_json_rules("not json", rule->tb_rules_));
+  rule->destroy();
+}
+
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  oceanbase::common::ObLogger::get_logger().set_log_level("ERROR");
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,244 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include "lib/string/ob_sql_string.h"
+#include "obproxy/proxy/mysqllib/ob_session_field_mgr.h"
+#include "proxy/mysql/ob_mysql_session_manager.h"
+#include "ob_session_vars_test_utils.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace proxy
+{
+using namespace common;
+
+ObDefaultSysVarSet g_default_sys_var_set;
+ObArenaAllocator g_allocator(ObModIds::TEST);
+
+class TestSharedServerSessionPool : public ::testing::Test
+{
+public:
+  static void SetUpTestCase()
+  {
+    ASSERT_EQ(OB_SUCCESS, g_default_sys_var_set.init());
+    ObSessionVarsTestUtils::load_default_system_variables(g_allocator, g_default_sys_var_set, false);
+  }
+
+  virtual void SetUp()
+  {
+    ASSERT_EQ(OB_SUCCESS, mgr1_.init());
+    ASSERT_EQ(OB_SUCCESS, mgr2_.init());
+    mgr1_.set_sys_var_set(&g_default_sys_var_set);
+    mgr2_.set_sys_var_set(&g_default_sys_var_set);
+  }
+
+  void update_sys_var(ObSessionFieldMgr &mgr, const char *name, const int64_t value)
+  {
+    ObObj obj;
+    ObSessionSysField *field = NULL;
+    obj.set_int(value);
+    ASSERT_EQ(OB_SUCCESS, mgr.update_system_variable(ObString::make_string(name), obj, field));
+  }
+
+  void replace_user_var(ObSessionFieldMgr &mgr, const char *name, const char *value)
+  {
+    ObObj obj;
+    obj.set_varchar(value);
+    ASSERT_EQ(OB_SUCCESS, mgr.replace_user_variable(ObString::make_string(name), obj));
+  }
+
+  bool is_same_identity()
+  {
+    ObSqlString identity1;
+    ObSqlString identity2;
+    EXPECT_EQ(OB_SUCCESS, mgr1_.format_shared_pool_identity(identity1));
+    EXPECT_EQ(OB_SUCCESS, mgr2_.format_shared_pool_identity(identity2));
+    return identity1.string() == identity2.string();
+  }
+
+public:
+  ObSessionFieldMgr mgr1_;
+  ObSessionFieldMgr mgr2_;
+};
+
+TEST_F(TestSharedServerSessionPool, identity_is_ordered)
+{
+  update_sys_var(mgr1_, "autocommit", 0);
+  replace_user_var(mgr1_, "a", "'x'");
+  replace_user_var(mgr1_, "b", "'y'");
+
+  replace_user_var(mgr2_, "b", "'y'");
+  replace_user_var(mgr2_, "a", "'x'");
+  update_sys_var(mgr2_, "autocommit", 0);
+  ASSERT_TRUE(is_same_identity());
+
+  ObSqlString identity;
+  ASSERT_EQ(OB_SUCCESS, mgr1_.format_shared_pool_identity(identity));
+  ASSERT_TRUE(NULL != strstr(identity.ptr(), "@@autocommit = 0,"));
+  ASSERT_TRUE(NULL != strstr(identity.ptr(), " @a = 'x', @b = 'y',"));
+}
+
+TEST_F(TestSharedServerSessionPool, identity_compares_full_value)
+{
+  // the var hash of the pool key ignores case, the identity does not
+  replace_user_var(mgr1_, "a", "'abc'");
+  replace_user_var(mgr2_, "a", "'ABC'");
+  ASSERT_FALSE(is_same_identity());
+
+  replace_user_var(mgr2_, "a", "'abc'");
+  ASSERT_TRUE(is_same_identity());
+
+  update_sys_var(mgr1_, "autocommit", 0);
+  update_sys_var(mgr2_, "autocommit", 1);
+  ASSERT_FALSE(is_same_identity());
+
+  update_sys_var(mgr2_, "autocommit", 0);
+  replace_user_var(mgr2_, "c", "'z'");
+  ASSERT_FALSE(is_same_identity());
+}
+
+TEST_F(TestSharedServerSessionPool, identity_skips_last_insert_id)
+{
+  // last_insert_id is compared by value and synced when acquire
+  update_sys_var(mgr1_, "last_insert_id", 1);
+  update_sys_var(mgr2_, "last_insert_id", 2);
+  ASSERT_TRUE(is_same_identity());
+}
+
+TEST(TestSharedServerSessionCounter, inc_dec_get)
+{
+  ObSharedServerSessionCounter *counter = new ObSharedServerSessionCounter();
+  const uint64_t hash = 100;
+  ASSERT_EQ(0, counter->get(hash));
+  ASSERT_TRUE(counter->inc(hash));
+  ASSERT_TRUE(counter->inc(hash));
+  ASSERT_EQ(2, counter->get(hash));
+  counter->dec(hash);
+  counter->dec(hash);
+  counter->dec(hash);
+  ASSERT_EQ(0, counter->get(hash));
+  counter->dec(hash + 1);
+  ASSERT_EQ(0, counter->get(hash + 1));
+
+  // the same slot, found by probing
+  const uint64_t collide_hash = hash + ObSharedServerSessionCounter::MAX_ITEM_COUNT;
+  ASSERT_TRUE(counter->inc(hash));
+  ASSERT_TRUE(counter->inc(collide_hash));
+  ASSERT_TRUE(counter->inc(collide_hash));
+  ASSERT_EQ(1, counter->get(hash));
+  ASSERT_EQ(2, counter->get(collide_hash));
+  counter->dec(hash);
+  ASSERT_EQ(0, counter->get(hash));
+  ASSERT_EQ(2, counter->get(collide_hash));
+  delete counter;
+}
+
+TEST(TestSharedServerSessionCounter, full_table)
+{
+  ObSharedServerSessionCounter *counter = new ObSharedServerSessionCounter();
+  for (int64_t i = 1; i <= ObSharedServerSessionCounter::MAX_ITEM_COUNT; ++i) {
+    ASSERT_TRUE(counter->inc(i));
+  }
+  const uint64_t new_hash = ObSharedServerSessionCounter::MAX_ITEM_COUNT + 1;
+  ASSERT_FALSE(counter->inc(new_hash));
+  ASSERT_EQ(0, counter->get(new_hash));
+
+  // an item with zero count is reused
+  counter->dec(5);
+  ASSERT_TRUE(counter->inc(new_hash));
+  ASSERT_EQ(1, counter->get(new_hash));
+  ASSERT_EQ(0, counter->get(5));
+  for (int64_t i = 6; i <= ObSharedServerSessionCounter::MAX_ITEM_COUNT; ++i) {
+    ASSERT_EQ(1, counter->get(i));
+  }
+  delete counter;
+}
+
+TEST(TestSharedServerSessionCounter, get_hash)
+{
+  sockaddr_in addr1;
+  sockaddr_in addr2;
+  MEMSET(&addr1, 0, sizeof(addr1));
+  MEMSET(&addr2, 0, sizeof(addr2));
+  addr1.sin_family = AF_INET;
+  addr1.sin_port = htons(2881);
+  addr1.sin_addr.s_addr = htonl(0x7F000001);
+  addr2 = addr1;
+  addr2.sin_port = htons(2882);
+  const ObString key = ObString::make_string("tenant:cluster:user");
+  const uint64_t hash1 = ObSharedServerSessionCounter::get_hash(key, *reinterpret_cast<sockaddr *>(&addr1));
+  const uint64_t hash2 = ObSharedServerSessionCounter::get_hash(key, *reinterpret_cast<sockaddr *>(&addr2));
+  ASSERT_NE(0, hash1);
+  ASSERT_NE(0, hash2);
+  ASSERT_NE(hash1, hash2);
+  ASSERT_EQ(hash1, ObSharedServerSessionCounter::get_hash(key, *reinterpret_cast<sockaddr *>(&addr1)));
+  ASSERT_NE(hash1, ObSharedServerSessionCounter::get_hash(ObString::make_string("other"),
+                                                          *reinterpret_cast<sockaddr *>(&addr1)));
+}
+
+TEST(TestSharedServerSessionCounter, waiter_queue)
+{
+  ObSharedServerSessionCounter *counter = new ObSharedServerSessionCounter();
+  ObSharedServerSessionWaiter waiter1;
+  ObSharedServerSessionWaiter waiter2;
+  ObSharedServerSessionWaiter waiter3;
+  counter->add_waiter(waiter1, 1);
+  counter->add_waiter(waiter2, 2);
+  counter->add_waiter(waiter3, 1);
+  // added twice is ignored
+  counter->add_waiter(waiter1, 2);
+  ASSERT_EQ(3, counter->get_waiter_count());
+  ASSERT_EQ(1, waiter1.hash_);
+
+  // first in first out for the same hash
+  ASSERT_TRUE(NULL == counter->pop_waiter(3));
+  ASSERT_EQ(&waiter1, counter->pop_waiter(1));
+  ASSERT_EQ(0, waiter1.hash_);
+  ASSERT_EQ(2, counter->get_waiter_count());
+
+  counter->remove_waiter(waiter3);
+  ASSERT_EQ(0, waiter3.hash_);
+  counter->remove_waiter(waiter3);
+  ASSERT_EQ(1, counter->get_waiter_count());
+  ASSERT_TRUE(NULL == counter->pop_waiter(1));
+
+  // no sm to wake up, only dequeued
+  counter->wake_up_waiter(1);
+  ASSERT_EQ(1, counter->get_waiter_count());
+  counter->wake_up_waiter(2);
+  ASSERT_EQ(0, counter->get_waiter_count());
+  ASSERT_EQ(0, waiter2.hash_);
+  counter->wake_up_waiter(2);
+
+  // requeued after woken up
+  counter->add_waiter(waiter2, 2);
+  ASSERT_EQ(&waiter2, counter->pop_waiter(2));
+  ASSERT_EQ(0, counter->get_waiter_count());
+  delete counter;
+}
+
+} // end of namespace proxy
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  oceanbase::common::ObLogger::get_logger().set_log_level("ERROR");
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
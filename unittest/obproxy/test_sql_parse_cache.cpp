@@ -0,0 +1,206 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include "obutils/ob_proxy_sql_parse_cache.h"
+#include "proxy/route/obproxy_expr_template_cache.h"
+#include "lib/allocator/page_arena.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+using namespace common;
+using namespace obutils;
+using namespace proxy;
+
+class TestSqlParseCache : public ::testing::Test
+{
+public:
+  virtual void SetUp() { }
+  virtual void TearDown() { }
+
+  void check_mask(const char *sql, const char *expect, const int64_t expect_first_pos)
+  {
+    char buf[ObSqlParseResultCache::MAX_CACHED_SQL_LENGTH];
+    int64_t pos = 0;
+    int64_t first_pos = 0;
+    ASSERT_EQ(OB_SUCCESS, ObSqlParseResultCache::mask_literals(ObString::make_string(sql),
+              buf, sizeof(buf), pos, first_pos));
+    ASSERT_EQ(ObString::make_string(expect), ObString(pos, buf));
+    ASSERT_EQ(expect_first_pos, first_pos);
+  }
+};
+
+TEST_F(TestSqlParseCache, mask_literals)
+{
+  const int64_t NONE = ObSqlParseResultCache::NO_LITERAL_POS;
+  check_mask("select * from t1 where c1 = 1", "select * from t1 where c1 = ?", 28);
+  check_mask("select * from t1 where c1 = 'a''b\\'c' and c2 = 1.5e-3",
+             "select * from t1 where c1 = ? and c2 = ?", 28);
+  check_mask("select * from t1 where c1 in (0x1F, .5, -3)",
+             "select * from t1 where c1 in (?, ?, -?)", 30);
+  check_mask("select * from `t2` where \"c3\" = c4", "select * from `t2` where \"c3\" = c4", NONE);
+  check_mask("select /*+ query_timeout(100) */ * from 1abc",
+             "select /*+ query_timeout(100) */ * from 1abc", NONE);
+  check_mask("select * from t -- 123\nwhere c = 2", "select * from t -- 123\nwhere c = ?", 33);
+}
+
+TEST_F(TestSqlParseCache, literal_spans)
+{
+  const char *sql = "select * from t1 where c1 = 'ab' and c2 in (12, 1.5e3)";
+  char buf[ObSqlParseResultCache::MAX_CACHED_SQL_LENGTH];
+  int64_t pos = 0;
+  int64_t first_pos = 0;
+  int64_t span_count = 0;
+  ObSqlLiteralSpan spans[3];
+  ASSERT_EQ(OB_SUCCESS, ObSqlParseResultCache::mask_literals(ObString::make_string(sql),
+            buf, sizeof(buf), pos, first_pos, spans, 3, span_count));
+  ASSERT_EQ(3, span_count);
+  ASSERT_EQ(ObString::make_string("'ab'"), ObString(spans[0].len_, sql + spans[0].start_));
+  ASSERT_EQ(ObString::make_string("12"), ObString(spans[1].len_, sql + spans[1].start_));
+  ASSERT_EQ(ObString::make_string("1.5e3"), ObString(spans[2].len_, sql + spans[2].start_));
+  ASSERT_EQ(OB_SIZE_OVERFLOW, ObSqlParseResultCache::mask_literals(ObString::make_string(sql),
+            buf, sizeof(buf), pos, first_pos, spans, 2, span_count));
+}
+
+// relation with value token as expr parser builds
+static void set_relation(ObExprParseResult &result, ObProxyRelationExpr &relation,
+                         ObProxyTokenList &list, ObProxyTokenNode &node)
+{
+  list.column_node_ = NULL;
+  list.head_ = &node;
+  list.tail_ = &node;
+  relation.column_idx_ = 0;
+  relation.left_value_ = NULL;
+  relation.right_value_ = &list;
+  relation.type_ = F_COMP_EQ;
+  relation.level_ = PART_KEY_LEVEL_ONE;
+  result.relation_info_.relations_[result.relation_info_.relation_num_++] = &relation;
+}
+
+TEST_F(TestSqlParseCache, expr_template)
+{
+  ObExprTemplateCache cache;
+  ObArenaAllocator allocator;
+  ObExprParseResult result;
+  ObProxyRelationExpr relation;
+  ObProxyTokenList list;
+  ObProxyTokenNode node;
+  bool is_hit = false;
+  MEMSET(&result, 0, sizeof(result));
+  MEMSET(&node, 0, sizeof(node));
+  ASSERT_EQ(OB_SUCCESS, cache.init(4));
+
+  // int value is mapped to the only literal of the value
+  const char *sql = "select * from t1 where c0 = 'x' and c1 = 7";
+  ASSERT_EQ(OB_SUCCESS, cache.get(ObString::make_string(sql), SELECT_STMT_PARSE_MODE,
+                                  OBPROXY_T_SELECT, 1, 14, allocator, result, is_hit));
+  ASSERT_FALSE(is_hit);
+  node.type_ = TOKEN_INT_VAL;
+  node.int_value_ = 7;
+  set_relation(result, relation, list, node);
+  ASSERT_EQ(OB_SUCCESS, cache.put(result));
+
+  MEMSET(&result, 0, sizeof(result));
+  ASSERT_EQ(OB_SUCCESS, cache.get(ObString::make_string("select * from t1 where c0 = 'y' and c1 = 'abc'"),
+                                  SELECT_STMT_PARSE_MODE, OBPROXY_T_SELECT, 1, 14, allocator, result, is_hit));
+  ASSERT_TRUE(is_hit);
+  ASSERT_EQ(1, result.relation_info_.relation_num_);
+  ObProxyTokenNode *value = result.relation_info_.relations_[0]->right_value_->head_;
+  ASSERT_EQ(TOKEN_STR_VAL, value->type_);
+  ASSERT_EQ(ObString::make_string("abc"), ObString(value->str_value_.str_len_, value->str_value_.str_));
+
+  // part key changes
+  ASSERT_EQ(OB_SUCCESS, cache.get(ObString::make_string("select * from t1 where c0 = 'y' and c1 = 8"),
+                                  SELECT_STMT_PARSE_MODE, OBPROXY_T_SELECT, 2, 14, allocator, result, is_hit));
+  ASSERT_FALSE(is_hit);
+
+  // placeholder differs from literal
+  ASSERT_EQ(OB_SUCCESS, cache.get(ObString::make_string("select * from t1 where c0 = 'y' and c1 = ?"),
+                                  SELECT_STMT_PARSE_MODE, OBPROXY_T_SELECT, 1, 14, allocator, result, is_hit));
+  ASSERT_FALSE(is_hit);
+
+  // keyword in literal may change where expr parser starts
+  ASSERT_EQ(OB_SUCCESS, cache.get(ObString::make_string("select * from t1 where c0 = 'where' and c1 = 8"),
+                                  SELECT_STMT_PARSE_MODE, OBPROXY_T_SELECT, 1, 14, allocator, result, is_hit));
+  ASSERT_FALSE(is_hit);
+
+  // ambiguous int value is not cached
+  MEMSET(&result, 0, sizeof(result));
+  sql = "select * from t2 where c0 = 7 and c1 = 7";
+  ASSERT_EQ(OB_SUCCESS, cache.get(ObString::make_string(sql), SELECT_STMT_PARSE_MODE,
+                                  OBPROXY_T_SELECT, 1, 14, allocator, result, is_hit));
+  set_relation(result, relation, list, node);
+  ASSERT_EQ(OB_SUCCESS, cache.put(result));
+  ASSERT_EQ(OB_SUCCESS, cache.get(ObString::make_string(sql), SELECT_STMT_PARSE_MODE,
+                                  OBPROXY_T_SELECT, 1, 14, allocator, result, is_hit));
+  ASSERT_FALSE(is_hit);
+}
+
+TEST_F(TestSqlParseCache, get_and_put)
+{
+  ObSqlParseResultCache cache;
+  ObSqlParseResult result;
+  ObSqlParseResult cached_result;
+  bool is_hit = false;
+  const int64_t flags = ObSqlParseResultCache::make_flags(NORMAL_PARSE_MODE, false, false);
+  ASSERT_EQ(OB_SUCCESS, cache.init(3));
+  ASSERT_EQ(4, cache.entry_count_);
+
+  ASSERT_EQ(OB_SUCCESS, cache.get(ObString::make_string("select * from t1 where c1 = 1"),
+                                  flags, cached_result, is_hit));
+  ASSERT_FALSE(is_hit);
+  result.stmt_type_ = OBPROXY_T_SELECT;
+  result.parsed_length_ = 16;
+  ASSERT_EQ(OB_SUCCESS, cache.put(result));
+
+  // only literal differs
+  ASSERT_EQ(OB_SUCCESS, cache.get(ObString::make_string("select * from t1 where c1 = 12345"),
+                                  flags, cached_result, is_hit));
+  ASSERT_TRUE(is_hit);
+  ASSERT_EQ(OBPROXY_T_SELECT, cached_result.get_stmt_type());
+  ASSERT_EQ(16, cached_result.get_parsed_length());
+
+  // different flags
+  ASSERT_EQ(OB_SUCCESS, cache.get(ObString::make_string("select * from t1 where c1 = 1"),
+                                  ObSqlParseResultCache::make_flags(NORMAL_PARSE_MODE, true, false),
+                                  cached_result, is_hit));
+  ASSERT_FALSE(is_hit);
+
+  // literal before parsed length, not cached
+  ASSERT_EQ(OB_SUCCESS, cache.get(ObString::make_string("select 1 from t2"), flags, cached_result, is_hit));
+  ASSERT_FALSE(is_hit);
+  ASSERT_EQ(OB_SUCCESS, cache.put(result));
+  ASSERT_EQ(OB_SUCCESS, cache.get(ObString::make_string("select 2 from t2"), flags, cached_result, is_hit));
+  ASSERT_FALSE(is_hit);
+
+  // non dml is not cached
+  ASSERT_EQ(OB_SUCCESS, cache.get(ObString::make_string("set @a = 1"), flags, cached_result, is_hit));
+  ASSERT_FALSE(is_hit);
+  result.stmt_type_ = OBPROXY_T_SET;
+  result.parsed_length_ = 3;
+  ASSERT_EQ(OB_SUCCESS, cache.put(result));
+  ASSERT_EQ(OB_SUCCESS, cache.get(ObString::make_string("set @a = 1"), flags, cached_result, is_hit));
+  ASSERT_FALSE(is_hit);
+}
+
+}
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
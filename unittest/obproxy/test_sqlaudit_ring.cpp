@@ -0,0 +1,269 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "proxy/mysql/ob_sqlaudit_ring.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+using namespace common;
+using namespace proxy;
+
+class TestSqlauditRing : public ::testing::Test
+{
+public:
+  virtual void SetUp() { }
+  virtual void TearDown() { }
+
+  void record(ObSqlauditRing &ring, const int64_t sm_id, const ObString &sql, const int64_t sql_max_len)
+  {
+    ObSqlauditRingRecord rec;
+    MEMSET(&rec, 0, sizeof(rec));
+    rec.sm_id_ = sm_id;
+    ring.record(rec, sql, sql_max_len);
+  }
+};
+
+TEST_F(TestSqlauditRing, record_and_read)
+{
+  ObSqlauditRing ring;
+  ASSERT_EQ(OB_INVALID_ARGUMENT, ring.init(1024, 0, NULL));
+  ASSERT_EQ(OB_SUCCESS, ring.init(ObSqlauditRing::MIN_CAPACITY + ObSqlauditRingHeader::HEADER_SIZE, 0, NULL));
+  ASSERT_EQ(ObSqlauditRing::MIN_CAPACITY, ring.get_capacity());
+
+  record(ring, 1, ObString::make_string("select 1"), 4096);
+  record(ring, 2, ObString::make_string("select * from t1 where c1 = 1"), 8);
+
+  char buf[4096];
+  int64_t offset = 0;
+  int64_t data_len = 0;
+  ASSERT_EQ(OB_SUCCESS, ring.read(offset, buf, sizeof(buf), data_len));
+  ASSERT_EQ(ring.get_head(), offset);
+
+  const ObSqlauditRingRecord *rec = reinterpret_cast<const ObSqlauditRingRecord *>(buf);
+  ASSERT_EQ(1, rec->sm_id_);
+  ASSERT_EQ(0, rec->seq_);
+  ASSERT_TRUE(rec->get_sql_string() == ObString::make_string("select 1"));
+  ASSERT_EQ(0, rec->flags_ & SQLAUDIT_RING_FLAG_SQL_TRUNCATED);
+
+  rec = reinterpret_cast<const ObSqlauditRingRecord *>(buf + rec->len_);
+  ASSERT_EQ(2, rec->sm_id_);
+  ASSERT_EQ(8, rec->sql_len_);
+  ASSERT_EQ(29, rec->orig_sql_len_);
+  ASSERT_TRUE(rec->get_sql_string() == ObString::make_string("select *"));
+  ASSERT_NE(0, rec->flags_ & SQLAUDIT_RING_FLAG_SQL_TRUNCATED);
+  ASSERT_EQ(data_len, reinterpret_cast<const char *>(rec) - buf + rec->len_);
+
+  // nothing new
+  ASSERT_EQ(OB_SUCCESS, ring.read(offset, buf, sizeof(buf), data_len));
+  ASSERT_EQ(0, data_len);
+}
+
+TEST_F(TestSqlauditRing, wrap)
+{
+  ObSqlauditRing ring;
+  ASSERT_EQ(OB_SUCCESS, ring.init(ObSqlauditRing::MIN_CAPACITY + ObSqlauditRingHeader::HEADER_SIZE, 0, NULL));
+  char sql_buf[1000];
+  MEMSET(sql_buf, 'a', sizeof(sql_buf));
+  const ObString sql(sizeof(sql_buf), sql_buf);
+  const int64_t record_count = 1000;
+  for (int64_t i = 0; i < record_count; ++i) {
+    record(ring, i, sql, 4096);
+    ASSERT_LE(ring.get_head() - ring.get_tail(), ring.get_capacity());
+  }
+  ASSERT_EQ(record_count, ring.get_record_count());
+
+  // the newest records are kept in order, padding records are skipped
+  char *buf = new char[ObSqlauditRing::MIN_CAPACITY];
+  int64_t offset = 0;
+  int64_t data_len = 0;
+  ASSERT_EQ(OB_SUCCESS, ring.read(offset, buf, ObSqlauditRing::MIN_CAPACITY, data_len));
+  ASSERT_EQ(ring.get_head(), offset);
+  int64_t last_sm_id = -1;
+  for (int64_t pos = 0; pos < data_len; ) {
+    const ObSqlauditRingRecord *rec = reinterpret_cast<const ObSqlauditRingRecord *>(buf + pos);
+    ASSERT_EQ(SQLAUDIT_RING_RECORD_SQL, rec->type_);
+    ASSERT_TRUE(last_sm_id < 0 || last_sm_id + 1 == rec->sm_id_);
+    ASSERT_EQ(rec->seq_, rec->sm_id_);
+    last_sm_id = rec->sm_id_;
+    pos += rec->len_;
+  }
+  ASSERT_EQ(record_count - 1, last_sm_id);
+
+  // a small buffer reads the records one by one
+  offset = 0;
+  ASSERT_EQ(OB_BUF_NOT_ENOUGH, ring.read(offset, buf, 64, data_len));
+  ASSERT_EQ(OB_SUCCESS, ring.read(offset, buf, ObSqlauditRing::get_record_len(1000), data_len));
+  ASSERT_EQ(ObSqlauditRing::get_record_len(1000), data_len);
+  delete [] buf;
+}
+
+TEST_F(TestSqlauditRing, invalid_record_len)
+{
+  ObSqlauditRing ring;
+  ASSERT_EQ(OB_SUCCESS, ring.init(ObSqlauditRing::MIN_CAPACITY + ObSqlauditRingHeader::HEADER_SIZE, 0, NULL));
+  const int64_t capacity = ring.get_capacity();
+  const int64_t head = capacity * 3;
+  ASSERT_TRUE(ring.is_valid_record_len(capacity, 128, head));
+  ASSERT_FALSE(ring.is_valid_record_len(capacity, 0, head));
+  ASSERT_FALSE(ring.is_valid_record_len(capacity, 12, head));
+  ASSERT_FALSE(ring.is_valid_record_len(head - 64, 128, head));
+  // records never cross the end of the ring
+  ASSERT_TRUE(ring.is_valid_record_len(capacity * 2 - 128, 128, head));
+  ASSERT_FALSE(ring.is_valid_record_len(capacity * 2 - 64, 128, head));
+
+  char sql_buf[1000];
+  MEMSET(sql_buf, 'a', sizeof(sql_buf));
+  const ObString sql(sizeof(sql_buf), sql_buf);
+  for (int64_t i = 0; i < 10; ++i) {
+    record(ring, i, sql, 4096);
+  }
+  // a corrupted record makes read fail and the writer drop all records, not loop on it
+  reinterpret_cast<ObSqlauditRingRecord *>(ring.get_pos(ring.get_tail()))->len_ = 0;
+  char *buf = new char[ObSqlauditRing::MIN_CAPACITY];
+  int64_t offset = 0;
+  int64_t data_len = 0;
+  ASSERT_EQ(OB_ERR_UNEXPECTED, ring.read(offset, buf, ObSqlauditRing::MIN_CAPACITY, data_len));
+  for (int64_t i = 10; i < 200; ++i) {
+    record(ring, i, sql, 4096);
+    ASSERT_LE(ring.get_head() - ring.get_tail(), ring.get_capacity());
+  }
+  offset = 0;
+  ASSERT_EQ(OB_SUCCESS, ring.read(offset, buf, ObSqlauditRing::MIN_CAPACITY, data_len));
+  ASSERT_GT(data_len, 0);
+  ASSERT_EQ(199, reinterpret_cast<const ObSqlauditRingRecord *>(
+      buf + data_len - ObSqlauditRing::get_record_len(1000))->sm_id_);
+  delete [] buf;
+}
+
+TEST_F(TestSqlauditRing, export_file)
+{
+  char path[256];
+  snprintf(path, sizeof(path), "/tmp/test_sqlaudit_ring.%d.0", getpid());
+  ObSqlauditRing ring;
+  const int64_t mem_size = ObSqlauditRing::MIN_CAPACITY + ObSqlauditRingHeader::HEADER_SIZE;
+  ASSERT_EQ(OB_SUCCESS, ring.init(mem_size, 0, path));
+  record(ring, 1, ObString::make_string("select 1"), 4096);
+  // raw sql text is only readable by the owner
+  struct stat st;
+  ASSERT_EQ(0, ::stat(path, &st));
+  ASSERT_EQ(0600, st.st_mode & 0777);
+
+  // read like a tool outside the process
+  const int fd = ::open(path, O_RDONLY);
+  ASSERT_GE(fd, 0);
+  void *addr = ::mmap(NULL, mem_size, PROT_READ, MAP_SHARED, fd, 0);
+  ASSERT_TRUE(MAP_FAILED != addr);
+  const ObSqlauditRingHeader *header = static_cast<const ObSqlauditRingHeader *>(addr);
+  ASSERT_EQ(ObSqlauditRingHeader::RING_MAGIC, header->magic_);
+  ASSERT_EQ(static_cast<int64_t>(getpid()), header->pid_);
+  ASSERT_EQ(ring.get_capacity(), header->capacity_);
+  ASSERT_EQ(ObSqlauditRing::get_record_len(8), header->head_);
+  const ObSqlauditRingRecord *rec = reinterpret_cast<const ObSqlauditRingRecord *>(
+      static_cast<const char *>(addr) + ObSqlauditRingHeader::HEADER_SIZE);
+  ASSERT_EQ(1, rec->sm_id_);
+  ASSERT_TRUE(rec->get_sql_string() == ObString::make_string("select 1"));
+  (void)::munmap(addr, mem_size);
+  (void)::close(fd);
+
+  ring.destroy();
+  (void)::unlink(path);
+}
+
+TEST_F(TestSqlauditRing, remove_stale_files)
+{
+  char dir[256];
+  char path[512];
+  snprintf(dir, sizeof(dir), "/tmp/test_sqlaudit_ring_dir.%d", getpid());
+  ASSERT_EQ(0, ::mkdir(dir, 0700));
+
+  // a pid which has exited
+  const pid_t dead_pid = fork();
+  ASSERT_GE(dead_pid, 0);
+  if (0 == dead_pid) {
+    _exit(0);
+  }
+  ASSERT_EQ(dead_pid, waitpid(dead_pid, NULL, 0));
+
+  const char *names[] = { "sqlaudit_ring.%d.0", "sqlaudit_ring.%d.1", "sqlaudit_ring.%d.1.bak" };
+  const int pids[] = { getpid(), getppid(), dead_pid };
+  for (int64_t i = 0; i < 3; ++i) {
+    for (int64_t j = 0; j < 3; ++j) {
+      char name[128];
+      snprintf(name, sizeof(name), names[j], pids[i]);
+      snprintf(path, sizeof(path), "%s/%s", dir, name);
+      const int fd = ::open(path, O_RDWR | O_CREAT, 0600);
+      ASSERT_GE(fd, 0);
+      (void)::close(fd);
+    }
+  }
+  snprintf(path, sizeof(path), "%s/obproxy.log", dir);
+  const int fd = ::open(path, O_RDWR | O_CREAT, 0600);
+  ASSERT_GE(fd, 0);
+  (void)::close(fd);
+
+  ASSERT_EQ(OB_SUCCESS, remove_stale_sqlaudit_ring_files(dir));
+  for (int64_t i = 0; i < 3; ++i) {
+    for (int64_t j = 0; j < 3; ++j) {
+      char name[128];
+      snprintf(name, sizeof(name), names[j], pids[i]);
+      snprintf(path, sizeof(path), "%s/%s", dir, name);
+      // only the rings of the exited process are removed
+      const bool is_removed = (dead_pid == pids[i] && j < 2);
+      ASSERT_EQ(is_removed ? -1 : 0, ::access(path, F_OK)) << path;
+      (void)::unlink(path);
+    }
+  }
+  snprintf(path, sizeof(path), "%s/obproxy.log", dir);
+  ASSERT_EQ(0, ::access(path, F_OK));
+  (void)::unlink(path);
+  ASSERT_EQ(0, ::rmdir(dir));
+  ASSERT_EQ(OB_IO_ERROR, remove_stale_sqlaudit_ring_files(dir));
+}
+
+TEST_F(TestSqlauditRing, need_record)
+{
+  ObSqlauditRing ring;
+  ASSERT_FALSE(ring.need_record(true, false, 100, 100));
+  ASSERT_EQ(OB_SUCCESS, ring.init(ObSqlauditRing::MIN_CAPACITY + ObSqlauditRingHeader::HEADER_SIZE, 0, NULL));
+  ASSERT_TRUE(ring.need_record(true, false, 0, 0));
+  ASSERT_TRUE(ring.need_record(false, true, 0, 100));
+  ASSERT_FALSE(ring.need_record(false, true, 100, 0));
+  ASSERT_FALSE(ring.need_record(false, false, 0, 100));
+
+  int64_t count = 0;
+  for (int64_t i = 0; i < 10000; ++i) {
+    if (ring.need_record(false, false, 10, 0)) {
+      ++count;
+    }
+  }
+  ASSERT_GT(count, 500);
+  ASSERT_LT(count, 1500);
+}
+
+}
+}
+
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
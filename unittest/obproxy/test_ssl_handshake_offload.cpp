@@ -0,0 +1,364 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY_NET
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+#include "test_eventsystem_api.h"
+#include "iocore/net/ob_unix_net_vconnection.h"
+#include "iocore/net/ob_ssl_processor.h"
+#include "stat/ob_net_stats.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+using namespace common;
+using namespace event;
+using namespace net;
+
+static const int64_t TEST_WAIT_TIMEOUT_MS = 5000;
+static const int64_t TEST_MAX_HANDSHAKE_ROUND = 20;
+
+// the net thread is told the handshake is over by reenable(), count it instead
+class TestSSLOffloadVConnection : public ObUnixNetVConnection
+{
+public:
+  TestSSLOffloadVConnection() : reenable_count_(0) {}
+  virtual ~TestSSLOffloadVConnection() {}
+  virtual void reenable(ObVIO *vio)
+  {
+    UNUSED(vio);
+    (void)ATOMIC_AAF(&reenable_count_, 1);
+  }
+
+  int64_t reenable_count_;
+};
+
+// plays the net thread, which offloads the handshake with vio mutex held
+// when the socket gets ready
+struct TestSSLOffloadDriver : public ObContinuation
+{
+  TestSSLOffloadDriver(ObProxyMutex *mutex, TestSSLOffloadVConnection *vc)
+    : ObContinuation(mutex), vc_(vc), ret_(OB_SUCCESS), run_count_(0), close_after_offload_(false),
+      is_sync_only_(false)
+  {
+    SET_HANDLER(&TestSSLOffloadDriver::handle_offload);
+  }
+
+  int handle_offload(int event, void *data)
+  {
+    UNUSED(event);
+    UNUSED(data);
+    if (is_sync_only_) {
+      // the handshake thread has released the vio mutex
+    } else if (OB_SUCCESS == (ret_ = vc_->offload_ssl_server_handshake(true)) && close_after_offload_) {
+      // client session is closed before the handshake thread runs
+      vc_->close_ssl();
+    }
+    (void)ATOMIC_AAF(&run_count_, 1);
+    return EVENT_DONE;
+  }
+
+  TestSSLOffloadVConnection *vc_;
+  int ret_;
+  int64_t run_count_;
+  bool close_after_offload_;
+  bool is_sync_only_;
+};
+
+class TestSSLHandshakeOffload : public ::testing::Test
+{
+public:
+  static void SetUpTestCase()
+  {
+    SSL_library_init();
+    SSL_load_error_strings();
+    server_ctx_ = SSL_CTX_new(SSLv23_server_method());
+    client_ctx_ = SSL_CTX_new(SSLv23_client_method());
+    ASSERT_TRUE(NULL != server_ctx_);
+    ASSERT_TRUE(NULL != client_ctx_);
+    SSL_CTX_set_verify(client_ctx_, SSL_VERIFY_NONE, NULL);
+    // tickets need the key callback of ObSSLProcessor, they are not the point here
+    SSL_CTX_set_options(server_ctx_, SSL_OP_NO_TICKET);
+    build_self_signed_cert(server_ctx_);
+  }
+
+  static void TearDownTestCase()
+  {
+    SSL_CTX_free(server_ctx_);
+    SSL_CTX_free(client_ctx_);
+  }
+
+  static void build_self_signed_cert(SSL_CTX *ctx)
+  {
+    EVP_PKEY *pkey = EVP_PKEY_new();
+    RSA *rsa = RSA_new();
+    BIGNUM *e = BN_new();
+    X509 *cert = X509_new();
+    ASSERT_TRUE(NULL != pkey && NULL != rsa && NULL != e && NULL != cert);
+    ASSERT_EQ(1, BN_set_word(e, RSA_F4));
+    ASSERT_EQ(1, RSA_generate_key_ex(rsa, 2048, e, NULL));
+    ASSERT_EQ(1, EVP_PKEY_assign_RSA(pkey, rsa));
+    ASSERT_EQ(1, X509_set_version(cert, 2));
+    ASSERT_EQ(1, ASN1_INTEGER_set(X509_get_serialNumber(cert), 1));
+    ASSERT_TRUE(NULL != X509_gmtime_adj(X509_get_notBefore(cert), 0));
+    ASSERT_TRUE(NULL != X509_gmtime_adj(X509_get_notAfter(cert), 3600));
+    ASSERT_EQ(1, X509_set_pubkey(cert, pkey));
+    X509_NAME *name = X509_get_subject_name(cert);
+    ASSERT_EQ(1, X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                                            reinterpret_cast<const unsigned char *>("obproxy"), -1, -1, 0));
+    ASSERT_EQ(1, X509_set_issuer_name(cert, name));
+    ASSERT_LT(0, X509_sign(cert, pkey, EVP_sha256()));
+    ASSERT_EQ(1, SSL_CTX_use_certificate(ctx, cert));
+    ASSERT_EQ(1, SSL_CTX_use_PrivateKey(ctx, pkey));
+    ASSERT_EQ(1, SSL_CTX_check_private_key(ctx));
+    X509_free(cert);
+    EVP_PKEY_free(pkey);
+    BN_free(e);
+  }
+
+  virtual void SetUp()
+  {
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds_));
+    ASSERT_EQ(0, fcntl(fds_[0], F_SETFL, fcntl(fds_[0], F_GETFL) | O_NONBLOCK));
+    ASSERT_EQ(0, fcntl(fds_[1], F_SETFL, fcntl(fds_[1], F_GETFL) | O_NONBLOCK));
+    client_ssl_ = SSL_new(client_ctx_);
+    ASSERT_TRUE(NULL != client_ssl_);
+    ASSERT_EQ(1, SSL_set_fd(client_ssl_, fds_[1]));
+    SSL_set_connect_state(client_ssl_);
+
+    thread_ = g_event_processor.event_thread_[ET_CALL][0];
+    mutex_ = new_proxy_mutex();
+    vc_ = new TestSSLOffloadVConnection();
+    vc_->nh_ = &net_handler_;
+    vc_->read_.vio_.mutex_ = mutex_;
+    vc_->ssl_ = SSL_new(server_ctx_);
+    ASSERT_TRUE(NULL != vc_->ssl_);
+    ASSERT_EQ(1, SSL_set_fd(vc_->ssl_, fds_[0]));
+    vc_->ssl_type_ = ObUnixNetVConnection::SSL_SERVER;
+    vc_->using_ssl_ = true;
+    driver_ = new TestSSLOffloadDriver(mutex_.ptr_, vc_);
+  }
+
+  virtual void TearDown()
+  {
+    driver_->is_sync_only_ = true;
+    wait_driver();
+    if (NULL != vc_->ssl_) {
+      SSL_free(vc_->ssl_);
+      vc_->ssl_ = NULL;
+    }
+    delete driver_;
+    delete vc_;
+    mutex_.release();
+    SSL_free(client_ssl_);
+    close(fds_[0]);
+    if (fds_[1] >= 0) {
+      close(fds_[1]);
+    }
+  }
+
+  // the socket got ready, net thread offloads the handshake and waits for
+  // the handshake thread to finish
+  void offload_and_wait()
+  {
+    wait_driver();
+    ASSERT_EQ(OB_SUCCESS, driver_->ret_);
+    int64_t i = 0;
+    for (; i < TEST_WAIT_TIMEOUT_MS && is_offload_running(); ++i) {
+      usleep(1000);
+    }
+    ASSERT_LT(i, TEST_WAIT_TIMEOUT_MS);
+  }
+
+  void wait_driver()
+  {
+    const int64_t run_count = ATOMIC_LOAD(&driver_->run_count_);
+    ASSERT_TRUE(NULL != g_event_processor.schedule_imm(driver_, ET_CALL));
+    int64_t i = 0;
+    for (; i < TEST_WAIT_TIMEOUT_MS && ATOMIC_LOAD(&driver_->run_count_) == run_count; ++i) {
+      usleep(1000);
+    }
+    ASSERT_LT(i, TEST_WAIT_TIMEOUT_MS);
+  }
+
+  bool is_offload_running()
+  {
+    const int64_t state = ATOMIC_LOAD(&vc_->ssl_offload_state_);
+    return ObUnixNetVConnection::SSL_OFFLOAD_RUNNING == state
+           || ObUnixNetVConnection::SSL_OFFLOAD_RUNNING_IO_PENDING == state;
+  }
+
+  // returns 1 if connected, -1 on error, 0 if it needs more data
+  int client_connect()
+  {
+    int ret = SSL_connect(client_ssl_);
+    if (1 != ret) {
+      const int code = SSL_get_error(client_ssl_, ret);
+      ret = (SSL_ERROR_WANT_READ == code || SSL_ERROR_WANT_WRITE == code) ? 0 : -1;
+    }
+    return ret;
+  }
+
+  int64_t get_full_handshakes()
+  {
+    int64_t count = 0;
+    EXPECT_EQ(OB_SUCCESS, ObStatProcessor::get_thread_raw_stat_sum(net_rsb, thread_, SSL_FULL_HANDSHAKES, count));
+    return count;
+  }
+
+public:
+  static SSL_CTX *server_ctx_;
+  static SSL_CTX *client_ctx_;
+  int fds_[2];
+  SSL *client_ssl_;
+  ObEThread *thread_;
+  ObPtr<ObProxyMutex> mutex_;
+  ObNetHandler net_handler_;
+  TestSSLOffloadVConnection *vc_;
+  TestSSLOffloadDriver *driver_;
+};
+
+SSL_CTX *TestSSLHandshakeOffload::server_ctx_ = NULL;
+SSL_CTX *TestSSLHandshakeOffload::client_ctx_ = NULL;
+
+TEST_F(TestSSLHandshakeOffload, complete)
+{
+  const int64_t full_handshakes = get_full_handshakes();
+  int client_ret = 0;
+  for (int64_t i = 0; i < TEST_MAX_HANDSHAKE_ROUND && 0 == ATOMIC_LOAD(&vc_->reenable_count_); ++i) {
+    ASSERT_LE(0, client_ret = client_connect());
+    offload_and_wait();
+    if (!vc_->ssl_connected_) {
+      // waits for the next epoll event without handing back
+      ASSERT_EQ(ObUnixNetVConnection::SSL_OFFLOAD_IDLE, ATOMIC_LOAD(&vc_->ssl_offload_state_));
+      ASSERT_EQ(0, ATOMIC_LOAD(&vc_->reenable_count_));
+    }
+  }
+  ASSERT_TRUE(vc_->ssl_connected_);
+  ASSERT_EQ(1, ATOMIC_LOAD(&vc_->reenable_count_));
+  ASSERT_EQ(ObUnixNetVConnection::SSL_OFFLOAD_IDLE, ATOMIC_LOAD(&vc_->ssl_offload_state_));
+  ASSERT_TRUE(NULL == vc_->ssl_offload_action_);
+  // data following the handshake may be buffered in ssl already
+  ASSERT_TRUE(vc_->read_.triggered_);
+  ASSERT_EQ(full_handshakes + 1, get_full_handshakes());
+
+  for (int64_t i = 0; i < TEST_MAX_HANDSHAKE_ROUND && 1 != client_ret; ++i) {
+    ASSERT_LE(0, client_ret = client_connect());
+  }
+  ASSERT_EQ(1, client_ret);
+  usleep(100 * 1000);
+  ASSERT_EQ(1, ATOMIC_LOAD(&vc_->reenable_count_));
+}
+
+TEST_F(TestSSLHandshakeOffload, io_pending)
+{
+  // the socket got ready while SSL_accept was running, it is run once more
+  // and then waits for epoll again
+  ATOMIC_STORE(&vc_->ssl_offload_state_, ObUnixNetVConnection::SSL_OFFLOAD_RUNNING_IO_PENDING);
+  vc_->handle_ssl_offload_handshake(*thread_);
+  ASSERT_EQ(ObUnixNetVConnection::SSL_OFFLOAD_IDLE, ATOMIC_LOAD(&vc_->ssl_offload_state_));
+  ASSERT_EQ(0, vc_->reenable_count_);
+  ASSERT_FALSE(vc_->ssl_connected_);
+
+  // edge while running is recorded, no second handshake is scheduled
+  ATOMIC_STORE(&vc_->ssl_offload_state_, ObUnixNetVConnection::SSL_OFFLOAD_RUNNING);
+  ASSERT_EQ(OB_SUCCESS, vc_->offload_ssl_server_handshake(true));
+  ASSERT_EQ(ObUnixNetVConnection::SSL_OFFLOAD_RUNNING_IO_PENDING, ATOMIC_LOAD(&vc_->ssl_offload_state_));
+  ASSERT_TRUE(NULL == vc_->ssl_offload_action_);
+  ASSERT_EQ(OB_SUCCESS, vc_->offload_ssl_server_handshake(true));
+  ASSERT_EQ(ObUnixNetVConnection::SSL_OFFLOAD_RUNNING_IO_PENDING, ATOMIC_LOAD(&vc_->ssl_offload_state_));
+  ASSERT_TRUE(NULL == vc_->ssl_offload_action_);
+
+  // vio mutex is not got, retried in next net loop
+  ATOMIC_STORE(&vc_->ssl_offload_state_, ObUnixNetVConnection::SSL_OFFLOAD_IDLE);
+  ASSERT_EQ(OB_SUCCESS, vc_->offload_ssl_server_handshake(false));
+  ASSERT_EQ(ObUnixNetVConnection::SSL_OFFLOAD_IDLE, ATOMIC_LOAD(&vc_->ssl_offload_state_));
+  ASSERT_TRUE(NULL == vc_->ssl_offload_action_);
+  ASSERT_TRUE(net_handler_.read_ready_list_.in(vc_));
+  net_handler_.read_ready_list_.remove(vc_);
+  ASSERT_EQ(0, vc_->reenable_count_);
+}
+
+TEST_F(TestSSLHandshakeOffload, fail)
+{
+  const char *request = "GET / HTTP/1.1\r\n\r\n";
+  ASSERT_EQ(static_cast<ssize_t>(strlen(request)), write(fds_[1], request, strlen(request)));
+  offload_and_wait();
+  ASSERT_EQ(ObUnixNetVConnection::SSL_OFFLOAD_FAILED, ATOMIC_LOAD(&vc_->ssl_offload_state_));
+  ASSERT_EQ(OB_SSL_ERROR, vc_->ssl_offload_ret_);
+  ASSERT_FALSE(vc_->ssl_connected_);
+  ASSERT_EQ(1, ATOMIC_LOAD(&vc_->reenable_count_));
+
+  // another epoll event before net thread signals the error, nothing is scheduled
+  offload_and_wait();
+  usleep(100 * 1000);
+  ASSERT_EQ(ObUnixNetVConnection::SSL_OFFLOAD_FAILED, ATOMIC_LOAD(&vc_->ssl_offload_state_));
+  ASSERT_TRUE(NULL == vc_->ssl_offload_action_);
+  ASSERT_EQ(1, ATOMIC_LOAD(&vc_->reenable_count_));
+}
+
+TEST_F(TestSSLHandshakeOffload, client_close_in_handshake)
+{
+  ASSERT_EQ(0, client_connect());
+  offload_and_wait();
+  ASSERT_EQ(ObUnixNetVConnection::SSL_OFFLOAD_IDLE, ATOMIC_LOAD(&vc_->ssl_offload_state_));
+  ASSERT_EQ(0, ATOMIC_LOAD(&vc_->reenable_count_));
+
+  // client goes away before finishing the handshake
+  close(fds_[1]);
+  fds_[1] = -1;
+  offload_and_wait();
+  ASSERT_EQ(ObUnixNetVConnection::SSL_OFFLOAD_FAILED, ATOMIC_LOAD(&vc_->ssl_offload_state_));
+  ASSERT_FALSE(vc_->ssl_connected_);
+  ASSERT_EQ(1, ATOMIC_LOAD(&vc_->reenable_count_));
+  usleep(100 * 1000);
+  ASSERT_EQ(1, ATOMIC_LOAD(&vc_->reenable_count_));
+}
+
+TEST_F(TestSSLHandshakeOffload, close_before_handshake_runs)
+{
+  ASSERT_EQ(0, client_connect());
+  driver_->close_after_offload_ = true;
+  offload_and_wait();
+  // cancelled under vio mutex, the handshake thread never touches the vc
+  usleep(100 * 1000);
+  ASSERT_TRUE(NULL == vc_->ssl_);
+  ASSERT_TRUE(NULL == vc_->ssl_offload_action_);
+  ASSERT_FALSE(vc_->using_ssl_);
+  ASSERT_EQ(ObUnixNetVConnection::SSL_OFFLOAD_IDLE, ATOMIC_LOAD(&vc_->ssl_offload_state_));
+  ASSERT_EQ(0, ATOMIC_LOAD(&vc_->reenable_count_));
+
+  // the handshake event was dequeued before cancel, it finds ssl gone
+  vc_->handle_ssl_offload_handshake(*thread_);
+  ASSERT_EQ(ObUnixNetVConnection::SSL_OFFLOAD_IDLE, ATOMIC_LOAD(&vc_->ssl_offload_state_));
+  ASSERT_EQ(0, ATOMIC_LOAD(&vc_->reenable_count_));
+}
+
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  signal(SIGPIPE, SIG_IGN);
+  oceanbase::common::ObLogger::get_logger().set_log_level("ERROR");
+  oceanbase::obproxy::init_g_net_processor();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,351 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY_NET
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <fcntl.h>
+#include <string>
+#include <openssl/rsa.h>
+#include <openssl/x509.h>
+#include "test_eventsystem_api.h"
+#include "iocore/net/ob_unix_net_vconnection.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+using namespace common;
+using namespace event;
+using namespace net;
+
+static const int64_t TEST_WAIT_TIMEOUT_MS = 5000;
+static const int64_t TEST_MAX_ROUND = 100;
+static const int64_t TEST_SMALL_BLOCK_SIZE = 1000;
+static const int64_t TEST_SMALL_BLOCK_COUNT = 40;
+static const int64_t TEST_DATA_SIZE = TEST_SMALL_BLOCK_SIZE * TEST_SMALL_BLOCK_COUNT;
+// tls record header: content type, version, length
+static const int64_t TLS_RECORD_HEADER_SIZE = 5;
+
+// write_to_net_internal() counts stats of the calling ethread, it is run in event thread
+struct TestSSLWriteDriver : public ObContinuation
+{
+  TestSSLWriteDriver(ObProxyMutex *mutex, ObUnixNetVConnection *vc, ObIOBufferReader *reader)
+    : ObContinuation(mutex), vc_(vc), reader_(reader), ret_(OB_SUCCESS),
+      total_write_(0), tmp_code_(0), run_count_(0)
+  {
+    SET_HANDLER(&TestSSLWriteDriver::handle_write);
+  }
+
+  int handle_write(int event, void *data)
+  {
+    UNUSED(event);
+    UNUSED(data);
+    total_write_ = 0;
+    tmp_code_ = 0;
+    ret_ = vc_->write_to_net_internal(*reader_, reader_->read_avail(), total_write_, tmp_code_);
+    (void)ATOMIC_AAF(&run_count_, 1);
+    return EVENT_DONE;
+  }
+
+  ObUnixNetVConnection *vc_;
+  ObIOBufferReader *reader_;
+  int ret_;
+  int64_t total_write_;
+  int tmp_code_;
+  int64_t run_count_;
+};
+
+class TestSSLRecordCoalesce : public ::testing::Test
+{
+public:
+  static void SetUpTestCase()
+  {
+    SSL_library_init();
+    SSL_load_error_strings();
+    server_ctx_ = SSL_CTX_new(SSLv23_server_method());
+    client_ctx_ = SSL_CTX_new(SSLv23_client_method());
+    ASSERT_TRUE(NULL != server_ctx_);
+    ASSERT_TRUE(NULL != client_ctx_);
+    SSL_CTX_set_verify(client_ctx_, SSL_VERIFY_NONE, NULL);
+    SSL_CTX_set_options(server_ctx_, SSL_OP_NO_TICKET);
+#if OPENSSL_VERSION_NUMBER >= 0x10101000L
+    // no records other than the written data after handshake
+    SSL_CTX_set_num_tickets(server_ctx_, 0);
+#endif
+    // the same as the ssl ctx of ObSSLProcessor
+    SSL_CTX_set_mode(server_ctx_, SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
+    build_self_signed_cert(server_ctx_);
+  }
+
+  static void TearDownTestCase()
+  {
+    SSL_CTX_free(server_ctx_);
+    SSL_CTX_free(client_ctx_);
+  }
+
+  static void build_self_signed_cert(SSL_CTX *ctx)
+  {
+    EVP_PKEY *pkey = EVP_PKEY_new();
+    RSA *rsa = RSA_new();
+    BIGNUM *e = BN_new();
+    X509 *cert = X509_new();
+    ASSERT_TRUE(NULL != pkey && NULL != rsa && NULL != e && NULL != cert);
+    ASSERT_EQ(1, BN_set_word(e, RSA_F4));
+    ASSERT_EQ(1, RSA_generate_key_ex(rsa, 2048, e, NULL));
+    ASSERT_EQ(1, EVP_PKEY_assign_RSA(pkey, rsa));
+    ASSERT_EQ(1, X509_set_version(cert, 2));
+    ASSERT_EQ(1, ASN1_INTEGER_set(X509_get_serialNumber(cert), 1));
+    ASSERT_TRUE(NULL != X509_gmtime_adj(X509_get_notBefore(cert), 0));
+    ASSERT_TRUE(NULL != X509_gmtime_adj(X509_get_notAfter(cert), 3600));
+    ASSERT_EQ(1, X509_set_pubkey(cert, pkey));
+    X509_NAME *name = X509_get_subject_name(cert);
+    ASSERT_EQ(1, X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                                            reinterpret_cast<const unsigned char *>("obproxy"), -1, -1, 0));
+    ASSERT_EQ(1, X509_set_issuer_name(cert, name));
+    ASSERT_LT(0, X509_sign(cert, pkey, EVP_sha256()));
+    ASSERT_EQ(1, SSL_CTX_use_certificate(ctx, cert));
+    ASSERT_EQ(1, SSL_CTX_use_PrivateKey(ctx, pkey));
+    ASSERT_EQ(1, SSL_CTX_check_private_key(ctx));
+    X509_free(cert);
+    EVP_PKEY_free(pkey);
+    BN_free(e);
+  }
+
+  virtual void SetUp()
+  {
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds_));
+    ASSERT_EQ(0, fcntl(fds_[0], F_SETFL, fcntl(fds_[0], F_GETFL) | O_NONBLOCK));
+    ASSERT_EQ(0, fcntl(fds_[1], F_SETFL, fcntl(fds_[1], F_GETFL) | O_NONBLOCK));
+    // client reads the raw records from socket first, then decrypts them
+    client_rbio_ = BIO_new(BIO_s_mem());
+    ASSERT_TRUE(NULL != client_rbio_);
+    client_ssl_ = SSL_new(client_ctx_);
+    ASSERT_TRUE(NULL != client_ssl_);
+    SSL_set_bio(client_ssl_, client_rbio_, BIO_new_socket(fds_[1], BIO_NOCLOSE));
+    SSL_set_connect_state(client_ssl_);
+
+    mutex_ = new_proxy_mutex();
+    vc_ = new ObUnixNetVConnection();
+    vc_->nh_ = &net_handler_;
+    vc_->ssl_ = SSL_new(server_ctx_);
+    ASSERT_TRUE(NULL != vc_->ssl_);
+    ASSERT_EQ(1, SSL_set_fd(vc_->ssl_, fds_[0]));
+    vc_->ssl_type_ = ObUnixNetVConnection::SSL_SERVER;
+    vc_->using_ssl_ = true;
+    vc_->con_.fd_ = fds_[0];
+
+    for (int64_t i = 0; i < TEST_DATA_SIZE; ++i) {
+      data_[i] = static_cast<char>('a' + i % 26);
+    }
+    buffer_ = NULL;
+    data_buffer_ = NULL;
+    reader_ = NULL;
+    driver_ = NULL;
+  }
+
+  virtual void TearDown()
+  {
+    delete driver_;
+    if (NULL != buffer_) {
+      free_miobuffer(buffer_);
+    }
+    if (NULL != data_buffer_) {
+      free_miobuffer(data_buffer_);
+    }
+    SSL_free(vc_->ssl_);
+    vc_->ssl_ = NULL;
+    vc_->con_.fd_ = -1;
+    delete vc_;
+    mutex_.release();
+    SSL_free(client_ssl_);
+    close(fds_[0]);
+    close(fds_[1]);
+  }
+
+  // raw bytes from server are kept to check the records, and handed to client ssl
+  void pump_client()
+  {
+    char buf[4096];
+    ssize_t n = 0;
+    while ((n = read(fds_[1], buf, sizeof(buf))) > 0) {
+      raw_.append(buf, n);
+      ASSERT_EQ(n, BIO_write(client_rbio_, buf, static_cast<int>(n)));
+    }
+  }
+
+  void handshake()
+  {
+    bool server_done = false;
+    bool client_done = false;
+    for (int64_t i = 0; i < TEST_MAX_ROUND && !(server_done && client_done); ++i) {
+      if (!server_done) {
+        server_done = (1 == SSL_accept(vc_->ssl_));
+      }
+      if (!client_done) {
+        client_done = (1 == SSL_connect(client_ssl_));
+      }
+      pump_client();
+    }
+    ASSERT_TRUE(server_done && client_done);
+    vc_->ssl_connected_ = true;
+    raw_.clear();
+  }
+
+  // every block holds TEST_SMALL_BLOCK_SIZE bytes, like the blocks shared
+  // from a server response by write(reader)
+  void prepare_small_blocks()
+  {
+    int64_t written = 0;
+#ifdef TRACK_BUFFER_USER
+    data_buffer_ = new_miobuffer_internal(RES_PATH("memory/ObSSLRecord/"), TEST_DATA_SIZE);
+    buffer_ = new_empty_miobuffer_internal(RES_PATH("memory/ObSSLRecord/"), TEST_SMALL_BLOCK_SIZE);
+#else
+    data_buffer_ = new_miobuffer_internal(TEST_DATA_SIZE);
+    buffer_ = new_empty_miobuffer_internal(TEST_SMALL_BLOCK_SIZE);
+#endif
+    ASSERT_TRUE(NULL != data_buffer_ && NULL != buffer_);
+    ObIOBufferReader *data_reader = data_buffer_->alloc_reader();
+    ASSERT_TRUE(NULL != data_reader);
+    ASSERT_EQ(OB_SUCCESS, data_buffer_->write(data_, TEST_DATA_SIZE, written));
+    ASSERT_EQ(TEST_DATA_SIZE, written);
+    ASSERT_TRUE(NULL != (reader_ = buffer_->alloc_reader()));
+    for (int64_t i = 0; i < TEST_SMALL_BLOCK_COUNT; ++i) {
+      ASSERT_EQ(OB_SUCCESS, buffer_->write(data_reader, TEST_SMALL_BLOCK_SIZE, written));
+      ASSERT_EQ(TEST_SMALL_BLOCK_SIZE, written);
+      ASSERT_EQ(OB_SUCCESS, data_reader->consume(TEST_SMALL_BLOCK_SIZE));
+    }
+    ASSERT_EQ(TEST_DATA_SIZE, reader_->read_avail());
+    int64_t block_count = 0;
+    for (ObIOBufferBlock *block = reader_->block_; NULL != block; block = block->next_) {
+      ++block_count;
+    }
+    ASSERT_EQ(TEST_SMALL_BLOCK_COUNT, block_count);
+    driver_ = new TestSSLWriteDriver(mutex_.ptr_, vc_, reader_);
+  }
+
+  void write_and_wait()
+  {
+    const int64_t run_count = ATOMIC_LOAD(&driver_->run_count_);
+    ASSERT_TRUE(NULL != g_event_processor.schedule_imm(driver_, ET_CALL));
+    int64_t i = 0;
+    for (; i < TEST_WAIT_TIMEOUT_MS && ATOMIC_LOAD(&driver_->run_count_) == run_count; ++i) {
+      usleep(1000);
+    }
+    ASSERT_LT(i, TEST_WAIT_TIMEOUT_MS);
+    ASSERT_EQ(OB_SUCCESS, driver_->ret_);
+    if (driver_->total_write_ > 0) {
+      ASSERT_EQ(OB_SUCCESS, reader_->consume(driver_->total_write_));
+    }
+  }
+
+  int64_t get_record_count()
+  {
+    int64_t count = 0;
+    int64_t pos = 0;
+    while (pos + TLS_RECORD_HEADER_SIZE <= static_cast<int64_t>(raw_.size())) {
+      const unsigned char *header = reinterpret_cast<const unsigned char *>(raw_.data() + pos);
+      const int64_t record_len = (header[3] << 8) | header[4];
+      // all data of one record is plaintext of one SSL_write
+      EXPECT_LE(record_len, ObNetHandler::SSL_RECORD_BUF_SIZE + 256);
+      pos += TLS_RECORD_HEADER_SIZE + record_len;
+      ++count;
+    }
+    EXPECT_EQ(pos, static_cast<int64_t>(raw_.size()));
+    return count;
+  }
+
+  void check_plaintext()
+  {
+    char buf[TEST_DATA_SIZE];
+    int64_t total_read = 0;
+    int n = 0;
+    while (total_read < TEST_DATA_SIZE
+           && (n = SSL_read(client_ssl_, buf + total_read, static_cast<int>(TEST_DATA_SIZE - total_read))) > 0) {
+      total_read += n;
+    }
+    ASSERT_EQ(TEST_DATA_SIZE, total_read);
+    ASSERT_EQ(0, memcmp(buf, data_, TEST_DATA_SIZE));
+  }
+
+public:
+  static SSL_CTX *server_ctx_;
+  static SSL_CTX *client_ctx_;
+  int fds_[2];
+  SSL *client_ssl_;
+  BIO *client_rbio_;
+  ObPtr<ObProxyMutex> mutex_;
+  ObNetHandler net_handler_;
+  ObUnixNetVConnection *vc_;
+  ObMIOBuffer *data_buffer_;
+  ObMIOBuffer *buffer_;
+  ObIOBufferReader *reader_;
+  TestSSLWriteDriver *driver_;
+  std::string raw_;
+  char data_[TEST_DATA_SIZE];
+};
+
+SSL_CTX *TestSSLRecordCoalesce::server_ctx_ = NULL;
+SSL_CTX *TestSSLRecordCoalesce::client_ctx_ = NULL;
+
+TEST_F(TestSSLRecordCoalesce, small_blocks)
+{
+  handshake();
+  prepare_small_blocks();
+  write_and_wait();
+  ASSERT_EQ(TEST_DATA_SIZE, driver_->total_write_);
+  ASSERT_EQ(0, reader_->read_avail());
+  pump_client();
+
+  // 16 blocks (NET_MAX_IOV) of 1000 bytes fit in one record, instead of one record per block
+  ASSERT_EQ(3, get_record_count());
+  check_plaintext();
+}
+
+TEST_F(TestSSLRecordCoalesce, retry_after_want_write)
+{
+  handshake();
+  prepare_small_blocks();
+  // the socket can not take all records at once
+  int sndbuf = 4096;
+  ASSERT_EQ(0, setsockopt(fds_[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof(sndbuf)));
+
+  int64_t round = 0;
+  for (; round < TEST_MAX_ROUND && reader_->read_avail() > 0; ++round) {
+    write_and_wait();
+    if (0 == driver_->total_write_) {
+      ASSERT_TRUE(SSL_ERROR_WANT_WRITE == driver_->tmp_code_ || 0 == driver_->tmp_code_);
+    }
+    pump_client();
+  }
+  ASSERT_LT(1, round);
+  ASSERT_EQ(0, reader_->read_avail());
+
+  // the pending record is sent again from the rebuilt record buffer, with the same bytes
+  ASSERT_EQ(3, get_record_count());
+  check_plaintext();
+}
+
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  signal(SIGPIPE, SIG_IGN);
+  oceanbase::common::ObLogger::get_logger().set_log_level("ERROR");
+  oceanbase::obproxy::init_g_net_processor();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
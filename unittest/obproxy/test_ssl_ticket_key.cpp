@@ -0,0 +1,212 @@
+/**
+ * Copyright (c) 2021 OceanBase
+ * OceanBase Database Proxy(ODP) is licensed under Mulan PubL v2.
+ * You can use this software according to the terms and conditions of the Mulan PubL v2.
+ * You may obtain a copy of Mulan PubL v2 at:
+ *          http://license.coscl.org.cn/MulanPubL-2.0
+ * THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+ * EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+ * MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+ * See the Mulan PubL v2 for more details.
+ */
+
+#define USING_LOG_PREFIX PROXY_NET
+#define private public
+#define protected public
+#include <gtest/gtest.h>
+#include "lib/oblog/ob_log.h"
+#include "iocore/net/ob_ssl_processor.h"
+#include "obutils/ob_proxy_config.h"
+
+namespace oceanbase
+{
+namespace obproxy
+{
+namespace net
+{
+using namespace common;
+using namespace obutils;
+
+static const char *TICKET_SECRET = "0123456789abcdef0123456789abcdef-shared";
+static const char *OTHER_TICKET_SECRET = "fedcba9876543210fedcba9876543210-other";
+static const char *SESSION_STATE = "master secret and cipher suite of the session";
+
+// the part of a ticket which the key callback is responsible for
+struct TestTicket
+{
+  unsigned char name_[ObSSLTicketKey::NAME_LEN];
+  unsigned char iv_[EVP_MAX_IV_LENGTH];
+  unsigned char data_[256];
+  int data_len_;
+  unsigned char mac_[EVP_MAX_MD_SIZE];
+  unsigned int mac_len_;
+};
+
+class TestSSLTicketKey : public ::testing::Test
+{
+public:
+  virtual void SetUp()
+  {
+    interval_us_ = get_global_proxy_config().ssl_session_ticket_key_rotate_interval;
+    now_us_ = 1000 * interval_us_ + 1;
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+    HMAC_CTX_init(&hmac_ctx_buf_);
+    hmac_ctx_ = &hmac_ctx_buf_;
+#else
+    hmac_ctx_ = HMAC_CTX_new();
+#endif
+    cipher_ctx_ = EVP_CIPHER_CTX_new();
+    ASSERT_TRUE(NULL != hmac_ctx_);
+    ASSERT_TRUE(NULL != cipher_ctx_);
+  }
+
+  virtual void TearDown()
+  {
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+    HMAC_CTX_cleanup(&hmac_ctx_buf_);
+#else
+    HMAC_CTX_free(hmac_ctx_);
+#endif
+    EVP_CIPHER_CTX_free(cipher_ctx_);
+  }
+
+  // returns the result of key callback
+  int issue(ObSSLProcessor &processor, const int64_t now_us, TestTicket &ticket)
+  {
+    int len = 0;
+    int cb_ret = processor.handle_ticket_key(ticket.name_, ticket.iv_, cipher_ctx_, hmac_ctx_, 1, now_us);
+    if (1 == cb_ret) {
+      EXPECT_EQ(1, EVP_EncryptUpdate(cipher_ctx_, ticket.data_, &ticket.data_len_,
+                                     reinterpret_cast<const unsigned char *>(SESSION_STATE),
+                                     static_cast<int>(strlen(SESSION_STATE))));
+      EXPECT_EQ(1, EVP_EncryptFinal_ex(cipher_ctx_, ticket.data_ + ticket.data_len_, &len));
+      ticket.data_len_ += len;
+      EXPECT_EQ(1, HMAC_Update(hmac_ctx_, ticket.data_, ticket.data_len_));
+      EXPECT_EQ(1, HMAC_Final(hmac_ctx_, ticket.mac_, &ticket.mac_len_));
+    }
+    return cb_ret;
+  }
+
+  // returns the result of key callback, the state is checked if the ticket is accepted
+  int resume(ObSSLProcessor &processor, const int64_t now_us, TestTicket &ticket)
+  {
+    unsigned char state[256];
+    int state_len = 0;
+    int len = 0;
+    unsigned char mac[EVP_MAX_MD_SIZE];
+    unsigned int mac_len = 0;
+    int cb_ret = processor.handle_ticket_key(ticket.name_, ticket.iv_, cipher_ctx_, hmac_ctx_, 0, now_us);
+    if (cb_ret > 0) {
+      EXPECT_EQ(1, HMAC_Update(hmac_ctx_, ticket.data_, ticket.data_len_));
+      EXPECT_EQ(1, HMAC_Final(hmac_ctx_, mac, &mac_len));
+      EXPECT_EQ(ticket.mac_len_, mac_len);
+      EXPECT_EQ(0, memcmp(ticket.mac_, mac, mac_len));
+      EXPECT_EQ(1, EVP_DecryptUpdate(cipher_ctx_, state, &state_len, ticket.data_, ticket.data_len_));
+      EXPECT_EQ(1, EVP_DecryptFinal_ex(cipher_ctx_, state + state_len, &len));
+      state_len += len;
+      EXPECT_EQ(static_cast<int>(strlen(SESSION_STATE)), state_len);
+      EXPECT_EQ(0, memcmp(SESSION_STATE, state, state_len));
+    }
+    return cb_ret;
+  }
+
+public:
+  int64_t interval_us_;
+  int64_t now_us_;
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
+  HMAC_CTX hmac_ctx_buf_;
+#endif
+  HMAC_CTX *hmac_ctx_;
+  EVP_CIPHER_CTX *cipher_ctx_;
+};
+
+TEST_F(TestSSLTicketKey, derive)
+{
+  ObSSLTicketKey key1;
+  ObSSLTicketKey key2;
+  const unsigned char *secret = reinterpret_cast<const unsigned char *>(TICKET_SECRET);
+  const int64_t secret_len = static_cast<int64_t>(strlen(TICKET_SECRET));
+  ASSERT_EQ(OB_INVALID_ARGUMENT, key1.derive(NULL, secret_len, 1));
+  ASSERT_FALSE(key1.is_valid_);
+
+  ASSERT_EQ(OB_SUCCESS, key1.derive(secret, secret_len, 1));
+  ASSERT_EQ(OB_SUCCESS, key2.derive(secret, secret_len, 1));
+  ASSERT_TRUE(key1.is_valid_);
+  ASSERT_EQ(1, key1.epoch_);
+  ASSERT_EQ(0, memcmp(&key1, &key2, sizeof(key1)));
+
+  ASSERT_EQ(OB_SUCCESS, key2.derive(secret, secret_len, 2));
+  ASSERT_NE(0, memcmp(key1.name_, key2.name_, ObSSLTicketKey::NAME_LEN));
+  ASSERT_NE(0, memcmp(key1.aes_key_, key2.aes_key_, ObSSLTicketKey::AES_KEY_LEN));
+  ASSERT_NE(0, memcmp(key1.hmac_key_, key2.hmac_key_, ObSSLTicketKey::HMAC_KEY_LEN));
+  ASSERT_NE(0, memcmp(key1.aes_key_, key1.hmac_key_, ObSSLTicketKey::AES_KEY_LEN));
+}
+
+TEST_F(TestSSLTicketKey, no_secret)
+{
+  ObSSLProcessor processor;
+  TestTicket ticket;
+  ASSERT_FALSE(processor.has_ticket_key_secret());
+  ASSERT_EQ(-1, issue(processor, now_us_, ticket));
+
+  processor.reset_session_resumption(ObString::make_string(TICKET_SECRET));
+  ASSERT_TRUE(processor.has_ticket_key_secret());
+  ASSERT_EQ(1, issue(processor, now_us_, ticket));
+
+  // removed from the security config
+  processor.reset_session_resumption(ObString());
+  ASSERT_FALSE(processor.has_ticket_key_secret());
+  ASSERT_EQ(0, resume(processor, now_us_, ticket));
+  ASSERT_EQ(-1, issue(processor, now_us_, ticket));
+
+  // checked before the certificate is touched
+  ASSERT_EQ(OB_INVALID_ARGUMENT, processor.update_key(ObString::make_string("FILE"), ObString::make_string("ca"),
+                                                      ObString::make_string("public"), ObString::make_string("private"),
+                                                      ObString::make_string("short secret")));
+  ASSERT_FALSE(processor.has_ticket_key_secret());
+}
+
+TEST_F(TestSSLTicketKey, issue_rotate_resume)
+{
+  // two proxy processes sharing the security config
+  ObSSLProcessor processor1;
+  ObSSLProcessor processor2;
+  ObSSLProcessor other_processor;
+  TestTicket ticket;
+  TestTicket new_ticket;
+  processor1.reset_session_resumption(ObString::make_string(TICKET_SECRET));
+  processor2.reset_session_resumption(ObString::make_string(TICKET_SECRET));
+  other_processor.reset_session_resumption(ObString::make_string(OTHER_TICKET_SECRET));
+
+  ASSERT_EQ(1, issue(processor1, now_us_, ticket));
+  ASSERT_EQ(1, resume(processor1, now_us_, ticket));
+  ASSERT_EQ(1, resume(processor2, now_us_ + interval_us_ / 2, ticket));
+  ASSERT_EQ(0, resume(other_processor, now_us_, ticket));
+
+  // rotated, the ticket of the previous key is accepted and renewed
+  const int64_t rotate_us = now_us_ + interval_us_;
+  ASSERT_EQ(1, issue(processor1, rotate_us, new_ticket));
+  ASSERT_NE(0, memcmp(ticket.name_, new_ticket.name_, ObSSLTicketKey::NAME_LEN));
+  ASSERT_EQ(2, resume(processor1, rotate_us, ticket));
+  ASSERT_EQ(2, resume(processor2, rotate_us, ticket));
+  ASSERT_EQ(1, resume(processor2, rotate_us, new_ticket));
+
+  // rotated twice
+  ASSERT_EQ(0, resume(processor1, rotate_us + interval_us_, ticket));
+  ASSERT_EQ(2, resume(processor2, rotate_us + interval_us_, new_ticket));
+
+  // a new secret invalidates all tickets
+  processor2.reset_session_resumption(ObString::make_string(OTHER_TICKET_SECRET));
+  ASSERT_EQ(0, resume(processor2, rotate_us, new_ticket));
+}
+
+} // end of namespace net
+} // end of namespace obproxy
+} // end of namespace oceanbase
+
+int main(int argc, char **argv)
+{
+  oceanbase::common::ObLogger::get_logger().set_log_level("ERROR");
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}